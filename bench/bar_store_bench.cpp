@@ -0,0 +1,293 @@
+// Compressed bar segments against raw columns, the store's reason to
+// exist: bytes on disk, decoding in memory against copying, and reading
+// a scan over many symbols from warm and cold page cache. Segments are read
+// with the batched readRanges path and with one readRange per symbol;
+// raw columns are read with the same AsyncReader batches, without
+// decoding. Cold runs drop each file's pages with posix_fadvise first.
+// Exits non-zero if any path returns different bars.
+#include "store/async_reader.h"
+#include "store/bar_segment.h"
+#include "store/bar_store.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace trading;
+
+namespace {
+    constexpr size_t kSymbols = 100;
+    constexpr size_t kSessions = 20;
+    constexpr size_t kBarsPerSession = 390; // 1-minute bars
+    constexpr size_t kRowBytes = 6 * 8;
+
+    std::string symbolName(size_t i) {
+        return "S" + std::to_string(1000 + i);
+    }
+
+    std::vector<std::string> sessionDates() {
+        std::vector<std::string> dates;
+        int64_t day = parseBarTime("2024-03-04") / 86400;
+        while (dates.size() < kSessions) {
+            const int64_t weekday = (day % 7 + 11) % 7;
+            if (weekday != 0 && weekday != 6) {
+                dates.push_back(formatBarTime(day * 86400).substr(0, 10));
+            }
+            day++;
+        }
+        return dates;
+    }
+
+    // One session of 1-minute bars: cent prices on a random walk, lumpy volume
+    BarColumns makeSession(const std::string& date, std::mt19937& rng, double& price) {
+        std::normal_distribution<double> step(0.0, 0.04);
+        std::lognormal_distribution<double> volume(8.0, 1.0);
+        BarColumns bars;
+        const int64_t open = parseBarTime(date + " 09:30:00");
+        for (size_t i = 0; i < kBarsPerSession; ++i) {
+            const double o = price;
+            price = std::max(1.0, std::round((price + step(rng)) * 100) / 100);
+            bars.timestamps.push_back(open + static_cast<int64_t>(i) * 60);
+            bars.open.push_back(o);
+            bars.high.push_back(std::max(o, price) + 0.01 * (rng() % 4));
+            bars.low.push_back(std::min(o, price) - 0.01 * (rng() % 4));
+            bars.close.push_back(price);
+            bars.volume.push_back(static_cast<int64_t>(volume(rng)) / 100 * 100);
+        }
+        return bars;
+    }
+
+    // Raw layout: the six columns back to back, 8 bytes per value
+    std::string rawColumns(const BarColumns& bars) {
+        std::string out;
+        const size_t n = bars.size();
+        out.append(reinterpret_cast<const char*>(bars.timestamps.data()), n * 8);
+        out.append(reinterpret_cast<const char*>(bars.open.data()), n * 8);
+        out.append(reinterpret_cast<const char*>(bars.high.data()), n * 8);
+        out.append(reinterpret_cast<const char*>(bars.low.data()), n * 8);
+        out.append(reinterpret_cast<const char*>(bars.close.data()), n * 8);
+        out.append(reinterpret_cast<const char*>(bars.volume.data()), n * 8);
+        return out;
+    }
+
+    void appendRaw(const uint8_t* data, size_t length, BarColumns& out) {
+        const size_t n = length / kRowBytes;
+        const size_t base = out.size();
+        out.resize(base + n);
+        std::memcpy(out.timestamps.data() + base, data, n * 8);
+        std::memcpy(out.open.data() + base, data + n * 8, n * 8);
+        std::memcpy(out.high.data() + base, data + n * 16, n * 8);
+        std::memcpy(out.low.data() + base, data + n * 24, n * 8);
+        std::memcpy(out.close.data() + base, data + n * 32, n * 8);
+        std::memcpy(out.volume.data() + base, data + n * 40, n * 8);
+    }
+
+    bool sameBars(const BarColumns& a, const BarColumns& b) {
+        return a.timestamps == b.timestamps && a.open == b.open && a.high == b.high && a.low == b.low &&
+               a.close == b.close && a.volume == b.volume;
+    }
+
+    void dropCache(const std::vector<std::string>& paths) {
+        for (const auto& path : paths) {
+            int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd >= 0) {
+                fdatasync(fd);
+                posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+                close(fd);
+            }
+        }
+    }
+
+    // Raw column files of every symbol, in one AsyncReader batch
+    std::vector<BarColumns> readRaw(const std::vector<std::vector<std::string>>& paths) {
+        std::vector<BarColumns> results(paths.size());
+        std::vector<ReadRequest> requests;
+        std::vector<size_t> owner;
+        for (size_t s = 0; s < paths.size(); ++s) {
+            results[s].reserve(kSessions * kBarsPerSession);
+            for (const auto& path : paths[s]) {
+                int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+                struct stat st;
+                fstat(fd, &st);
+                requests.push_back({fd, 0, static_cast<size_t>(st.st_size)});
+                owner.push_back(s);
+            }
+        }
+        // Sessions of a symbol are appended in completion order, then put back in time order
+        std::vector<std::vector<std::pair<size_t, BarColumns>>> parts(paths.size());
+        AsyncReader::shared().readBatch(requests, [&](size_t index, const uint8_t* data, size_t length, int error) {
+            if (error != 0) {
+                throw std::runtime_error(std::string("read failed: ") + std::strerror(error));
+            }
+            parts[owner[index]].emplace_back(index, BarColumns());
+            appendRaw(data, length, parts[owner[index]].back().second);
+        });
+        for (size_t s = 0; s < parts.size(); ++s) {
+            std::sort(parts[s].begin(), parts[s].end(),
+                      [](const auto& a, const auto& b) { return a.first < b.first; });
+            for (const auto& part : parts[s]) {
+                results[s].append(part.second, 0, part.second.size());
+            }
+        }
+        for (const auto& request : requests) {
+            close(request.fd);
+        }
+        return results;
+    }
+
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void removeTree(const std::string& path) {
+        if (DIR* dir = opendir(path.c_str())) {
+            while (struct dirent* entry = readdir(dir)) {
+                std::string name = entry->d_name;
+                if (name != "." && name != "..") {
+                    removeTree(path + "/" + name);
+                }
+            }
+            closedir(dir);
+            rmdir(path.c_str());
+        } else {
+            unlink(path.c_str());
+        }
+    }
+}
+
+int main() {
+    char dirTemplate[] = "/tmp/bar_store_bench.XXXXXX";
+    const std::string root = mkdtemp(dirTemplate);
+    const std::string rawRoot = root + "/raw";
+    mkdir(rawRoot.c_str(), 0755);
+    const BarStore store(root + "/store");
+    const std::vector<std::string> dates = sessionDates();
+
+    std::mt19937 rng(5);
+    std::vector<BarColumns> expected(kSymbols);
+    std::vector<std::vector<std::string>> rawPaths(kSymbols);
+    std::vector<std::string> segmentPaths;
+    std::vector<std::string> segments; // in memory, for the decode-only comparison
+    size_t rawBytes = 0;
+    size_t segmentBytes = 0;
+    for (size_t s = 0; s < kSymbols; ++s) {
+        double price = 20.0 + s;
+        for (const auto& date : dates) {
+            const BarColumns bars = makeSession(date, rng, price);
+            expected[s].append(bars, 0, bars.size());
+            store.put(symbolName(s), "1m", date, bars);
+            segmentPaths.push_back(store.pathFor(symbolName(s), "1m", date));
+            segments.push_back(BarSegment::encode(bars));
+            segmentBytes += segments.back().size();
+
+            const std::string raw = rawColumns(bars);
+            const std::string path = rawRoot + "/" + symbolName(s) + "." + date + ".raw";
+            FILE* file = std::fopen(path.c_str(), "wb");
+            std::fwrite(raw.data(), 1, raw.size(), file);
+            std::fclose(file);
+            rawPaths[s].push_back(path);
+            rawBytes += raw.size();
+        }
+    }
+    std::vector<std::string> allRawPaths;
+    for (const auto& paths : rawPaths) {
+        allRawPaths.insert(allRawPaths.end(), paths.begin(), paths.end());
+    }
+    const double outputMB = static_cast<double>(rawBytes) / (1 << 20);
+    const size_t rows = kSymbols * kSessions * kBarsPerSession;
+
+    std::printf("%zu symbols x %zu sessions x %zu bars (%zu rows), reader: %s\n", kSymbols, kSessions,
+                kBarsPerSession, rows, AsyncReader::shared().backend());
+    std::printf("  raw columns   %8.2f MB\n", outputMB);
+    std::printf("  segments      %8.2f MB  (%.2fx smaller)\n", static_cast<double>(segmentBytes) / (1 << 20),
+                static_cast<double>(rawBytes) / segmentBytes);
+
+    size_t mismatches = 0;
+
+    // In memory: decoding segments against copying raw columns
+    std::vector<std::string> rawInMemory;
+    for (size_t s = 0; s < kSymbols; ++s) {
+        rawInMemory.push_back(rawColumns(expected[s]));
+    }
+    std::vector<BarColumns> copied(kSymbols);
+    std::vector<BarColumns> decoded(kSymbols);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t s = 0; s < kSymbols; ++s) {
+        appendRaw(reinterpret_cast<const uint8_t*>(rawInMemory[s].data()), rawInMemory[s].size(), copied[s]);
+    }
+    const double copySeconds = secondsSince(start);
+    start = std::chrono::steady_clock::now();
+    for (size_t s = 0; s < kSymbols; ++s) {
+        decoded[s].reserve(kSessions * kBarsPerSession);
+        for (size_t d = 0; d < kSessions; ++d) {
+            const std::string& segment = segments[s * kSessions + d];
+            BarSegment::decodeRange(reinterpret_cast<const uint8_t*>(segment.data()), segment.size(),
+                                    INT64_MIN, INT64_MAX, decoded[s]);
+        }
+    }
+    const double decodeSeconds = secondsSince(start);
+    for (size_t s = 0; s < kSymbols; ++s) {
+        mismatches += !sameBars(copied[s], expected[s]) + !sameBars(decoded[s], expected[s]);
+    }
+    std::printf("In memory, MB/s of bars produced\n");
+    std::printf("  copy raw columns      %9.0f MB/s\n", outputMB / copySeconds);
+    std::printf("  decode segments       %9.0f MB/s\n", outputMB / decodeSeconds);
+
+    // From files: every symbol's whole range, warm and then cold
+    std::vector<RangeQuery> queries;
+    for (size_t s = 0; s < kSymbols; ++s) {
+        queries.push_back({symbolName(s), "1m", parseBarTime(dates.front()), parseBarTime(dates.back() + " 23:59:59")});
+    }
+    for (bool cold : {false, true}) {
+        std::printf("%s page cache, ms for the whole scan\n", cold ? "Cold" : "Warm");
+
+        if (cold) {
+            dropCache(allRawPaths);
+        }
+        start = std::chrono::steady_clock::now();
+        std::vector<BarColumns> raw = readRaw(rawPaths);
+        const double rawSeconds = secondsSince(start);
+
+        if (cold) {
+            dropCache(segmentPaths);
+        }
+        start = std::chrono::steady_clock::now();
+        std::vector<BarColumns> batched = store.readRanges(queries);
+        const double batchedSeconds = secondsSince(start);
+
+        if (cold) {
+            dropCache(segmentPaths);
+        }
+        start = std::chrono::steady_clock::now();
+        std::vector<BarColumns> mapped;
+        for (const auto& query : queries) {
+            mapped.push_back(store.readRange(query.symbol, query.interval, query.from, query.to));
+        }
+        const double mappedSeconds = secondsSince(start);
+
+        for (size_t s = 0; s < kSymbols; ++s) {
+            mismatches += !sameBars(raw[s], expected[s]) + !sameBars(batched[s], expected[s]) +
+                          !sameBars(mapped[s], expected[s]);
+        }
+        std::printf("  raw columns, batched reads      %8.1f ms  (%5.2f MB read)\n", rawSeconds * 1e3, outputMB);
+        std::printf("  segments, readRanges (batched)  %8.1f ms  (%5.2f MB read)\n", batchedSeconds * 1e3,
+                    static_cast<double>(segmentBytes) / (1 << 20));
+        std::printf("  segments, readRange per symbol  %8.1f ms\n", mappedSeconds * 1e3);
+    }
+
+    removeTree(root);
+    if (mismatches > 0) {
+        std::printf("  %zu results differ from the bars written\n", mismatches);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,83 @@
+// MACDBatch against one MACDStrategy run per configuration over the same
+// series. Exits non-zero if any configuration's result differs.
+#include "strategies/batch_strategy.h"
+#include "strategies/macd_strategy.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace trading;
+
+namespace {
+    MarketData randomWalk(size_t bars, unsigned seed) {
+        MarketData data;
+        std::mt19937 rng(seed);
+        std::normal_distribution<double> step(0.0, 0.003);
+        double price = 100.0;
+        for (size_t i = 0; i < bars; ++i) {
+            price *= std::exp(step(rng));
+            data.prices.push_back(price);
+            data.timestamps.push_back("2024-03-05 10:00:00");
+        }
+        return data;
+    }
+
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main() {
+    const size_t bars = 2000;
+    const double initialCash = 100000.0;
+    const MarketData data = randomWalk(bars, 7);
+
+    std::vector<MACDConfig> configs;
+    for (int fast = 2; fast <= 9; ++fast) {
+        for (int slow = fast + 2; slow <= fast + 17; slow += 3) {
+            for (int signal = 3; signal <= 9; signal += 2) {
+                for (double stop : {0.01, 0.03}) {
+                    configs.push_back({fast, slow, signal, stop, 0.001});
+                }
+            }
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    const std::vector<BatchResult> batch = MACDBatch(configs).run(data, initialCash);
+    const double batchSeconds = secondsSince(start);
+
+    // MACDStrategy logs every tenth tick; a stream without a buffer drops
+    // the output before it is formatted
+    std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+    std::vector<SimulationResult> single;
+    start = std::chrono::steady_clock::now();
+    for (const MACDConfig& c : configs) {
+        MACDStrategy strategy(0.02, 0.3, 1e-6, 0.1, 0.85, c.macdFastPeriod, c.macdSlowPeriod,
+                              c.signalPeriod, 0.05, c.stopLossPercentage, c.transactionCost);
+        single.push_back(strategy.execute(data, initialCash));
+    }
+    const double singleSeconds = secondsSince(start);
+    std::cout.rdbuf(coutBuffer);
+    std::cout.clear();
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < configs.size(); ++i) {
+        if (std::abs(batch[i].finalPortfolioValue - single[i].finalPortfolioValue) > 1e-6 ||
+            batch[i].numTrades != static_cast<int>(single[i].trades.size())) {
+            ++mismatches;
+        }
+    }
+
+    std::printf("MACD, %zu configurations x %zu bars\n", configs.size(), bars);
+    std::printf("  MACDStrategy one by one  %9.2f ms\n", singleSeconds * 1e3);
+    std::printf("  MACDBatch                %9.2f ms  (%.0fx)\n", batchSeconds * 1e3, singleSeconds / batchSeconds);
+    if (mismatches > 0) {
+        std::printf("  %zu configurations differ\n", mismatches);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,160 @@
+// A mean reversion sweep on the compute scheduler, split into 512-config
+// units as /sweep does, with the workers unpinned and then pinned to
+// TRADING_COMPUTE_CPUS (all available CPUs if unset). Reports throughput
+// and the spread of unit run times, the jitter pinning is meant to reduce.
+// Exits non-zero if the two placements' results differ.
+#include "strategies/batch_strategy.h"
+#include "utils/placement.h"
+#include "utils/scheduler.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <mutex>
+#include <random>
+#include <vector>
+
+using namespace trading;
+
+namespace {
+    constexpr size_t kUnitSize = 512;
+    constexpr int kRounds = 3;
+
+    MarketData randomWalk(size_t bars, unsigned seed) {
+        MarketData data;
+        std::mt19937 rng(seed);
+        std::normal_distribution<double> step(0.0, 0.003);
+        double price = 100.0;
+        for (size_t i = 0; i < bars; ++i) {
+            price *= std::exp(step(rng));
+            data.prices.push_back(price);
+            data.timestamps.push_back("2024-03-05 10:00:00");
+        }
+        return data;
+    }
+
+    struct SweepRun {
+        double seconds;
+        std::vector<double> unitMs;
+        std::vector<BatchResult> results;
+    };
+
+    // Runs the batch as resumable background units, one lane per worker
+    SweepRun sweep(Scheduler& scheduler, const MeanReversionBatch& batch, const MarketData& data) {
+        SweepRun run;
+        run.results.resize(batch.size());
+        std::atomic<size_t> next{0};
+        std::mutex unitMutex;
+        const size_t lanes = scheduler.limit(Priority::Background);
+
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::future<void>> pending;
+        for (size_t lane = 0; lane < lanes; ++lane) {
+            pending.push_back(scheduler.submitResumable(Priority::Background, [&]() {
+                size_t begin = next.fetch_add(kUnitSize);
+                if (begin >= batch.size()) {
+                    return false;
+                }
+                size_t end = std::min(begin + kUnitSize, batch.size());
+                const auto unitStart = std::chrono::steady_clock::now();
+                batch.run(data, 100000.0, begin, end, run.results.data() + begin);
+                const double ms =
+                    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - unitStart).count();
+                std::lock_guard<std::mutex> lock(unitMutex);
+                run.unitMs.push_back(ms);
+                return end < batch.size();
+            }));
+        }
+        for (auto& future : pending) {
+            future.get();
+        }
+        run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return run;
+    }
+
+    double percentile(std::vector<double> values, double p) {
+        std::sort(values.begin(), values.end());
+        return values[static_cast<size_t>(p * (values.size() - 1))];
+    }
+
+    void report(const char* label, const CpuList& cpus, size_t configs, const std::vector<SweepRun>& runs) {
+        double seconds = 0;
+        std::vector<double> units;
+        for (const auto& run : runs) {
+            seconds += run.seconds;
+            units.insert(units.end(), run.unitMs.begin(), run.unitMs.end());
+        }
+        double mean = 0;
+        for (double ms : units) {
+            mean += ms;
+        }
+        mean /= units.size();
+        double variance = 0;
+        for (double ms : units) {
+            variance += (ms - mean) * (ms - mean);
+        }
+        const double p50 = percentile(units, 0.5);
+        std::printf("  %-9s cpus=%-10s %9.0f configs/s   unit ms p50 %6.2f  p99 %6.2f  max %6.2f  "
+                    "stddev %5.2f  (max/p50 %.2f)\n",
+                    label, cpus.empty() ? "any" : formatCpuList(cpus).c_str(), configs * runs.size() / seconds,
+                    p50, percentile(units, 0.99), percentile(units, 1.0), std::sqrt(variance / units.size()),
+                    percentile(units, 1.0) / p50);
+    }
+}
+
+int main() {
+    const size_t bars = 5000;
+    const MarketData data = randomWalk(bars, 11);
+
+    std::vector<MeanReversionConfig> configs;
+    for (int lookback = 10; lookback <= 100; lookback += 10) {
+        for (double entry = 1.0; entry <= 3.0; entry += 0.25) {
+            for (double exit = 0.0; exit <= 1.0; exit += 0.25) {
+                for (double stop : {0.01, 0.02, 0.03, 0.05}) {
+                    for (double target : {0.02, 0.03, 0.05, 0.08}) {
+                        configs.push_back({lookback, entry, exit, stop, target, 0.001});
+                    }
+                }
+            }
+        }
+    }
+    const MeanReversionBatch batch(configs);
+
+    CpuList pinned = cpuListFromEnvironment("TRADING_COMPUTE_CPUS");
+    if (pinned.empty()) {
+        pinned = availableCpus();
+    }
+    const size_t workers = pinned.size();
+
+    std::printf("Mean reversion sweep, %zu configurations x %zu bars, %zu workers, %d rounds\n",
+                configs.size(), bars, workers, kRounds);
+    std::vector<BatchResult> reference;
+    size_t mismatches = 0;
+    for (bool pin : {false, true}) {
+        const CpuList cpus = pin ? pinned : CpuList();
+        Scheduler scheduler(workers, workers, workers, cpus);
+        sweep(scheduler, batch, data); // warm-up: first touch of the workers' scratch
+        std::vector<SweepRun> runs;
+        for (int round = 0; round < kRounds; ++round) {
+            runs.push_back(sweep(scheduler, batch, data));
+        }
+        report(pin ? "pinned" : "unpinned", cpus, configs.size(), runs);
+        for (const auto& run : runs) {
+            if (reference.empty()) {
+                reference = run.results;
+            }
+            for (size_t i = 0; i < configs.size(); ++i) {
+                if (run.results[i].finalPortfolioValue != reference[i].finalPortfolioValue ||
+                    run.results[i].numTrades != reference[i].numTrades) {
+                    ++mismatches;
+                }
+            }
+        }
+    }
+    if (mismatches > 0) {
+        std::printf("  %zu results differ between runs\n", mismatches);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,85 @@
+// Rolling median and MAD from RollingQuantile against copying and sorting
+// the window on every bar. Exits non-zero if the two ever disagree.
+#include "utils/indicators.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace trading;
+
+namespace {
+    double sortedMedian(std::vector<double>& values) {
+        std::sort(values.begin(), values.end());
+        const size_t n = values.size();
+        return n % 2 == 1 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+    }
+
+    void sortedMedianMAD(const double* values, size_t n, int period, double* median, double* mad) {
+        std::vector<double> window;
+        for (size_t i = 0; i < n; ++i) {
+            if (i + 1 < static_cast<size_t>(period)) {
+                median[i] = mad[i] = std::nan("");
+                continue;
+            }
+            window.assign(values + i + 1 - period, values + i + 1);
+            const double center = sortedMedian(window);
+            for (double& x : window) {
+                x = std::abs(x - center);
+            }
+            median[i] = center;
+            mad[i] = sortedMedian(window);
+        }
+    }
+
+    bool same(double a, double b) {
+        return a == b || (std::isnan(a) && std::isnan(b));
+    }
+
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main() {
+    // Prices rounded to cents, so windows hold repeated values
+    const size_t bars = 50000;
+    std::vector<double> prices(bars);
+    std::mt19937 rng(11);
+    std::student_t_distribution<double> step(3.0);
+    double price = 100.0;
+    for (double& p : prices) {
+        price = std::max(1.0, price + 0.05 * step(rng));
+        p = std::round(price * 100) / 100;
+    }
+
+    std::printf("Rolling median + MAD, %zu bars\n", bars);
+    bool agree = true;
+    for (int period : {20, 100, 500}) {
+        std::vector<double> median(bars), mad(bars), sortedMed(bars), sortedMad(bars);
+
+        auto start = std::chrono::steady_clock::now();
+        calculateRollingMedianMAD(prices.data(), bars, period, median.data(), mad.data());
+        const double windowSeconds = secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        sortedMedianMAD(prices.data(), bars, period, sortedMed.data(), sortedMad.data());
+        const double sortSeconds = secondsSince(start);
+
+        size_t mismatches = 0;
+        for (size_t i = 0; i < bars; ++i) {
+            if (!same(median[i], sortedMed[i]) || !same(mad[i], sortedMad[i])) {
+                ++mismatches;
+            }
+        }
+        std::printf("  w=%-4d copy and sort %8.2f ms   RollingQuantile %7.2f ms  (%.1fx)\n",
+                    period, sortSeconds * 1e3, windowSeconds * 1e3, sortSeconds / windowSeconds);
+        if (mismatches > 0) {
+            std::printf("         %zu bars differ\n", mismatches);
+            agree = false;
+        }
+    }
+    return agree ? 0 : 1;
+}
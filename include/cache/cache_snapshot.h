@@ -0,0 +1,62 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace trading {
+
+struct SnapshotRecord {
+    std::string_view key;
+    std::string_view value;
+    int64_t createdAt;
+};
+
+// Read-only, memory-mapped cache snapshot. The file carries its own
+// open-addressing hash index, so opening it costs the same regardless of
+// its size and lookups probe the mapping directly.
+class CacheSnapshot {
+public:
+    ~CacheSnapshot();
+    CacheSnapshot(const CacheSnapshot&) = delete;
+    CacheSnapshot& operator=(const CacheSnapshot&) = delete;
+
+    // Maps a snapshot; returns nullptr if the file is missing, corrupt or
+    // was written by a different generation.
+    static std::shared_ptr<const CacheSnapshot> open(const std::string& path,
+                                                     const std::string& generation);
+
+    struct Entry {
+        std::string key;
+        std::shared_ptr<const std::string> value;
+        int64_t createdAt;
+    };
+
+    // Writes entries to path via a temp file and rename
+    static void write(const std::string& path, const std::string& generation,
+                      const std::vector<Entry>& entries);
+
+    std::optional<SnapshotRecord> find(const std::string& key) const;
+    void forEach(const std::function<void(const SnapshotRecord&)>& visit) const;
+    size_t entryCount() const { return count; }
+
+private:
+    CacheSnapshot(const char* data, size_t size, uint64_t bucketCount, uint64_t count);
+
+    std::optional<SnapshotRecord> recordAt(uint64_t offset) const;
+
+    const char* data;
+    size_t size;
+    uint64_t bucketCount;
+    uint64_t count;
+};
+
+// Current binary's identity, used as the generation of result snapshots so
+// a redeploy never serves results computed by older strategy code.
+std::string binaryGeneration();
+
+} // namespace trading
@@ -0,0 +1,38 @@
+#pragma once
+#include <functional>
+#include <optional>
+#include <string>
+
+namespace trading {
+
+// On-disk key/value cache that can be shared by several processes, on one
+// host or across hosts on a shared volume. Entries are published with an
+// atomic rename, so readers never take a lock and never see a torn file.
+// Cold fetches are leased with an advisory lock per key so only one
+// process (and one thread within it) does the work.
+class DiskCache {
+public:
+    explicit DiskCache(std::string directory);
+
+    // Builds a cache rooted at $TRADING_CACHE_DIR, disabled if unset
+    static DiskCache fromEnvironment();
+
+    bool enabled() const { return !directory.empty(); }
+    const std::string& getDirectory() const { return directory; }
+
+    std::optional<std::string> get(const std::string& key) const;
+    void put(const std::string& key, const std::string& value) const;
+
+    // Returns the cached value or runs fetch under the key's lease and
+    // publishes its result when cacheable(result) is true.
+    std::string getOrFetch(const std::string& key,
+                           const std::function<std::string()>& fetch,
+                           const std::function<bool(const std::string&)>& cacheable) const;
+
+    std::string pathFor(const std::string& key) const;
+
+private:
+    std::string directory;
+};
+
+} // namespace trading
@@ -0,0 +1,59 @@
+#pragma once
+#include "cache/cache_snapshot.h"
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace trading {
+
+// Thread-safe in-memory LRU cache of serialized values, bounded by bytes.
+// Snapshots from a previous run can be attached as a lazily consulted
+// second level: entries are validated and promoted on first access.
+class MemoryCache {
+public:
+    using Validator = std::function<bool(const std::string& key, int64_t createdAt)>;
+
+    explicit MemoryCache(size_t capacityBytes);
+
+    std::shared_ptr<const std::string> get(const std::string& key);
+    void put(const std::string& key, std::string value);
+
+    // Snapshots are consulted in order. The first is the one this process
+    // saved last time; only its unrequested entries are carried over by
+    // saveSnapshot, so processes sharing a directory do not copy each
+    // other's files. Null snapshots are ignored.
+    void attachSnapshots(std::vector<std::shared_ptr<const CacheSnapshot>> snapshots, Validator validator);
+
+    // Writes at most capacityBytes of entries, most recently used first
+    void saveSnapshot(const std::string& path, const std::string& generation) const;
+
+    size_t size() const;
+    size_t bytes() const;
+
+private:
+    struct Node {
+        std::string key;
+        std::shared_ptr<const std::string> value;
+        int64_t createdAt;
+    };
+
+    void insertLocked(const std::string& key, std::shared_ptr<const std::string> value, int64_t createdAt);
+
+    mutable std::mutex mutex;
+    size_t capacityBytes;
+    size_t usedBytes;
+    std::list<Node> lru; // most recently used first
+    std::unordered_map<std::string, std::list<Node>::iterator> index;
+
+    std::vector<std::shared_ptr<const CacheSnapshot>> snapshots;
+    Validator validator;
+    std::unordered_set<std::string> rejected; // snapshot keys that failed validation
+};
+
+} // namespace trading
@@ -0,0 +1,39 @@
+#pragma once
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace trading {
+
+// Remembers failed lookups for a short time so repeated requests for a bad
+// key are answered without redoing the expensive work. Entries expire after
+// `ttl`; the map is bounded by `maxEntries`.
+class NegativeCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    NegativeCache(std::chrono::seconds ttl, size_t maxEntries);
+
+    std::shared_ptr<const std::string> get(const std::string& key);
+    void put(const std::string& key, std::string value);
+
+    bool enabled() const { return ttl.count() > 0; }
+    size_t size() const;
+
+private:
+    struct Entry {
+        std::shared_ptr<const std::string> value;
+        Clock::time_point expiresAt;
+    };
+
+    void pruneLocked(Clock::time_point now);
+
+    mutable std::mutex mutex;
+    std::chrono::seconds ttl;
+    size_t maxEntries;
+    std::unordered_map<std::string, Entry> entries;
+};
+
+} // namespace trading
@@ -0,0 +1,37 @@
+#pragma once
+#include "store/series_pyramid.h"
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace trading {
+
+// Thread-safe LRU of chart pyramids keyed by the result they were built
+// from, bounded by bytes
+class PyramidCache {
+public:
+    explicit PyramidCache(size_t capacityBytes);
+
+    std::shared_ptr<const SeriesPyramid> get(const std::string& key);
+    void put(const std::string& key, std::shared_ptr<const SeriesPyramid> pyramid);
+
+    size_t size() const;
+    size_t bytes() const;
+
+private:
+    struct Node {
+        std::string key;
+        std::shared_ptr<const SeriesPyramid> pyramid;
+        size_t bytes;
+    };
+
+    mutable std::mutex mutex;
+    size_t capacityBytes;
+    size_t usedBytes;
+    std::list<Node> lru; // most recently used first
+    std::unordered_map<std::string, std::list<Node>::iterator> index;
+};
+
+} // namespace trading
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace trading {
+
+// A gzip-compressed response body kept in a mapped spill file
+class SpilledBody {
+public:
+    ~SpilledBody();
+    SpilledBody(const SpilledBody&) = delete;
+    SpilledBody& operator=(const SpilledBody&) = delete;
+
+    const char* gzipData() const { return mapping + offset; }
+    size_t gzipSize() const { return size - offset; }
+    std::string decompress() const;
+
+private:
+    friend class SpillCache;
+    SpilledBody(const char* mapping, size_t size, size_t offset);
+
+    const char* mapping;
+    size_t size;
+    size_t offset;
+};
+
+// Second level for large cached responses. Bodies at least `minBytes` long
+// are gzip-compressed into one file each under `directory` and served from
+// a read-only mapping, so they cost page cache rather than heap. Files
+// carry the key and a generation tag; a file from another binary, or for a
+// colliding key, is treated as a miss. Several processes may share the
+// directory: files are published with rename(), and a file another process
+// wrote is picked up on its first lookup. `capacityBytes` is a budget for
+// the directory as a whole. The file count and byte total are kept in a
+// ledger file updated under a FileLock, and once they exceed the budget
+// the least recently used files are removed, whichever process wrote them.
+// A hit refreshes its file's modification time, which is what "recently
+// used" means here.
+class SpillCache {
+public:
+    SpillCache(std::string directory, std::string generation, size_t minBytes, size_t capacityBytes);
+
+    // Spills to $TRADING_SPILL_DIR, disabled if unset. TRADING_SPILL_MIN_KB
+    // and TRADING_SPILL_MAX_MB set the size threshold and disk budget.
+    static std::unique_ptr<SpillCache> fromEnvironment(const std::string& generation);
+
+    bool enabled() const { return !directory.empty(); }
+    bool accepts(size_t bodyBytes) const { return enabled() && bodyBytes >= minBytes; }
+
+    std::shared_ptr<const SpilledBody> get(const std::string& key);
+    void put(const std::string& key, const std::string& body);
+
+    // Files and bytes in the directory, across all processes sharing it
+    size_t size() const;
+    size_t bytes() const;
+
+private:
+    struct Usage {
+        size_t files;
+        size_t bytes;
+    };
+
+    // Callers hold `mutex` and a FileLock on lockPath()
+    std::string lockPath() const;
+    bool readUsageLocked(Usage& usage) const;
+    void writeUsageLocked(const Usage& usage) const;
+    Usage evictLocked(size_t targetBytes);
+    Usage usage() const;
+
+    std::string directory;
+    std::string generation;
+    size_t minBytes;
+    size_t capacityBytes;
+
+    // fcntl locks are per process, so threads serialize on this first
+    mutable std::mutex mutex;
+};
+
+} // namespace trading
@@ -0,0 +1,79 @@
+#pragma once
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "store/bar_columns.h"
+#include "utils/cancellation.h"
+
+namespace httplib {
+class Client;
+}
+
+namespace trading {
+
+struct ChartRequest {
+    std::string symbol;
+    std::string interval; // "5m", or the server's "5min" spelling
+    std::string date;     // session date, YYYY-MM-DD
+};
+
+// Failure of a chart request. Request errors (unknown symbol, no session,
+// bad interval) are properties of the request; anything else is an
+// upstream failure.
+class ChartError : public std::runtime_error {
+public:
+    ChartError(const std::string& message, bool requestError)
+        : std::runtime_error(message), requestError_(requestError) {}
+
+    bool requestError() const { return requestError_; }
+
+private:
+    bool requestError_;
+};
+
+// In-process client for a Yahoo-chart-compatible endpoint
+// (GET <base>/v8/finance/chart/<SYMBOL>), replacing a Python fetcher run
+// per request. Keep-alive connections are pooled and reused across calls,
+// and fetchMany() spreads a batch over up to `parallelism` connections.
+// Bars are parsed from the chart JSON straight into columns, with times
+// converted to the exchange's wall clock like the Python fetcher does.
+class ChartClient {
+public:
+    ChartClient(const std::string& baseUrl, size_t parallelism, std::chrono::milliseconds timeout);
+    ~ChartClient();
+
+    ChartClient(const ChartClient&) = delete;
+    ChartClient& operator=(const ChartClient&) = delete;
+
+    // Client for $TRADING_CHART_URL (default Yahoo), sized by
+    // TRADING_CHART_PARALLEL and TRADING_CHART_TIMEOUT_MS
+    static ChartClient& shared();
+
+    // Throws ChartError on failure and OperationCancelled if the token fires
+    BarColumns fetchBars(const ChartRequest& request, const CancellationToken& token);
+
+    // Same result as fetchBars in the Python fetcher's JSON format:
+    // {"data": [...]} or {"error": "..."}; only cancellation throws
+    std::string fetch(const ChartRequest& request, const CancellationToken& token);
+    std::vector<std::string> fetchMany(const std::vector<ChartRequest>& requests, const CancellationToken& token);
+
+private:
+    std::unique_ptr<httplib::Client> acquire();
+    void release(std::unique_ptr<httplib::Client> client);
+
+    std::string hostUrl;    // scheme://host[:port]
+    std::string pathPrefix; // path part of the base URL, without a trailing '/'
+    size_t parallelism;
+    std::chrono::milliseconds timeout;
+
+    std::mutex poolMutex;
+    std::vector<std::unique_ptr<httplib::Client>> idle;
+};
+
+// Parses a chart response into the session's bars; throws ChartError
+BarColumns parseChartResponse(const std::string& body, const std::string& interval, const std::string& date);
+
+} // namespace trading
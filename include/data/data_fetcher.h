@@ -1,16 +1,33 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include "../../nlohmann_json.hpp"
 #include "strategies/base_types.h"
+#include "data/data_source.h"
+#include "data/source_layers.h"
+#include "store/bar_columns.h"
+#include "utils/cancellation.h"
 
 using json = nlohmann::json;
 
 namespace trading {
 
+// Converts a fetcher response's "data" array into OHLCV columns
+BarColumns parseBars(const json& data);
+
 class DataFetcher {
 public:
-    DataFetcher();
+    explicit DataFetcher(std::shared_ptr<DataSource> source);
+
+    // Passed to the source; cancelling it kills an in-flight fetcher process
+    void setCancellationToken(const CancellationToken& token) { cancellationToken = token; }
+
+    // Recent upstream fetch times, shared by all fetchers
+    static const DurationEstimate& scriptDuration();
+
+    // Upstream circuit breaker and negative cache state, shared by all fetchers
+    static FetchHealth health();
     
     json fetchDailyDataFull(const std::string& symbol, const std::string& date);
     json fetchIntradayData(const std::string& symbol, const std::string& interval, const std::string& date);
@@ -18,6 +35,12 @@ public:
     MarketData parseIntradayData(const json& data,
                                 const std::string& interval,
                                 const std::string& date);
+
+private:
+    std::string fetchRaw(const std::string& symbol, const std::string& interval, const std::string& date);
+
+    std::shared_ptr<DataSource> source;
+    CancellationToken cancellationToken;
 };
 
 }
@@ -0,0 +1,91 @@
+#pragma once
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "cache/memory_cache.h"
+#include "store/bar_columns.h"
+#include "utils/cancellation.h"
+
+namespace trading {
+
+struct DataRequest {
+    std::string symbol;
+    std::string interval;
+    std::string date; // session date, YYYY-MM-DD
+
+    // Cache key shared by every caching layer
+    std::string key() const { return "bars|" + symbol + "|" + interval + "|" + date; }
+};
+
+// Anything that can answer a bar request. Responses use the Python
+// fetcher's JSON format, {"data": [...]} or {"error": "..."}, so sources
+// and the layers stacked on them can be swapped freely. Implementations
+// must be safe to call from several threads at once.
+class DataSource {
+public:
+    virtual ~DataSource() = default;
+
+    // Throws OperationCancelled if the token fires; other failures are
+    // reported in the response or as exceptions
+    virtual std::string fetch(const DataRequest& request, const CancellationToken& token) = 0;
+};
+
+// How a response is treated by the caching and failure handling layers
+enum class FetchOutcome {
+    Data,     // bars were returned
+    Rejected, // an error specific to the request (bad symbol, no session)
+    Failed    // the source itself failed
+};
+
+FetchOutcome classifyResponse(const std::string& raw);
+
+// Why a request cannot be served, or "" if it is well formed. Symbols are
+// 1-32 characters of [A-Za-z0-9.^=-] starting with a letter, digit or '^';
+// intervals 1-8 letters and digits; dates real YYYY-MM-DD days. Caches and
+// sources build file names and upstream URLs from these fields.
+std::string requestProblem(const DataRequest& request);
+
+// True if the session on `date` (YYYY-MM-DD) has ended and its bars are final
+bool isCompleteSession(const std::string& date);
+
+// Formats bars as a fetcher "data" response
+std::string formatBars(const BarColumns& bars);
+
+// Thrown without running the upstream source while the circuit breaker is open
+class UpstreamUnavailable : public std::runtime_error {
+public:
+    UpstreamUnavailable(const std::string& message, std::chrono::seconds retryAfter)
+        : std::runtime_error(message), retryAfter_(retryAfter) {}
+
+    std::chrono::seconds retryAfter() const { return retryAfter_; }
+
+private:
+    std::chrono::seconds retryAfter_;
+};
+
+// Which sources and layers make up the data pipeline
+struct DataSourceConfig {
+    // Sources tried in order until one returns data: "python", "chart",
+    // "files:<dir>" or "synthetic"
+    std::vector<std::string> chain = {"python"};
+    MemoryCache* memoryCache = nullptr;
+    std::string diskCacheDir;
+    std::string barStoreDir;
+    bool singleFlight = true;
+
+    // TRADING_DATA_SOURCE (comma separated chain), TRADING_CACHE_DIR,
+    // TRADING_BAR_STORE_DIR and TRADING_SINGLE_FLIGHT
+    static DataSourceConfig fromEnvironment(MemoryCache* memoryCache);
+};
+
+// Builds one named source; throws std::invalid_argument for unknown names
+std::shared_ptr<DataSource> makeSource(const std::string& spec);
+
+// Stacks the configured layers, outermost first: request validation, memory
+// cache, single-flight, disk cache, bar store archiving, upstream guard, then
+// the source chain
+std::shared_ptr<DataSource> buildDataSource(const DataSourceConfig& config);
+
+} // namespace trading
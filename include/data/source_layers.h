@@ -0,0 +1,111 @@
+#pragma once
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "cache/disk_cache.h"
+#include "cache/memory_cache.h"
+#include "data/data_source.h"
+#include "store/bar_store.h"
+
+namespace trading {
+
+// Decorators over a DataSource. Each adds one concern and passes every
+// request it does not answer itself to the wrapped source.
+
+// Answers malformed requests (see requestProblem) with an error without
+// passing them on, so no cache or source builds a path or URL from them
+class RequestValidationLayer : public DataSource {
+public:
+    explicit RequestValidationLayer(std::shared_ptr<DataSource> inner);
+    std::string fetch(const DataRequest& request, const CancellationToken& token) override;
+
+private:
+    std::shared_ptr<DataSource> inner;
+};
+
+// Serves and fills an in-memory cache. Only data for completed sessions is stored.
+class MemoryCacheLayer : public DataSource {
+public:
+    MemoryCacheLayer(std::shared_ptr<DataSource> inner, MemoryCache& cache);
+    std::string fetch(const DataRequest& request, const CancellationToken& token) override;
+
+private:
+    std::shared_ptr<DataSource> inner;
+    MemoryCache& cache;
+};
+
+// Serves and fills a disk cache shared between processes; a miss is
+// fetched under the key's lease so only one process fetches it
+class DiskCacheLayer : public DataSource {
+public:
+    DiskCacheLayer(std::shared_ptr<DataSource> inner, DiskCache cache);
+    std::string fetch(const DataRequest& request, const CancellationToken& token) override;
+
+private:
+    std::shared_ptr<DataSource> inner;
+    DiskCache cache;
+};
+
+// Coalesces concurrent requests for the same key within the process: the
+// first caller fetches and the others wait for its response. A waiter
+// whose leader was cancelled fetches again under its own token.
+class SingleFlightLayer : public DataSource {
+public:
+    explicit SingleFlightLayer(std::shared_ptr<DataSource> inner);
+    std::string fetch(const DataRequest& request, const CancellationToken& token) override;
+
+private:
+    std::shared_ptr<DataSource> inner;
+    std::mutex mutex;
+    std::unordered_map<std::string, std::shared_future<std::string>> inFlight;
+};
+
+// Archives data for completed sessions in the bar store
+class BarStoreLayer : public DataSource {
+public:
+    BarStoreLayer(std::shared_ptr<DataSource> inner, BarStore store);
+    std::string fetch(const DataRequest& request, const CancellationToken& token) override;
+
+private:
+    std::shared_ptr<DataSource> inner;
+    BarStore store;
+};
+
+// Protects the upstream: answers recently rejected requests from the
+// negative cache, fails fast when the deadline cannot fit a typical fetch,
+// and stops calling the upstream while the circuit breaker is open. The
+// breaker, negative cache and duration estimate are shared process-wide.
+class UpstreamGuardLayer : public DataSource {
+public:
+    explicit UpstreamGuardLayer(std::shared_ptr<DataSource> inner);
+    std::string fetch(const DataRequest& request, const CancellationToken& token) override;
+
+private:
+    std::shared_ptr<DataSource> inner;
+};
+
+// Tries sources in order and returns the first response with data. If none
+// has data, the last response is returned (or the last exception rethrown).
+class FallbackSource : public DataSource {
+public:
+    explicit FallbackSource(std::vector<std::shared_ptr<DataSource>> sources);
+    std::string fetch(const DataRequest& request, const CancellationToken& token) override;
+
+private:
+    std::vector<std::shared_ptr<DataSource>> sources;
+};
+
+struct FetchHealth {
+    std::string breakerState; // "closed", "open" or "half_open"
+    size_t consecutiveFailures;
+    size_t negativeEntries;
+};
+
+// State shared by every UpstreamGuardLayer
+FetchHealth upstreamHealth();
+const DurationEstimate& upstreamDuration();
+
+} // namespace trading
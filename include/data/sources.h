@@ -0,0 +1,62 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include "data/data_source.h"
+
+namespace trading {
+
+class ChartClient;
+
+// Runs yfinance_fetcher.py in its own process per request. Cancelling the
+// token kills the process group.
+class PythonSource : public DataSource {
+public:
+    std::string fetch(const DataRequest& request, const CancellationToken& token) override;
+};
+
+// In-process chart API client (see chart_client.h)
+class ChartSource : public DataSource {
+public:
+    explicit ChartSource(ChartClient& client);
+    std::string fetch(const DataRequest& request, const CancellationToken& token) override;
+
+private:
+    ChartClient& client;
+};
+
+// Recorded fetcher responses under <directory>/<SYMBOL>/<interval>/<date>.json;
+// a missing file is answered as "no data"
+class FileSource : public DataSource {
+public:
+    explicit FileSource(std::string directory);
+    std::string fetch(const DataRequest& request, const CancellationToken& token) override;
+
+private:
+    std::string directory;
+};
+
+// Deterministic random-walk session from 09:30 to 16:00, seeded by symbol
+// and date, for offline runs and benchmarks
+class SyntheticSource : public DataSource {
+public:
+    std::string fetch(const DataRequest& request, const CancellationToken& token) override;
+};
+
+// Answers with a caller-supplied function and counts calls, for tests
+class MockSource : public DataSource {
+public:
+    using Responder = std::function<std::string(const DataRequest&)>;
+
+    explicit MockSource(Responder responder);
+    std::string fetch(const DataRequest& request, const CancellationToken& token) override;
+
+    size_t calls() const { return callCount.load(); }
+
+private:
+    Responder responder;
+    std::atomic<size_t> callCount{0};
+};
+
+} // namespace trading
@@ -0,0 +1,86 @@
+#pragma once
+#include "store/bar_columns.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace trading {
+
+// Log returns of several symbols aligned on one bar grid. The grid is the
+// union of every symbol's bar times; a symbol has a return at grid point t
+// when it has bars at both t and the grid point before it, in the same
+// session, so overnight gaps and missing bars leave holes instead of
+// stretching returns over several bars.
+struct ReturnPanel {
+    std::vector<int64_t> times;    // grid bar times, ascending; return t ends at times[t]
+    size_t stride = 0;             // values per series, padded to a SIMD multiple
+    std::vector<double> values;    // series x stride, standardized, 0 where missing
+    std::vector<double> present;   // series x stride, 1 where the return exists, else 0
+    std::vector<uint32_t> counts;  // returns per series
+    std::vector<bool> constant;    // series whose returns do not vary
+
+    size_t series() const { return counts.size(); }
+    bool complete(size_t s) const { return counts[s] == times.size(); }
+};
+
+// Aligns bar series (each sorted by time) on their common grid
+ReturnPanel alignReturns(const std::vector<BarColumns>& bars);
+
+// Pairwise Pearson correlations; NaN where a pair is undefined
+struct CorrelationMatrix {
+    size_t size = 0;
+    std::vector<double> values;    // size x size, row major
+    std::vector<uint32_t> overlap; // returns both symbols of a pair have
+
+    double at(size_t i, size_t j) const { return values[i * size + j]; }
+};
+
+struct CorrelationPair {
+    size_t first;
+    size_t second;
+    double correlation;
+    uint32_t overlap;
+};
+
+// Computes a panel's correlation matrix over the returns each pair has in
+// common, ignoring pairs with fewer than `minOverlap` of them. The upper
+// triangle is cut into square tiles that can run concurrently; each tile
+// streams its series through cache-sized slices of the grid and a
+// register-blocked SIMD kernel. Tiles whose series have no missing
+// returns need one dot product per pair, the rest six masked sums.
+class CorrelationKernel {
+public:
+    CorrelationKernel(const ReturnPanel& panel, size_t minOverlap);
+
+    size_t tiles() const { return tileList.size(); }
+
+    // Computes one tile; distinct tiles may run on different threads
+    void run(size_t tile);
+
+    // The matrix, once every tile has run
+    CorrelationMatrix result() const;
+
+private:
+    struct Tile {
+        size_t rowBlock;
+        size_t columnBlock;
+    };
+
+    void runComplete(const Tile& tile);
+    void runMasked(const Tile& tile);
+    void store(size_t i, size_t j, double correlation, double overlap);
+
+    const ReturnPanel& panel;
+    size_t minOverlap;
+    std::vector<size_t> order; // series by position, complete ones first
+    size_t completeCount;
+    std::vector<Tile> tileList;
+    CorrelationMatrix matrix;
+};
+
+// The `k` strongest pairs by |r| when `order` is "abs", the most positive
+// for "desc" or the most negative for "asc"; throws std::invalid_argument
+// on another order
+std::vector<CorrelationPair> topPairs(const CorrelationMatrix& matrix, size_t k, const std::string& order);
+
+} // namespace trading
@@ -0,0 +1,47 @@
+#pragma once
+#include "data/data_source.h"
+#include "store/bar_store.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace trading {
+
+struct FeatureExportConfig {
+    std::vector<std::string> symbols;
+    std::string interval = "5min";
+    std::string from; // first session date, YYYY-MM-DD
+    std::string to;   // last session date, inclusive
+    std::string features = "ema:12,ema:26,macd:12:26:9,garch,zscore:20";
+    std::string outputDir = "features";
+    size_t threads = 0; // 0 means one per hardware thread
+
+    // Parses the arguments of `trader export`; throws std::invalid_argument
+    static FeatureExportConfig fromArguments(const std::vector<std::string>& args);
+};
+
+struct FeatureExportSummary {
+    size_t files = 0;
+    size_t failedSymbols = 0;
+    uint64_t sessions = 0;
+    uint64_t rows = 0;
+    uint64_t bytes = 0;
+};
+
+// Computes the configured features over every weekday session in
+// [from, to] for each symbol, and writes <outputDir>/<SYMBOL>.feat per
+// symbol (see FeatureFile) plus <outputDir>/MANIFEST.json. Symbols are
+// spread over the worker threads. A worker reads a symbol's sessions from
+// the bar store when it has them and fetches the rest through `source`,
+// then computes and writes the whole file before taking the next symbol,
+// so memory holds one symbol's table per worker.
+FeatureExportSummary exportFeatures(const FeatureExportConfig& config,
+                                    const std::shared_ptr<DataSource>& source,
+                                    const BarStore& store);
+
+// Entry point for `trader export`, using the data pipeline and bar store
+// configured in the environment; returns the process exit status
+int runFeatureExport(const std::vector<std::string>& args);
+
+} // namespace trading
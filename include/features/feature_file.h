@@ -0,0 +1,49 @@
+#pragma once
+#include "store/bar_columns.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace trading {
+
+// Rows of one session within a feature table
+struct FeatureSession {
+    std::string date; // YYYY-MM-DD
+    uint64_t firstRow;
+    uint64_t rowCount;
+};
+
+// Bars and feature values of one symbol, sessions back to back in time order
+struct FeatureTable {
+    std::vector<FeatureSession> sessions;
+    BarColumns bars;
+    std::vector<std::string> names;          // value column names
+    std::vector<std::vector<double>> values; // one column per name, bars.size() rows each
+
+    size_t rows() const { return bars.size(); }
+};
+
+// Uncompressed columnar feature file, laid out for memory mapping and
+// zero-copy loading (e.g. numpy.frombuffer at a column's offset):
+//
+//   header       magic "DGFEAT01", column count, session count, row count
+//   columns      per column: name, type, byte offset and length
+//   sessions     per session: date, first row, row count
+//   data         each column contiguous and 64-byte aligned
+//
+// The bar columns come first: timestamp (int64, bar time in seconds),
+// open, high, low, close (float64) and volume (int64), then one float64
+// column per feature. Native byte order. Files are published atomically
+// via a temp file and rename().
+class FeatureFile {
+public:
+    enum ColumnType : uint32_t { Int64 = 0, Float64 = 1 };
+
+    // Returns the file size in bytes
+    static uint64_t write(const std::string& path, const FeatureTable& table);
+
+    // Throws std::runtime_error if the file cannot be read or is malformed
+    static FeatureTable read(const std::string& path);
+};
+
+} // namespace trading
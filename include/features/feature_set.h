@@ -0,0 +1,73 @@
+#pragma once
+#include "store/bar_columns.h"
+#include "utils/math_utils.h"
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace trading {
+
+// One indicator of a feature export, written "name" or "name:arg:arg...",
+// e.g. "ema:12" or "macd:12:26:9". Missing arguments take the defaults
+// the strategies use.
+struct FeatureSpec {
+    std::string name;
+    std::vector<double> args;
+
+    // Throws std::invalid_argument for unknown names or bad arguments
+    static FeatureSpec parse(const std::string& text);
+
+    // "name:arg:..." with every argument spelled out
+    std::string text() const;
+};
+
+// A configured list of indicators and the value columns they produce.
+// Sessions are computed independently, each from fresh indicator state,
+// the way a strategy run sees them, and values an indicator cannot give
+// yet (a rolling window that is not full) are NaN. compute() is const and
+// may run on several threads at once.
+//
+// Indicators and their columns:
+//   ema:N                    ema_N, seeded with the session's first close
+//   macd:F:S:G               macd_F_S_G, macd_signal_F_S_G, macd_hist_F_S_G
+//   trend:A                  trend_A, MACDStrategy's trend estimator
+//   garch:V:O:A:B            garch_sigma_V_O_A_B on log returns, as in MACDStrategy
+//   zscore:N                 zscore_N, against the rolling mean and stddev
+//   robust_zscore:N          robust_zscore_N, against the rolling median and MAD
+//   rsi:N                    rsi_N
+//   bollinger:N:W            bb_lower_N_W, bb_middle_N_W, bb_upper_N_W
+//   atr:N                    atr_N
+//   vwap                     vwap, of the typical price (high + low + close) / 3
+//   rolling_min:N            rolling_min_N of the low
+//   rolling_max:N            rolling_max_N of the high
+//   log_return               log_return of the close
+class FeatureSet {
+public:
+    explicit FeatureSet(std::vector<FeatureSpec> specs);
+
+    // Comma separated specs, e.g. "ema:12,macd,zscore:20"
+    static FeatureSet parse(const std::string& list);
+
+    const std::vector<FeatureSpec>& specs() const { return specs_; }
+
+    // Value column names, in output order
+    const std::vector<std::string>& columns() const { return columns_; }
+
+    // Computes the bars [begin, begin + rows) as one session. Column c is
+    // written to out[c][0 .. rows).
+    void compute(const BarColumns& bars, size_t begin, size_t rows, double* const* out) const;
+
+private:
+    struct Feature {
+        FeatureSpec spec;
+        size_t column;                               // first output column
+        std::optional<GARCHEstimator<double>> garch; // validated once, copied per session
+    };
+
+    std::vector<FeatureSpec> specs_;
+    std::vector<std::string> columns_;
+    std::vector<Feature> features;
+};
+
+} // namespace trading
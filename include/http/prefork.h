@@ -0,0 +1,14 @@
+#pragma once
+
+namespace trading {
+
+// Number of pre-forked worker processes requested via $TRADING_WORKERS,
+// or 0 to serve from a single process.
+int workerCountFromEnvironment();
+
+// Supervises `workers` TradingServer processes that all listen on the same
+// port with SO_REUSEPORT, restarting any that exit unexpectedly. Returns
+// the process exit code once the supervisor is asked to shut down.
+int runPreforked(int workers);
+
+} // namespace trading
@@ -3,12 +3,28 @@
 #include <memory>
 #include <string>
 #include "strategies/strategy.h"
+#include "cache/memory_cache.h"
+#include "cache/pyramid_cache.h"
+#include "cache/spill_cache.h"
+#include "data/data_source.h"
+#include "store/bar_store.h"
+#include "utils/scheduler.h"
+#include "utils/cancellation.h"
+#include <mutex>
+#include <unordered_map>
 
 namespace trading {
 
+// Blocks SIGINT and SIGTERM in the calling thread. Call it before
+// constructing a TradingServer: the threads the server starts inherit the
+// mask, so the signals reach run()'s graceful shutdown instead of killing
+// the process.
+void blockShutdownSignals();
+
 class TradingServer {
 public:
-    TradingServer();
+    // `workerSlot` is the pre-fork worker's slot, or -1 for a single process
+    explicit TradingServer(int workerSlot = -1);
     void run();
 
 private:
@@ -16,9 +32,51 @@ private:
                               httplib::Response& res);
     std::string handleStrategies(const httplib::Request& req,
                                httplib::Response& res);
+    std::string handleSweep(const httplib::Request& req,
+                            httplib::Response& res);
+    std::string handleBaseline(const httplib::Request& req,
+                               httplib::Response& res);
+    std::string handleMetrics(const httplib::Request& req,
+                              httplib::Response& res);
+    std::string handleCancel(const httplib::Request& req,
+                             httplib::Response& res);
+    std::string handleBars(const httplib::Request& req,
+                           httplib::Response& res);
+    std::string handleChart(const httplib::Request& req,
+                            httplib::Response& res);
+    std::string handleCorrelation(const httplib::Request& req,
+                                  httplib::Response& res);
+
+    bool beginRequest(const httplib::Request& req, httplib::Response& res, std::string& requestId,
+                      CancellationToken& token);
+    void applyDeadline(const httplib::Request& req, CancellationToken& token) const;
+    void endRequest(const std::string& requestId);
+    void sendSpilled(const httplib::Request& req, httplib::Response& res,
+                     std::shared_ptr<const SpilledBody> body) const;
+
+    void loadSnapshots();
+    void saveSnapshots();
     
     httplib::Server server;
     std::string authToken_;
+    int workerSlot;
+
+    MemoryCache dataCache;
+    MemoryCache resultCache;
+    std::unique_ptr<SpillCache> spillCache;
+    PyramidCache chartCache;
+    std::string snapshotDir;
+
+    std::unique_ptr<Scheduler> scheduler;
+    BarStore barStore;
+    std::shared_ptr<DataSource> dataSource;
+
+    DurationEstimate simulateStage;
+    DurationEstimate serializeStage;
+    int64_t defaultDeadlineMs;
+
+    std::mutex activeRequestsMutex;
+    std::unordered_map<std::string, CancellationToken> activeRequests;
 };
 
 } // namespace trading
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace trading {
+
+struct ReadRequest {
+    int fd;
+    uint64_t offset;
+    size_t length;
+};
+
+// Called once per request on the thread that issued the batch, in
+// completion order. `data` is only valid during the call. `error` is 0 on
+// success or an errno value, in which case `data` is nullptr.
+using ReadCompletion = std::function<void(size_t index, const uint8_t* data, size_t length, int error)>;
+
+// Batched asynchronous file reads. The io_uring backend keeps up to `depth`
+// reads in flight from a single thread, reading into a registered buffer
+// pool; the pread backend runs the same batches on a small thread pool for
+// kernels without io_uring. Batches on one reader are serialized.
+class AsyncReader {
+public:
+    virtual ~AsyncReader() = default;
+
+    // Runs every request to completion. If a completion callback throws,
+    // the remaining reads are drained and the first exception is rethrown.
+    virtual void readBatch(const std::vector<ReadRequest>& requests, const ReadCompletion& onComplete) = 0;
+
+    virtual const char* backend() const = 0;
+
+    // backend is "auto", "io_uring" or "pread"; "auto" falls back to pread
+    static std::unique_ptr<AsyncReader> create(const std::string& backend, size_t depth);
+
+    // Process-wide reader configured by TRADING_IO_BACKEND and TRADING_IO_DEPTH
+    static AsyncReader& shared();
+};
+
+} // namespace trading
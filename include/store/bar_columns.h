@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace trading {
+
+// OHLCV bars stored column by column. Timestamps are seconds since the
+// epoch of the exchange's wall clock, i.e. "2024-01-05 09:30:00" ET is
+// stored as if it were that time in UTC.
+struct BarColumns {
+    std::vector<int64_t> timestamps;
+    std::vector<double> open;
+    std::vector<double> high;
+    std::vector<double> low;
+    std::vector<double> close;
+    std::vector<int64_t> volume;
+
+    size_t size() const { return timestamps.size(); }
+    void reserve(size_t rows);
+    void resize(size_t rows);
+    void append(const BarColumns& other, size_t begin, size_t end);
+};
+
+// Converts between "YYYY-MM-DD HH:MM:SS" and bar time; throws std::invalid_argument on bad input
+int64_t parseBarTime(const std::string& text);
+std::string formatBarTime(int64_t seconds);
+
+// Weekday session dates from `from` to `to` ("YYYY-MM-DD"), inclusive.
+// Throws std::invalid_argument for a malformed range or one with no
+// weekdays or more than `maxSessions`; the span is counted before any
+// date is listed.
+std::vector<std::string> weekdaySessions(const std::string& from, const std::string& to,
+                                         size_t maxSessions = SIZE_MAX);
+
+// Appends the rows of time-ordered `bars` that fall on session `date` to
+// `out` and returns how many there were
+size_t appendSession(BarColumns& out, const BarColumns& bars, const std::string& date);
+
+} // namespace trading
@@ -0,0 +1,64 @@
+#pragma once
+#include "store/bar_columns.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace trading {
+
+// Compressed columnar bar file. Rows are split into blocks of up to
+// kBlockRows; each block stores its six columns back to back, encoded with
+// the codecs in column_codec.h, so a block can be decoded on its own.
+// A footer at the end of the file indexes the blocks by time range and
+// carries a checksum per block, so range reads decode only what they need.
+class BarSegment {
+public:
+    static constexpr uint32_t kBlockRows = 1024;
+
+    static std::string encode(const BarColumns& bars);
+    static BarColumns decode(const uint8_t* data, size_t length);
+
+    // Appends the bars with from <= timestamp <= to from an in-memory segment
+    static void decodeRange(const uint8_t* data, size_t length, int64_t from, int64_t to, BarColumns& out);
+
+    // Files are published atomically via a temp file and rename()
+    static void write(const std::string& path, const BarColumns& bars);
+    static BarColumns read(const std::string& path);
+
+    // Maps a segment file, validating only its footer
+    static std::shared_ptr<const BarSegment> open(const std::string& path);
+
+    ~BarSegment();
+    BarSegment(const BarSegment&) = delete;
+    BarSegment& operator=(const BarSegment&) = delete;
+
+    int64_t minTime() const { return firstTime; }
+    int64_t maxTime() const { return lastTime; }
+    uint64_t rowCount() const { return rows; }
+    uint32_t blockCount() const { return blocks; }
+
+    // The file as stored, for serving it without decoding
+    const uint8_t* bytes() const { return data; }
+    size_t byteSize() const { return size; }
+
+    // Starts readahead of the whole file ahead of a sequential pass
+    void willNeed() const;
+
+    // Bars with from <= timestamp <= to, decoding only the overlapping blocks
+    BarColumns readRange(int64_t from, int64_t to) const;
+    void readRange(int64_t from, int64_t to, BarColumns& out) const;
+
+private:
+    BarSegment(const uint8_t* data, size_t size);
+
+    const uint8_t* data;
+    size_t size;
+    int64_t firstTime;
+    int64_t lastTime;
+    uint64_t rows;
+    uint32_t blocks;
+    uint64_t indexOffset;
+};
+
+} // namespace trading
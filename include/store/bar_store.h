@@ -0,0 +1,76 @@
+#pragma once
+#include "store/bar_columns.h"
+#include "store/bar_segment.h"
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace trading {
+
+// Manifest entry describing one stored segment
+struct SegmentInfo {
+    std::string date;
+    int64_t minTime;
+    int64_t maxTime;
+    uint64_t rowCount;
+};
+
+struct RangeQuery {
+    std::string symbol;
+    std::string interval;
+    int64_t from;
+    int64_t to;
+};
+
+// Directory of compressed bar segments, one per symbol, interval and
+// session: <root>/<SYMBOL>/<interval>/<YYYY-MM-DD>.seg. Each symbol and
+// interval directory also holds a MANIFEST listing its segments in time
+// order, so range reads find their segments without listing or opening
+// the rest. An empty root disables the store.
+class BarStore {
+public:
+    explicit BarStore(std::string root);
+
+    // Store rooted at $TRADING_BAR_STORE_DIR, disabled if unset
+    static BarStore fromEnvironment();
+
+    bool enabled() const { return !root.empty(); }
+
+    void put(const std::string& symbol, const std::string& interval, const std::string& date,
+             const BarColumns& bars) const;
+    std::optional<BarColumns> get(const std::string& symbol, const std::string& interval,
+                                  const std::string& date) const;
+
+    // Stored segments in time order; empty if there are none
+    std::vector<SegmentInfo> manifest(const std::string& symbol, const std::string& interval) const;
+
+    // Mapped segments overlapping [from, to], in time order
+    std::vector<std::shared_ptr<const BarSegment>> openRange(const std::string& symbol, const std::string& interval,
+                                                             int64_t from, int64_t to) const;
+
+    // Bars with from <= timestamp <= to across all stored sessions
+    BarColumns readRange(const std::string& symbol, const std::string& interval,
+                         int64_t from, int64_t to) const;
+
+    // Batched form of readRange for scans over many symbols. All segment
+    // reads go through the shared AsyncReader, and each segment is decoded
+    // as soon as its read completes.
+    std::vector<BarColumns> readRanges(const std::vector<RangeQuery>& queries) const;
+
+    std::string pathFor(const std::string& symbol, const std::string& interval, const std::string& date) const;
+
+private:
+    std::string directoryFor(const std::string& symbol, const std::string& interval) const;
+    void updateManifest(const std::string& directory, const SegmentInfo& info) const;
+
+    std::string root;
+};
+
+// Maps a symbol, interval or date to a file name: characters outside
+// [A-Za-z0-9.^=-] become '_'. Throws std::invalid_argument for names that
+// would still address another directory ("", "." and "..").
+std::string pathComponent(const std::string& name);
+
+} // namespace trading
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace trading {
+
+// Column encodings used by bar segments. Each encoder appends to `out`; each
+// decoder fills exactly `count` values from [data, data + length) and throws
+// std::runtime_error if the input is truncated or malformed.
+
+// Timestamps: delta-of-delta, zigzag, LEB128 varint. Regular bars cost one
+// byte each.
+void encodeTimestamps(const int64_t* values, size_t count, std::string& out);
+void decodeTimestamps(const uint8_t* data, size_t length, int64_t* values, size_t count);
+
+// Prices: Gorilla-style XOR against the previous value, bit packed.
+// Unchanged prices cost one bit each.
+void encodeFloats(const double* values, size_t count, std::string& out);
+void decodeFloats(const uint8_t* data, size_t length, double* values, size_t count);
+
+// Counters such as volume: delta, zigzag, LEB128 varint.
+void encodeIntegers(const int64_t* values, size_t count, std::string& out);
+void decodeIntegers(const uint8_t* data, size_t length, int64_t* values, size_t count);
+
+} // namespace trading
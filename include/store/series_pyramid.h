@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace trading {
+
+// Summary of a run of consecutive points
+struct PyramidBucket {
+    double first;
+    double last;
+    double min;
+    double max;
+};
+
+// One downsampled view: a bucket per output column for each requested series
+struct PyramidView {
+    size_t level = 0;                  // pyramid level the buckets were assembled from
+    std::vector<int64_t> timestamps;   // time of each bucket's first point
+    std::vector<std::vector<PyramidBucket>> series;
+};
+
+// Min/max/first/last pyramid over several series sharing one time axis.
+// Level l summarizes aligned runs of 2^l points, so any index range can be
+// reduced to `width` buckets in O(width) from the level whose runs are just
+// finer than one output column. Total size is about twice the raw series.
+class SeriesPyramid {
+public:
+    // Every series must have one value per timestamp; timestamps ascending
+    SeriesPyramid(std::vector<int64_t> timestamps,
+                  std::vector<std::pair<std::string, std::vector<double>>> series);
+
+    size_t size() const { return timestamps_.size(); }
+    size_t levels() const;
+    size_t byteSize() const;
+    const std::vector<int64_t>& timestamps() const { return timestamps_; }
+    const std::vector<std::string>& names() const { return names_; }
+
+    // Index of a series by name, or size_t(-1) if there is none
+    size_t find(const std::string& name) const;
+
+    // Half-open index range of the points with from <= time <= to
+    std::pair<size_t, size_t> indexRange(int64_t from, int64_t to) const;
+
+    // Reduces points [begin, end) of the given series to at most `width`
+    // buckets. Bucket edges are aligned to the chosen level, so buckets hold
+    // slightly uneven point counts; each point lands in exactly one bucket.
+    PyramidView query(size_t begin, size_t end, size_t width, const std::vector<size_t>& series) const;
+
+private:
+    PyramidBucket aggregate(size_t s, size_t begin, size_t end) const;
+
+    std::vector<int64_t> timestamps_;
+    std::vector<std::string> names_;
+    std::vector<std::vector<double>> raw_;                       // level 0, per series
+    std::vector<std::vector<std::vector<PyramidBucket>>> upper_; // levels 1.., per series
+};
+
+} // namespace trading
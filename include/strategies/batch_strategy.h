@@ -0,0 +1,98 @@
+#pragma once
+#include "strategies/base_types.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace trading {
+
+// Summary of one configuration in a batch run
+struct BatchResult {
+    double finalPortfolioValue;
+    double profitLoss;
+    int numTrades;
+};
+
+struct MACDConfig {
+    int macdFastPeriod = 12;
+    int macdSlowPeriod = 26;
+    int signalPeriod = 9;
+    double stopLossPercentage = 0.02;
+    double transactionCost = 0.001;
+};
+
+struct MeanReversionConfig {
+    int lookbackPeriod = 20;
+    double entryThreshold = 1.5;
+    double exitThreshold = 0.5;
+    double stopLossPercentage = 0.02;
+    double profitTargetPercentage = 0.03;
+    double transactionCost = 0.001;
+};
+
+// Runs N MACDStrategy configurations in lockstep over one series.
+// Parameters and per-run state are kept in struct-of-arrays form so the
+// per-bar update over configurations vectorizes.
+class MACDBatch {
+public:
+    explicit MACDBatch(const std::vector<MACDConfig>& configs);
+
+    size_t size() const { return fastAlpha.size(); }
+
+    std::vector<BatchResult> run(const MarketData& data, double initialCash) const;
+    void run(const MarketData& data, double initialCash,
+             size_t begin, size_t end, BatchResult* out) const;
+
+private:
+    std::vector<double> fastAlpha;
+    std::vector<double> slowAlpha;
+    std::vector<double> signalAlpha;
+    std::vector<double> stopLossPct;
+    std::vector<double> transactionCostRate;
+};
+
+// Runs N MeanReversionStrategy configurations in lockstep over one series.
+// Window statistics are computed once per distinct lookback and shared.
+class MeanReversionBatch {
+public:
+    explicit MeanReversionBatch(const std::vector<MeanReversionConfig>& configs);
+
+    size_t size() const { return lookbackIndex.size(); }
+
+    std::vector<BatchResult> run(const MarketData& data, double initialCash) const;
+    void run(const MarketData& data, double initialCash,
+             size_t begin, size_t end, BatchResult* out) const;
+
+private:
+    std::vector<int> lookbacks;      // distinct lookback periods
+    std::vector<int> lookbackIndex;  // per config, index into lookbacks
+    std::vector<double> entryThreshold;
+    std::vector<double> exitThreshold;
+    std::vector<double> stopLossPct;
+    std::vector<double> profitTargetPct;
+    std::vector<double> transactionCostRate;
+};
+
+// Runs N random-entry baselines in lockstep over one series, as a null
+// distribution for another strategy's PnL. On each bar a run trades with
+// probability `tradeRate`: a flat run goes long or short with all its cash,
+// an open run exits. Run i draws from Philox stream i under `seed`, so
+// results do not depend on how runs are split across threads.
+class RandomBatch {
+public:
+    RandomBatch(size_t runs, double tradeRate, double transactionCost, uint64_t seed);
+
+    size_t size() const { return runs; }
+
+    std::vector<BatchResult> run(const MarketData& data, double initialCash) const;
+    void run(const MarketData& data, double initialCash,
+             size_t begin, size_t end, BatchResult* out) const;
+
+private:
+    size_t runs;
+    double tradeRate;
+    double transactionCostRate;
+    uint64_t seed;
+};
+
+} // namespace trading
@@ -2,12 +2,13 @@
 #define FIXED_TIME_STRATEGY_H
 
 #include "strategy.h"
+#include "strategies/portfolio.h"
 #include "utils/math_utils.h"
+#include "utils/timer_wheel.h"
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <memory>
-#include <chrono>
-#include <unordered_map>
 
 namespace trading {
 
@@ -22,13 +23,15 @@ public:
     virtual void onTick(double price, int timeStep, const std::string& tickTimestamp) override;
 
 private:
-    std::vector<Trade> trades;
-    std::vector<HistoricalDataPoint> historicalData;
-    std::unordered_map<int, std::string> positionStartTimes;
+    Portfolio portfolio;
+
+    // Exits and cooldown expiries, keyed on bar time in seconds
+    TimerWheel timers;
+    std::vector<TimerWheel::Expired> expired;
+    TimerWheel::TimerId exitTimer;
+    TimerWheel::TimerId cooldownTimer;
+    int64_t positionStartTime; // bar time of the open position's entry
     
-    double cash;
-    int position;
-    double transactionCostRate;
     double lastPrice;
     bool debugDetailTicks;
     
@@ -37,13 +40,9 @@ private:
     double positionSizePercent;
     int cooldownPeriodMinutes;
     
-    // Helper values
-    int lastTradeStep;
-    
     // Helper methods
-    int getMinutesDifference(const std::string& startTime, const std::string& endTime) const;
-    bool isWithinTradingHours(const std::string& timestamp) const;
-    std::chrono::system_clock::time_point parseTimestamp(const std::string& timestamp) const;
+    void startCooldown(int64_t barTime);
+    bool isWithinTradingHours(int64_t barTime) const;
 };
 
 // Factory function for creating Fixed Time strategy
@@ -2,6 +2,7 @@
 #define MACD_STRATEGY_H
 
 #include "strategy.h"
+#include "strategies/portfolio.h"
 #include "utils/math_utils.h"
 #include <vector>
 #include <string>
@@ -35,14 +36,9 @@ private:
     TrendEstimator<double> slowEMAEstimator;
     TrendEstimator<double> signalEMAEstimator;
 
-    std::vector<Trade> trades;
-    std::vector<HistoricalDataPoint> historicalData;
+    Portfolio portfolio;
 
-    double cash;
-    int position;
     double stopLossPct;
-    double transactionCostRate;
-    double entryPrice;
     double lastPrice;
     double currentMACD;
     double currentSignal;
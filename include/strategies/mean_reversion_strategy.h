@@ -2,11 +2,12 @@
 #define MEAN_REVERSION_STRATEGY_H
 
 #include "strategy.h"
+#include "strategies/portfolio.h"
 #include "utils/math_utils.h"
+#include "utils/indicators.h"
 #include <vector>
 #include <string>
 #include <memory>
-#include <deque>
 
 namespace trading {
 
@@ -17,24 +18,23 @@ public:
                           double exitThreshold = 0.5,
                           double stopLossPercentage = 0.02,
                           double profitTargetPercentage = 0.03,
-                          double transactionCost = 0.001);
+                          double transactionCost = 0.001,
+                          bool robustZScore = false);
 
     SimulationResult execute(const MarketData& data, double initialCash) override;
     virtual void onTick(double price, int timeStep, const std::string& tickTimestamp) override;
 
 private:
-    std::vector<Trade> trades;
-    std::vector<HistoricalDataPoint> historicalData;
-    
-    // Price history for calculating mean and standard deviation
-    std::deque<double> priceHistory;
+    Portfolio portfolio;
+
+    // Rolling mean and standard deviation of the last lookbackPeriod prices
+    RollingStats<double> priceStats;
+    // Rolling median and MAD of the same window, kept in robust mode
+    RollingQuantile<double> priceQuantiles;
+    bool robustZScore;
     
-    double cash;
-    int position;
     double stopLossPct;
     double profitTargetPct;
-    double transactionCostRate;
-    double entryPrice;
     double lastPrice;
     
     int lookbackPeriod;
@@ -64,7 +64,8 @@ namespace {
         {"exitThreshold", "number", "Z-score threshold to exit a position (<1.0 recommended)", "0.5", {}},
         {"stopLossPercentage", "number", "Stop loss percentage for risk management", "0.02", {}},
         {"profitTargetPercentage", "number", "Profit target percentage for taking profits", "0.03", {}},
-        {"transactionCost", "number", "Transaction cost as a percentage", "0.001", {}}
+        {"transactionCost", "number", "Transaction cost as a percentage", "0.001", {}},
+        {"robustZScore", "boolean", "Use the rolling median and MAD instead of mean and standard deviation", "false", {"true", "false"}}
     };
 
     static bool registered_mean_reversion = Strategy::registerStrategy({
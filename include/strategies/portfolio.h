@@ -0,0 +1,105 @@
+#pragma once
+#include "strategies/base_types.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace trading {
+
+// Cash and holdings of one simulated account. Buying pays price plus fee
+// and selling, short sales included, receives price minus fee, so equity
+// is always cash + position * price. Four doubles: a block of accounts, or
+// the same fields held as columns, stays in L1 while a series streams past.
+struct Account {
+    double cash = 0.0;
+    double position = 0.0;   // shares, negative when short
+    double entryPrice = 0.0; // price the open position was entered at, 0 when flat
+    double fills = 0.0;      // trades so far; a double so updates stay in one type
+
+    double equity(double price) const { return cash + position * price; }
+};
+
+// Cash change from trading `qty` shares (negative sells) at `price`, fee included
+inline double fillCash(double qty, double price, double feeRate) {
+    return -qty * price - std::abs(qty) * price * feeRate;
+}
+
+// std::floor as arithmetic and selects. Below SSE4.1 std::floor is a
+// library call, which would keep the batch engines' loops from vectorizing.
+// Adding and subtracting 2^52 rounds a smaller value to the nearest
+// integer, and a step of -1 undoes rounding up; larger values already are
+// integers. The step compares rather than taking the sign of x - rounded,
+// which is -0.0 for x = -0.0 and would floor it to -1.
+inline double floorBranchless(double x) {
+    constexpr double kTwo52 = 4503599627370496.0;
+    const double bias = std::copysign(kTwo52, x);
+    const double rounded = (x + bias) - bias;
+    const double floored = rounded - (rounded > x ? 1.0 : 0.0);
+    return std::abs(x) < kTwo52 ? floored : x;
+}
+
+// Whole shares `cash` pays for at `price` once the fee is included
+inline double affordableShares(double cash, double price, double feeRate) {
+    return floorBranchless(cash / (price * (1 + feeRate)));
+}
+
+// Moves the account to `target` shares if `execute` is set. Going from long
+// to short or back counts as two trades, an exit and an entry. Written as
+// selects rather than branches so batch engines can apply it to a block
+// of accounts in vector code; Portfolio runs the same code for one account.
+// Moving to the current position is not a trade: its cash change is zero
+// and it keeps the entry price, so only the fill count tests for it.
+inline void tradeTo(Account& a, double target, double price, double feeRate, bool execute) {
+    const double delta = target - a.position;
+    const bool opens = a.position * target <= 0; // from flat, or across zero
+    const bool flips = a.position * target < 0;
+    const double cashAfter = a.cash + fillCash(delta, price, feeRate);
+    const double entryAfter = target == 0 ? 0.0 : (opens ? price : a.entryPrice);
+    const double fillsAfter = a.fills + (delta == 0 ? 0.0 : (flips ? 2.0 : 1.0));
+    a.cash = execute ? cashAfter : a.cash;
+    a.entryPrice = execute ? entryAfter : a.entryPrice;
+    a.fills = execute ? fillsAfter : a.fills;
+    a.position = execute ? target : a.position;
+}
+
+// Accounting for a single strategy run: applies orders to an Account,
+// records each fill as a Trade and each bar's equity, and liquidates at the
+// end of the session. Strategies decide what to hold; Portfolio does the rest.
+class Portfolio {
+public:
+    explicit Portfolio(double feeRate = 0.0);
+
+    // Starts a run with `initialCash` and no position; `bars` sizes the history
+    void reset(double initialCash, size_t bars);
+
+    const Account& account() const { return account_; }
+    double cash() const { return account_.cash; }
+    double position() const { return account_.position; }
+    double entryPrice() const { return account_.entryPrice; }
+    double equity(double price) const { return account_.equity(price); }
+    double feeRate() const { return feeRate_; }
+    const std::vector<Trade>& trades() const { return trades_; }
+
+    // Orders. Each records one trade per side it touches (exit long, enter
+    // short, and so on) and returns the cash it moved, fees included.
+    double targetPosition(double target, double price, int timeStep);
+    double buy(double qty, double price, int timeStep) { return targetPosition(position() + qty, price, timeStep); }
+    double sell(double qty, double price, int timeStep) { return targetPosition(position() - qty, price, timeStep); }
+    double close(double price, int timeStep) { return targetPosition(0.0, price, timeStep); }
+
+    // Records this bar's equity, cash and position with the strategy's indicators
+    void mark(double price, double macd = 0.0, double signal = 0.0, double trend = 0.0, double volatility = 0.0);
+
+    // Closes any open position at the last bar and hands over the run's results
+    SimulationResult finish(double finalPrice, int finalStep);
+
+private:
+    Account account_;
+    double feeRate_;
+    double initialCash_;
+    std::vector<Trade> trades_;
+    std::vector<HistoricalDataPoint> historical_;
+};
+
+} // namespace trading
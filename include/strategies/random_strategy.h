@@ -2,10 +2,12 @@
 #define RANDOM_STRATEGY_H
 
 #include "strategy.h"
+#include "strategies/portfolio.h"
 #include "utils/math_utils.h"
+#include "utils/philox.h"
+#include <cstdint>
 #include <vector>
 #include <string>
-#include <random>
 #include <memory>
 
 namespace trading {
@@ -14,19 +16,17 @@ class RandomStrategy : public Strategy {
 public:
     RandomStrategy(double transactionCost = 0.001, 
                    int timeStepInterval = 10, 
-                   bool clearAtEndOfDay = true);
+                   bool clearAtEndOfDay = true,
+                   uint64_t seed = 42,
+                   uint64_t runId = 0);
 
     SimulationResult execute(const MarketData& data, double initialCash) override;
     virtual void onTick(double price, int timeStep, const std::string& tickTimestamp) override;
 
 private:
-    std::vector<Trade> trades;
-    std::vector<HistoricalDataPoint> historicalData;
-    std::mt19937 rng; // Random number generator
+    Portfolio portfolio;
+    Philox rng; // Draws keyed by (seed, run id, bar index)
     
-    double cash;
-    int position;
-    double transactionCostRate;
     int timeStepInterval; // How often to consider trading (every X time steps)
     bool clearAtEndOfDay; // Whether to sell all holdings at end of day
     double lastPrice;
@@ -46,7 +46,9 @@ namespace {
     static const std::vector<StrategyParam> randomParams = {
         {"transactionCost", "number", "Transaction cost as a percentage", "0.001", {}},
         {"timeStepInterval", "number", "Trade frequency (consider trade every X time steps)", "10", {}},
-        {"clearAtEndOfDay", "boolean", "Sell all holdings at the end of trading day", "true", {"true", "false"}}
+        {"clearAtEndOfDay", "boolean", "Sell all holdings at the end of trading day", "true", {"true", "false"}},
+        {"seed", "number", "Random seed", "42", {}},
+        {"runId", "number", "Independent random stream under the same seed", "0", {}}
     };
 
     static bool registered_random = Strategy::registerStrategy({
@@ -1,5 +1,6 @@
 #pragma once
 #include "strategies/base_types.h"
+#include "utils/cancellation.h"
 #include <functional>
 #include <memory>
 #include <string>
@@ -38,6 +39,9 @@ public:
     // Core strategy methods
     virtual SimulationResult execute(const MarketData& data, double initialCash) = 0;
     
+    // Token checked periodically by execute(); cancelling it aborts the run
+    void setCancellationToken(const CancellationToken& token) { cancellationToken = token; }
+
     // Static registration helper
     static bool registerStrategy(const StrategyInfo& info);
     
@@ -46,6 +50,16 @@ public:
 
 protected:
     virtual void onTick(double price, int timeStep, const std::string& tickTimestamp = "") = 0;
+
+    // Cancellation checkpoint for execute() loops, polled every kCancellationCheckBars bars
+    static constexpr size_t kCancellationCheckBars = 256;
+    void checkCancellation(size_t bar) const {
+        if (bar % kCancellationCheckBars == 0) {
+            cancellationToken.throwIfCancelled();
+        }
+    }
+
+    CancellationToken cancellationToken;
     
 private:
     // Registry of all available strategies
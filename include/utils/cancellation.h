@@ -0,0 +1,78 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+namespace trading {
+
+// Thrown at a cancellation checkpoint once the token has been cancelled
+class OperationCancelled : public std::runtime_error {
+public:
+    explicit OperationCancelled(const std::string& reason) : std::runtime_error(reason) {}
+};
+
+// Thrown at a checkpoint once the token's deadline has passed, or when the
+// remaining budget cannot cover the next stage
+class DeadlineExceeded : public OperationCancelled {
+public:
+    explicit DeadlineExceeded(const std::string& reason) : OperationCancelled(reason) {}
+};
+
+// Cooperative cancellation flag shared by every copy of the token. Work
+// checks it at stage boundaries and periodically inside long loops. An
+// optional probe (e.g. "has the client disconnected?") is consulted on each
+// check and cancels the token when it fires, and an optional deadline
+// cancels it once it passes.
+class CancellationToken {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    CancellationToken();
+
+    void cancel(const std::string& reason = "Request cancelled") const;
+    bool isCancelled() const;
+    void throwIfCancelled() const;
+    std::string reason() const;
+
+    void setProbe(std::function<bool()> probe);
+
+    void setDeadline(Clock::time_point deadline);
+    bool hasDeadline() const;
+    std::chrono::milliseconds remaining() const;
+
+    // Fails fast when the remaining budget cannot cover a stage expected to take `needed`
+    void requireBudget(std::chrono::milliseconds needed, const std::string& stage) const;
+
+private:
+    void expire(const std::string& reason) const;
+
+    struct State {
+        std::atomic<bool> cancelled{false};
+        std::atomic<bool> deadlineExceeded{false};
+        std::atomic<int64_t> deadlineNs{0}; // steady clock, 0 = no deadline
+        mutable std::mutex mutex;
+        std::string reason;
+        std::function<bool()> probe;
+    };
+
+    std::shared_ptr<State> state;
+};
+
+// Moving average of a stage's recent durations; callers pass budget() to
+// CancellationToken::requireBudget before starting the stage
+class DurationEstimate {
+public:
+    void record(CancellationToken::Clock::time_point start);
+    std::chrono::milliseconds budget() const;
+    double averageMs() const { return average.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> average{0.0};
+};
+
+} // namespace trading
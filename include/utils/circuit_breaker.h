@@ -0,0 +1,40 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
+namespace trading {
+
+// Stops calls to a failing dependency. After `failureThreshold` consecutive
+// failures the breaker opens and rejects calls for `cooldown`; then a single
+// trial call is let through, which closes it again on success or reopens it
+// on failure.
+class CircuitBreaker {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class State { Closed, Open, HalfOpen };
+
+    CircuitBreaker(size_t failureThreshold, std::chrono::milliseconds cooldown);
+
+    // Every allowed call must end in recordSuccess, recordFailure or recordAbandoned
+    bool allow();
+    void recordSuccess();
+    void recordFailure();
+    void recordAbandoned();
+
+    State state() const;
+    size_t consecutiveFailures() const;
+    std::chrono::milliseconds retryAfter() const;
+
+private:
+    mutable std::mutex mutex;
+    size_t failureThreshold;
+    std::chrono::milliseconds cooldown;
+    State current;
+    size_t failures;
+    bool trialInFlight;
+    Clock::time_point openedAt;
+};
+
+} // namespace trading
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdio>
+#include <functional>
+#include <string>
+
+namespace trading {
+
+// Holds an exclusive fcntl lock on a lock file for its lifetime. The kernel
+// drops the lock if the owning process dies, so a crashed holder never
+// wedges other processes. Threads of one process share fcntl locks, so
+// callers must serialize same-process users themselves.
+class FileLock {
+public:
+    explicit FileLock(const std::string& path);
+    ~FileLock();
+
+    FileLock(const FileLock&) = delete;
+    FileLock& operator=(const FileLock&) = delete;
+
+private:
+    int fd;
+};
+
+// Creates `path` and any missing parents. Errors are std::runtime_error
+// prefixed with `owner`, as are those of the functions below.
+void makeDirectory(const std::string& path, const std::string& owner);
+
+// Writes a new file next to `path` through `write`, which returns false on
+// failure, then flushes it (and fsyncs it if `sync`). The name is unique
+// to this host, process and call. Returns the temp path; it is removed if
+// anything fails.
+std::string writeTempFile(const std::string& path, const std::string& owner,
+                          const std::function<bool(FILE*)>& write, bool sync = true);
+
+// Renames a finished temp file over `path`, removing it if that fails
+void publishTempFile(const std::string& tempPath, const std::string& path, const std::string& owner);
+
+// Both of the above: readers of `path` see the old file or the whole new one
+void publishFile(const std::string& path, const std::string& owner, const std::function<bool(FILE*)>& write);
+
+} // namespace trading
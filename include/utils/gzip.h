@@ -0,0 +1,15 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace trading {
+
+// gzip (RFC 1952) framing via zlib; throws std::runtime_error on failure
+std::string gzipCompress(std::string_view data, int level);
+std::string gzipDecompress(const char* data, size_t length);
+
+// Whether an Accept-Encoding header value allows a gzip response
+bool acceptsGzip(const std::string& acceptEncoding);
+
+} // namespace trading
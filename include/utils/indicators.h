@@ -0,0 +1,722 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace trading {
+
+// Streaming indicators. Each update is O(1), amortized for the rolling
+// extremes, and storage is fixed at construction, so an indicator can sit
+// in a strategy's per-bar path without allocating. ready() turns true once
+// the indicator has seen enough bars for its definition; before that,
+// value() is computed from the bars seen so far.
+//
+// Every indicator also has a calculate* form over a span of bars that
+// writes one value per bar into caller-owned output, NaN before ready, for
+// batch and vectorized modes.
+
+// Fixed-capacity FIFO over a preallocated buffer
+template <typename T = double>
+class RingBuffer {
+public:
+    explicit RingBuffer(size_t capacity) : data(capacity), head(0), count(0) {
+        if (capacity == 0) {
+            throw std::invalid_argument("RingBuffer: capacity must be positive");
+        }
+    }
+
+    size_t capacity() const { return data.size(); }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == data.size(); }
+
+    // i = 0 is the oldest element
+    const T& operator[](size_t i) const { return data[(head + i) % data.size()]; }
+    T& operator[](size_t i) { return data[(head + i) % data.size()]; }
+    const T& front() const { return (*this)[0]; }
+    const T& back() const { return (*this)[count - 1]; }
+
+    void push_back(const T& value) {
+        if (full()) {
+            throw std::length_error("RingBuffer: push_back on a full buffer");
+        }
+        data[(head + count) % data.size()] = value;
+        count++;
+    }
+
+    void pop_front() {
+        head = (head + 1) % data.size();
+        count--;
+    }
+
+    void pop_back() {
+        count--;
+    }
+
+    // Appends, evicting the oldest element when full
+    void push(const T& value) {
+        if (full()) {
+            pop_front();
+        }
+        push_back(value);
+    }
+
+    void clear() {
+        head = 0;
+        count = 0;
+    }
+
+private:
+    std::vector<T> data;
+    size_t head;
+    size_t count;
+};
+
+// Mean and variance of the last `period` values, updated by sliding
+// Welford steps rather than by re-summing the window. Sliding updates
+// accumulate rounding error, which matters most when the window goes flat
+// and the true variance is 0. The moments are therefore recomputed from
+// the window once per `period` updates, and sooner if the variance falls
+// near the error accumulated since then. A window that stays flat adds no
+// error, so it never triggers the early recompute; the cost stays O(1)
+// amortized.
+template <typename T = double>
+class RollingStats {
+public:
+    explicit RollingStats(int period) : window(checkedPeriod(period)), mean_(0), m2(0), drift(0), slides(0) {}
+
+    void update(T x) {
+        if (window.full()) {
+            const T y = window.front();
+            const T oldMean = mean_;
+            mean_ += (x - y) / window.size();
+            m2 += (x - y) * (x - mean_ + y - oldMean);
+            drift += std::abs(x - y) * (std::abs(x - mean_) + std::abs(y - oldMean));
+            window.push(x);
+            if (++slides == window.size() || (drift > 0 && m2 < drift * kDriftTolerance)) {
+                recompute();
+            }
+        } else {
+            window.push(x);
+            const T delta = x - mean_;
+            mean_ += delta / window.size();
+            m2 += delta * (x - mean_);
+        }
+    }
+
+    bool ready() const { return window.full(); }
+    size_t count() const { return window.size(); }
+    T mean() const { return mean_; }
+
+    // Population variance, as MeanReversionStrategy has always used
+    T variance() const { return window.empty() ? T(0) : m2 / window.size(); }
+    T sampleVariance() const { return window.size() < 2 ? T(0) : m2 / (window.size() - 1); }
+    T stdDev() const { return std::sqrt(variance()); }
+
+    // (x - mean) / stdDev, or 0 for a flat window
+    T zScore(T x) const {
+        const T sd = stdDev();
+        return sd > 0 ? (x - mean_) / sd : T(0);
+    }
+
+    void reset() {
+        window.clear();
+        mean_ = 0;
+        m2 = 0;
+        drift = 0;
+        slides = 0;
+    }
+
+private:
+    // Far above the rounding error of one update relative to its terms
+    static constexpr T kDriftTolerance = T(1e-8);
+
+    static size_t checkedPeriod(int period) {
+        if (period <= 0) {
+            throw std::invalid_argument("RollingStats: period must be positive");
+        }
+        return static_cast<size_t>(period);
+    }
+
+    void recompute() {
+        T sum = 0;
+        for (size_t i = 0; i < window.size(); ++i) {
+            sum += window[i];
+        }
+        mean_ = sum / window.size();
+        m2 = 0;
+        for (size_t i = 0; i < window.size(); ++i) {
+            m2 += (window[i] - mean_) * (window[i] - mean_);
+        }
+        drift = 0;
+        slides = 0;
+    }
+
+    RingBuffer<T> window;
+    T mean_;
+    T m2;
+    T drift;
+    size_t slides;
+};
+
+// Bollinger bands: rolling mean plus and minus `width` population standard deviations
+template <typename T = double>
+class BollingerBands {
+public:
+    BollingerBands(int period, T width) : stats(period), width(width) {
+        if (width <= 0) {
+            throw std::invalid_argument("BollingerBands: width must be positive");
+        }
+    }
+
+    void update(T price) {
+        stats.update(price);
+        last = price;
+    }
+
+    bool ready() const { return stats.ready(); }
+    T middle() const { return stats.mean(); }
+    T upper() const { return stats.mean() + width * stats.stdDev(); }
+    T lower() const { return stats.mean() - width * stats.stdDev(); }
+
+    // Position of the last price within the bands: 0 at the lower, 1 at the upper
+    T percentB() const {
+        const T span = upper() - lower();
+        return span > 0 ? (last - lower()) / span : T(0.5);
+    }
+
+    // Band width relative to the middle band
+    T bandwidth() const {
+        return stats.mean() != 0 ? (upper() - lower()) / stats.mean() : T(0);
+    }
+
+    void reset() {
+        stats.reset();
+        last = 0;
+    }
+
+private:
+    RollingStats<T> stats;
+    T width;
+    T last = 0;
+};
+
+// Wilder's relative strength index. The first `period` changes seed the
+// average gain and loss as simple means; later changes are smoothed with
+// weight 1/period.
+template <typename T = double>
+class WilderRSI {
+public:
+    explicit WilderRSI(int period) : period(period) {
+        if (period <= 0) {
+            throw std::invalid_argument("WilderRSI: period must be positive");
+        }
+    }
+
+    void update(T price) {
+        if (bars++ == 0) {
+            previous = price;
+            return;
+        }
+        const T change = price - previous;
+        previous = price;
+        const T gain = change > 0 ? change : T(0);
+        const T loss = change < 0 ? -change : T(0);
+        const size_t changes = bars - 1;
+        if (changes <= static_cast<size_t>(period)) {
+            avgGain += (gain - avgGain) / changes;
+            avgLoss += (loss - avgLoss) / changes;
+        } else {
+            avgGain = (avgGain * (period - 1) + gain) / period;
+            avgLoss = (avgLoss * (period - 1) + loss) / period;
+        }
+    }
+
+    bool ready() const { return bars > static_cast<size_t>(period); }
+
+    // 0 to 100; 50 when there has been no movement at all
+    T value() const {
+        if (avgLoss == 0) {
+            return avgGain == 0 ? T(50) : T(100);
+        }
+        return T(100) - T(100) / (1 + avgGain / avgLoss);
+    }
+
+    void reset() {
+        bars = 0;
+        previous = avgGain = avgLoss = 0;
+    }
+
+private:
+    int period;
+    size_t bars = 0;
+    T previous = 0;
+    T avgGain = 0;
+    T avgLoss = 0;
+};
+
+// Average true range with Wilder smoothing. With close-only data, pass the
+// close as high and low too; the true range is then the absolute change.
+template <typename T = double>
+class AverageTrueRange {
+public:
+    explicit AverageTrueRange(int period) : period(period) {
+        if (period <= 0) {
+            throw std::invalid_argument("AverageTrueRange: period must be positive");
+        }
+    }
+
+    void update(T high, T low, T close) {
+        T range = high - low;
+        if (bars > 0) {
+            range = std::max({range, std::abs(high - previousClose), std::abs(low - previousClose)});
+        }
+        previousClose = close;
+        bars++;
+        if (bars <= static_cast<size_t>(period)) {
+            atr += (range - atr) / bars;
+        } else {
+            atr = (atr * (period - 1) + range) / period;
+        }
+    }
+
+    bool ready() const { return bars >= static_cast<size_t>(period); }
+    T value() const { return atr; }
+
+    void reset() {
+        bars = 0;
+        previousClose = atr = 0;
+    }
+
+private:
+    int period;
+    size_t bars = 0;
+    T previousClose = 0;
+    T atr = 0;
+};
+
+// Volume-weighted average price since the start of the session
+template <typename T = double>
+class SessionVWAP {
+public:
+    void startSession() {
+        priceVolume = 0;
+        volume = 0;
+    }
+
+    // `price` is usually the bar's typical price, (high + low + close) / 3
+    void update(T price, T barVolume) {
+        priceVolume += price * barVolume;
+        volume += barVolume;
+        last = price;
+    }
+
+    bool ready() const { return volume > 0; }
+
+    // The last price until any volume has traded
+    T value() const { return volume > 0 ? priceVolume / volume : last; }
+
+private:
+    T priceVolume = 0;
+    T volume = 0;
+    T last = 0;
+};
+
+// Minimum (Compare = std::less) or maximum (std::greater) of the last
+// `period` values. A monotonic deque over a fixed ring buffer holds only the
+// values that can still become the extreme, so each update pushes and pops
+// every value at most once.
+template <typename T, typename Compare>
+class RollingExtremum {
+public:
+    explicit RollingExtremum(int period) : period(period), candidates(checkedPeriod(period)) {}
+
+    void update(T x) {
+        if (!candidates.empty() && candidates.front().bar + period <= bars) {
+            candidates.pop_front();
+        }
+        while (!candidates.empty() && !better(candidates.back().value, x)) {
+            candidates.pop_back();
+        }
+        candidates.push_back({bars, x});
+        bars++;
+    }
+
+    bool ready() const { return bars >= static_cast<size_t>(period); }
+    T value() const { return candidates.empty() ? T(0) : candidates.front().value; }
+
+    void reset() {
+        candidates.clear();
+        bars = 0;
+    }
+
+private:
+    struct Entry {
+        size_t bar;
+        T value;
+    };
+
+    static size_t checkedPeriod(int period) {
+        if (period <= 0) {
+            throw std::invalid_argument("RollingExtremum: period must be positive");
+        }
+        return static_cast<size_t>(period);
+    }
+
+    size_t period;
+    RingBuffer<Entry> candidates;
+    size_t bars = 0;
+    Compare better;
+};
+
+template <typename T = double>
+using RollingMin = RollingExtremum<T, std::less<T>>;
+
+template <typename T = double>
+using RollingMax = RollingExtremum<T, std::greater<T>>;
+
+// Order statistics of the last `period` values: any rank, quantile, the
+// median and the median absolute deviation. The window is kept sorted in an
+// indexable skiplist (each link records how many values it skips) over a
+// node pool fixed at construction, so evicting the oldest value and
+// inserting the newest are O(log period), as is select(). Equal values are
+// ordered by arrival, which gives every node a unique key, and a node's
+// height is a hash of its arrival number rather than a draw from shared
+// generator state.
+template <typename T = double>
+class RollingQuantile {
+public:
+    explicit RollingQuantile(int period)
+        : period(checkedPeriod(period))
+        , levels(levelsFor(this->period))
+        , keys(this->period)
+        , arrivals(this->period)
+        , heights(this->period)
+        , links((this->period + 1) * levels)
+    {
+        reset();
+    }
+
+    void update(T x) {
+        const int32_t node = static_cast<int32_t>(bars % period);
+        if (bars >= period) {
+            erase(node);
+        }
+        keys[node] = x;
+        arrivals[node] = bars;
+        heights[node] = heightOf(bars);
+        insert(node);
+        bars++;
+    }
+
+    bool ready() const { return bars >= period; }
+    size_t count() const { return size; }
+
+    // The rank-th smallest value in the window, 0-based
+    T select(size_t rank) const {
+        int32_t node = head();
+        size_t remaining = rank + 1;
+        for (int level = levels - 1; level >= 0; --level) {
+            const Link* l = &links[link(node, level)];
+            while (l->next != kNone && l->width <= remaining) {
+                remaining -= l->width;
+                node = l->next;
+                l = &links[link(node, level)];
+            }
+        }
+        return keys[node];
+    }
+
+    // Quantile q in [0, 1], interpolating linearly between order statistics
+    T quantile(T q) const {
+        if (size == 0) {
+            return T(0);
+        }
+        const T h = (size - 1) * std::min(std::max(q, T(0)), T(1));
+        const size_t below = static_cast<size_t>(h);
+        const T low = select(below);
+        return below + 1 < size ? low + (h - below) * (select(below + 1) - low) : low;
+    }
+
+    T median() const {
+        if (size == 0) {
+            return T(0);
+        }
+        const T upper = select(size / 2);
+        return size % 2 == 1 ? upper : (select(size / 2 - 1) + upper) / 2;
+    }
+
+    // Median of |x - median()| over the window. The deviations of the values
+    // below the median and of those above it are two sorted sequences, so
+    // their median is found by bisection without materializing them:
+    // O(log^2 period).
+    T mad() const { return size == 0 ? T(0) : madAbout(median()); }
+
+    // (x - median) / (1.4826 * MAD), the scale matching the standard
+    // deviation for normal data, or 0 when more than half the window is equal
+    T robustZScore(T x) const {
+        if (size == 0) {
+            return T(0);
+        }
+        const T center = median();
+        const T scale = T(1.4826) * madAbout(center);
+        return scale > 0 ? (x - center) / scale : T(0);
+    }
+
+    void reset() {
+        std::fill(links.begin(), links.end(), Link{kNone, 1});
+        size = 0;
+        bars = 0;
+    }
+
+private:
+    static constexpr int32_t kNone = -1;
+    static constexpr size_t kWalkLimit = 128;
+
+    struct Link {
+        int32_t next;    // kNone at the end of the level
+        uint32_t width;  // values the link moves past, its target included
+    };
+
+    static size_t checkedPeriod(int period) {
+        if (period <= 0) {
+            throw std::invalid_argument("RollingQuantile: period must be positive");
+        }
+        return static_cast<size_t>(period);
+    }
+
+    static int levelsFor(size_t period) {
+        int levels = 1;
+        while ((size_t(1) << (levels - 1)) < period) {
+            levels++;
+        }
+        return levels;
+    }
+
+    // Geometric heights, P(height > h) = 2^-h, from a splitmix64 hash
+    int heightOf(uint64_t arrival) const {
+        uint64_t z = arrival + 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        z ^= z >> 31;
+        return 1 + __builtin_ctzll(z | (uint64_t(1) << (levels - 1)));
+    }
+
+    int32_t head() const { return static_cast<int32_t>(period); }
+    size_t link(int32_t node, int level) const { return static_cast<size_t>(node) * levels + level; }
+
+    bool before(int32_t a, int32_t b) const {
+        return keys[a] < keys[b] || (!(keys[b] < keys[a]) && arrivals[a] < arrivals[b]);
+    }
+
+    void insert(int32_t node) {
+        int32_t chain[64];
+        size_t steps[64];
+        int32_t at = head();
+        size_t position = 0;
+        for (int level = levels - 1; level >= 0; --level) {
+            while (links[link(at, level)].next != kNone && before(links[link(at, level)].next, node)) {
+                position += links[link(at, level)].width;
+                at = links[link(at, level)].next;
+            }
+            chain[level] = at;
+            steps[level] = position;
+        }
+        // position is the rank of the predecessor, counting the head as 0
+        for (int level = 0; level < levels; ++level) {
+            Link& from = links[link(chain[level], level)];
+            if (level < heights[node]) {
+                const uint32_t skipped = static_cast<uint32_t>(position - steps[level]);
+                links[link(node, level)] = Link{from.next, from.width - skipped};
+                from = Link{node, skipped + 1};
+            } else {
+                from.width++;
+            }
+        }
+        size++;
+    }
+
+    void erase(int32_t node) {
+        int32_t at = head();
+        for (int level = levels - 1; level >= 0; --level) {
+            while (links[link(at, level)].next != kNone && before(links[link(at, level)].next, node)) {
+                at = links[link(at, level)].next;
+            }
+            Link& from = links[link(at, level)];
+            if (level < heights[node]) {
+                const Link& removed = links[link(node, level)];
+                from = Link{removed.next, from.width + removed.width - 1};
+            } else {
+                from.width--;
+            }
+        }
+        size--;
+    }
+
+    // Median of the deviations from `center`. Bisection reads O(log size)
+    // order statistics; on small windows reading them from one walk along
+    // the bottom level beats O(log size) skiplist descents whose branches
+    // change every bar.
+    T madAbout(T center) const {
+        if (size <= kWalkLimit) {
+            T sorted[kWalkLimit];
+            size_t rank = 0;
+            for (int32_t node = links[link(head(), 0)].next; node != kNone; node = links[link(node, 0)].next) {
+                sorted[rank++] = keys[node];
+            }
+            return deviationMedian(center, [&](size_t r) { return sorted[r]; });
+        }
+        return deviationMedian(center, [&](size_t r) { return select(r); });
+    }
+
+    // The deviations are center - value for the size / 2 smallest values,
+    // ascending from the middle down, and value - center for the rest,
+    // ascending from the middle up: two sorted sequences. Bisects on how
+    // many of the k + 1 smallest deviations come from the lower side.
+    template <typename Rank>
+    T deviationMedian(T center, Rank valueAt) const {
+        const size_t below = size / 2;
+        const size_t above = size - below;
+        auto lower = [&](size_t i) { return center - valueAt(below - 1 - i); };
+        auto higher = [&](size_t j) { return valueAt(below + j) - center; };
+        const size_t k = (size - 1) / 2;
+        size_t lo = k + 1 > above ? k + 1 - above : 0;
+        size_t hi = std::min(k + 1, below);
+        while (lo < hi) {
+            const size_t i = (lo + hi) / 2;
+            if (lower(i) < higher(k - i)) {
+                lo = i + 1;
+            } else {
+                hi = i;
+            }
+        }
+        // lo deviations from the lower side and k + 1 - lo from the upper
+        // side are the k + 1 smallest
+        const size_t fromHigher = k + 1 - lo;
+        T kth;
+        if (lo == 0) {
+            kth = higher(fromHigher - 1);
+        } else if (fromHigher == 0) {
+            kth = lower(lo - 1);
+        } else {
+            kth = std::max(lower(lo - 1), higher(fromHigher - 1));
+        }
+        if (size % 2 == 1) {
+            return kth;
+        }
+        // Even window: average with the next smallest deviation
+        T following = std::numeric_limits<T>::infinity();
+        if (lo < below) {
+            following = lower(lo);
+        }
+        if (fromHigher < above) {
+            following = std::min(following, higher(fromHigher));
+        }
+        return (kth + following) / 2;
+    }
+
+    size_t period;
+    int levels;
+    std::vector<T> keys;
+    std::vector<uint64_t> arrivals;
+    std::vector<uint8_t> heights;
+    std::vector<Link> links;  // per node and level; the head is node `period`
+    size_t size;
+    size_t bars;
+};
+
+// Span forms: one output per input bar, NaN until the indicator is ready
+
+template <typename T = double>
+void calculateRollingMeanStd(const T* prices, size_t n, int period, T* mean, T* stdDev) {
+    RollingStats<T> stats(period);
+    for (size_t i = 0; i < n; ++i) {
+        stats.update(prices[i]);
+        mean[i] = stats.ready() ? stats.mean() : std::numeric_limits<T>::quiet_NaN();
+        stdDev[i] = stats.ready() ? stats.stdDev() : std::numeric_limits<T>::quiet_NaN();
+    }
+}
+
+template <typename T = double>
+void calculateBollinger(const T* prices, size_t n, int period, T width, T* lower, T* middle, T* upper) {
+    BollingerBands<T> bands(period, width);
+    for (size_t i = 0; i < n; ++i) {
+        bands.update(prices[i]);
+        const bool ready = bands.ready();
+        lower[i] = ready ? bands.lower() : std::numeric_limits<T>::quiet_NaN();
+        middle[i] = ready ? bands.middle() : std::numeric_limits<T>::quiet_NaN();
+        upper[i] = ready ? bands.upper() : std::numeric_limits<T>::quiet_NaN();
+    }
+}
+
+template <typename T = double>
+void calculateRSI(const T* prices, size_t n, int period, T* out) {
+    WilderRSI<T> rsi(period);
+    for (size_t i = 0; i < n; ++i) {
+        rsi.update(prices[i]);
+        out[i] = rsi.ready() ? rsi.value() : std::numeric_limits<T>::quiet_NaN();
+    }
+}
+
+template <typename T = double>
+void calculateATR(const T* high, const T* low, const T* close, size_t n, int period, T* out) {
+    AverageTrueRange<T> atr(period);
+    for (size_t i = 0; i < n; ++i) {
+        atr.update(high[i], low[i], close[i]);
+        out[i] = atr.ready() ? atr.value() : std::numeric_limits<T>::quiet_NaN();
+    }
+}
+
+// One session's bars; split longer spans at session boundaries
+template <typename T = double>
+void calculateVWAP(const T* prices, const T* volumes, size_t n, T* out) {
+    SessionVWAP<T> vwap;
+    for (size_t i = 0; i < n; ++i) {
+        vwap.update(prices[i], volumes[i]);
+        out[i] = vwap.ready() ? vwap.value() : std::numeric_limits<T>::quiet_NaN();
+    }
+}
+
+template <typename T = double>
+void calculateRollingMin(const T* values, size_t n, int period, T* out) {
+    RollingMin<T> extremum(period);
+    for (size_t i = 0; i < n; ++i) {
+        extremum.update(values[i]);
+        out[i] = extremum.ready() ? extremum.value() : std::numeric_limits<T>::quiet_NaN();
+    }
+}
+
+template <typename T = double>
+void calculateRollingMax(const T* values, size_t n, int period, T* out) {
+    RollingMax<T> extremum(period);
+    for (size_t i = 0; i < n; ++i) {
+        extremum.update(values[i]);
+        out[i] = extremum.ready() ? extremum.value() : std::numeric_limits<T>::quiet_NaN();
+    }
+}
+
+template <typename T = double>
+void calculateRollingQuantile(const T* values, size_t n, int period, T q, T* out) {
+    RollingQuantile<T> window(period);
+    for (size_t i = 0; i < n; ++i) {
+        window.update(values[i]);
+        out[i] = window.ready() ? window.quantile(q) : std::numeric_limits<T>::quiet_NaN();
+    }
+}
+
+template <typename T = double>
+void calculateRollingMedianMAD(const T* values, size_t n, int period, T* median, T* mad) {
+    RollingQuantile<T> window(period);
+    for (size_t i = 0; i < n; ++i) {
+        window.update(values[i]);
+        median[i] = window.ready() ? window.median() : std::numeric_limits<T>::quiet_NaN();
+        mad[i] = window.ready() ? window.mad() : std::numeric_limits<T>::quiet_NaN();
+    }
+}
+
+} // namespace trading
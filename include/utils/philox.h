@@ -0,0 +1,94 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace trading {
+
+// Philox4x32-10 counter-based generator (Salmon et al., "Parallel random
+// numbers: as easy as 1, 2, 3", SC'11). Output is a pure function of
+// (key, counter), so a draw depends only on what it is for, never on how
+// many draws came before it or which thread made them. State is the 8-byte
+// key; any number of runs can draw in parallel from disjoint streams.
+class Philox {
+public:
+    using Block = std::array<uint32_t, 4>;
+
+    // `seed` selects the family of streams, `stream` one run within it
+    explicit Philox(uint64_t seed = 0, uint64_t stream = 0)
+        : key_{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)}
+        , stream_(stream)
+    {}
+
+    uint64_t seed() const { return key_[0] | (static_cast<uint64_t>(key_[1]) << 32); }
+    uint64_t stream() const { return stream_; }
+
+    // 128 random bits for block `block` of bar `index`
+    Block bits(uint32_t index, uint32_t block) const {
+        return generate({index, block, static_cast<uint32_t>(stream_), static_cast<uint32_t>(stream_ >> 32)}, key_);
+    }
+
+    // Draw `draw` of bar `index`, uniform on [0, 1) with 53 bits of precision
+    double uniform(uint32_t index, uint32_t draw) const {
+        Block b = bits(index, draw / 2);
+        return (draw % 2 == 0) ? unit(b[0], b[1]) : unit(b[2], b[3]);
+    }
+
+    // Uniform on [low, high)
+    double uniform(uint32_t index, uint32_t draw, double low, double high) const {
+        return low + (high - low) * uniform(index, draw);
+    }
+
+    // Two output words as a double on [0, 1), for callers using generate directly
+    static double unit(uint32_t high, uint32_t low) {
+        uint64_t word = (static_cast<uint64_t>(high) << 32) | low;
+        return static_cast<double>(word >> 11) * 0x1.0p-53;
+    }
+
+    // The raw block function, ten rounds
+    static Block generate(Block counter, std::array<uint32_t, 2> key) {
+        for (int round = 0; round < 10; ++round) {
+            if (round > 0) {
+                key[0] += 0x9E3779B9u;
+                key[1] += 0xBB67AE85u;
+            }
+            const uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * counter[0];
+            const uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * counter[2];
+            counter = {
+                static_cast<uint32_t>(p1 >> 32) ^ counter[1] ^ key[0],
+                static_cast<uint32_t>(p1),
+                static_cast<uint32_t>(p0 >> 32) ^ counter[3] ^ key[1],
+                static_cast<uint32_t>(p0)
+            };
+        }
+        return counter;
+    }
+
+    // generate() over n counters held as four columns, in place. Each round
+    // is a plain loop over the columns, which compiles to vector code.
+    static void generate(size_t n, uint32_t* c0, uint32_t* c1, uint32_t* c2, uint32_t* c3,
+                         std::array<uint32_t, 2> key) {
+        for (int round = 0; round < 10; ++round) {
+            if (round > 0) {
+                key[0] += 0x9E3779B9u;
+                key[1] += 0xBB67AE85u;
+            }
+            for (size_t j = 0; j < n; ++j) {
+                const uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * c0[j];
+                const uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * c2[j];
+                const uint32_t x1 = c1[j];
+                const uint32_t x3 = c3[j];
+                c0[j] = static_cast<uint32_t>(p1 >> 32) ^ x1 ^ key[0];
+                c1[j] = static_cast<uint32_t>(p1);
+                c2[j] = static_cast<uint32_t>(p0 >> 32) ^ x3 ^ key[1];
+                c3[j] = static_cast<uint32_t>(p0);
+            }
+        }
+    }
+
+private:
+    std::array<uint32_t, 2> key_;
+    uint64_t stream_;
+};
+
+} // namespace trading
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace trading {
+
+// CPU numbers as listed by the kernel, e.g. {2, 3, 4, 5, 8}
+using CpuList = std::vector<int>;
+
+// Parses a kernel-style list such as "2-5,8"; throws std::invalid_argument on bad input
+CpuList parseCpuList(const std::string& text);
+std::string formatCpuList(const CpuList& cpus);
+
+// CPUs this process may run on
+CpuList availableCpus();
+
+// Reads a CPU list from an environment variable. Returns an empty list if the
+// variable is unset or invalid; CPUs outside availableCpus() are dropped.
+CpuList cpuListFromEnvironment(const char* name);
+
+// Restricts the calling thread (and threads it creates later) to a CPU set
+bool pinCurrentThread(const CpuList& cpus);
+
+// Whether TRADING_HUGE_PAGES asks for transparent huge pages on large buffers
+bool hugePagesEnabled();
+
+// Asks for transparent huge pages on the 2 MB aligned interior of a buffer.
+// Call it before the pages are first written. Does nothing unless
+// hugePagesEnabled() and the buffer spans at least one huge page.
+void adviseHugePages(const void* data, size_t bytes);
+
+} // namespace trading
@@ -0,0 +1,106 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "utils/placement.h"
+
+namespace trading {
+
+enum class Priority {
+    Interactive = 0, // latency sensitive requests such as /simulate
+    Background = 1   // sweeps, scans, warm-ups
+};
+
+// A resumable unit of work: runs one small step and returns true while more
+// steps remain. The scheduler re-queues it between steps, which is where
+// background work yields to interactive work.
+using ResumableTask = std::function<bool()>;
+
+struct SchedulerClassStats {
+    size_t queued;
+    size_t running;
+    size_t limit;
+    uint64_t completed;
+    uint64_t units;
+    double totalQueueMs;
+    double maxQueueMs;
+    double totalRunMs;
+    double maxRunMs;
+};
+
+struct SchedulerStats {
+    size_t workers;
+    CpuList cpus;
+    SchedulerClassStats interactive;
+    SchedulerClassStats background;
+};
+
+// Fixed pool of compute workers with two priority classes. A free worker
+// always takes queued interactive work first, and each class has its own
+// concurrency limit, so keeping the background limit below the worker
+// count reserves capacity for interactive requests.
+//
+// Given a CPU set, each worker pins itself before taking work: to one CPU
+// of its own when there are enough, otherwise to the whole set. Memory a
+// worker allocates and first writes is then local to the CPU that uses it.
+class Scheduler {
+public:
+    Scheduler(size_t workers, size_t maxInteractive, size_t maxBackground, CpuList cpus = {});
+    ~Scheduler();
+
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    // Sizes the pool from TRADING_COMPUTE_THREADS, TRADING_MAX_INTERACTIVE
+    // and TRADING_MAX_BACKGROUND, defaulting to the hardware concurrency,
+    // and pins the workers to TRADING_COMPUTE_CPUS if it is set.
+    static std::unique_ptr<Scheduler> fromEnvironment();
+
+    std::future<void> submit(Priority priority, std::function<void()> task);
+    std::future<void> submitResumable(Priority priority, ResumableTask task);
+
+    size_t limit(Priority priority) const;
+    const CpuList& cpus() const { return cpuSet; }
+    SchedulerStats stats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Job {
+        ResumableTask task;
+        std::shared_ptr<std::promise<void>> done;
+        Clock::time_point enqueuedAt;
+    };
+
+    struct ClassState {
+        std::deque<Job> queue;
+        size_t running = 0;
+        size_t limit = 0;
+        uint64_t completed = 0;
+        uint64_t units = 0;
+        double totalQueueMs = 0.0;
+        double maxQueueMs = 0.0;
+        double totalRunMs = 0.0;
+        double maxRunMs = 0.0;
+    };
+
+    void workerLoop(const CpuList& cpus);
+    bool runnable(const ClassState& state) const;
+    SchedulerClassStats snapshot(const ClassState& state) const;
+
+    mutable std::mutex mutex;
+    std::condition_variable wakeup;
+    ClassState classes[2];
+    bool stopping;
+    const CpuList cpuSet;
+    std::vector<std::thread> threads;
+};
+
+} // namespace trading
@@ -0,0 +1,88 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace trading {
+
+// Hierarchical timer wheel over integer time (bar seconds, bar indices, or
+// any other monotonic count). Four levels of 64 slots: level l holds timers
+// due within the current 64^(l+1) block, one slot per 64^l units, and
+// timers beyond that wait in an overflow list. As time passes, a slot's
+// timers cascade to the level below. Occupancy bitmaps let advance() jump
+// straight to the next non-empty slot, so advancing costs O(levels + fired
+// + cascaded) however far time moves, and each timer cascades at most
+// four times.
+class TimerWheel {
+public:
+    // 0 is never a valid id, so callers can use it for "no timer"
+    using TimerId = uint64_t;
+
+    struct Expired {
+        TimerId id;
+        int64_t due;
+        uint64_t payload;
+    };
+
+    explicit TimerWheel(int64_t start = 0);
+
+    // Drops every timer and restarts the clock at `start`
+    void reset(int64_t start);
+
+    int64_t now() const { return current; }
+    size_t size() const { return active; }
+
+    // Schedules `payload` to expire at `due`. A timer due at or before
+    // now() expires on the next advance().
+    TimerId schedule(int64_t due, uint64_t payload);
+
+    // Whether `id` is scheduled and has neither expired nor been cancelled
+    bool pending(TimerId id) const;
+
+    // Removes a pending timer; false if it already expired or was cancelled
+    bool cancel(TimerId id);
+
+    // Moves the clock to `time` and appends every timer due at or before it
+    // to `expired`, in due order. The clock never moves backwards.
+    void advance(int64_t time, std::vector<Expired>& expired);
+
+private:
+    static constexpr int kLevelBits = 6;
+    static constexpr int kSlots = 1 << kLevelBits;
+    static constexpr int kLevels = 4;
+    static constexpr int32_t kNone = -1;
+    static constexpr int32_t kReady = kLevels * kSlots;  // due at or before now()
+    static constexpr int32_t kOverflow = kReady + 1;      // beyond the top level
+    static constexpr int32_t kLists = kOverflow + 1;
+
+    struct Node {
+        int64_t due;
+        uint64_t payload;
+        uint32_t generation;
+        int32_t list;  // index into lists, kNone when free
+        int32_t prev;
+        int32_t next;
+    };
+
+    struct List {
+        int32_t head = kNone;
+        int32_t tail = kNone;
+    };
+
+    void place(int32_t index);
+    void link(int32_t index, int32_t list);
+    void unlink(int32_t index);
+    void release(int32_t index);
+    void fire(int32_t index, std::vector<Expired>& expired);
+    TimerId idOf(int32_t index) const;
+    int32_t indexOf(TimerId id) const;
+
+    int64_t current;
+    size_t active;
+    std::vector<Node> nodes;
+    std::vector<int32_t> freeNodes;
+    List lists[kLists];
+    uint64_t occupied[kLevels];
+};
+
+} // namespace trading
@@ -4,6 +4,7 @@ pkgs.mkShell {
     pkgs.gnumake
     pkgs.gcc
     pkgs.curl
+    pkgs.zlib
     pkgs.python3
     pkgs.python3Packages.pandas
     pkgs.python3Packages.pip
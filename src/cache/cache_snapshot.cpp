@@ -0,0 +1,240 @@
+#include "cache/cache_snapshot.h"
+#include "utils/file_lock.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace trading {
+
+namespace {
+    // File layout (native byte order):
+    //   Header
+    //   Bucket[bucketCount]    open-addressing index, offset 0 = empty
+    //   Record...              8-byte aligned, key and value bytes inline
+    constexpr char kMagic[8] = {'D', 'G', 'S', 'N', 'A', 'P', '0', '1'};
+
+    struct Header {
+        char magic[8];
+        uint64_t bucketCount;
+        uint64_t entryCount;
+        char generation[40];
+    };
+
+    struct Bucket {
+        uint64_t hash;
+        uint64_t offset;
+    };
+
+    struct RecordHeader {
+        uint32_t keyLength;
+        uint32_t reserved;
+        uint64_t valueLength;
+        int64_t createdAt;
+    };
+
+    uint64_t hashKey(std::string_view key) {
+        uint64_t h = 1469598103934665603ULL;
+        for (unsigned char c : key) {
+            h ^= c;
+            h *= 1099511628211ULL;
+        }
+        return h | 1; // never collide with an empty bucket
+    }
+
+    uint64_t align8(uint64_t n) {
+        return (n + 7) & ~uint64_t(7);
+    }
+
+    bool writeAll(FILE* file, const void* data, size_t length) {
+        return length == 0 || std::fwrite(data, 1, length, file) == length;
+    }
+}
+
+CacheSnapshot::CacheSnapshot(const char* data, size_t size, uint64_t bucketCount, uint64_t count)
+    : data(data)
+    , size(size)
+    , bucketCount(bucketCount)
+    , count(count)
+{
+}
+
+CacheSnapshot::~CacheSnapshot() {
+    munmap(const_cast<char*>(data), size);
+}
+
+/**
+ * @brief Memory-maps a snapshot file.
+ *
+ * Only the header is inspected here; the index and records are paged in on
+ * demand by lookups, so startup cost does not grow with the snapshot.
+ *
+ * @param path Snapshot file path
+ * @param generation Expected generation; snapshots from another generation are ignored
+ * @return The mapped snapshot, or nullptr if it is missing, corrupt or stale
+ */
+std::shared_ptr<const CacheSnapshot> CacheSnapshot::open(const std::string& path,
+                                                         const std::string& generation) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        close(fd);
+        return nullptr;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        return nullptr;
+    }
+
+    const Header* header = static_cast<const Header*>(mapped);
+    bool valid = std::memcmp(header->magic, kMagic, sizeof(kMagic)) == 0 &&
+                 generation.compare(0, sizeof(header->generation) - 1, header->generation) == 0 &&
+                 header->bucketCount > 0 &&
+                 (header->bucketCount & (header->bucketCount - 1)) == 0 &&
+                 header->bucketCount <= (size - sizeof(Header)) / sizeof(Bucket);
+    if (!valid) {
+        munmap(mapped, size);
+        return nullptr;
+    }
+
+    madvise(mapped, size, MADV_RANDOM);
+    return std::shared_ptr<const CacheSnapshot>(
+        new CacheSnapshot(static_cast<const char*>(mapped), size, header->bucketCount, header->entryCount));
+}
+
+/**
+ * @brief Writes a snapshot file.
+ *
+ * The index is sized to a power of two at most half full. The file is
+ * written to a temp path and renamed into place, so a reader mapping the
+ * old snapshot is unaffected and a crash mid-write leaves no torn file.
+ *
+ * @param path Destination path
+ * @param generation Generation tag stored in the header
+ * @param entries Entries to store
+ */
+void CacheSnapshot::write(const std::string& path, const std::string& generation,
+                          const std::vector<Entry>& entries) {
+    uint64_t bucketCount = 1;
+    while (bucketCount < entries.size() * 2) {
+        bucketCount <<= 1;
+    }
+
+    std::vector<Bucket> buckets(bucketCount, Bucket{0, 0});
+    uint64_t offset = sizeof(Header) + bucketCount * sizeof(Bucket);
+    for (const auto& entry : entries) {
+        uint64_t h = hashKey(entry.key);
+        uint64_t i = h & (bucketCount - 1);
+        while (buckets[i].offset != 0) {
+            i = (i + 1) & (bucketCount - 1);
+        }
+        buckets[i] = {h, offset};
+        offset += align8(sizeof(RecordHeader) + entry.key.size() + entry.value->size());
+    }
+
+    Header header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.bucketCount = bucketCount;
+    header.entryCount = entries.size();
+    std::strncpy(header.generation, generation.c_str(), sizeof(header.generation) - 1);
+
+    publishFile(path, "CacheSnapshot", [&](FILE* file) {
+        static const char padding[8] = {};
+        bool ok = writeAll(file, &header, sizeof(header)) &&
+                  writeAll(file, buckets.data(), buckets.size() * sizeof(Bucket));
+        for (const auto& entry : entries) {
+            RecordHeader record = {static_cast<uint32_t>(entry.key.size()), 0,
+                                   entry.value->size(), entry.createdAt};
+            size_t length = sizeof(record) + entry.key.size() + entry.value->size();
+            ok = ok && writeAll(file, &record, sizeof(record)) && writeAll(file, entry.key.data(), entry.key.size()) &&
+                 writeAll(file, entry.value->data(), entry.value->size()) &&
+                 writeAll(file, padding, align8(length) - length);
+        }
+        return ok;
+    });
+}
+
+/**
+ * @brief Decodes the record at an offset, bounds-checked against the mapping.
+ *
+ * @param offset Byte offset of the record header
+ * @return The record, or std::nullopt if it would run past the end of the file
+ */
+std::optional<SnapshotRecord> CacheSnapshot::recordAt(uint64_t offset) const {
+    if (offset % 8 != 0 || offset > size || size - offset < sizeof(RecordHeader)) {
+        return std::nullopt;
+    }
+    const RecordHeader* record = reinterpret_cast<const RecordHeader*>(data + offset);
+    uint64_t available = size - offset - sizeof(RecordHeader);
+    if (record->keyLength > available || record->valueLength > available - record->keyLength) {
+        return std::nullopt;
+    }
+    const char* keyData = data + offset + sizeof(RecordHeader);
+    return SnapshotRecord{std::string_view(keyData, record->keyLength),
+                          std::string_view(keyData + record->keyLength, record->valueLength),
+                          record->createdAt};
+}
+
+/**
+ * @brief Looks up a key by probing the on-disk index.
+ *
+ * @param key Cache key
+ * @return The record (viewing the mapping), or std::nullopt on a miss
+ */
+std::optional<SnapshotRecord> CacheSnapshot::find(const std::string& key) const {
+    const Bucket* buckets = reinterpret_cast<const Bucket*>(data + sizeof(Header));
+    uint64_t h = hashKey(key);
+    for (uint64_t probe = 0, i = h & (bucketCount - 1); probe < bucketCount; ++probe, i = (i + 1) & (bucketCount - 1)) {
+        if (buckets[i].offset == 0) {
+            return std::nullopt;
+        }
+        if (buckets[i].hash != h) {
+            continue;
+        }
+        auto record = recordAt(buckets[i].offset);
+        if (record && record->key == key) {
+            return record;
+        }
+    }
+    return std::nullopt;
+}
+
+/**
+ * @brief Visits every intact record in the snapshot.
+ *
+ * @param visit Callback invoked once per record
+ */
+void CacheSnapshot::forEach(const std::function<void(const SnapshotRecord&)>& visit) const {
+    const Bucket* buckets = reinterpret_cast<const Bucket*>(data + sizeof(Header));
+    for (uint64_t i = 0; i < bucketCount; ++i) {
+        if (buckets[i].offset == 0) {
+            continue;
+        }
+        if (auto record = recordAt(buckets[i].offset)) {
+            visit(*record);
+        }
+    }
+}
+
+/**
+ * @brief Identifies the running binary by its size and modification time.
+ *
+ * @return A short generation tag, or "unknown" if the binary cannot be inspected
+ */
+std::string binaryGeneration() {
+    struct stat st;
+    if (stat("/proc/self/exe", &st) != 0) {
+        return "unknown";
+    }
+    return std::to_string(static_cast<long long>(st.st_mtime)) + "-" + std::to_string(static_cast<long long>(st.st_size));
+}
+
+} // namespace trading
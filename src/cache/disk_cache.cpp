@@ -0,0 +1,189 @@
+#include "cache/disk_cache.h"
+#include "utils/file_lock.h"
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace trading {
+
+namespace {
+    // Threads of one process share fcntl locks, so same-process callers are
+    // serialized by a striped mutex before they take the file lock.
+    std::array<std::mutex, 64> leaseStripes;
+
+    uint64_t fnv1a(const std::string& s) {
+        uint64_t h = 1469598103934665603ULL;
+        for (unsigned char c : s) {
+            h ^= c;
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+    std::string fileNameFor(const std::string& key) {
+        std::string name;
+        for (char c : key) {
+            if (name.size() >= 64) {
+                break;
+            }
+            bool safe = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                        (c >= '0' && c <= '9') || c == '-' || c == '.';
+            name += safe ? c : '_';
+        }
+        char hash[17];
+        std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(fnv1a(key)));
+        return name + "-" + hash;
+    }
+}
+
+/**
+ * @brief Constructor for the disk cache.
+ *
+ * Creates the cache directory and its lease subdirectory if needed. An empty
+ * directory disables the cache.
+ *
+ * @param directory Root directory of the cache
+ */
+DiskCache::DiskCache(std::string directory) : directory(std::move(directory)) {
+    while (this->directory.size() > 1 && this->directory.back() == '/') {
+        this->directory.pop_back();
+    }
+    if (enabled()) {
+        makeDirectory(this->directory + "/locks", "DiskCache");
+    }
+}
+
+/**
+ * @brief Builds a cache from the TRADING_CACHE_DIR environment variable.
+ *
+ * @return A cache rooted at $TRADING_CACHE_DIR, or a disabled cache if unset
+ */
+DiskCache DiskCache::fromEnvironment() {
+    const char* dir = std::getenv("TRADING_CACHE_DIR");
+    return DiskCache(dir ? dir : "");
+}
+
+/**
+ * @brief Maps a key to its entry path.
+ *
+ * File names are a readable prefix of the key followed by a hash of the full
+ * key, so the directory itself is the index and lookups need no lock.
+ *
+ * @param key Cache key
+ * @return Absolute or relative path of the entry file
+ */
+std::string DiskCache::pathFor(const std::string& key) const {
+    return directory + "/" + fileNameFor(key);
+}
+
+/**
+ * @brief Reads an entry without taking any lock.
+ *
+ * Entries only ever appear through rename(), so an open() either misses or
+ * sees a complete file.
+ *
+ * @param key Cache key
+ * @return The entry contents, or std::nullopt if the key is not cached
+ */
+std::optional<std::string> DiskCache::get(const std::string& key) const {
+    if (!enabled()) {
+        return std::nullopt;
+    }
+
+    int fd = open(pathFor(key).c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+
+    std::string contents;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        contents.reserve(static_cast<size_t>(st.st_size));
+    }
+    char buffer[65536];
+    ssize_t n;
+    while ((n = read(fd, buffer, sizeof(buffer))) != 0) {
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            close(fd);
+            return std::nullopt;
+        }
+        contents.append(buffer, static_cast<size_t>(n));
+    }
+    close(fd);
+    return contents;
+}
+
+/**
+ * @brief Publishes an entry atomically.
+ *
+ * The value is written to a temp file unique to this host, process and call,
+ * flushed to stable storage and renamed over the final path.
+ *
+ * @param key Cache key
+ * @param value Entry contents
+ */
+void DiskCache::put(const std::string& key, const std::string& value) const {
+    if (!enabled()) {
+        return;
+    }
+
+    publishFile(pathFor(key), "DiskCache", [&](FILE* file) {
+        return std::fwrite(value.data(), 1, value.size(), file) == value.size();
+    });
+}
+
+/**
+ * @brief Returns a cached entry, fetching it under a lease on a miss.
+ *
+ * On a miss the caller takes the key's lease (an in-process stripe mutex
+ * plus an fcntl lock on a per-key lease file), re-checks the cache in case
+ * another process published while it waited, and only then runs fetch.
+ * Every other process asking for the same key blocks on the lease and then
+ * reads the published entry, so a cold key is fetched once fleet-wide.
+ *
+ * @param key Cache key
+ * @param fetch Produces the value on a miss
+ * @param cacheable Decides whether a fetched value may be published
+ * @return The cached or freshly fetched value
+ */
+std::string DiskCache::getOrFetch(const std::string& key,
+                                  const std::function<std::string()>& fetch,
+                                  const std::function<bool(const std::string&)>& cacheable) const {
+    if (!enabled()) {
+        return fetch();
+    }
+    if (auto hit = get(key)) {
+        return *hit;
+    }
+
+    std::lock_guard<std::mutex> stripe(leaseStripes[fnv1a(key) % leaseStripes.size()]);
+    FileLock lease(directory + "/locks/" + fileNameFor(key) + ".lock");
+
+    if (auto hit = get(key)) {
+        return *hit;
+    }
+
+    std::string value = fetch();
+    if (cacheable(value)) {
+        try {
+            put(key, value);
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: " << e.what() << std::endl;
+        }
+    }
+    return value;
+}
+
+} // namespace trading
@@ -0,0 +1,178 @@
+#include "cache/memory_cache.h"
+#include <algorithm>
+#include <chrono>
+
+namespace trading {
+
+namespace {
+    int64_t nowSeconds() {
+        return std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+}
+
+/**
+ * @brief Constructor for the in-memory cache.
+ *
+ * @param capacityBytes Total key and value bytes kept before evicting the least recently used entries
+ */
+MemoryCache::MemoryCache(size_t capacityBytes)
+    : capacityBytes(capacityBytes)
+    , usedBytes(0)
+{
+}
+
+/**
+ * @brief Looks up a key, falling back to the attached snapshots.
+ *
+ * Snapshot entries are validated the first time they are requested. Valid
+ * entries are copied into memory and are then served like any other entry.
+ * Invalid entries are remembered and skipped after that.
+ *
+ * @param key Cache key
+ * @return The cached value, or nullptr on a miss
+ */
+std::shared_ptr<const std::string> MemoryCache::get(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if (it != index.end()) {
+        lru.splice(lru.begin(), lru, it->second);
+        return it->second->value;
+    }
+
+    if (snapshots.empty() || rejected.count(key)) {
+        return nullptr;
+    }
+    bool stale = false;
+    for (const auto& snapshot : snapshots) {
+        if (!snapshot) {
+            continue;
+        }
+        auto record = snapshot->find(key);
+        if (!record) {
+            continue;
+        }
+        if (validator && !validator(key, record->createdAt)) {
+            stale = true;
+            continue;
+        }
+        auto value = std::make_shared<const std::string>(record->value);
+        insertLocked(key, value, record->createdAt);
+        return value;
+    }
+    if (stale) {
+        rejected.insert(key);
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Inserts or replaces an entry and evicts down to capacity.
+ *
+ * @param key Cache key
+ * @param value Serialized value
+ */
+void MemoryCache::put(const std::string& key, std::string value) {
+    auto shared = std::make_shared<const std::string>(std::move(value));
+    std::lock_guard<std::mutex> lock(mutex);
+    insertLocked(key, std::move(shared), nowSeconds());
+}
+
+void MemoryCache::insertLocked(const std::string& key, std::shared_ptr<const std::string> value, int64_t createdAt) {
+    auto it = index.find(key);
+    if (it != index.end()) {
+        usedBytes -= it->second->key.size() + it->second->value->size();
+        lru.erase(it->second);
+        index.erase(it);
+    }
+
+    size_t entryBytes = key.size() + value->size();
+    if (entryBytes > capacityBytes) {
+        return;
+    }
+    lru.push_front({key, std::move(value), createdAt});
+    index[key] = lru.begin();
+    usedBytes += entryBytes;
+
+    while (usedBytes > capacityBytes && !lru.empty()) {
+        const Node& victim = lru.back();
+        usedBytes -= victim.key.size() + victim.value->size();
+        index.erase(victim.key);
+        lru.pop_back();
+    }
+}
+
+/**
+ * @brief Attaches snapshots from a previous run as a lazily consulted second level.
+ *
+ * @param snapshots Mapped snapshots, this process's own first; any may be nullptr
+ * @param validator Decides on first access whether a snapshot entry is still fresh
+ */
+void MemoryCache::attachSnapshots(std::vector<std::shared_ptr<const CacheSnapshot>> snapshots, Validator validator) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->snapshots = std::move(snapshots);
+    this->validator = std::move(validator);
+    rejected.clear();
+}
+
+/**
+ * @brief Persists the cache for the next run.
+ *
+ * Writes the in-memory entries, most recently used first, then fills what
+ * is left of capacityBytes with the newest still-valid entries of this
+ * process's own snapshot that were never requested during this run, so
+ * cold entries survive restarts until the validator ages them out. A
+ * snapshot is therefore never larger than the cache that loads it.
+ *
+ * @param path Snapshot file path
+ * @param generation Generation tag for the snapshot header
+ */
+void MemoryCache::saveSnapshot(const std::string& path, const std::string& generation) const {
+    std::vector<CacheSnapshot::Entry> entries;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.reserve(lru.size());
+        for (const auto& node : lru) {
+            entries.push_back({node.key, node.value, node.createdAt});
+        }
+
+        std::vector<SnapshotRecord> unrequested;
+        if (!snapshots.empty() && snapshots.front()) {
+            snapshots.front()->forEach([&](const SnapshotRecord& record) {
+                std::string key(record.key);
+                if (index.count(key) || rejected.count(key)) {
+                    return;
+                }
+                if (validator && !validator(key, record.createdAt)) {
+                    return;
+                }
+                unrequested.push_back(record);
+            });
+        }
+        std::stable_sort(unrequested.begin(), unrequested.end(),
+                         [](const SnapshotRecord& a, const SnapshotRecord& b) { return a.createdAt > b.createdAt; });
+        size_t savedBytes = usedBytes;
+        for (const auto& record : unrequested) {
+            const size_t entryBytes = record.key.size() + record.value.size();
+            if (savedBytes + entryBytes > capacityBytes) {
+                continue;
+            }
+            savedBytes += entryBytes;
+            entries.push_back({std::string(record.key), std::make_shared<const std::string>(record.value),
+                               record.createdAt});
+        }
+    }
+    CacheSnapshot::write(path, generation, entries);
+}
+
+size_t MemoryCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return lru.size();
+}
+
+size_t MemoryCache::bytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return usedBytes;
+}
+
+} // namespace trading
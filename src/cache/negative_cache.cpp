@@ -0,0 +1,79 @@
+#include "cache/negative_cache.h"
+
+namespace trading {
+
+/**
+ * @brief Constructor for the negative cache.
+ *
+ * @param ttl How long a failure is remembered; zero disables the cache
+ * @param maxEntries Upper bound on remembered failures
+ */
+NegativeCache::NegativeCache(std::chrono::seconds ttl, size_t maxEntries)
+    : ttl(ttl)
+    , maxEntries(maxEntries)
+{
+}
+
+/**
+ * @brief Looks up an unexpired failure.
+ *
+ * @param key Cache key
+ * @return The remembered failure, or nullptr if there is none or it expired
+ */
+std::shared_ptr<const std::string> NegativeCache::get(const std::string& key) {
+    if (!enabled()) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        return nullptr;
+    }
+    if (Clock::now() >= it->second.expiresAt) {
+        entries.erase(it);
+        return nullptr;
+    }
+    return it->second.value;
+}
+
+/**
+ * @brief Remembers a failure for the configured TTL.
+ *
+ * @param key Cache key
+ * @param value Failure response to replay
+ */
+void NegativeCache::put(const std::string& key, std::string value) {
+    if (!enabled()) {
+        return;
+    }
+    auto shared = std::make_shared<const std::string>(std::move(value));
+    Clock::time_point now = Clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (entries.size() >= maxEntries && !entries.count(key)) {
+        pruneLocked(now);
+    }
+    entries[key] = {std::move(shared), now + ttl};
+}
+
+/**
+ * @brief Drops expired entries, or everything if the map is still full.
+ */
+void NegativeCache::pruneLocked(Clock::time_point now) {
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (now >= it->second.expiresAt) {
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (entries.size() >= maxEntries) {
+        entries.clear();
+    }
+}
+
+size_t NegativeCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+} // namespace trading
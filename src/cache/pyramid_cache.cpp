@@ -0,0 +1,66 @@
+#include "cache/pyramid_cache.h"
+
+namespace trading {
+
+/**
+ * @brief Constructor for the pyramid cache.
+ *
+ * @param capacityBytes Total key and pyramid bytes kept before evicting the least recently used entries
+ */
+PyramidCache::PyramidCache(size_t capacityBytes)
+    : capacityBytes(capacityBytes)
+    , usedBytes(0)
+{
+}
+
+std::shared_ptr<const SeriesPyramid> PyramidCache::get(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if (it == index.end()) {
+        return nullptr;
+    }
+    lru.splice(lru.begin(), lru, it->second);
+    return it->second->pyramid;
+}
+
+/**
+ * @brief Inserts or replaces an entry and evicts down to capacity.
+ *
+ * @param key Cache key of the result the pyramid summarizes
+ * @param pyramid The pyramid; entries larger than the capacity are not kept
+ */
+void PyramidCache::put(const std::string& key, std::shared_ptr<const SeriesPyramid> pyramid) {
+    size_t entryBytes = key.size() + pyramid->byteSize();
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if (it != index.end()) {
+        usedBytes -= it->second->bytes;
+        lru.erase(it->second);
+        index.erase(it);
+    }
+    if (entryBytes > capacityBytes) {
+        return;
+    }
+    lru.push_front({key, std::move(pyramid), entryBytes});
+    index[key] = lru.begin();
+    usedBytes += entryBytes;
+
+    while (usedBytes > capacityBytes && !lru.empty()) {
+        const Node& victim = lru.back();
+        usedBytes -= victim.bytes;
+        index.erase(victim.key);
+        lru.pop_back();
+    }
+}
+
+size_t PyramidCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return lru.size();
+}
+
+size_t PyramidCache::bytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return usedBytes;
+}
+
+} // namespace trading
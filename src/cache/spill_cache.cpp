@@ -0,0 +1,328 @@
+#include "cache/spill_cache.h"
+#include "utils/file_lock.h"
+#include "utils/gzip.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace trading {
+
+namespace {
+    // File layout: Header, key bytes, gzip body
+    constexpr char kMagic[8] = {'D', 'G', 'S', 'P', 'I', 'L', '0', '1'};
+    constexpr const char* kSuffix = ".spill";
+
+    constexpr int64_t kDefaultMinKB = 64;
+    constexpr int64_t kDefaultMaxMB = 4096;
+
+    // Spilled bodies are written once and served many times, so the default
+    // level's better ratio is worth its extra time over level 1
+    constexpr int kCompressionLevel = 6;
+
+    struct Header {
+        char magic[8];
+        char generation[40];
+        uint32_t keyLength;
+        uint32_t reserved;
+        uint64_t gzipBytes;
+    };
+
+    // Eviction goes below the budget, so a full directory is not rescanned on every put
+    constexpr size_t kEvictToPercent = 90;
+
+    // A hit refreshes its file's modification time at most this often
+    constexpr int64_t kTouchIntervalSeconds = 60;
+
+    int64_t envInteger(const char* name, int64_t defaultValue) {
+        const char* value = std::getenv(name);
+        if (!value) {
+            return defaultValue;
+        }
+        try {
+            int64_t parsed = std::stoll(value);
+            if (parsed >= 0) {
+                return parsed;
+            }
+        } catch (const std::exception&) {
+        }
+        std::cerr << "Warning: ignoring invalid " << name << " value '" << value << "'" << std::endl;
+        return defaultValue;
+    }
+
+    std::string fileNameFor(const std::string& key) {
+        uint64_t h = 1469598103934665603ULL;
+        for (unsigned char c : key) {
+            h ^= c;
+            h *= 1099511628211ULL;
+        }
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx%s", static_cast<unsigned long long>(h), kSuffix);
+        return name;
+    }
+
+    bool hasSuffix(const std::string& name) {
+        size_t n = std::strlen(kSuffix);
+        return name.size() > n && name.compare(name.size() - n, n, kSuffix) == 0;
+    }
+}
+
+SpilledBody::SpilledBody(const char* mapping, size_t size, size_t offset)
+    : mapping(mapping)
+    , size(size)
+    , offset(offset)
+{
+}
+
+SpilledBody::~SpilledBody() {
+    munmap(const_cast<char*>(mapping), size);
+}
+
+std::string SpilledBody::decompress() const {
+    return gzipDecompress(gzipData(), gzipSize());
+}
+
+/**
+ * @brief Constructor for the spill cache.
+ *
+ * Creates the directory if needed. The ledger is rebuilt from a scan of
+ * the files already there, evicting down to the budget, so totals left
+ * wrong by a crashed process are corrected at the next start.
+ *
+ * @param directory Spill directory; empty disables the cache
+ * @param generation Tag written into every file; files with another tag are ignored
+ * @param minBytes Smallest body worth spilling
+ * @param capacityBytes Disk budget for all spill files in the directory
+ * @throws std::runtime_error if the directory or its lock file cannot be created
+ */
+SpillCache::SpillCache(std::string directory, std::string generation, size_t minBytes, size_t capacityBytes)
+    : directory(std::move(directory))
+    , generation(std::move(generation))
+    , minBytes(minBytes)
+    , capacityBytes(capacityBytes)
+{
+    if (enabled()) {
+        makeDirectory(this->directory, "SpillCache");
+        std::lock_guard<std::mutex> lock(mutex);
+        FileLock lease(lockPath());
+        evictLocked(capacityBytes);
+    }
+}
+
+std::unique_ptr<SpillCache> SpillCache::fromEnvironment(const std::string& generation) {
+    const char* dir = std::getenv("TRADING_SPILL_DIR");
+    size_t minBytes = static_cast<size_t>(envInteger("TRADING_SPILL_MIN_KB", kDefaultMinKB)) << 10;
+    size_t capacityBytes = static_cast<size_t>(envInteger("TRADING_SPILL_MAX_MB", kDefaultMaxMB)) << 20;
+    return std::make_unique<SpillCache>(dir ? dir : "", generation, minBytes, capacityBytes);
+}
+
+std::string SpillCache::lockPath() const {
+    return directory + "/spill.lock";
+}
+
+bool SpillCache::readUsageLocked(Usage& usage) const {
+    FILE* file = std::fopen((directory + "/spill.usage").c_str(), "r");
+    if (!file) {
+        return false;
+    }
+    unsigned long long files = 0;
+    unsigned long long bytes = 0;
+    bool ok = std::fscanf(file, "%llu %llu", &files, &bytes) == 2;
+    std::fclose(file);
+    usage = {static_cast<size_t>(files), static_cast<size_t>(bytes)};
+    return ok;
+}
+
+void SpillCache::writeUsageLocked(const Usage& usage) const {
+    FILE* file = std::fopen((directory + "/spill.usage").c_str(), "w");
+    if (!file) {
+        return; // the next put finds no ledger and rescans
+    }
+    std::fprintf(file, "%llu %llu\n", static_cast<unsigned long long>(usage.files),
+                 static_cast<unsigned long long>(usage.bytes));
+    std::fclose(file);
+}
+
+/**
+ * @brief Rescans the directory and removes the least recently used files until at most `targetBytes` remain.
+ *
+ * Files are ordered by modification time, which a hit refreshes. Readers
+ * that already mapped an evicted file keep their copy.
+ *
+ * @param targetBytes Bytes to keep at most
+ * @return The remaining usage, also written to the ledger
+ */
+SpillCache::Usage SpillCache::evictLocked(size_t targetBytes) {
+    struct Found {
+        std::string file;
+        size_t bytes;
+        int64_t modified;
+    };
+    std::vector<Found> found;
+    Usage usage = {0, 0};
+    if (DIR* dir = opendir(directory.c_str())) {
+        while (struct dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            struct stat st;
+            if (hasSuffix(name) && stat((directory + "/" + name).c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+                found.push_back({name, static_cast<size_t>(st.st_size), static_cast<int64_t>(st.st_mtime)});
+                usage.files++;
+                usage.bytes += static_cast<size_t>(st.st_size);
+            }
+        }
+        closedir(dir);
+    }
+
+    if (usage.bytes > targetBytes) {
+        std::sort(found.begin(), found.end(), [](const Found& a, const Found& b) { return a.modified < b.modified; });
+        for (const auto& victim : found) {
+            if (usage.bytes <= targetBytes) {
+                break;
+            }
+            if (unlink((directory + "/" + victim.file).c_str()) == 0 || errno == ENOENT) {
+                usage.files--;
+                usage.bytes -= victim.bytes;
+            }
+        }
+    }
+    writeUsageLocked(usage);
+    return usage;
+}
+
+SpillCache::Usage SpillCache::usage() const {
+    if (!enabled()) {
+        return {0, 0};
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    FileLock lease(lockPath());
+    Usage usage = {0, 0};
+    readUsageLocked(usage);
+    return usage;
+}
+
+/**
+ * @brief Maps the spill file for a key.
+ *
+ * @param key Cache key
+ * @return The compressed body, or nullptr if there is no valid file for the key
+ */
+std::shared_ptr<const SpilledBody> SpillCache::get(const std::string& key) {
+    if (!enabled()) {
+        return nullptr;
+    }
+    const std::string file = fileNameFor(key);
+    const std::string path = directory + "/" + file;
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        close(fd);
+        return nullptr;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+        close(fd);
+        return nullptr;
+    }
+
+    const Header* header = static_cast<const Header*>(mapped);
+    const char* keyData = static_cast<const char*>(mapped) + sizeof(Header);
+    size_t offset = sizeof(Header) + header->keyLength;
+    bool valid = std::memcmp(header->magic, kMagic, sizeof(kMagic)) == 0 &&
+                 generation.compare(0, sizeof(header->generation) - 1, header->generation) == 0 &&
+                 header->keyLength <= size - sizeof(Header) &&
+                 header->gzipBytes == size - offset &&
+                 key.compare(0, std::string::npos, keyData, header->keyLength) == 0;
+    if (!valid) {
+        munmap(mapped, size);
+        close(fd);
+        return nullptr;
+    }
+
+    // Mark the file as recently used for every process's eviction
+    if (static_cast<int64_t>(st.st_mtime) + kTouchIntervalSeconds < static_cast<int64_t>(time(nullptr))) {
+        futimens(fd, nullptr);
+    }
+    close(fd);
+    madvise(mapped, size, MADV_SEQUENTIAL);
+    return std::shared_ptr<const SpilledBody>(new SpilledBody(static_cast<const char*>(mapped), size, offset));
+}
+
+/**
+ * @brief Compresses a body and publishes it as the key's spill file.
+ *
+ * The file is written to a temp path and renamed into place, so readers
+ * never see a partial file. The ledger is then updated, and if the
+ * directory is over budget the least recently used files are evicted to
+ * 90% of it.
+ *
+ * @param key Cache key
+ * @param body Uncompressed response body
+ * @throws std::runtime_error if the file cannot be written
+ */
+void SpillCache::put(const std::string& key, const std::string& body) {
+    if (!enabled()) {
+        return;
+    }
+    std::string compressed = gzipCompress(body, kCompressionLevel);
+
+    Header header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    std::strncpy(header.generation, generation.c_str(), sizeof(header.generation) - 1);
+    header.keyLength = static_cast<uint32_t>(key.size());
+    header.gzipBytes = compressed.size();
+
+    const std::string file = fileNameFor(key);
+    const std::string path = directory + "/" + file;
+    // Not fsynced: a spill file lost in a crash is only a cache miss
+    const std::string tempPath = writeTempFile(path, "SpillCache", [&](FILE* out) {
+        return std::fwrite(&header, sizeof(header), 1, out) == 1 &&
+               std::fwrite(key.data(), 1, key.size(), out) == key.size() &&
+               std::fwrite(compressed.data(), 1, compressed.size(), out) == compressed.size();
+    }, false);
+
+    // Publish and account under the directory lock, so an eviction scan
+    // never counts a file the ledger is about to add
+    std::lock_guard<std::mutex> lock(mutex);
+    FileLock lease(lockPath());
+    struct stat st;
+    const bool replacing = stat(path.c_str(), &st) == 0;
+    const size_t replacedBytes = replacing ? static_cast<size_t>(st.st_size) : 0;
+    publishTempFile(tempPath, path, "SpillCache");
+
+    Usage usage;
+    if (!readUsageLocked(usage) || usage.bytes < replacedBytes || (replacing && usage.files == 0)) {
+        evictLocked(capacityBytes); // missing or inconsistent ledger
+        return;
+    }
+    usage.files += replacing ? 0 : 1;
+    usage.bytes += sizeof(header) + key.size() + compressed.size() - replacedBytes;
+    if (usage.bytes > capacityBytes) {
+        evictLocked(capacityBytes / 100 * kEvictToPercent);
+    } else {
+        writeUsageLocked(usage);
+    }
+}
+
+size_t SpillCache::size() const {
+    return usage().files;
+}
+
+size_t SpillCache::bytes() const {
+    return usage().bytes;
+}
+
+} // namespace trading
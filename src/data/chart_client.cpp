@@ -0,0 +1,356 @@
+#include "data/chart_client.h"
+#include "data/data_source.h"
+#include "../../httplib.h"
+#include "../../nlohmann_json.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+using json = nlohmann::json;
+
+namespace trading {
+
+namespace {
+    const char* const kDefaultBaseUrl = "https://query1.finance.yahoo.com";
+    constexpr int64_t kDefaultParallelism = 4;
+    constexpr int64_t kDefaultTimeoutMs = 10000;
+    constexpr int kConnectTimeoutSeconds = 5;
+    constexpr int64_t kSecondsPerDay = 24 * 60 * 60;
+
+    // Prefixes classifyResponse relies on: request errors are negatively
+    // cached, unexpected errors count against the circuit breaker
+    const char* const kNoDataPrefix = "No data found";
+    const char* const kUnexpectedPrefix = "An unexpected error occurred: ";
+
+    const char* const kValidIntervals[] = {"1m", "2m", "5m", "15m", "30m", "60m", "90m", "1h", "1d"};
+
+    int64_t envInteger(const char* name, int64_t defaultValue) {
+        const char* value = std::getenv(name);
+        if (!value) {
+            return defaultValue;
+        }
+        try {
+            int64_t parsed = std::stoll(value);
+            if (parsed > 0) {
+                return parsed;
+            }
+        } catch (const std::exception&) {
+        }
+        std::cerr << "Warning: ignoring invalid " << name << " value '" << value << "'" << std::endl;
+        return defaultValue;
+    }
+
+    // The server spells intervals "5min"; the chart API wants "5m"
+    std::string chartInterval(const std::string& interval) {
+        std::string normalized = interval;
+        if (normalized.size() > 3 && normalized.compare(normalized.size() - 3, 3, "min") == 0) {
+            normalized.resize(normalized.size() - 2);
+        }
+        for (const char* valid : kValidIntervals) {
+            if (normalized == valid) {
+                return normalized;
+            }
+        }
+        throw ChartError("Invalid interval. Must be one of: 1m, 2m, 5m, 15m, 30m, 60m, 90m, 1h, 1d", true);
+    }
+
+    std::string encodePathSegment(const std::string& text) {
+        std::string out;
+        for (unsigned char c : text) {
+            bool unreserved = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+                              c == '-' || c == '.' || c == '_' || c == '~';
+            if (unreserved) {
+                out += static_cast<char>(c);
+            } else {
+                char escaped[4];
+                std::snprintf(escaped, sizeof(escaped), "%%%02X", c);
+                out += escaped;
+            }
+        }
+        return out;
+    }
+
+    int64_t weekday(int64_t days) {
+        return (days % 7 + 11) % 7; // 1970-01-01 was a Thursday; 0 is Sunday
+    }
+
+    // UTC offset of US Eastern time: daylight time runs from 2:00 on the
+    // second Sunday of March to 2:00 on the first Sunday of November
+    int64_t easternOffset(int64_t utc) {
+        std::string year = formatBarTime(utc).substr(0, 4);
+        int64_t march = parseBarTime(year + "-03-01") / kSecondsPerDay;
+        int64_t november = parseBarTime(year + "-11-01") / kSecondsPerDay;
+        int64_t dstStart = (march + (7 - weekday(march)) % 7 + 7) * kSecondsPerDay + 7 * 3600;
+        int64_t dstEnd = (november + (7 - weekday(november)) % 7) * kSecondsPerDay + 6 * 3600;
+        return (utc >= dstStart && utc < dstEnd) ? -4 * 3600 : -5 * 3600;
+    }
+
+    bool isNumber(const json& values, size_t i) {
+        return i < values.size() && values[i].is_number();
+    }
+}
+
+/**
+ * @brief Parses a chart API response into one session's bars.
+ *
+ * Bar times are converted from UTC to the exchange's wall clock: US
+ * Eastern rules for New York listings, otherwise the response's fixed
+ * gmtoffset. Only bars on `date` are kept, and bars with a missing price
+ * are skipped. Daily bars are stamped at midnight.
+ *
+ * @param body Response body
+ * @param interval Requested interval
+ * @param date Session date in YYYY-MM-DD format
+ * @return The bars in time order
+ * @throws ChartError if the response reports an error, is malformed or has no bars on the date
+ */
+BarColumns parseChartResponse(const std::string& body, const std::string& interval, const std::string& date) {
+    json parsed = json::parse(body, nullptr, false);
+    if (parsed.is_discarded() || !parsed.is_object() || !parsed.contains("chart")) {
+        throw ChartError(std::string(kUnexpectedPrefix) + "malformed chart response", false);
+    }
+    const json& chart = parsed["chart"];
+    if (chart.contains("error") && chart["error"].is_object()) {
+        const json& error = chart["error"];
+        std::string code = error.value("code", "");
+        std::string description = error.value("description", "");
+        if (code == "Not Found" || code == "Bad Request") {
+            throw ChartError(std::string(kNoDataPrefix) + ": " + description, true);
+        }
+        throw ChartError(kUnexpectedPrefix + code + ": " + description, false);
+    }
+    if (!chart.contains("result") || !chart["result"].is_array() || chart["result"].empty()) {
+        throw ChartError(std::string(kNoDataPrefix) + " for date: " + date, true);
+    }
+
+    const json& result = chart["result"][0];
+    const json& meta = result.contains("meta") ? result["meta"] : json::object();
+    bool eastern = meta.value("exchangeTimezoneName", "") == "America/New_York";
+    int64_t fixedOffset = meta.value("gmtoffset", int64_t(0));
+    bool daily = chartInterval(interval) == "1d";
+    const int64_t dayStart = parseBarTime(date);
+
+    BarColumns bars;
+    if (!result.contains("timestamp") || !result["timestamp"].is_array()) {
+        throw ChartError(std::string(kNoDataPrefix) + " for date: " + date, true);
+    }
+    const json& times = result["timestamp"];
+    const json* quote = nullptr;
+    if (result.contains("indicators") && result["indicators"].contains("quote") &&
+        result["indicators"]["quote"].is_array() && !result["indicators"]["quote"].empty()) {
+        quote = &result["indicators"]["quote"][0];
+    }
+    if (!quote) {
+        throw ChartError(std::string(kUnexpectedPrefix) + "chart response has no quotes", false);
+    }
+    static const json empty = json::array();
+    const json& open = quote->contains("open") ? (*quote)["open"] : empty;
+    const json& high = quote->contains("high") ? (*quote)["high"] : empty;
+    const json& low = quote->contains("low") ? (*quote)["low"] : empty;
+    const json& close = quote->contains("close") ? (*quote)["close"] : empty;
+    const json& volume = quote->contains("volume") ? (*quote)["volume"] : empty;
+
+    bars.reserve(times.size());
+    for (size_t i = 0; i < times.size(); ++i) {
+        if (!times[i].is_number_integer() || !isNumber(open, i) || !isNumber(high, i) ||
+            !isNumber(low, i) || !isNumber(close, i)) {
+            continue;
+        }
+        int64_t utc = times[i].get<int64_t>();
+        int64_t local = utc + (eastern ? easternOffset(utc) : fixedOffset);
+        if (local < dayStart || local >= dayStart + kSecondsPerDay) {
+            continue;
+        }
+        bars.timestamps.push_back(daily ? dayStart : local);
+        bars.open.push_back(open[i].get<double>());
+        bars.high.push_back(high[i].get<double>());
+        bars.low.push_back(low[i].get<double>());
+        bars.close.push_back(close[i].get<double>());
+        bars.volume.push_back(isNumber(volume, i) ? volume[i].get<int64_t>() : 0);
+    }
+    if (bars.size() == 0) {
+        throw ChartError(std::string(kNoDataPrefix) + " for date: " + date + " (ET), interval: " + interval, true);
+    }
+    return bars;
+}
+
+/**
+ * @brief Constructor for the chart client.
+ *
+ * @param baseUrl Endpoint root, e.g. "https://query1.finance.yahoo.com" or
+ *        "http://127.0.0.1:9000/recorded"; https needs an OpenSSL-enabled httplib
+ * @param parallelism Most connections fetchMany() uses at once
+ * @param timeout Per-request read timeout, further capped by the request deadline
+ * @throws std::invalid_argument if the URL's scheme is not supported
+ */
+ChartClient::ChartClient(const std::string& baseUrl, size_t parallelism, std::chrono::milliseconds timeout)
+    : parallelism(std::max<size_t>(1, parallelism))
+    , timeout(timeout)
+{
+    size_t schemeEnd = baseUrl.find("://");
+    size_t pathStart = baseUrl.find('/', schemeEnd == std::string::npos ? 0 : schemeEnd + 3);
+    hostUrl = baseUrl.substr(0, pathStart);
+    pathPrefix = pathStart == std::string::npos ? "" : baseUrl.substr(pathStart);
+    while (!pathPrefix.empty() && pathPrefix.back() == '/') {
+        pathPrefix.pop_back();
+    }
+    release(acquire()); // fails early on an unsupported scheme
+}
+
+ChartClient::~ChartClient() = default;
+
+ChartClient& ChartClient::shared() {
+    static ChartClient client(
+        std::getenv("TRADING_CHART_URL") ? std::getenv("TRADING_CHART_URL") : kDefaultBaseUrl,
+        static_cast<size_t>(envInteger("TRADING_CHART_PARALLEL", kDefaultParallelism)),
+        std::chrono::milliseconds(envInteger("TRADING_CHART_TIMEOUT_MS", kDefaultTimeoutMs)));
+    return client;
+}
+
+/**
+ * @brief Takes an idle keep-alive connection from the pool, or opens a new one.
+ */
+std::unique_ptr<httplib::Client> ChartClient::acquire() {
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        if (!idle.empty()) {
+            std::unique_ptr<httplib::Client> client = std::move(idle.back());
+            idle.pop_back();
+            return client;
+        }
+    }
+    auto client = std::make_unique<httplib::Client>(hostUrl);
+    if (!client->is_valid()) {
+        throw std::invalid_argument("ChartClient: unsupported URL " + hostUrl);
+    }
+    client->set_keep_alive(true);
+    client->set_connection_timeout(kConnectTimeoutSeconds, 0);
+    client->set_default_headers({{"User-Agent", "Mozilla/5.0"}, {"Accept", "application/json"}});
+    return client;
+}
+
+void ChartClient::release(std::unique_ptr<httplib::Client> client) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    if (idle.size() < parallelism) {
+        idle.push_back(std::move(client));
+    }
+}
+
+/**
+ * @brief Fetches and parses one session's bars.
+ *
+ * The session is requested with a window two UTC days wide, which covers
+ * the whole exchange day in any western timezone, and then trimmed to the
+ * date. The read timeout is capped by the token's remaining budget, and the
+ * body download stops as soon as the token is cancelled.
+ *
+ * @param request Symbol, interval and date
+ * @param token Cancellation and deadline of the calling request
+ * @return The bars
+ * @throws ChartError on request errors and upstream failures
+ * @throws OperationCancelled if the token fires
+ */
+BarColumns ChartClient::fetchBars(const ChartRequest& request, const CancellationToken& token) {
+    token.throwIfCancelled();
+    std::string interval = chartInterval(request.interval);
+    int64_t dayStart = 0;
+    try {
+        dayStart = parseBarTime(request.date);
+    } catch (const std::invalid_argument&) {
+        throw ChartError("Invalid date format. Please use YYYY-MM-DD format.", true);
+    }
+    std::string symbol = request.symbol;
+    std::transform(symbol.begin(), symbol.end(), symbol.begin(), [](unsigned char c) { return std::toupper(c); });
+
+    std::string path = pathPrefix + "/v8/finance/chart/" + encodePathSegment(symbol) +
+                       "?period1=" + std::to_string(dayStart) +
+                       "&period2=" + std::to_string(dayStart + 2 * kSecondsPerDay) +
+                       "&interval=" + interval + "&includePrePost=false";
+
+    auto budget = std::min<std::chrono::milliseconds>(timeout, token.remaining());
+    std::unique_ptr<httplib::Client> client = acquire();
+    client->set_read_timeout(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::max(budget, std::chrono::milliseconds(1))));
+    httplib::Result response = client->Get(path, [&token](uint64_t, uint64_t) { return !token.isCancelled(); });
+    token.throwIfCancelled();
+    if (!response) {
+        // The connection may be half-closed; drop it rather than reuse it
+        throw ChartError(kUnexpectedPrefix + httplib::to_string(response.error()), false);
+    }
+    release(std::move(client));
+
+    if (response->status == 404 || response->status == 400 || response->status == 422) {
+        try {
+            return parseChartResponse(response->body, interval, request.date);
+        } catch (const ChartError& e) {
+            throw ChartError(e.what(), true);
+        }
+    }
+    if (response->status != 200) {
+        throw ChartError(kUnexpectedPrefix + std::string("HTTP ") + std::to_string(response->status), false);
+    }
+    return parseChartResponse(response->body, interval, request.date);
+}
+
+/**
+ * @brief Fetches one session in the Python fetcher's output format.
+ *
+ * Errors are reported in the body, using the same wording as the fetcher,
+ * so the data fetcher's caching and failure classification apply unchanged.
+ *
+ * @throws OperationCancelled if the token fires
+ */
+std::string ChartClient::fetch(const ChartRequest& request, const CancellationToken& token) {
+    try {
+        return formatBars(fetchBars(request, token));
+    } catch (const ChartError& e) {
+        return json{{"error", e.what()}}.dump();
+    } catch (const std::invalid_argument& e) {
+        return json{{"error", kUnexpectedPrefix + std::string(e.what())}}.dump();
+    }
+}
+
+/**
+ * @brief Fetches many sessions concurrently.
+ *
+ * Up to `parallelism` threads pull requests from a shared cursor, each
+ * reusing pooled connections, so a multi-day range costs about one round
+ * trip per `parallelism` days instead of one per day.
+ *
+ * @param requests Sessions to fetch
+ * @param token Cancellation and deadline shared by the whole batch
+ * @return One fetcher-format response per request, in request order
+ * @throws OperationCancelled if the token fires
+ */
+std::vector<std::string> ChartClient::fetchMany(const std::vector<ChartRequest>& requests,
+                                                const CancellationToken& token) {
+    std::vector<std::string> results(requests.size());
+    std::atomic<size_t> next{0};
+    auto work = [&]() {
+        for (size_t i = next++; i < requests.size() && !token.isCancelled(); i = next++) {
+            try {
+                results[i] = fetch(requests[i], token);
+            } catch (const OperationCancelled&) {
+                return;
+            }
+        }
+    };
+
+    size_t threads = std::min(parallelism, requests.size());
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < threads; ++t) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    token.throwIfCancelled();
+    return results;
+}
+
+} // namespace trading
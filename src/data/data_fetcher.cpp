@@ -1,43 +1,68 @@
 #include "data/data_fetcher.h"
-#include <cstdio>
-#include <memory>
 #include <stdexcept>
 #include <string>
-#include <array>
-#include <iostream>
-#include <algorithm>
-#include <chrono>
-#include <iomanip>
-#include <sstream>
 
 namespace trading {
 
-namespace {
-    std::string execPythonScript(const std::string& symbol, const std::string& interval, const std::string& date) {
-        std::string cmd = "python yfinance_fetcher.py " + symbol + " " + interval + " " + date;
-        std::array<char, 128> buffer;
-        std::string result;
-        FILE* pipe = popen(cmd.c_str(), "r");
-        
-        if (!pipe) {
-            throw std::runtime_error("popen() failed!");
-        }
-        
-        while (fgets(buffer.data(), buffer.size(), pipe) != nullptr) {
-            result += buffer.data();
-        }
-        
-        pclose(pipe);
-        return result;
+/**
+ * @brief Converts fetcher bars into OHLCV columns.
+ *
+ * @param data Fetcher response containing a "data" array
+ * @return The bars, in the order the fetcher returned them
+ * @throws std::runtime_error if the response has no bars or a bar is malformed
+ */
+BarColumns parseBars(const json& data) {
+    if (!data.contains("data") || !data["data"].is_array()) {
+        throw std::runtime_error("Invalid data format: missing data field");
     }
+    const auto& rows = data["data"];
+    BarColumns bars;
+    bars.resize(rows.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const auto& row = rows[i];
+        bars.timestamps[i] = parseBarTime(row.at("timestamp").get<std::string>());
+        bars.open[i] = row.at("open").get<double>();
+        bars.high[i] = row.at("high").get<double>();
+        bars.low[i] = row.at("low").get<double>();
+        bars.close[i] = row.at("close").get<double>();
+        bars.volume[i] = row.at("volume").get<int64_t>();
+    }
+    return bars;
+}
+
+DataFetcher::DataFetcher(std::shared_ptr<DataSource> source)
+    : source(std::move(source))
+{
 }
 
-DataFetcher::DataFetcher() {}
+const DurationEstimate& DataFetcher::scriptDuration() {
+    return upstreamDuration();
+}
+
+FetchHealth DataFetcher::health() {
+    return upstreamHealth();
+}
+
+/**
+ * @brief Returns the raw fetcher output from the data source.
+ *
+ * @param symbol Ticker symbol
+ * @param interval Bar interval passed to the fetcher
+ * @param date Session date in YYYY-MM-DD format
+ * @return Raw JSON text in the fetcher's format
+ */
+std::string DataFetcher::fetchRaw(const std::string& symbol, const std::string& interval, const std::string& date) {
+    return source->fetch({symbol, interval, date}, cancellationToken);
+}
 
 json DataFetcher::fetchDailyDataFull(const std::string& symbol, const std::string& date) {
     try {
-        std::string result = execPythonScript(symbol, "1d", date);
+        std::string result = fetchRaw(symbol, "1d", date);
         return json::parse(result);
+    } catch (const OperationCancelled&) {
+        throw;
+    } catch (const UpstreamUnavailable&) {
+        throw;
     } catch (const std::exception& e) {
         throw std::runtime_error("Failed to fetch daily data: " + std::string(e.what()));
     }
@@ -45,8 +70,12 @@ json DataFetcher::fetchDailyDataFull(const std::string& symbol, const std::strin
 
 json DataFetcher::fetchIntradayData(const std::string& symbol, const std::string& interval, const std::string& date) {
     try {
-        std::string result = execPythonScript(symbol, interval, date);
+        std::string result = fetchRaw(symbol, interval, date);
         return json::parse(result);
+    } catch (const OperationCancelled&) {
+        throw;
+    } catch (const UpstreamUnavailable&) {
+        throw;
     } catch (const std::exception& e) {
         throw std::runtime_error("Failed to fetch intraday data: " + std::string(e.what()));
     }
@@ -0,0 +1,237 @@
+#include "data/data_source.h"
+#include "data/chart_client.h"
+#include "data/source_layers.h"
+#include "data/sources.h"
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include "../../nlohmann_json.hpp"
+
+using json = nlohmann::json;
+
+namespace trading {
+
+namespace {
+    // Prefix the fetcher gives errors that are not a property of the request
+    const char* const kUpstreamErrorPrefix = "An unexpected error occurred";
+
+    const char* const kFilesPrefix = "files:";
+
+    constexpr size_t kMaxSymbolLength = 32;
+    constexpr size_t kMaxIntervalLength = 8;
+
+    std::vector<std::string> splitChain(const std::string& text) {
+        std::vector<std::string> names;
+        std::stringstream ss(text);
+        std::string name;
+        while (std::getline(ss, name, ',')) {
+            name.erase(0, name.find_first_not_of(" \t"));
+            name.erase(name.find_last_not_of(" \t") + 1);
+            if (!name.empty()) {
+                names.push_back(name);
+            }
+        }
+        return names;
+    }
+}
+
+/**
+ * @brief Decides how the caching and failure handling layers treat a response.
+ *
+ * Unparseable output and errors carrying the fetcher's "unexpected error"
+ * prefix are failures of the source; any other error is about the request.
+ */
+FetchOutcome classifyResponse(const std::string& raw) {
+    json parsed = json::parse(raw, nullptr, false);
+    if (parsed.is_discarded() || !parsed.is_object()) {
+        return FetchOutcome::Failed;
+    }
+    if (parsed.contains("data")) {
+        return FetchOutcome::Data;
+    }
+    auto error = parsed.find("error");
+    if (error == parsed.end() || !error->is_string() ||
+        error->get<std::string>().rfind(kUpstreamErrorPrefix, 0) == 0) {
+        return FetchOutcome::Failed;
+    }
+    return FetchOutcome::Rejected;
+}
+
+/**
+ * @brief Checks a request's fields before any layer or source uses them.
+ *
+ * @return The error to answer the request with, or an empty string
+ */
+std::string requestProblem(const DataRequest& request) {
+    const std::string& symbol = request.symbol;
+    bool symbolOk = !symbol.empty() && symbol.size() <= kMaxSymbolLength &&
+                    (std::isalnum(static_cast<unsigned char>(symbol[0])) || symbol[0] == '^');
+    for (char c : symbol) {
+        symbolOk = symbolOk && (std::isalnum(static_cast<unsigned char>(c)) || c == '.' || c == '^' || c == '=' ||
+                                c == '-');
+    }
+    if (!symbolOk) {
+        return "Invalid symbol: " + symbol;
+    }
+
+    const std::string& interval = request.interval;
+    bool intervalOk = !interval.empty() && interval.size() <= kMaxIntervalLength;
+    for (char c : interval) {
+        intervalOk = intervalOk && std::isalnum(static_cast<unsigned char>(c));
+    }
+    if (!intervalOk) {
+        return "Invalid interval: " + interval;
+    }
+
+    const std::string& date = request.date;
+    bool dateOk = date.size() == 10 && date[4] == '-' && date[7] == '-';
+    for (size_t i = 0; dateOk && i < date.size(); ++i) {
+        dateOk = i == 4 || i == 7 || std::isdigit(static_cast<unsigned char>(date[i]));
+    }
+    try {
+        // Round-tripping rejects days that do not exist, such as 2024-02-30
+        dateOk = dateOk && formatBarTime(parseBarTime(date)).compare(0, 10, date) == 0;
+    } catch (const std::invalid_argument&) {
+        dateOk = false;
+    }
+    if (!dateOk) {
+        return "Invalid date format. Please use YYYY-MM-DD format.";
+    }
+    return "";
+}
+
+/**
+ * @brief Checks whether a session's bars can no longer change.
+ *
+ * Today's session is still being written, so only earlier dates are final.
+ *
+ * @param date Session date in YYYY-MM-DD format
+ * @return true if the date is before today
+ */
+bool isCompleteSession(const std::string& date) {
+    auto now_c = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    std::tm now_tm;
+    localtime_r(&now_c, &now_tm);
+    std::stringstream ss;
+    ss << std::put_time(&now_tm, "%Y-%m-%d");
+    return date < ss.str();
+}
+
+std::string formatBars(const BarColumns& bars) {
+    json rows = json::array();
+    for (size_t i = 0; i < bars.size(); ++i) {
+        rows.push_back({
+            {"timestamp", formatBarTime(bars.timestamps[i])},
+            {"open", bars.open[i]},
+            {"high", bars.high[i]},
+            {"low", bars.low[i]},
+            {"close", bars.close[i]},
+            {"volume", bars.volume[i]}
+        });
+    }
+    return json{{"data", std::move(rows)}}.dump();
+}
+
+/**
+ * @brief Reads the pipeline configuration from the environment.
+ *
+ * An invalid TRADING_DATA_SOURCE is reported and the Python fetcher used
+ * instead. TRADING_SINGLE_FLIGHT=0 turns off request coalescing.
+ */
+DataSourceConfig DataSourceConfig::fromEnvironment(MemoryCache* memoryCache) {
+    DataSourceConfig config;
+    config.memoryCache = memoryCache;
+    if (const char* value = std::getenv("TRADING_DATA_SOURCE")) {
+        std::vector<std::string> chain = splitChain(value);
+        try {
+            for (const auto& name : chain) {
+                makeSource(name);
+            }
+            if (!chain.empty()) {
+                config.chain = std::move(chain);
+            }
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "Warning: ignoring invalid TRADING_DATA_SOURCE value '" << value << "': "
+                      << e.what() << std::endl;
+        }
+    }
+    if (const char* value = std::getenv("TRADING_CACHE_DIR")) {
+        config.diskCacheDir = value;
+    }
+    if (const char* value = std::getenv("TRADING_BAR_STORE_DIR")) {
+        config.barStoreDir = value;
+    }
+    if (const char* value = std::getenv("TRADING_SINGLE_FLIGHT")) {
+        config.singleFlight = std::string(value) != "0";
+    }
+    return config;
+}
+
+/**
+ * @brief Builds one source of a chain.
+ *
+ * @param spec "python", "chart", "files:<dir>" or "synthetic"
+ * @throws std::invalid_argument for an unknown name or an empty directory
+ */
+std::shared_ptr<DataSource> makeSource(const std::string& spec) {
+    if (spec == "python") {
+        return std::make_shared<PythonSource>();
+    }
+    if (spec == "chart") {
+        return std::make_shared<ChartSource>(ChartClient::shared());
+    }
+    if (spec == "synthetic") {
+        return std::make_shared<SyntheticSource>();
+    }
+    if (spec.rfind(kFilesPrefix, 0) == 0) {
+        std::string directory = spec.substr(std::char_traits<char>::length(kFilesPrefix));
+        if (directory.empty()) {
+            throw std::invalid_argument("files: source needs a directory");
+        }
+        return std::make_shared<FileSource>(directory);
+    }
+    throw std::invalid_argument("unknown data source '" + spec + "'");
+}
+
+/**
+ * @brief Assembles the data pipeline.
+ *
+ * The upstream guard always wraps the source chain, so the circuit breaker
+ * and negative cache cover every source, and request validation always
+ * comes first, so no layer sees a malformed request; the other layers are
+ * added when configured. Several chained sources are tried in order behind
+ * one guard.
+ */
+std::shared_ptr<DataSource> buildDataSource(const DataSourceConfig& config) {
+    std::shared_ptr<DataSource> source;
+    if (config.chain.size() == 1) {
+        source = makeSource(config.chain.front());
+    } else {
+        std::vector<std::shared_ptr<DataSource>> sources;
+        for (const auto& name : config.chain) {
+            sources.push_back(makeSource(name));
+        }
+        source = std::make_shared<FallbackSource>(std::move(sources));
+    }
+
+    source = std::make_shared<UpstreamGuardLayer>(std::move(source));
+    if (!config.barStoreDir.empty()) {
+        source = std::make_shared<BarStoreLayer>(std::move(source), BarStore(config.barStoreDir));
+    }
+    if (!config.diskCacheDir.empty()) {
+        source = std::make_shared<DiskCacheLayer>(std::move(source), DiskCache(config.diskCacheDir));
+    }
+    if (config.singleFlight) {
+        source = std::make_shared<SingleFlightLayer>(std::move(source));
+    }
+    if (config.memoryCache) {
+        source = std::make_shared<MemoryCacheLayer>(std::move(source), *config.memoryCache);
+    }
+    return std::make_shared<RequestValidationLayer>(std::move(source));
+}
+
+} // namespace trading
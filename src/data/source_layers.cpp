@@ -0,0 +1,285 @@
+#include "data/source_layers.h"
+#include "data/data_fetcher.h"
+#include "cache/negative_cache.h"
+#include "utils/circuit_breaker.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+namespace trading {
+
+namespace {
+    // How often a waiter checks its own token while another caller fetches
+    constexpr auto kSingleFlightPoll = std::chrono::milliseconds(50);
+
+    constexpr int64_t kDefaultNegativeCacheSeconds = 60;
+    constexpr size_t kNegativeCacheMaxEntries = 10000;
+    constexpr int64_t kDefaultBreakerFailures = 5;
+    constexpr int64_t kDefaultBreakerCooldownSeconds = 30;
+
+    DurationEstimate upstreamDurationEstimate;
+
+    int64_t envInteger(const char* name, int64_t defaultValue) {
+        const char* value = std::getenv(name);
+        if (!value) {
+            return defaultValue;
+        }
+        try {
+            return std::stoll(value);
+        } catch (const std::exception&) {
+            std::cerr << "Warning: ignoring invalid " << name << " value '" << value << "'" << std::endl;
+            return defaultValue;
+        }
+    }
+
+    NegativeCache& negativeCache() {
+        static NegativeCache cache(
+            std::chrono::seconds(std::max<int64_t>(0, envInteger("TRADING_NEGATIVE_CACHE_SECONDS", kDefaultNegativeCacheSeconds))),
+            kNegativeCacheMaxEntries);
+        return cache;
+    }
+
+    CircuitBreaker& upstreamBreaker() {
+        static CircuitBreaker breaker(
+            static_cast<size_t>(std::max<int64_t>(1, envInteger("TRADING_BREAKER_FAILURES", kDefaultBreakerFailures))),
+            std::chrono::seconds(std::max<int64_t>(0, envInteger("TRADING_BREAKER_COOLDOWN_SECONDS", kDefaultBreakerCooldownSeconds))));
+        return breaker;
+    }
+
+    bool cacheable(const std::string& raw, const DataRequest& request) {
+        return isCompleteSession(request.date) && classifyResponse(raw) == FetchOutcome::Data;
+    }
+}
+
+/**
+ * @brief Reports the upstream circuit breaker and negative cache state.
+ */
+FetchHealth upstreamHealth() {
+    const CircuitBreaker& breaker = upstreamBreaker();
+    const char* state = "closed";
+    switch (breaker.state()) {
+        case CircuitBreaker::State::Closed: state = "closed"; break;
+        case CircuitBreaker::State::Open: state = "open"; break;
+        case CircuitBreaker::State::HalfOpen: state = "half_open"; break;
+    }
+    return {state, breaker.consecutiveFailures(), negativeCache().size()};
+}
+
+const DurationEstimate& upstreamDuration() {
+    return upstreamDurationEstimate;
+}
+
+RequestValidationLayer::RequestValidationLayer(std::shared_ptr<DataSource> inner)
+    : inner(std::move(inner))
+{
+}
+
+std::string RequestValidationLayer::fetch(const DataRequest& request, const CancellationToken& token) {
+    std::string problem = requestProblem(request);
+    if (!problem.empty()) {
+        return json{{"error", problem}}.dump();
+    }
+    return inner->fetch(request, token);
+}
+
+MemoryCacheLayer::MemoryCacheLayer(std::shared_ptr<DataSource> inner, MemoryCache& cache)
+    : inner(std::move(inner))
+    , cache(cache)
+{
+}
+
+std::string MemoryCacheLayer::fetch(const DataRequest& request, const CancellationToken& token) {
+    const std::string key = request.key();
+    if (auto hit = cache.get(key)) {
+        return *hit;
+    }
+    std::string raw = inner->fetch(request, token);
+    if (cacheable(raw, request)) {
+        cache.put(key, raw);
+    }
+    return raw;
+}
+
+DiskCacheLayer::DiskCacheLayer(std::shared_ptr<DataSource> inner, DiskCache cache)
+    : inner(std::move(inner))
+    , cache(std::move(cache))
+{
+}
+
+std::string DiskCacheLayer::fetch(const DataRequest& request, const CancellationToken& token) {
+    return cache.getOrFetch(
+        request.key(),
+        [&]() { return inner->fetch(request, token); },
+        [&](const std::string& raw) { return cacheable(raw, request); });
+}
+
+SingleFlightLayer::SingleFlightLayer(std::shared_ptr<DataSource> inner)
+    : inner(std::move(inner))
+{
+}
+
+/**
+ * @brief Fetches a key once for all concurrent callers.
+ *
+ * The leader's response or exception is handed to every waiter. Waiters
+ * poll their own tokens, so each can still be cancelled on its own. If the
+ * leader was cancelled, a waiter that was not retries and may become the
+ * next leader.
+ *
+ * @throws OperationCancelled if the caller's token fires
+ */
+std::string SingleFlightLayer::fetch(const DataRequest& request, const CancellationToken& token) {
+    const std::string key = request.key();
+    while (true) {
+        std::shared_future<std::string> result;
+        std::promise<std::string> promise;
+        bool leader = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = inFlight.find(key);
+            if (it != inFlight.end()) {
+                result = it->second;
+            } else {
+                result = promise.get_future().share();
+                inFlight.emplace(key, result);
+                leader = true;
+            }
+        }
+
+        if (leader) {
+            try {
+                promise.set_value(inner->fetch(request, token));
+            } catch (...) {
+                promise.set_exception(std::current_exception());
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            inFlight.erase(key);
+            return result.get();
+        }
+
+        while (result.wait_for(kSingleFlightPoll) != std::future_status::ready) {
+            token.throwIfCancelled();
+        }
+        try {
+            return result.get();
+        } catch (const OperationCancelled&) {
+            token.throwIfCancelled();
+            // The leader gave up; fetch again for this caller
+        }
+    }
+}
+
+BarStoreLayer::BarStoreLayer(std::shared_ptr<DataSource> inner, BarStore store)
+    : inner(std::move(inner))
+    , store(std::move(store))
+{
+}
+
+std::string BarStoreLayer::fetch(const DataRequest& request, const CancellationToken& token) {
+    std::string raw = inner->fetch(request, token);
+    if (cacheable(raw, request)) {
+        try {
+            store.put(request.symbol, request.interval, request.date, parseBars(json::parse(raw)));
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: not storing bars for " << request.symbol << " " << request.date
+                      << ": " << e.what() << std::endl;
+        }
+    }
+    return raw;
+}
+
+UpstreamGuardLayer::UpstreamGuardLayer(std::shared_ptr<DataSource> inner)
+    : inner(std::move(inner))
+{
+}
+
+/**
+ * @brief Calls the upstream behind the negative cache, deadline check and circuit breaker.
+ *
+ * The request must have enough deadline budget left for a typical upstream
+ * fetch. While the breaker is open the upstream is not called at all.
+ * Every fetch's outcome is reported to the breaker, except fetches that
+ * were cancelled, and request errors are remembered in the negative cache.
+ *
+ * @throws UpstreamUnavailable if the breaker is open
+ * @throws DeadlineExceeded if the remaining budget is too small for a fetch
+ */
+std::string UpstreamGuardLayer::fetch(const DataRequest& request, const CancellationToken& token) {
+    const std::string key = request.key();
+    if (auto failure = negativeCache().get(key)) {
+        return *failure;
+    }
+    token.requireBudget(upstreamDurationEstimate.budget(), "fetch");
+
+    CircuitBreaker& breaker = upstreamBreaker();
+    if (!breaker.allow()) {
+        auto retryAfter = std::chrono::duration_cast<std::chrono::seconds>(breaker.retryAfter()) + std::chrono::seconds(1);
+        throw UpstreamUnavailable("Market data upstream is failing; retry in " +
+                                  std::to_string(retryAfter.count()) + "s", retryAfter);
+    }
+
+    std::string result;
+    auto start = CancellationToken::Clock::now();
+    try {
+        result = inner->fetch(request, token);
+    } catch (const OperationCancelled&) {
+        breaker.recordAbandoned();
+        throw;
+    } catch (...) {
+        breaker.recordFailure();
+        throw;
+    }
+    upstreamDurationEstimate.record(start);
+
+    FetchOutcome outcome = classifyResponse(result);
+    if (outcome == FetchOutcome::Failed) {
+        breaker.recordFailure();
+    } else {
+        breaker.recordSuccess();
+    }
+    if (outcome == FetchOutcome::Rejected) {
+        negativeCache().put(key, result);
+    }
+    return result;
+}
+
+FallbackSource::FallbackSource(std::vector<std::shared_ptr<DataSource>> sources)
+    : sources(std::move(sources))
+{
+    if (this->sources.empty()) {
+        throw std::invalid_argument("FallbackSource: at least one source is required");
+    }
+}
+
+/**
+ * @brief Returns the first source's response that has data.
+ *
+ * A response without data, or an exception other than cancellation, moves
+ * on to the next source.
+ *
+ * @throws OperationCancelled if the token fires
+ */
+std::string FallbackSource::fetch(const DataRequest& request, const CancellationToken& token) {
+    std::string last;
+    std::exception_ptr lastError;
+    for (const auto& source : sources) {
+        try {
+            last = source->fetch(request, token);
+            lastError = nullptr;
+            if (classifyResponse(last) == FetchOutcome::Data) {
+                return last;
+            }
+        } catch (const OperationCancelled&) {
+            throw;
+        } catch (...) {
+            lastError = std::current_exception();
+        }
+    }
+    if (lastError) {
+        std::rethrow_exception(lastError);
+    }
+    return last;
+}
+
+} // namespace trading
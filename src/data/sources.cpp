@@ -0,0 +1,250 @@
+#include "data/sources.h"
+#include "data/chart_client.h"
+#include "store/bar_store.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../../nlohmann_json.hpp"
+
+using json = nlohmann::json;
+
+namespace trading {
+
+namespace {
+    // How often a running fetcher is checked for cancellation
+    constexpr int kFetchPollIntervalMs = 50;
+
+    // Regular session of the synthetic source, in seconds after midnight
+    constexpr int64_t kSessionOpen = 9 * 3600 + 30 * 60;
+    constexpr int64_t kSessionClose = 16 * 3600;
+
+    // Bar length in seconds for the interval spellings the fetchers accept
+    int64_t intervalSeconds(const std::string& interval) {
+        size_t digits = 0;
+        while (digits < interval.size() && std::isdigit(static_cast<unsigned char>(interval[digits]))) {
+            digits++;
+        }
+        if (digits == 0) {
+            return 0;
+        }
+        int64_t count = std::stoll(interval.substr(0, digits));
+        std::string unit = interval.substr(digits);
+        if (unit == "m" || unit == "min") {
+            return count * 60;
+        }
+        if (unit == "h") {
+            return count * 3600;
+        }
+        if (unit == "d") {
+            return count * 86400;
+        }
+        return 0;
+    }
+
+    uint64_t fnv1a(const std::string& s) {
+        uint64_t h = 1469598103934665603ULL;
+        for (unsigned char c : s) {
+            h ^= c;
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+    std::string noData(const DataRequest& request, const std::string& detail) {
+        return json{{"error", "No data found for symbol: " + request.symbol + ", date: " + request.date +
+                              ", interval: " + request.interval + " (" + detail + ")"}}.dump();
+    }
+
+    /**
+     * @brief Runs the fetcher script in its own process group and collects its stdout.
+     *
+     * The script is exec'd directly (no shell), so request parameters are never
+     * interpreted as shell syntax. While waiting for output the cancellation
+     * token is polled; once it fires the whole process group is killed, so no
+     * interpreter keeps running for a request nobody is waiting on.
+     *
+     * @throws DeadlineExceeded if the token's deadline passes before the script finishes
+     * @throws OperationCancelled if the token is cancelled before the script finishes
+     */
+    std::string execPythonScript(const std::string& symbol, const std::string& interval, const std::string& date,
+                                 const CancellationToken& token) {
+        token.throwIfCancelled();
+
+        std::vector<std::string> args = {"python", "yfinance_fetcher.py", symbol, interval, date};
+        std::vector<char*> argv;
+        for (auto& arg : args) {
+            argv.push_back(arg.data());
+        }
+        argv.push_back(nullptr);
+
+        int fds[2];
+        if (pipe2(fds, O_CLOEXEC) != 0) {
+            throw std::runtime_error("pipe() failed!");
+        }
+
+        pid_t pid = fork();
+        if (pid < 0) {
+            close(fds[0]);
+            close(fds[1]);
+            throw std::runtime_error("fork() failed!");
+        }
+        if (pid == 0) {
+            setpgid(0, 0);
+            dup2(fds[1], STDOUT_FILENO);
+            execvp(argv[0], argv.data());
+            _exit(127);
+        }
+        setpgid(pid, pid);
+        close(fds[1]);
+
+        std::string result;
+        std::array<char, 4096> buffer;
+        bool cancelled = false;
+        while (true) {
+            if (token.isCancelled()) {
+                cancelled = true;
+                break;
+            }
+            struct pollfd pfd = {fds[0], POLLIN, 0};
+            int ready = poll(&pfd, 1, kFetchPollIntervalMs);
+            if (ready < 0 && errno != EINTR) {
+                break;
+            }
+            if (ready <= 0) {
+                continue;
+            }
+            ssize_t n = read(fds[0], buffer.data(), buffer.size());
+            if (n > 0) {
+                result.append(buffer.data(), static_cast<size_t>(n));
+            } else if (n == 0 || errno != EINTR) {
+                break;
+            }
+        }
+        close(fds[0]);
+
+        if (cancelled) {
+            kill(-pid, SIGKILL);
+        }
+        while (waitpid(pid, nullptr, 0) < 0 && errno == EINTR) {
+        }
+        if (cancelled) {
+            token.throwIfCancelled();
+        }
+        return result;
+    }
+}
+
+std::string PythonSource::fetch(const DataRequest& request, const CancellationToken& token) {
+    return execPythonScript(request.symbol, request.interval, request.date, token);
+}
+
+ChartSource::ChartSource(ChartClient& client)
+    : client(client)
+{
+}
+
+std::string ChartSource::fetch(const DataRequest& request, const CancellationToken& token) {
+    return client.fetch({request.symbol, request.interval, request.date}, token);
+}
+
+FileSource::FileSource(std::string directory)
+    : directory(std::move(directory))
+{
+}
+
+/**
+ * @brief Reads a recorded response from disk.
+ *
+ * Symbol, interval and date are mapped to file names the way the bar store
+ * maps them, so no request can address a file outside the directory.
+ *
+ * @return The file's contents, or a "no data" error if there is no file for the request
+ */
+std::string FileSource::fetch(const DataRequest& request, const CancellationToken& token) {
+    token.throwIfCancelled();
+    std::string path;
+    try {
+        path = directory + "/" + pathComponent(request.symbol) + "/" + pathComponent(request.interval) + "/" +
+               pathComponent(request.date) + ".json";
+    } catch (const std::invalid_argument& e) {
+        return noData(request, e.what());
+    }
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return noData(request, "no file " + path);
+    }
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+/**
+ * @brief Generates a session of bars.
+ *
+ * Closes follow a geometric random walk seeded from the symbol and date,
+ * so the same request always gets the same bars. Daily requests get a
+ * single bar.
+ *
+ * @return A fetcher "data" response, or a "no data" error for weekends and bad input
+ */
+std::string SyntheticSource::fetch(const DataRequest& request, const CancellationToken& token) {
+    token.throwIfCancelled();
+    int64_t step = intervalSeconds(request.interval);
+    int64_t day = 0;
+    try {
+        day = parseBarTime(request.date);
+    } catch (const std::invalid_argument&) {
+        return noData(request, "invalid date");
+    }
+    if (step <= 0) {
+        return noData(request, "unsupported interval");
+    }
+    int64_t weekday = (day / 86400 % 7 + 11) % 7; // 0 is Sunday
+    if (weekday == 0 || weekday == 6) {
+        return noData(request, "weekend");
+    }
+
+    std::mt19937_64 rng(fnv1a(request.symbol + "|" + request.date));
+    std::normal_distribution<double> shock(0.0, 0.002);
+    std::uniform_int_distribution<int64_t> volume(1000, 50000);
+
+    BarColumns bars;
+    double price = 50.0 + static_cast<double>(rng() % 10000) / 50.0;
+    int64_t end = step >= 86400 ? kSessionOpen + 1 : kSessionClose;
+    for (int64_t t = kSessionOpen; t < end; t += step) {
+        double open = price;
+        price *= std::exp(shock(rng));
+        bars.timestamps.push_back(day + (step >= 86400 ? 0 : t));
+        bars.open.push_back(open);
+        bars.high.push_back(std::max(open, price) * 1.0005);
+        bars.low.push_back(std::min(open, price) * 0.9995);
+        bars.close.push_back(price);
+        bars.volume.push_back(volume(rng));
+    }
+    return formatBars(bars);
+}
+
+MockSource::MockSource(Responder responder)
+    : responder(std::move(responder))
+{
+}
+
+std::string MockSource::fetch(const DataRequest& request, const CancellationToken& token) {
+    token.throwIfCancelled();
+    callCount++;
+    return responder(request);
+}
+
+} // namespace trading
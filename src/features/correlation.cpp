@@ -0,0 +1,410 @@
+#include "features/correlation.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace trading {
+
+namespace {
+    constexpr int64_t kDaySeconds = 86400;
+    constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+    // Series per tile side, and grid points per slice: a complete tile
+    // streams 2 x 32 x 512 doubles (256 KB) per slice, a masked one twice
+    // that, so a slice stays in L2 while every pair of the tile uses it
+    constexpr size_t kTile = 32;
+    constexpr size_t kDepth = 512;
+
+    // Doubles per SIMD vector; rows are padded to a multiple of it
+    constexpr size_t kLanes = 4;
+
+    // Overlap variance below this fraction of the sum of squares is rounding
+    constexpr double kVarianceFloor = 1e-12;
+
+    // Four doubles, loaded from any 8-byte aligned address. Without AVX the
+    // compiler splits each operation into two SSE2 ones.
+    typedef double Vec __attribute__((vector_size(32), aligned(8), may_alias));
+
+    const Vec* vectors(const double* row, size_t t) {
+        return reinterpret_cast<const Vec*>(row + t);
+    }
+
+    double sum(const Vec& v) {
+        return (v[0] + v[1]) + (v[2] + v[3]);
+    }
+
+    // Dot products of two rows of `a` with four rows of `b` over [begin, end).
+    // The eight accumulators are spelled out so they stay in registers.
+    __attribute__((target_clones("arch=x86-64-v3", "default")))
+    void dot2x4(const double* const* a, const double* const* b, size_t begin, size_t end, double out[2][4]) {
+        const Vec* a0 = vectors(a[0], begin);
+        const Vec* a1 = vectors(a[1], begin);
+        const Vec* b0 = vectors(b[0], begin);
+        const Vec* b1 = vectors(b[1], begin);
+        const Vec* b2 = vectors(b[2], begin);
+        const Vec* b3 = vectors(b[3], begin);
+        Vec c00 = {}, c01 = {}, c02 = {}, c03 = {}, c10 = {}, c11 = {}, c12 = {}, c13 = {};
+        for (size_t v = 0; v < (end - begin) / kLanes; ++v) {
+            const Vec x0 = a0[v];
+            const Vec x1 = a1[v];
+            c00 += x0 * b0[v];
+            c10 += x1 * b0[v];
+            c01 += x0 * b1[v];
+            c11 += x1 * b1[v];
+            c02 += x0 * b2[v];
+            c12 += x1 * b2[v];
+            c03 += x0 * b3[v];
+            c13 += x1 * b3[v];
+        }
+        out[0][0] += sum(c00);
+        out[0][1] += sum(c01);
+        out[0][2] += sum(c02);
+        out[0][3] += sum(c03);
+        out[1][0] += sum(c10);
+        out[1][1] += sum(c11);
+        out[1][2] += sum(c12);
+        out[1][3] += sum(c13);
+    }
+
+    // The six sums of the masked correlation of one row against two, over
+    // [begin, end): x.y, x.my, mx.y, xx.my, mx.yy and mx.my, where m is the
+    // presence mask and x, y are zero wherever their mask is
+    __attribute__((target_clones("arch=x86-64-v3", "default")))
+    void masked1x2(const double* x, const double* mx, const double* const* y, const double* const* my,
+                   size_t begin, size_t end, double out[2][6]) {
+        const Vec* xv = vectors(x, begin);
+        const Vec* mxv = vectors(mx, begin);
+        const Vec* y0 = vectors(y[0], begin);
+        const Vec* y1 = vectors(y[1], begin);
+        const Vec* m0 = vectors(my[0], begin);
+        const Vec* m1 = vectors(my[1], begin);
+        Vec xy0 = {}, xm0 = {}, my0 = {}, xxm0 = {}, myy0 = {}, mm0 = {};
+        Vec xy1 = {}, xm1 = {}, my1 = {}, xxm1 = {}, myy1 = {}, mm1 = {};
+        for (size_t v = 0; v < (end - begin) / kLanes; ++v) {
+            const Vec xi = xv[v];
+            const Vec mi = mxv[v];
+            const Vec qi = xi * xi;
+            Vec yj = y0[v];
+            Vec mj = m0[v];
+            xy0 += xi * yj;
+            xm0 += xi * mj;
+            my0 += mi * yj;
+            xxm0 += qi * mj;
+            myy0 += mi * (yj * yj);
+            mm0 += mi * mj;
+            yj = y1[v];
+            mj = m1[v];
+            xy1 += xi * yj;
+            xm1 += xi * mj;
+            my1 += mi * yj;
+            xxm1 += qi * mj;
+            myy1 += mi * (yj * yj);
+            mm1 += mi * mj;
+        }
+        const Vec sums[2][6] = {{xy0, xm0, my0, xxm0, myy0, mm0}, {xy1, xm1, my1, xxm1, myy1, mm1}};
+        for (size_t j = 0; j < 2; ++j) {
+            for (size_t k = 0; k < 6; ++k) {
+                out[j][k] += sum(sums[j][k]);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Aligns bar series on their common grid as standardized log returns.
+ *
+ * Each series is centred and scaled by its own mean and standard deviation,
+ * which leaves correlations unchanged but keeps the kernel's one-pass sums
+ * well conditioned. For a series with every return present the scaled
+ * values then have zero sum and a sum of squares equal to the grid size.
+ *
+ * @param bars One bar series per symbol, each sorted by time
+ * @return The aligned returns
+ */
+ReturnPanel alignReturns(const std::vector<BarColumns>& bars) {
+    // Union of bar times, then the grid points that can end a return
+    std::vector<int64_t> grid;
+    for (const auto& series : bars) {
+        grid.insert(grid.end(), series.timestamps.begin(), series.timestamps.end());
+    }
+    std::sort(grid.begin(), grid.end());
+    grid.erase(std::unique(grid.begin(), grid.end()), grid.end());
+
+    ReturnPanel panel;
+    std::vector<size_t> slot(grid.size(), static_cast<size_t>(-1));
+    for (size_t g = 1; g < grid.size(); ++g) {
+        if (grid[g] / kDaySeconds == grid[g - 1] / kDaySeconds) {
+            slot[g] = panel.times.size();
+            panel.times.push_back(grid[g]);
+        }
+    }
+    const size_t slots = panel.times.size();
+    panel.stride = (slots + kLanes - 1) / kLanes * kLanes;
+    panel.values.assign(bars.size() * panel.stride, 0.0);
+    panel.present.assign(bars.size() * panel.stride, 0.0);
+    panel.counts.assign(bars.size(), 0);
+    panel.constant.assign(bars.size(), false);
+
+    for (size_t s = 0; s < bars.size(); ++s) {
+        const BarColumns& series = bars[s];
+        double* values = panel.values.data() + s * panel.stride;
+        double* present = panel.present.data() + s * panel.stride;
+        auto cursor = grid.begin();
+        for (size_t k = 1; k < series.size(); ++k) {
+            cursor = std::lower_bound(cursor, grid.end(), series.timestamps[k]);
+            const size_t g = cursor - grid.begin();
+            if (slot[g] == static_cast<size_t>(-1) || series.timestamps[k - 1] != grid[g - 1]) {
+                continue;
+            }
+            const double r = std::log(series.close[k] / series.close[k - 1]);
+            if (std::isfinite(r)) {
+                values[slot[g]] = r;
+                present[slot[g]] = 1.0;
+                ++panel.counts[s];
+            }
+        }
+
+        const uint32_t n = panel.counts[s];
+        double mean = 0.0;
+        for (size_t t = 0; t < slots; ++t) {
+            mean += values[t];
+        }
+        mean = n ? mean / n : 0.0;
+        double sumSq = 0.0;
+        for (size_t t = 0; t < slots; ++t) {
+            if (present[t] != 0.0) {
+                sumSq += (values[t] - mean) * (values[t] - mean);
+            }
+        }
+        const double sd = n ? std::sqrt(sumSq / n) : 0.0;
+        if (!(sd > 0.0)) {
+            panel.constant[s] = true;
+            std::fill(values, values + slots, 0.0);
+            continue;
+        }
+        for (size_t t = 0; t < slots; ++t) {
+            values[t] = present[t] != 0.0 ? (values[t] - mean) / sd : 0.0;
+        }
+    }
+    return panel;
+}
+
+/**
+ * @brief Constructor for a correlation kernel over a panel.
+ *
+ * Series with every return present are ordered first, so as many tiles as
+ * possible take the single-product path.
+ *
+ * @param panel Aligned returns; must outlive the kernel
+ * @param minOverlap Fewest common returns a pair needs for a correlation
+ */
+CorrelationKernel::CorrelationKernel(const ReturnPanel& panel, size_t minOverlap)
+    : panel(panel)
+    , minOverlap(std::max<size_t>(minOverlap, 2))
+{
+    const size_t n = panel.series();
+    for (size_t s = 0; s < n; ++s) {
+        if (panel.complete(s)) {
+            order.push_back(s);
+        }
+    }
+    completeCount = order.size();
+    for (size_t s = 0; s < n; ++s) {
+        if (!panel.complete(s)) {
+            order.push_back(s);
+        }
+    }
+
+    const size_t blocks = (n + kTile - 1) / kTile;
+    for (size_t row = 0; row < blocks; ++row) {
+        for (size_t column = row; column < blocks; ++column) {
+            tileList.push_back({row, column});
+        }
+    }
+
+    matrix.size = n;
+    matrix.values.assign(n * n, kNaN);
+    matrix.overlap.assign(n * n, 0);
+    for (size_t s = 0; s < n; ++s) {
+        matrix.overlap[s * n + s] = panel.counts[s];
+        if (!panel.constant[s] && panel.counts[s] >= this->minOverlap) {
+            matrix.values[s * n + s] = 1.0;
+        }
+    }
+}
+
+void CorrelationKernel::run(size_t tile) {
+    const Tile& t = tileList.at(tile);
+    if (std::min((t.columnBlock + 1) * kTile, order.size()) <= completeCount) {
+        runComplete(t);
+    } else {
+        runMasked(t);
+    }
+}
+
+CorrelationMatrix CorrelationKernel::result() const {
+    return matrix;
+}
+
+/**
+ * @brief Computes a tile whose series have every return: r = z_i . z_j / T.
+ */
+void CorrelationKernel::runComplete(const Tile& tile) {
+    const size_t rowBegin = tile.rowBlock * kTile;
+    const size_t columnBegin = tile.columnBlock * kTile;
+    const size_t rows = std::min(kTile, order.size() - rowBegin);
+    const size_t columns = std::min(kTile, order.size() - columnBegin);
+    const double* base = panel.values.data();
+    const size_t stride = panel.stride;
+    // Ragged edges repeat the last row, whose extra results are dropped
+    auto row = [&](size_t begin, size_t count, size_t k) {
+        return base + order[begin + std::min(k, count - 1)] * stride;
+    };
+
+    double dots[kTile][kTile] = {};
+    for (size_t t0 = 0; t0 < stride; t0 += kDepth) {
+        const size_t t1 = std::min(t0 + kDepth, stride);
+        for (size_t i = 0; i < rows; i += 2) {
+            const double* a[2] = {row(rowBegin, rows, i), row(rowBegin, rows, i + 1)};
+            // The diagonal tile only needs its upper triangle
+            const size_t firstColumn = tile.rowBlock == tile.columnBlock ? i / 4 * 4 : 0;
+            for (size_t j = firstColumn; j < columns; j += 4) {
+                const double* b[4] = {row(columnBegin, columns, j), row(columnBegin, columns, j + 1),
+                                      row(columnBegin, columns, j + 2), row(columnBegin, columns, j + 3)};
+                double out[2][4] = {};
+                dot2x4(a, b, t0, t1, out);
+                for (size_t ii = 0; ii < 2 && i + ii < rows; ++ii) {
+                    for (size_t jj = 0; jj < 4 && j + jj < columns; ++jj) {
+                        dots[i + ii][j + jj] += out[ii][jj];
+                    }
+                }
+            }
+        }
+    }
+
+    const double n = static_cast<double>(panel.times.size());
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < columns; ++j) {
+            const size_t si = order[rowBegin + i];
+            const size_t sj = order[columnBegin + j];
+            if (rowBegin + i >= columnBegin + j) {
+                continue;
+            }
+            const bool defined = !panel.constant[si] && !panel.constant[sj] && n >= minOverlap;
+            store(si, sj, defined ? dots[i][j] / n : kNaN, n);
+        }
+    }
+}
+
+/**
+ * @brief Computes a tile with missing returns over each pair's overlap.
+ *
+ * With n common returns and sums Sx, Sy, Sxx, Syy, Sxy over them,
+ * r = (n Sxy - Sx Sy) / sqrt((n Sxx - Sx^2)(n Syy - Sy^2)). Masks select
+ * the overlap, so every sum is a product over the whole grid.
+ */
+void CorrelationKernel::runMasked(const Tile& tile) {
+    const size_t rowBegin = tile.rowBlock * kTile;
+    const size_t columnBegin = tile.columnBlock * kTile;
+    const size_t rows = std::min(kTile, order.size() - rowBegin);
+    const size_t columns = std::min(kTile, order.size() - columnBegin);
+    const size_t stride = panel.stride;
+    auto offset = [&](size_t begin, size_t count, size_t k) {
+        return order[begin + std::min(k, count - 1)] * stride;
+    };
+
+    std::vector<double> sums(kTile * kTile * 6, 0.0);
+    for (size_t t0 = 0; t0 < stride; t0 += kDepth) {
+        const size_t t1 = std::min(t0 + kDepth, stride);
+        for (size_t i = 0; i < rows; ++i) {
+            const size_t oi = offset(rowBegin, rows, i);
+            const size_t firstColumn = tile.rowBlock == tile.columnBlock ? i + 1 : 0;
+            for (size_t j = firstColumn; j < columns; j += 2) {
+                const size_t oj[2] = {offset(columnBegin, columns, j), offset(columnBegin, columns, j + 1)};
+                const double* y[2] = {panel.values.data() + oj[0], panel.values.data() + oj[1]};
+                const double* my[2] = {panel.present.data() + oj[0], panel.present.data() + oj[1]};
+                double out[2][6] = {};
+                masked1x2(panel.values.data() + oi, panel.present.data() + oi, y, my, t0, t1, out);
+                for (size_t jj = 0; jj < 2 && j + jj < columns; ++jj) {
+                    double* cell = sums.data() + (i * kTile + j + jj) * 6;
+                    for (size_t k = 0; k < 6; ++k) {
+                        cell[k] += out[jj][k];
+                    }
+                }
+            }
+        }
+    }
+
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < columns; ++j) {
+            if (rowBegin + i >= columnBegin + j) {
+                continue;
+            }
+            const double* cell = sums.data() + (i * kTile + j) * 6;
+            const double sxy = cell[0], sx = cell[1], sy = cell[2], sxx = cell[3], syy = cell[4], n = cell[5];
+            const double vx = n * sxx - sx * sx;
+            const double vy = n * syy - sy * sy;
+            double r = kNaN;
+            if (n >= minOverlap && vx > n * sxx * kVarianceFloor && vy > n * syy * kVarianceFloor) {
+                r = (n * sxy - sx * sy) / std::sqrt(vx * vy);
+            }
+            store(order[rowBegin + i], order[columnBegin + j], r, n);
+        }
+    }
+}
+
+void CorrelationKernel::store(size_t i, size_t j, double correlation, double overlap) {
+    if (!std::isnan(correlation)) {
+        correlation = std::clamp(correlation, -1.0, 1.0);
+    }
+    const size_t n = matrix.size;
+    matrix.values[i * n + j] = matrix.values[j * n + i] = correlation;
+    matrix.overlap[i * n + j] = matrix.overlap[j * n + i] = static_cast<uint32_t>(overlap);
+}
+
+/**
+ * @brief Selects the strongest pairs of a correlation matrix.
+ *
+ * @param matrix Correlations; undefined pairs are skipped
+ * @param k Pairs to return at most
+ * @param order "abs", "desc" or "asc"
+ * @return Pairs with first < second, strongest first, ties by index
+ * @throws std::invalid_argument if the order is unknown
+ */
+std::vector<CorrelationPair> topPairs(const CorrelationMatrix& matrix, size_t k, const std::string& order) {
+    double (*key)(double);
+    if (order == "abs") {
+        key = [](double r) { return std::abs(r); };
+    } else if (order == "desc") {
+        key = [](double r) { return r; };
+    } else if (order == "asc") {
+        key = [](double r) { return -r; };
+    } else {
+        throw std::invalid_argument("Invalid order: " + order + ". Must be 'abs', 'desc' or 'asc'.");
+    }
+
+    std::vector<CorrelationPair> pairs;
+    for (size_t i = 0; i < matrix.size; ++i) {
+        for (size_t j = i + 1; j < matrix.size; ++j) {
+            const double r = matrix.at(i, j);
+            if (!std::isnan(r)) {
+                pairs.push_back({i, j, r, matrix.overlap[i * matrix.size + j]});
+            }
+        }
+    }
+    auto stronger = [key](const CorrelationPair& a, const CorrelationPair& b) {
+        const double ka = key(a.correlation);
+        const double kb = key(b.correlation);
+        if (ka != kb) {
+            return ka > kb;
+        }
+        return a.first != b.first ? a.first < b.first : a.second < b.second;
+    };
+    k = std::min(k, pairs.size());
+    std::partial_sort(pairs.begin(), pairs.begin() + k, pairs.end(), stronger);
+    pairs.resize(k);
+    return pairs;
+}
+
+} // namespace trading
@@ -0,0 +1,371 @@
+#include "features/feature_export.h"
+#include "features/feature_file.h"
+#include "features/feature_set.h"
+#include "data/data_fetcher.h"
+#include "utils/file_lock.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_set>
+
+namespace trading {
+
+namespace {
+    constexpr int64_t kDaySeconds = 86400;
+
+    const char* kUsage =
+        "Usage: trader export (--symbols AAPL,MSFT | --symbols-file FILE) --from YYYY-MM-DD [--to YYYY-MM-DD]\n"
+        "                     [--interval 5min] [--features LIST] [--out DIR] [--threads N]\n";
+
+    struct SymbolReport {
+        std::string symbol;
+        std::string file;
+        uint64_t sessions = 0;
+        uint64_t rows = 0;
+        uint64_t bytes = 0;
+        std::vector<std::pair<std::string, std::string>> skipped; // date, reason
+        std::string error;
+    };
+
+    // Symbols name files, so only ticker characters are allowed
+    void checkSymbol(const std::string& symbol) {
+        const bool valid = !symbol.empty() && symbol[0] != '.' &&
+            std::all_of(symbol.begin(), symbol.end(), [](char c) {
+                return std::isalnum(static_cast<unsigned char>(c)) || c == '.' || c == '-' || c == '^' || c == '=';
+            });
+        if (!valid) {
+            throw std::invalid_argument("Invalid symbol: " + symbol);
+        }
+    }
+
+    std::vector<std::string> splitList(const std::string& text) {
+        std::vector<std::string> items;
+        std::stringstream ss(text);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            if (!item.empty()) {
+                items.push_back(item);
+            }
+        }
+        return items;
+    }
+
+    // Fetches one session through the data pipeline. Returns false with
+    // `reason` set if there are no bars for it.
+    bool fetchSession(const FeatureExportConfig& config, DataSource& source, const std::string& symbol,
+                      const std::string& date, BarColumns& bars, std::string& reason) {
+        const std::string raw = source.fetch({symbol, config.interval, date}, CancellationToken());
+        if (classifyResponse(raw) != FetchOutcome::Data) {
+            json parsed = json::parse(raw, nullptr, false);
+            reason = parsed.is_object() && parsed.contains("error") && parsed["error"].is_string()
+                ? parsed["error"].get<std::string>() : "no data";
+            return false;
+        }
+        // Keep only the requested session, as parseIntradayData does
+        bars = BarColumns();
+        if (appendSession(bars, parseBars(json::parse(raw)), date) == 0) {
+            reason = "no bars in session";
+            return false;
+        }
+        return true;
+    }
+
+    SymbolReport exportSymbol(const FeatureExportConfig& config, const FeatureSet& features,
+                              const std::vector<std::string>& dates, DataSource& source,
+                              const BarStore& store, const std::string& symbol) {
+        SymbolReport report;
+        report.symbol = symbol;
+
+        // Sessions already in the store are read in one batch, the rest fetched
+        std::unordered_set<std::string> storedDates;
+        BarColumns stored;
+        if (store.enabled()) {
+            for (const auto& info : store.manifest(symbol, config.interval)) {
+                if (info.date >= dates.front() && info.date <= dates.back()) {
+                    storedDates.insert(info.date);
+                }
+            }
+        }
+        if (!storedDates.empty()) {
+            try {
+                stored = store.readRanges({{symbol, config.interval, parseBarTime(dates.front()),
+                                            parseBarTime(dates.back()) + kDaySeconds - 1}})[0];
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: ignoring stored bars for " << symbol << ": " << e.what() << std::endl;
+                storedDates.clear();
+            }
+        }
+
+        FeatureTable table;
+        BarColumns session;
+        for (const auto& date : dates) {
+            if (storedDates.count(date)) {
+                const size_t offset = table.bars.size();
+                const size_t rows = appendSession(table.bars, stored, date);
+                if (rows > 0) {
+                    table.sessions.push_back({date, offset, rows});
+                    continue;
+                }
+            }
+            std::string reason;
+            bool loaded = false;
+            try {
+                loaded = fetchSession(config, source, symbol, date, session, reason);
+            } catch (const std::exception& e) {
+                reason = e.what();
+            }
+            if (!loaded) {
+                report.skipped.emplace_back(date, reason);
+                continue;
+            }
+            table.sessions.push_back({date, table.bars.size(), session.size()});
+            table.bars.append(session, 0, session.size());
+        }
+        if (table.sessions.empty()) {
+            report.error = "no sessions";
+            return report;
+        }
+
+        const size_t rows = table.rows();
+        table.names = features.columns();
+        table.values.assign(table.names.size(), std::vector<double>(rows));
+        std::vector<double*> out(table.names.size());
+        for (const auto& s : table.sessions) {
+            for (size_t c = 0; c < out.size(); ++c) {
+                out[c] = table.values[c].data() + s.firstRow;
+            }
+            features.compute(table.bars, s.firstRow, s.rowCount, out.data());
+        }
+
+        report.file = symbol + ".feat";
+        report.bytes = FeatureFile::write(config.outputDir + "/" + report.file, table);
+        report.sessions = table.sessions.size();
+        report.rows = rows;
+        return report;
+    }
+
+    void writeManifest(const FeatureExportConfig& config, const FeatureSet& features,
+                       const std::vector<SymbolReport>& reports) {
+        json columns = json::array();
+        for (const char* name : {"timestamp", "open", "high", "low", "close", "volume"}) {
+            const bool integer = std::strcmp(name, "timestamp") == 0 || std::strcmp(name, "volume") == 0;
+            columns.push_back({{"name", name}, {"type", integer ? "int64" : "float64"}});
+        }
+        for (const auto& name : features.columns()) {
+            columns.push_back({{"name", name}, {"type", "float64"}});
+        }
+        json specs = json::array();
+        for (const auto& spec : features.specs()) {
+            specs.push_back(spec.text());
+        }
+        json symbols = json::array();
+        json failed = json::array();
+        for (const auto& report : reports) {
+            json skipped = json::array();
+            for (const auto& [date, reason] : report.skipped) {
+                skipped.push_back({{"date", date}, {"reason", reason}});
+            }
+            if (!report.error.empty()) {
+                failed.push_back({{"symbol", report.symbol}, {"error", report.error}, {"skipped", skipped}});
+                continue;
+            }
+            symbols.push_back({
+                {"symbol", report.symbol},
+                {"file", report.file},
+                {"sessions", report.sessions},
+                {"rows", report.rows},
+                {"bytes", report.bytes},
+                {"skipped", skipped}
+            });
+        }
+        json manifest = {
+            {"format", "DGFEAT01"},
+            {"interval", config.interval},
+            {"from", config.from},
+            {"to", config.to},
+            {"features", specs},
+            {"columns", columns},
+            {"symbols", symbols},
+            {"failed", failed}
+        };
+
+        const std::string text = manifest.dump(2) + "\n";
+        publishFile(config.outputDir + "/MANIFEST.json", "FeatureExport", [&](FILE* file) {
+            return std::fwrite(text.data(), 1, text.size(), file) == text.size();
+        });
+    }
+}
+
+/**
+ * @brief Parses the arguments of `trader export`.
+ *
+ * @param args Arguments after "export", as "--name value" pairs
+ * Symbols listed more than once are kept once, at their first position.
+ *
+ * @return The export configuration
+ * @throws std::invalid_argument on unknown options, missing values or an invalid configuration
+ */
+FeatureExportConfig FeatureExportConfig::fromArguments(const std::vector<std::string>& args) {
+    FeatureExportConfig config;
+    for (size_t i = 0; i < args.size(); i += 2) {
+        const std::string& name = args[i];
+        if (i + 1 >= args.size()) {
+            throw std::invalid_argument("Missing value for " + name);
+        }
+        const std::string& value = args[i + 1];
+        if (name == "--symbols") {
+            for (auto& symbol : splitList(value)) {
+                config.symbols.push_back(symbol);
+            }
+        } else if (name == "--symbols-file") {
+            std::ifstream file(value);
+            if (!file) {
+                throw std::invalid_argument("Cannot read symbols file: " + value);
+            }
+            std::string line;
+            while (std::getline(file, line)) {
+                line.erase(std::remove_if(line.begin(), line.end(), [](unsigned char c) { return std::isspace(c); }),
+                           line.end());
+                if (!line.empty() && line[0] != '#') {
+                    config.symbols.push_back(line);
+                }
+            }
+        } else if (name == "--from") {
+            config.from = value;
+        } else if (name == "--to") {
+            config.to = value;
+        } else if (name == "--interval") {
+            config.interval = value;
+        } else if (name == "--features") {
+            config.features = value;
+        } else if (name == "--out") {
+            config.outputDir = value;
+        } else if (name == "--threads") {
+            config.threads = static_cast<size_t>(std::stoul(value));
+        } else {
+            throw std::invalid_argument("Unknown option: " + name);
+        }
+    }
+    if (config.symbols.empty()) {
+        throw std::invalid_argument("No symbols given");
+    }
+    // Each symbol names one output file, so a repeated symbol is exported once
+    std::unordered_set<std::string> seen;
+    std::vector<std::string> unique;
+    for (const auto& symbol : config.symbols) {
+        checkSymbol(symbol);
+        if (seen.insert(symbol).second) {
+            unique.push_back(symbol);
+        }
+    }
+    config.symbols = std::move(unique);
+    if (config.from.empty()) {
+        throw std::invalid_argument("--from is required");
+    }
+    if (config.to.empty()) {
+        config.to = config.from;
+    }
+    return config;
+}
+
+/**
+ * @brief Runs a feature export.
+ *
+ * A symbol whose sessions all fail, or whose file cannot be written, is
+ * listed under "failed" in the manifest; the other symbols still export.
+ *
+ * @param config Universe, session range, features and output directory
+ * @param source Data pipeline for sessions the store does not have
+ * @param store Bar store read first; may be disabled
+ * @return Counts over the written files
+ * @throws std::invalid_argument if the range or feature list is invalid
+ * @throws std::runtime_error if the output directory or manifest cannot be written
+ */
+FeatureExportSummary exportFeatures(const FeatureExportConfig& config,
+                                    const std::shared_ptr<DataSource>& source,
+                                    const BarStore& store) {
+    const FeatureSet features = FeatureSet::parse(config.features);
+    const std::vector<std::string> dates = weekdaySessions(config.from, config.to);
+    makeDirectory(config.outputDir, "FeatureExport");
+
+    std::vector<SymbolReport> reports(config.symbols.size());
+    std::atomic<size_t> next{0};
+    std::mutex progressMutex;
+    size_t done = 0;
+    auto work = [&]() {
+        for (size_t i = next++; i < config.symbols.size(); i = next++) {
+            try {
+                reports[i] = exportSymbol(config, features, dates, *source, store, config.symbols[i]);
+            } catch (const std::exception& e) {
+                reports[i].symbol = config.symbols[i];
+                reports[i].error = e.what();
+            }
+            std::lock_guard<std::mutex> lock(progressMutex);
+            done++;
+            std::cout << "[" << done << "/" << config.symbols.size() << "] " << config.symbols[i] << ": "
+                      << (reports[i].error.empty() ? std::to_string(reports[i].rows) + " rows" : reports[i].error)
+                      << std::endl;
+        }
+    };
+
+    const size_t hardware = std::max<size_t>(1, std::thread::hardware_concurrency());
+    const size_t threads = std::min(config.threads > 0 ? config.threads : hardware, config.symbols.size());
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < threads; ++t) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    writeManifest(config, features, reports);
+    FeatureExportSummary summary;
+    for (const auto& report : reports) {
+        if (!report.error.empty()) {
+            summary.failedSymbols++;
+            continue;
+        }
+        summary.files++;
+        summary.sessions += report.sessions;
+        summary.rows += report.rows;
+        summary.bytes += report.bytes;
+    }
+    return summary;
+}
+
+int runFeatureExport(const std::vector<std::string>& args) {
+    FeatureExportConfig config;
+    try {
+        config = FeatureExportConfig::fromArguments(args);
+        FeatureSet::parse(config.features);
+        weekdaySessions(config.from, config.to);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n" << kUsage;
+        return 2;
+    }
+
+    auto source = buildDataSource(DataSourceConfig::fromEnvironment(nullptr));
+    const BarStore store = BarStore::fromEnvironment();
+    const auto start = std::chrono::steady_clock::now();
+    const FeatureExportSummary summary = exportFeatures(config, source, store);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Exported " << summary.files << " symbols, " << summary.sessions << " sessions, "
+              << summary.rows << " rows, " << summary.bytes / (1024.0 * 1024.0) << " MB in " << seconds << " s";
+    if (summary.failedSymbols > 0) {
+        std::cout << "; " << summary.failedSymbols << " symbols failed (see MANIFEST.json)";
+    }
+    std::cout << std::endl;
+    return summary.failedSymbols > 0 ? 1 : 0;
+}
+
+} // namespace trading
@@ -0,0 +1,214 @@
+#include "features/feature_file.h"
+#include "utils/file_lock.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace trading {
+
+namespace {
+    constexpr char kMagic[8] = {'D', 'G', 'F', 'E', 'A', 'T', '0', '1'};
+    constexpr uint64_t kAlignment = 64;
+    constexpr size_t kBarColumns = 6;
+
+    // Distinguishes temp files of concurrent writes within one process
+
+    struct FileHeader {
+        char magic[8];
+        uint32_t columnCount;
+        uint32_t sessionCount;
+        uint64_t rowCount;
+        uint64_t reserved;
+    };
+
+    struct ColumnEntry {
+        char name[64]; // NUL terminated
+        uint32_t type;
+        uint32_t reserved;
+        uint64_t offset;
+        uint64_t bytes;
+    };
+
+    struct SessionEntry {
+        char date[16]; // NUL terminated
+        uint64_t firstRow;
+        uint64_t rowCount;
+    };
+
+    struct ColumnData {
+        const char* name;
+        FeatureFile::ColumnType type;
+        const void* data;
+    };
+
+    template <typename T>
+    void append(std::string& out, const T& value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void copyName(char* dest, size_t size, const std::string& name) {
+        if (name.size() >= size) {
+            throw std::invalid_argument("FeatureFile: name too long: " + name);
+        }
+        std::memcpy(dest, name.c_str(), name.size() + 1);
+    }
+
+    [[noreturn]] void corrupt(const std::string& path, const char* what) {
+        throw std::runtime_error("FeatureFile: " + path + " is corrupt (" + what + ")");
+    }
+}
+
+/**
+ * @brief Writes a feature table and publishes it atomically.
+ *
+ * The header and directories go out in one write, then each column in one
+ * write straight from the table's vectors, so the file costs a single
+ * sequential pass over the data.
+ *
+ * @param path Destination path
+ * @param table Table to write; every value column must have one value per bar
+ * @return Bytes written
+ * @throws std::invalid_argument if the table is inconsistent
+ * @throws std::runtime_error if the file cannot be written
+ */
+uint64_t FeatureFile::write(const std::string& path, const FeatureTable& table) {
+    const uint64_t rows = table.rows();
+    const BarColumns& bars = table.bars;
+    if (table.names.size() != table.values.size()) {
+        throw std::invalid_argument("FeatureFile: column names and values differ in count");
+    }
+    std::vector<ColumnData> columns = {
+        {"timestamp", Int64, bars.timestamps.data()},
+        {"open", Float64, bars.open.data()},
+        {"high", Float64, bars.high.data()},
+        {"low", Float64, bars.low.data()},
+        {"close", Float64, bars.close.data()},
+        {"volume", Int64, bars.volume.data()},
+    };
+    for (size_t c = 0; c < table.names.size(); ++c) {
+        if (table.values[c].size() != rows) {
+            throw std::invalid_argument("FeatureFile: column " + table.names[c] + " has the wrong length");
+        }
+        columns.push_back({table.names[c].c_str(), Float64, table.values[c].data()});
+    }
+
+    FileHeader header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.columnCount = static_cast<uint32_t>(columns.size());
+    header.sessionCount = static_cast<uint32_t>(table.sessions.size());
+    header.rowCount = rows;
+
+    std::string head;
+    append(head, header);
+    uint64_t offset = sizeof(FileHeader) + columns.size() * sizeof(ColumnEntry) +
+                      table.sessions.size() * sizeof(SessionEntry);
+    for (const auto& column : columns) {
+        offset = (offset + kAlignment - 1) & ~(kAlignment - 1);
+        ColumnEntry entry = {};
+        copyName(entry.name, sizeof(entry.name), column.name);
+        entry.type = column.type;
+        entry.offset = offset;
+        entry.bytes = rows * 8;
+        append(head, entry);
+        offset += entry.bytes;
+    }
+    for (const auto& session : table.sessions) {
+        if (session.firstRow + session.rowCount > rows) {
+            throw std::invalid_argument("FeatureFile: session " + session.date + " is out of range");
+        }
+        SessionEntry entry = {};
+        copyName(entry.date, sizeof(entry.date), session.date);
+        entry.firstRow = session.firstRow;
+        entry.rowCount = session.rowCount;
+        append(head, entry);
+    }
+
+    uint64_t written = 0;
+    publishFile(path, "FeatureFile", [&](FILE* file) {
+        static const char padding[kAlignment] = {};
+        bool ok = std::fwrite(head.data(), 1, head.size(), file) == head.size();
+        written = head.size();
+        for (const auto& column : columns) {
+            const uint64_t pad = (kAlignment - written % kAlignment) % kAlignment;
+            ok = ok && std::fwrite(padding, 1, pad, file) == pad;
+            ok = ok && std::fwrite(column.data, 8, rows, file) == rows;
+            written += pad + rows * 8;
+        }
+        return ok;
+    });
+    return written;
+}
+
+/**
+ * @brief Reads a whole feature file.
+ *
+ * @param path Feature file path
+ * @return The table, with the bar columns in `bars` and the rest as values
+ * @throws std::runtime_error if the file cannot be read or is malformed
+ */
+FeatureTable FeatureFile::read(const std::string& path) {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        throw std::runtime_error("FeatureFile: cannot open " + path + ": " + std::strerror(errno));
+    }
+    std::string bytes;
+    char buffer[1 << 16];
+    size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        bytes.append(buffer, n);
+    }
+    std::fclose(file);
+
+    FileHeader header;
+    if (bytes.size() < sizeof(header)) {
+        corrupt(path, "header");
+    }
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.columnCount < kBarColumns) {
+        corrupt(path, "header");
+    }
+    const uint64_t directoryBytes = header.columnCount * sizeof(ColumnEntry) + header.sessionCount * sizeof(SessionEntry);
+    if (bytes.size() - sizeof(header) < directoryBytes) {
+        corrupt(path, "directory");
+    }
+
+    FeatureTable table;
+    const uint64_t rows = header.rowCount;
+    table.bars.resize(rows);
+    const char* cursor = bytes.data() + sizeof(header);
+    for (uint32_t c = 0; c < header.columnCount; ++c, cursor += sizeof(ColumnEntry)) {
+        ColumnEntry entry;
+        std::memcpy(&entry, cursor, sizeof(entry));
+        entry.name[sizeof(entry.name) - 1] = '\0';
+        if (entry.bytes != rows * 8 || entry.offset > bytes.size() || bytes.size() - entry.offset < entry.bytes) {
+            corrupt(path, "column extent");
+        }
+        void* dest;
+        if (c < kBarColumns) {
+            void* barColumns[kBarColumns] = {table.bars.timestamps.data(), table.bars.open.data(), table.bars.high.data(),
+                                             table.bars.low.data(), table.bars.close.data(), table.bars.volume.data()};
+            dest = barColumns[c];
+        } else {
+            table.names.push_back(entry.name);
+            table.values.emplace_back(rows);
+            dest = table.values.back().data();
+        }
+        if (rows > 0) {
+            std::memcpy(dest, bytes.data() + entry.offset, entry.bytes);
+        }
+    }
+    for (uint32_t s = 0; s < header.sessionCount; ++s, cursor += sizeof(SessionEntry)) {
+        SessionEntry entry;
+        std::memcpy(&entry, cursor, sizeof(entry));
+        entry.date[sizeof(entry.date) - 1] = '\0';
+        if (entry.firstRow > rows || rows - entry.firstRow < entry.rowCount) {
+            corrupt(path, "session extent");
+        }
+        table.sessions.push_back({entry.date, entry.firstRow, entry.rowCount});
+    }
+    return table;
+}
+
+} // namespace trading
@@ -0,0 +1,267 @@
+#include "features/feature_set.h"
+#include "utils/indicators.h"
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace trading {
+
+namespace {
+    struct Indicator {
+        const char* name;
+        std::vector<double> defaults;
+        std::vector<const char*> columns; // column name prefixes
+    };
+
+    const std::vector<Indicator>& catalog() {
+        static const std::vector<Indicator> indicators = {
+            {"ema", {12}, {"ema"}},
+            {"macd", {12, 26, 9}, {"macd", "macd_signal", "macd_hist"}},
+            {"trend", {0.3}, {"trend"}},
+            {"garch", {0.02, 1e-6, 0.1, 0.85}, {"garch_sigma"}},
+            {"zscore", {20}, {"zscore"}},
+            {"robust_zscore", {20}, {"robust_zscore"}},
+            {"rsi", {14}, {"rsi"}},
+            {"bollinger", {20, 2}, {"bb_lower", "bb_middle", "bb_upper"}},
+            {"atr", {14}, {"atr"}},
+            {"vwap", {}, {"vwap"}},
+            {"rolling_min", {20}, {"rolling_min"}},
+            {"rolling_max", {20}, {"rolling_max"}},
+            {"log_return", {}, {"log_return"}},
+        };
+        return indicators;
+    }
+
+    const Indicator& indicatorFor(const std::string& name) {
+        for (const auto& indicator : catalog()) {
+            if (name == indicator.name) {
+                return indicator;
+            }
+        }
+        throw std::invalid_argument("Unknown feature: " + name);
+    }
+
+    std::string formatArg(double value) {
+        std::ostringstream out;
+        out.precision(12);
+        out << value;
+        return out.str();
+    }
+
+    int period(const FeatureSpec& spec, size_t arg) {
+        const double value = spec.args[arg];
+        if (value < 1 || value != std::floor(value) || value > 1e6) {
+            throw std::invalid_argument("Feature " + spec.text() + ": periods must be positive integers");
+        }
+        return static_cast<int>(value);
+    }
+
+    constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+}
+
+/**
+ * @brief Parses one feature spec.
+ *
+ * @param text "name" or "name:arg:arg...", with at most as many arguments as the indicator takes
+ * @return The spec, with missing arguments set to their defaults
+ * @throws std::invalid_argument if the name is unknown or an argument is not a number
+ */
+FeatureSpec FeatureSpec::parse(const std::string& text) {
+    std::vector<std::string> parts;
+    std::stringstream ss(text);
+    std::string part;
+    while (std::getline(ss, part, ':')) {
+        parts.push_back(part);
+    }
+    if (parts.empty() || parts[0].empty()) {
+        throw std::invalid_argument("Empty feature spec");
+    }
+    const Indicator& indicator = indicatorFor(parts[0]);
+    if (parts.size() - 1 > indicator.defaults.size()) {
+        throw std::invalid_argument("Too many arguments for feature: " + text);
+    }
+    FeatureSpec spec{parts[0], indicator.defaults};
+    for (size_t i = 1; i < parts.size(); ++i) {
+        size_t used = 0;
+        try {
+            spec.args[i - 1] = std::stod(parts[i], &used);
+        } catch (const std::exception&) {
+            used = 0;
+        }
+        if (used == 0 || used != parts[i].size() || !std::isfinite(spec.args[i - 1])) {
+            throw std::invalid_argument("Invalid argument '" + parts[i] + "' for feature: " + text);
+        }
+    }
+    return spec;
+}
+
+std::string FeatureSpec::text() const {
+    std::string out = name;
+    for (double arg : args) {
+        out += ":" + formatArg(arg);
+    }
+    return out;
+}
+
+/**
+ * @brief Constructor for a feature set.
+ *
+ * @param specs Indicators to compute, in output order
+ * @throws std::invalid_argument if an indicator's arguments are out of range or two specs produce the same column
+ */
+FeatureSet::FeatureSet(std::vector<FeatureSpec> specs)
+    : specs_(std::move(specs))
+{
+    for (const auto& spec : specs_) {
+        const Indicator& indicator = indicatorFor(spec.name);
+        if (spec.args.size() != indicator.defaults.size()) {
+            throw std::invalid_argument("Wrong number of arguments for feature: " + spec.text());
+        }
+        Feature feature{spec, columns_.size(), std::nullopt};
+        if (spec.name == "macd") {
+            if (period(spec, 0) >= period(spec, 1)) {
+                throw std::invalid_argument("Feature " + spec.text() + ": the fast period must be shorter than the slow one");
+            }
+            period(spec, 2);
+        } else if (spec.name == "trend") {
+            TrendEstimator<double>(0.0, spec.args[0]);
+        } else if (spec.name == "garch") {
+            feature.garch.emplace(spec.args[0], spec.args[1], spec.args[2], spec.args[3]);
+        } else if (spec.name == "bollinger") {
+            period(spec, 0);
+            if (spec.args[1] <= 0) {
+                throw std::invalid_argument("Feature " + spec.text() + ": the band width must be positive");
+            }
+        } else {
+            for (size_t a = 0; a < spec.args.size(); ++a) {
+                period(spec, a);
+            }
+        }
+
+        std::string suffix;
+        for (double arg : spec.args) {
+            suffix += "_" + formatArg(arg);
+        }
+        for (const char* prefix : indicator.columns) {
+            const std::string column = prefix + suffix;
+            for (const auto& existing : columns_) {
+                if (existing == column) {
+                    throw std::invalid_argument("Duplicate feature column: " + column);
+                }
+            }
+            columns_.push_back(column);
+        }
+        features.push_back(std::move(feature));
+    }
+}
+
+FeatureSet FeatureSet::parse(const std::string& list) {
+    std::vector<FeatureSpec> specs;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            specs.push_back(FeatureSpec::parse(item));
+        }
+    }
+    if (specs.empty()) {
+        throw std::invalid_argument("No features given");
+    }
+    return FeatureSet(std::move(specs));
+}
+
+/**
+ * @brief Computes every feature over one session.
+ *
+ * Each indicator makes one pass over the session's bars and writes its
+ * columns sequentially, so a session stays in cache while all of its
+ * columns are produced.
+ *
+ * @param bars Bars holding the session
+ * @param begin First bar of the session
+ * @param rows Bars in the session
+ * @param out One pointer per column, each to room for `rows` values
+ */
+void FeatureSet::compute(const BarColumns& bars, size_t begin, size_t rows, double* const* out) const {
+    if (rows == 0) {
+        return;
+    }
+    const double* close = bars.close.data() + begin;
+    const double* high = bars.high.data() + begin;
+    const double* low = bars.low.data() + begin;
+    const int64_t* volume = bars.volume.data() + begin;
+
+    for (const auto& feature : features) {
+        const FeatureSpec& spec = feature.spec;
+        double* const* columns = out + feature.column;
+        if (spec.name == "ema") {
+            TrendEstimator<double> ema(close[0], 2.0 / (period(spec, 0) + 1.0));
+            for (size_t i = 0; i < rows; ++i) {
+                ema.update(close[i]);
+                columns[0][i] = ema.getTrend();
+            }
+        } else if (spec.name == "macd") {
+            TrendEstimator<double> fast(close[0], 2.0 / (period(spec, 0) + 1.0));
+            TrendEstimator<double> slow(close[0], 2.0 / (period(spec, 1) + 1.0));
+            TrendEstimator<double> signal(0.0, 2.0 / (period(spec, 2) + 1.0));
+            for (size_t i = 0; i < rows; ++i) {
+                fast.update(close[i]);
+                slow.update(close[i]);
+                const double macd = fast.getTrend() - slow.getTrend();
+                signal.update(macd);
+                columns[0][i] = macd;
+                columns[1][i] = signal.getTrend();
+                columns[2][i] = macd - signal.getTrend();
+            }
+        } else if (spec.name == "trend") {
+            TrendEstimator<double> trend(close[0], spec.args[0]);
+            for (size_t i = 0; i < rows; ++i) {
+                trend.update(close[i]);
+                columns[0][i] = trend.getTrend();
+            }
+        } else if (spec.name == "garch") {
+            GARCHEstimator<double> garch = *feature.garch;
+            columns[0][0] = garch.getSigma();
+            for (size_t i = 1; i < rows; ++i) {
+                garch.update(std::log(close[i] / close[i - 1]));
+                columns[0][i] = garch.getSigma();
+            }
+        } else if (spec.name == "zscore") {
+            RollingStats<double> stats(period(spec, 0));
+            for (size_t i = 0; i < rows; ++i) {
+                stats.update(close[i]);
+                columns[0][i] = stats.ready() ? stats.zScore(close[i]) : kNaN;
+            }
+        } else if (spec.name == "robust_zscore") {
+            RollingQuantile<double> window(period(spec, 0));
+            for (size_t i = 0; i < rows; ++i) {
+                window.update(close[i]);
+                columns[0][i] = window.ready() ? window.robustZScore(close[i]) : kNaN;
+            }
+        } else if (spec.name == "rsi") {
+            calculateRSI(close, rows, period(spec, 0), columns[0]);
+        } else if (spec.name == "bollinger") {
+            calculateBollinger(close, rows, period(spec, 0), spec.args[1], columns[0], columns[1], columns[2]);
+        } else if (spec.name == "atr") {
+            calculateATR(high, low, close, rows, period(spec, 0), columns[0]);
+        } else if (spec.name == "vwap") {
+            SessionVWAP<double> vwap;
+            for (size_t i = 0; i < rows; ++i) {
+                vwap.update((high[i] + low[i] + close[i]) / 3.0, static_cast<double>(volume[i]));
+                columns[0][i] = vwap.ready() ? vwap.value() : kNaN;
+            }
+        } else if (spec.name == "rolling_min") {
+            calculateRollingMin(low, rows, period(spec, 0), columns[0]);
+        } else if (spec.name == "rolling_max") {
+            calculateRollingMax(high, rows, period(spec, 0), columns[0]);
+        } else if (spec.name == "log_return") {
+            columns[0][0] = kNaN;
+            for (size_t i = 1; i < rows; ++i) {
+                columns[0][i] = std::log(close[i] / close[i - 1]);
+            }
+        }
+    }
+}
+
+} // namespace trading
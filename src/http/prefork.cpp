@@ -0,0 +1,175 @@
+#include "http/prefork.h"
+#include "http/server.h"
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace trading {
+
+namespace {
+    volatile std::sig_atomic_t shutdownRequested = 0;
+
+    void onShutdownSignal(int) {
+        shutdownRequested = 1;
+    }
+
+    // Workers that die sooner than this after starting are considered to be
+    // crash looping and are restarted with a delay.
+    constexpr auto kMinWorkerLifetime = std::chrono::seconds(5);
+    constexpr auto kRestartBackoff = std::chrono::seconds(1);
+
+    pid_t spawnWorker(int slot) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            std::cerr << "Error: fork() failed for worker " << slot << ": " << std::strerror(errno) << std::endl;
+            return -1;
+        }
+        if (pid > 0) {
+            return pid;
+        }
+
+        // Worker process: default signal handling, and exit if the supervisor dies
+        std::signal(SIGTERM, SIG_DFL);
+        std::signal(SIGINT, SIG_DFL);
+        prctl(PR_SET_PDEATHSIG, SIGTERM);
+        if (getppid() == 1) {
+            _exit(0);
+        }
+
+        int code = 0;
+        try {
+            blockShutdownSignals();
+            TradingServer server(slot);
+            server.run();
+        } catch (const std::exception& e) {
+            std::cerr << "Fatal error in worker " << slot << ": " << e.what() << std::endl;
+            code = 1;
+        }
+        std::cout.flush();
+        _exit(code);
+    }
+}
+
+/**
+ * @brief Reads the pre-fork worker count from TRADING_WORKERS.
+ *
+ * @return The requested number of workers, or 0 if unset or invalid
+ */
+int workerCountFromEnvironment() {
+    const char* value = std::getenv("TRADING_WORKERS");
+    if (!value) {
+        return 0;
+    }
+    try {
+        return std::max(0, std::stoi(value));
+    } catch (const std::exception&) {
+        std::cerr << "Warning: ignoring invalid TRADING_WORKERS value '" << value << "'" << std::endl;
+        return 0;
+    }
+}
+
+/**
+ * @brief Runs the pre-fork supervisor.
+ *
+ * Forks `workers` processes, each running its own TradingServer with its own
+ * heap and thread pool. Every worker binds the same port with SO_REUSEPORT
+ * so the kernel balances incoming connections between them, and a crash in
+ * one worker only drops that worker's in-flight requests. Workers share
+ * fetched data through the on-disk cache (TRADING_CACHE_DIR).
+ *
+ * Crashed workers are restarted; workers that crash right after starting
+ * are restarted after a short backoff. SIGTERM or SIGINT stops the
+ * supervisor, which forwards SIGTERM to all workers and waits for them.
+ *
+ * @param workers Number of worker processes to keep running
+ * @return Process exit code
+ */
+int runPreforked(int workers) {
+    struct sigaction sa = {};
+    sa.sa_handler = onShutdownSignal;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGTERM, &sa, nullptr);
+    sigaction(SIGINT, &sa, nullptr);
+
+    std::cout << "Starting " << workers << " pre-forked trading server workers...\n";
+    std::cout.flush();
+
+    struct WorkerSlot {
+        int slot;
+        std::chrono::steady_clock::time_point startedAt;
+    };
+    std::unordered_map<pid_t, WorkerSlot> running;
+
+    for (int slot = 0; slot < workers; ++slot) {
+        pid_t pid = spawnWorker(slot);
+        if (pid > 0) {
+            running[pid] = {slot, std::chrono::steady_clock::now()};
+        }
+    }
+
+    while (!shutdownRequested) {
+        int status = 0;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == ECHILD && running.empty()) {
+                std::cerr << "Error: no worker processes could be started" << std::endl;
+                return 1;
+            }
+            continue;
+        }
+
+        auto it = running.find(pid);
+        if (it == running.end()) {
+            continue;
+        }
+        WorkerSlot worker = it->second;
+        running.erase(it);
+        if (shutdownRequested) {
+            break;
+        }
+
+        if (WIFSIGNALED(status)) {
+            std::cerr << "Warning: worker " << worker.slot << " (pid " << pid << ") killed by signal "
+                      << WTERMSIG(status) << ", restarting" << std::endl;
+        } else {
+            std::cerr << "Warning: worker " << worker.slot << " (pid " << pid << ") exited with status "
+                      << WEXITSTATUS(status) << ", restarting" << std::endl;
+        }
+        if (std::chrono::steady_clock::now() - worker.startedAt < kMinWorkerLifetime) {
+            std::this_thread::sleep_for(kRestartBackoff);
+        }
+
+        pid_t replacement = spawnWorker(worker.slot);
+        if (replacement > 0) {
+            running[replacement] = {worker.slot, std::chrono::steady_clock::now()};
+        }
+    }
+
+    std::cout << "Shutting down " << running.size() << " workers...\n";
+    for (const auto& [pid, worker] : running) {
+        kill(pid, SIGTERM);
+    }
+    while (!running.empty()) {
+        pid_t pid = waitpid(-1, nullptr, 0);
+        if (pid < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        running.erase(pid);
+    }
+    return 0;
+}
+
+} // namespace trading
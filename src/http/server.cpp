@@ -1,20 +1,402 @@
 #include "http/server.h"
 #include "data/data_fetcher.h"
+#include "features/correlation.h"
 #include "strategies/strategy.h"
 #include "strategies/macd_strategy.h"
 #include "strategies/random_strategy.h"
+#include "strategies/batch_strategy.h"
+#include "utils/gzip.h"
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include <iostream> 
 #include <cstdlib>
+#include <cstdio>
+#include <sstream>
+#include <thread>
+#include <csignal>
+#include <atomic>
+#include <future>
+#include <pthread.h>
+#include <dirent.h>
 
 namespace trading {
 
-TradingServer::TradingServer() {
+namespace {
+    constexpr size_t kDefaultMemoryCacheMB = 128;
+    constexpr int64_t kDefaultSnapshotMaxAgeHours = 24 * 7;
+
+    // Generation tag for data snapshots; bump when the fetcher output changes
+    const char* const kDataSnapshotGeneration = "bars-v1";
+
+    int64_t envInteger(const char* name, int64_t defaultValue) {
+        const char* value = std::getenv(name);
+        if (!value) {
+            return defaultValue;
+        }
+        try {
+            return std::stoll(value);
+        } catch (const std::exception&) {
+            std::cerr << "Warning: ignoring invalid " << name << " value '" << value << "'" << std::endl;
+            return defaultValue;
+        }
+    }
+
+    // Snapshot file of one cache: "data.snapshot" for a single process,
+    // "data.<slot>.snapshot" for pre-fork worker `slot`
+    std::string snapshotName(const std::string& cache, int workerSlot) {
+        return workerSlot < 0 ? cache + ".snapshot" : cache + "." + std::to_string(workerSlot) + ".snapshot";
+    }
+
+    // Maps this process's snapshot of a cache, then every other process's
+    // snapshot of it in the directory, so any worker can serve an entry
+    // whichever worker cached it last run
+    std::vector<std::shared_ptr<const CacheSnapshot>> openSnapshots(const std::string& dir, const std::string& cache,
+                                                                    int workerSlot, const std::string& generation) {
+        const std::string own = snapshotName(cache, workerSlot);
+        std::vector<std::string> others;
+        if (DIR* listing = opendir(dir.c_str())) {
+            const std::string prefix = cache + ".";
+            const std::string suffix = ".snapshot";
+            while (struct dirent* entry = readdir(listing)) {
+                std::string name = entry->d_name;
+                if (name != own && name.size() >= prefix.size() + suffix.size() &&
+                    name.compare(0, prefix.size(), prefix) == 0 &&
+                    name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+                    others.push_back(name);
+                }
+            }
+            closedir(listing);
+        }
+        std::sort(others.begin(), others.end());
+
+        std::vector<std::shared_ptr<const CacheSnapshot>> snapshots;
+        snapshots.push_back(CacheSnapshot::open(dir + "/" + own, generation));
+        for (const auto& name : others) {
+            snapshots.push_back(CacheSnapshot::open(dir + "/" + name, generation));
+        }
+        return snapshots;
+    }
+
+    size_t entryCount(const std::vector<std::shared_ptr<const CacheSnapshot>>& snapshots) {
+        size_t count = 0;
+        for (const auto& snapshot : snapshots) {
+            count += snapshot ? snapshot->entryCount() : 0;
+        }
+        return count;
+    }
+
+    constexpr int64_t kDefaultDeadlineMs = 30000;
+
+    // Rows serialized between deadline checks
+    constexpr size_t kSerializeCheckRows = 1024;
+
+    // Query parameters that control request handling rather than its result
+    bool isControlParam(const std::string& name) {
+        return name == "request_id" || name == "deadline_ms";
+    }
+
+    // Query parameters that select a /chart view rather than the result it views
+    bool isChartViewParam(const std::string& name) {
+        return name == "from" || name == "to" || name == "width" || name == "series";
+    }
+
+    // Percent-encodes everything but unreserved characters, so a decoded
+    // parameter containing '=' or '&' cannot pass for several parameters
+    std::string encodeKeyPart(const std::string& text) {
+        std::string out;
+        for (unsigned char c : text) {
+            bool unreserved = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+                              c == '-' || c == '.' || c == '_' || c == '~';
+            if (unreserved) {
+                out += static_cast<char>(c);
+            } else {
+                char escaped[4];
+                std::snprintf(escaped, sizeof(escaped), "%%%02X", c);
+                out += escaped;
+            }
+        }
+        return out;
+    }
+
+    void appendKeyParam(std::string& key, const std::string& name, const std::string& value) {
+        key += encodeKeyPart(name) + "=" + encodeKeyPart(value) + "&";
+    }
+
+    // Canonical cache key for a request: path plus its sorted query parameters
+    std::string requestCacheKey(const httplib::Request& req) {
+        std::string key = req.path + "?";
+        for (const auto& [name, value] : req.params) {
+            if (!isControlParam(name)) {
+                appendKeyParam(key, name, value);
+            }
+        }
+        return key;
+    }
+
+    // Key of the /simulate result a /chart request views
+    std::string chartResultKey(const httplib::Request& req) {
+        std::string key = "/simulate?";
+        for (const auto& [name, value] : req.params) {
+            if (!isControlParam(name) && !isChartViewParam(name)) {
+                appendKeyParam(key, name, value);
+            }
+        }
+        return key;
+    }
+
+    // Status for requests abandoned by the client (nginx convention)
+    constexpr int kClientClosedRequest = 499;
+
+    constexpr int kGatewayTimeout = 504;
+
+    constexpr int64_t kSecondsPerDay = 24 * 60 * 60;
+
+    // Largest slice of a mapped file handed to the socket at once
+    constexpr size_t kBodyChunkBytes = 1 << 20;
+
+    template <typename F>
+    struct ScopeExit {
+        F onExit;
+        ~ScopeExit() { onExit(); }
+    };
+
+    template <typename F>
+    ScopeExit<F> makeScopeExit(F onExit) {
+        return {std::move(onExit)};
+    }
+
+    // Configurations one background unit simulates before yielding
+    constexpr size_t kSweepChunkSize = 512;
+
+    // Runs a batch split into resumable chunks, as background work unless
+    // told otherwise. Up to the class's concurrency limit of lanes pull
+    // chunks from a shared cursor, and background lanes yield to
+    // interactive work between chunks.
+    template <typename Batch>
+    std::vector<BatchResult> runSweep(Scheduler& scheduler, const Batch& batch,
+                                      const MarketData& data, double initialCash,
+                                      const CancellationToken& token,
+                                      Priority priority = Priority::Background) {
+        std::vector<BatchResult> results(batch.size());
+        std::atomic<size_t> next{0};
+        size_t chunks = (batch.size() + kSweepChunkSize - 1) / kSweepChunkSize;
+        size_t lanes = std::min(scheduler.limit(priority), chunks);
+
+        std::vector<std::future<void>> pending;
+        for (size_t lane = 0; lane < lanes; ++lane) {
+            pending.push_back(scheduler.submitResumable(priority, [&]() {
+                token.throwIfCancelled();
+                size_t begin = next.fetch_add(kSweepChunkSize);
+                if (begin >= batch.size()) {
+                    return false;
+                }
+                size_t end = std::min(begin + kSweepChunkSize, batch.size());
+                batch.run(data, initialCash, begin, end, results.data() + begin);
+                return end < batch.size();
+            }));
+        }
+        // Every lane references locals, so wait for all before rethrowing
+        for (auto& future : pending) {
+            future.wait();
+        }
+        for (auto& future : pending) {
+            future.get();
+        }
+        return results;
+    }
+
+    json classStatsJson(const SchedulerClassStats& stats) {
+        return {
+            {"queued", stats.queued},
+            {"running", stats.running},
+            {"limit", stats.limit},
+            {"completed", stats.completed},
+            {"units", stats.units},
+            {"avg_queue_ms", stats.units ? stats.totalQueueMs / stats.units : 0.0},
+            {"max_queue_ms", stats.maxQueueMs},
+            {"avg_run_ms", stats.units ? stats.totalRunMs / stats.units : 0.0},
+            {"max_run_ms", stats.maxRunMs}
+        };
+    }
+
+    constexpr size_t kDefaultChartCacheMB = 64;
+    constexpr size_t kDefaultChartWidth = 800;
+    constexpr size_t kMaxChartWidth = 10000;
+
+    // Indicators of a /simulate response summarized for charts, after "price"
+    const char* const kChartIndicators[] = {
+        "portfolio_value", "cash", "position", "macd", "signal", "trend", "volatility"
+    };
+
+    // Builds the chart pyramid of a /simulate response's historical_data
+    std::shared_ptr<const SeriesPyramid> buildChartPyramid(const json& historicalData) {
+        std::vector<int64_t> timestamps;
+        std::vector<std::pair<std::string, std::vector<double>>> series;
+        series.emplace_back("price", std::vector<double>());
+        for (const char* name : kChartIndicators) {
+            series.emplace_back(name, std::vector<double>());
+        }
+        timestamps.reserve(historicalData.size());
+        for (auto& [name, values] : series) {
+            values.reserve(historicalData.size());
+        }
+        for (const auto& row : historicalData) {
+            timestamps.push_back(parseBarTime(row.at("timestamp").get<std::string>()));
+            series[0].second.push_back(row.at("price").get<double>());
+            const auto& indicators = row.at("indicators");
+            for (size_t i = 1; i < series.size(); ++i) {
+                series[i].second.push_back(indicators.at(series[i].first).get<double>());
+            }
+        }
+        return std::make_shared<const SeriesPyramid>(std::move(timestamps), std::move(series));
+    }
+
+    // Upper bound on the configurations a single /sweep request may expand to
+    constexpr size_t kMaxSweepConfigs = 100000;
+
+    constexpr size_t kDefaultBaselineRuns = 2000;
+    constexpr size_t kMaxBaselineRuns = 100000;
+    constexpr uint64_t kDefaultBaselineSeed = 42;
+
+    // Baseline PnL quantiles reported by /baseline, as fractions
+    const double kBaselineQuantiles[] = {0.01, 0.05, 0.25, 0.5, 0.75, 0.95, 0.99};
+
+    // A strategy's registered default for a numeric parameter
+    double registeredDefault(const StrategyInfo& info, const std::string& name, double fallback) {
+        for (const auto& param : info.parameters) {
+            if (param.name == name) {
+                return std::stod(param.defaultValue);
+            }
+        }
+        return fallback;
+    }
+
+    // Parses a comma separated list of numbers, e.g. "8,12,16"
+    std::vector<double> parseNumberList(const std::string& value) {
+        std::vector<double> values;
+        std::stringstream ss(value);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            if (!item.empty()) {
+                values.push_back(std::stod(item));
+            }
+        }
+        if (values.empty()) {
+            throw std::invalid_argument("empty parameter list");
+        }
+        return values;
+    }
+
+    std::vector<double> sweepValues(const httplib::Request& req, const std::string& name, double defaultValue) {
+        if (!req.has_param(name)) {
+            return {defaultValue};
+        }
+        return parseNumberList(req.get_param_value(name));
+    }
+
+    // Expands the per-parameter value lists into their cartesian product
+    std::vector<std::vector<double>> cartesianProduct(const std::vector<std::vector<double>>& axes) {
+        size_t total = 1;
+        for (const auto& axis : axes) {
+            total *= axis.size();
+            if (total > kMaxSweepConfigs) {
+                throw std::length_error("Sweep expands to more than " + std::to_string(kMaxSweepConfigs) + " configurations");
+            }
+        }
+
+        std::vector<std::vector<double>> combos;
+        combos.reserve(total);
+        std::vector<size_t> idx(axes.size(), 0);
+        for (size_t n = 0; n < total; ++n) {
+            std::vector<double> combo(axes.size());
+            for (size_t a = 0; a < axes.size(); ++a) {
+                combo[a] = axes[a][idx[a]];
+            }
+            combos.push_back(std::move(combo));
+            for (size_t a = axes.size(); a-- > 0;) {
+                if (++idx[a] < axes[a].size()) {
+                    break;
+                }
+                idx[a] = 0;
+            }
+        }
+        return combos;
+    }
+
+    constexpr size_t kMaxCorrelationSymbols = 1000;
+    constexpr size_t kMaxCorrelationSessions = 31;
+    constexpr size_t kDefaultMinOverlap = 30;
+
+    // Sessions /correlation fetches at once when the bar store lacks them
+    constexpr size_t kCorrelationFetchThreads = 8;
+
+    // The bars of one session in a fetcher response, none for an error response
+    BarColumns sessionBars(const json& response, const std::string& date) {
+        BarColumns session;
+        if (response.contains("data")) {
+            appendSession(session, parseBars(response), date);
+        }
+        return session;
+    }
+
+    // Runs every tile of a correlation kernel as background work. As in
+    // runSweep, lanes pull tiles from a shared cursor and yield to
+    // interactive work between tiles.
+    void runCorrelation(Scheduler& scheduler, CorrelationKernel& kernel, const CancellationToken& token) {
+        std::atomic<size_t> next{0};
+        size_t lanes = std::min(scheduler.limit(Priority::Background), kernel.tiles());
+
+        std::vector<std::future<void>> pending;
+        for (size_t lane = 0; lane < lanes; ++lane) {
+            pending.push_back(scheduler.submitResumable(Priority::Background, [&]() {
+                token.throwIfCancelled();
+                size_t tile = next++;
+                if (tile >= kernel.tiles()) {
+                    return false;
+                }
+                kernel.run(tile);
+                return tile + 1 < kernel.tiles();
+            }));
+        }
+        for (auto& future : pending) {
+            future.wait();
+        }
+        for (auto& future : pending) {
+            future.get();
+        }
+    }
+}
+
+TradingServer::TradingServer(int workerSlot)
+    : workerSlot(workerSlot)
+    , dataCache(static_cast<size_t>(envInteger("TRADING_MEMORY_CACHE_MB", kDefaultMemoryCacheMB)) << 20)
+    , resultCache(static_cast<size_t>(envInteger("TRADING_MEMORY_CACHE_MB", kDefaultMemoryCacheMB)) << 20)
+    , spillCache(SpillCache::fromEnvironment(binaryGeneration()))
+    , chartCache(static_cast<size_t>(envInteger("TRADING_CHART_CACHE_MB", kDefaultChartCacheMB)) << 20)
+    , scheduler(Scheduler::fromEnvironment())
+    , barStore(BarStore::fromEnvironment())
+    , dataSource(buildDataSource(DataSourceConfig::fromEnvironment(&dataCache)))
+    , defaultDeadlineMs(envInteger("TRADING_REQUEST_TIMEOUT_MS", kDefaultDeadlineMs))
+{
     const char* envToken = std::getenv("TRADING_API_TOKEN");
     if (envToken) {
         authToken_ = envToken;
     }
 
+    // SO_REUSEPORT lets pre-forked workers bind the same port; the kernel
+    // then load balances new connections between them. A single process
+    // leaves it off, so a second server on the same port fails to bind
+    // instead of quietly taking half the connections.
+    const bool sharePort = workerSlot >= 0;
+    server.set_socket_options([sharePort](socket_t sock) {
+        int opt = 1;
+        setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+        if (sharePort) {
+            setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt));
+        }
+    });
+
     server.set_pre_routing_handler([this](const httplib::Request& req, httplib::Response& res) {
 
         if (req.method == "OPTIONS") {
@@ -52,11 +434,145 @@ TradingServer::TradingServer() {
     server.Get("/strategies", [this](const httplib::Request& req, httplib::Response& res) {
         return handleStrategies(req, res);
     });
+
+    server.Get("/sweep", [this](const httplib::Request& req, httplib::Response& res) {
+        return handleSweep(req, res);
+    });
+
+    server.Get("/baseline", [this](const httplib::Request& req, httplib::Response& res) {
+        return handleBaseline(req, res);
+    });
+
+    server.Get("/metrics", [this](const httplib::Request& req, httplib::Response& res) {
+        return handleMetrics(req, res);
+    });
+
+    server.Get("/cancel", [this](const httplib::Request& req, httplib::Response& res) {
+        return handleCancel(req, res);
+    });
+
+    server.Get("/bars", [this](const httplib::Request& req, httplib::Response& res) {
+        return handleBars(req, res);
+    });
+
+    server.Get("/chart", [this](const httplib::Request& req, httplib::Response& res) {
+        return handleChart(req, res);
+    });
+
+    server.Get("/correlation", [this](const httplib::Request& req, httplib::Response& res) {
+        return handleCorrelation(req, res);
+    });
+
+    const char* envSnapshotDir = std::getenv("TRADING_SNAPSHOT_DIR");
+    if (envSnapshotDir) {
+        snapshotDir = envSnapshotDir;
+        loadSnapshots();
+    }
 }
 
+/**
+ * @brief Maps the cache snapshots written by the previous run.
+ *
+ * Only the snapshot headers are read here, so startup time does not depend
+ * on snapshot size. Pre-fork workers each write their own files, and every
+ * process maps all of them, its own first. Entries are validated and
+ * promoted on first access; anything older than
+ * TRADING_SNAPSHOT_MAX_AGE_HOURS is treated as stale. Result snapshots are
+ * tied to the binary that produced them.
+ */
+void TradingServer::loadSnapshots() {
+    const int64_t maxAgeSeconds = envInteger("TRADING_SNAPSHOT_MAX_AGE_HOURS", kDefaultSnapshotMaxAgeHours) * 3600;
+    auto validator = [maxAgeSeconds](const std::string& /* key */, int64_t createdAt) {
+        auto now = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        return now - createdAt <= maxAgeSeconds;
+    };
+
+    auto dataSnapshots = openSnapshots(snapshotDir, "data", workerSlot, kDataSnapshotGeneration);
+    auto resultSnapshots = openSnapshots(snapshotDir, "results", workerSlot, binaryGeneration());
+    std::cout << "Mapped cache snapshots: " << entryCount(dataSnapshots) << " data entries, "
+              << entryCount(resultSnapshots) << " result entries" << std::endl;
+    dataCache.attachSnapshots(std::move(dataSnapshots), validator);
+    resultCache.attachSnapshots(std::move(resultSnapshots), validator);
+}
+
+/**
+ * @brief Writes the in-memory caches to TRADING_SNAPSHOT_DIR on graceful shutdown.
+ *
+ * Each pre-fork worker writes files named after its slot, so workers never
+ * replace each other's snapshots.
+ */
+void TradingServer::saveSnapshots() {
+    if (snapshotDir.empty()) {
+        return;
+    }
+    try {
+        dataCache.saveSnapshot(snapshotDir + "/" + snapshotName("data", workerSlot), kDataSnapshotGeneration);
+        resultCache.saveSnapshot(snapshotDir + "/" + snapshotName("results", workerSlot), binaryGeneration());
+        std::cout << "Saved cache snapshots to " << snapshotDir << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Warning: failed to save cache snapshots: " << e.what() << std::endl;
+    }
+}
+
+void blockShutdownSignals() {
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+}
+
+/**
+ * @brief Serves requests until SIGINT or SIGTERM, then shuts down gracefully.
+ *
+ * The signals are blocked before the server's threads start (see
+ * blockShutdownSignals) and are handled by a dedicated thread that stops
+ * the server, so in-flight requests finish and the caches are snapshotted
+ * before the process exits.
+ *
+ * Before listening, the thread pins itself to TRADING_HTTP_CPUS, or to the
+ * CPUs left over by the compute workers, so httplib's threads (which
+ * inherit the mask) stay off the compute cores.
+ */
 void TradingServer::run() {
-    std::cout << "Starting trading server on port 18080...\n";
-    server.listen("0.0.0.0", 18080);
+    blockShutdownSignals();
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+
+    std::thread signalWatcher([this, signals]() {
+        int sig = 0;
+        sigwait(&signals, &sig);
+        std::cout << "Received signal " << sig << ", shutting down..." << std::endl;
+        server.stop();
+    });
+
+    CpuList httpCpus = cpuListFromEnvironment("TRADING_HTTP_CPUS");
+    if (httpCpus.empty() && !scheduler->cpus().empty()) {
+        const CpuList& computeCpus = scheduler->cpus();
+        for (int cpu : availableCpus()) {
+            if (!std::binary_search(computeCpus.begin(), computeCpus.end(), cpu)) {
+                httpCpus.push_back(cpu);
+            }
+        }
+    }
+    if (!httpCpus.empty()) {
+        if (pinCurrentThread(httpCpus)) {
+            std::cout << "HTTP threads pinned to CPUs " << formatCpuList(httpCpus) << std::endl;
+        } else {
+            std::cerr << "Warning: cannot pin HTTP threads to CPUs " << formatCpuList(httpCpus) << std::endl;
+        }
+    }
+
+    std::cout << "Starting trading server on port 18080 (pid " << getpid() << ")..." << std::endl;
+    if (!server.listen("0.0.0.0", 18080)) {
+        signalWatcher.detach();
+        throw std::runtime_error("Failed to listen on port 18080");
+    }
+    signalWatcher.join();
+    saveSnapshots();
 }
 
 std::string TradingServer::handleStrategies(const httplib::Request& /* req */, httplib::Response& res) {
@@ -101,6 +617,12 @@ std::string TradingServer::handleStrategies(const httplib::Request& /* req */, h
 }
 
 std::string TradingServer::handleSimulate(const httplib::Request& req, httplib::Response& res) {
+    std::string requestId;
+    CancellationToken token;
+    if (!beginRequest(req, res, requestId, token)) {
+        return "";
+    }
+    auto requestScope = makeScopeExit([this, &requestId]() { endRequest(requestId); });
     try {
         std::cout << "\nDEBUG: Received /simulate request with parameters:\n"; // Debug print start
         for (const auto& param : req.params) { // REMOVED THE PARENTHESES HERE: req.params (not req.params())
@@ -132,7 +654,26 @@ std::string TradingServer::handleSimulate(const httplib::Request& req, httplib::
             return "";
         }
 
-        DataFetcher fetcher;
+        try {
+            applyDeadline(req, token);
+        } catch (const std::invalid_argument& e) {
+            res.status = 400;
+            res.set_content(e.what(), "text/plain");
+            return "";
+        }
+
+        const std::string cacheKey = requestCacheKey(req);
+        if (auto cached = resultCache.get(cacheKey)) {
+            res.set_content(*cached, "application/json");
+            return "";
+        }
+        if (auto spilled = spillCache->get(cacheKey)) {
+            sendSpilled(req, res, std::move(spilled));
+            return "";
+        }
+
+        DataFetcher fetcher(dataSource);
+        fetcher.setCancellationToken(token);
         json intradayData = fetcher.fetchIntradayData(symbol, interval, dateStr);
         auto marketData = fetcher.parseIntradayData(intradayData, interval, dateStr);
 
@@ -152,9 +693,412 @@ std::string TradingServer::handleSimulate(const httplib::Request& req, httplib::
             return "";
         }
         
-        auto strategy = it->second.factory();
-        auto result = strategy->execute(marketData, initialCash); // Pass initialCash
+        // Simulation and serialization run as interactive compute work
+        const bool cacheResult = isCompleteSession(dateStr);
+        std::string body;
+        std::shared_ptr<const SeriesPyramid> chartPyramid;
+        scheduler->submit(Priority::Interactive, [&]() {
+            token.requireBudget(simulateStage.budget(), "simulation");
+            auto simulateStart = std::chrono::steady_clock::now();
+            auto strategy = it->second.factory();
+            strategy->setCancellationToken(token);
+            auto result = strategy->execute(marketData, initialCash); // Pass initialCash
+            simulateStage.record(simulateStart);
+
+            token.requireBudget(serializeStage.budget(), "serialization");
+            auto serializeStart = std::chrono::steady_clock::now();
+
+
+            json response;
+            response["symbol"] = symbol;
+            response["strategy"] = strategyName;
+            response["interval"] = interval;
+            response["date"] = dateStr;
+            response["initial_capital"] = initialCash;
+            response["final_portfolio_value"] = result.finalPortfolioValue;
+            response["profit_loss"] = result.profitLoss;
+            response["num_trades"] = result.trades.size();
+
+
+            response["historical_data"] = json::array();
+
+            for (size_t i = 0; i < marketData.timestamps.size(); i++) {
+                if (i % kSerializeCheckRows == 0) {
+                    token.throwIfCancelled();
+                }
+                json timestepData;
+                timestepData["timestamp"] = marketData.timestamps[i];
+                timestepData["price"] = marketData.prices[i];
+
+                timestepData["indicators"] = {
+                    {"macd", result.historical[i].macd},
+                    {"signal", result.historical[i].signal},
+                    {"portfolio_value", result.historical[i].portfolioValue},
+                    {"position", result.historical[i].position},
+                    {"cash", result.historical[i].cash},
+                    {"trend", result.historical[i].trend},
+                    {"volatility", result.historical[i].volatility}
+                };
+
+                auto trade_it = std::find_if(result.trades.begin(), result.trades.end(),
+                    [i](const Trade& trade) { return trade.timeStep == static_cast<int>(i); });
+
+                if (trade_it != result.trades.end()) {
+                    timestepData["trade"] = {
+                        {"type", trade_it->type},
+                        {"side", trade_it->side},
+                        {"quantity", trade_it->quantity},
+                        {"price", trade_it->price}
+                    };
+                }
+
+                response["historical_data"].push_back(timestepData);
+            }
+
+
+            response["trades"] = json::array();
+            for (const auto& trade : result.trades) {
+                response["trades"].push_back({
+                    {"time_step", trade.timeStep},
+                    {"type", trade.type},
+                    {"side", trade.side},
+                    {"price", trade.price},
+                    {"quantity", trade.quantity}
+                });
+            }
+
+            if (cacheResult) {
+                chartPyramid = buildChartPyramid(response["historical_data"]);
+            }
+            body = response.dump();
+            serializeStage.record(serializeStart);
+        }).get();
+        if (cacheResult) {
+            chartCache.put(cacheKey, std::move(chartPyramid));
+            if (spillCache->accepts(body.size())) {
+                try {
+                    spillCache->put(cacheKey, body);
+                } catch (const std::exception& e) {
+                    std::cerr << "Warning: " << e.what() << std::endl;
+                }
+            } else {
+                resultCache.put(cacheKey, body);
+            }
+        }
+        res.set_content(body, "application/json");
+        return "";
+
+    } catch (const UpstreamUnavailable& ex) {
+        res.status = 503;
+        res.set_header("Retry-After", std::to_string(ex.retryAfter().count()));
+        res.set_content(ex.what(), "text/plain");
+        return "";
+    } catch (const DeadlineExceeded& ex) {
+        res.status = kGatewayTimeout;
+        res.set_content(ex.what(), "text/plain");
+        return "";
+    } catch (const OperationCancelled& ex) {
+        res.status = kClientClosedRequest;
+        res.set_content(ex.what(), "text/plain");
+        return "";
+    } catch (const std::exception& ex) {
+        res.status = 500;
+        res.set_content(ex.what(), "text/plain");
+        return "";
+    }
+}
 
+/**
+ * @brief Creates the cancellation token for an incoming request.
+ *
+ * The token cancels itself when the client's connection closes. If the
+ * client supplied an id (X-Request-Id header or request_id parameter) the
+ * token is also registered so /cancel can reach it. An id can only belong
+ * to one running request: a second request reusing it is answered with
+ * 409 and not run, so /cancel never picks between two requests and the
+ * first one's registration stays until it ends.
+ *
+ * @param req Incoming request; must outlive every check of the token
+ * @param res Response, filled in when the request is refused
+ * @param requestId Receives the client supplied id, or an empty string
+ * @param token Receives the request's cancellation token
+ * @return false if the id is already in use; the caller returns at once
+ */
+bool TradingServer::beginRequest(const httplib::Request& req, httplib::Response& res, std::string& requestId,
+                                 CancellationToken& token) {
+    token.setProbe([&req]() { return req.is_connection_closed(); });
+
+    requestId = req.get_header_value("X-Request-Id");
+    if (requestId.empty() && req.has_param("request_id")) {
+        requestId = req.get_param_value("request_id");
+    }
+    if (!requestId.empty()) {
+        std::lock_guard<std::mutex> lock(activeRequestsMutex);
+        if (!activeRequests.emplace(requestId, token).second) {
+            json response = {{"request_id", requestId}, {"error", "A request with this id is already running."}};
+            res.status = 409;
+            res.set_content(response.dump(), "application/json");
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Sets a request's deadline.
+ *
+ * The budget comes from the X-Deadline-Ms header or the deadline_ms
+ * parameter, in milliseconds from now. Clients may only shorten the server
+ * default (TRADING_REQUEST_TIMEOUT_MS); a default of 0 disables it.
+ *
+ * @param req Incoming request
+ * @param token The request's cancellation token
+ * @throws std::invalid_argument if the client's budget is not a positive integer
+ */
+void TradingServer::applyDeadline(const httplib::Request& req, CancellationToken& token) const {
+    int64_t budgetMs = defaultDeadlineMs;
+    std::string requested = req.get_header_value("X-Deadline-Ms");
+    if (requested.empty() && req.has_param("deadline_ms")) {
+        requested = req.get_param_value("deadline_ms");
+    }
+    if (!requested.empty()) {
+        int64_t clientMs = 0;
+        try {
+            size_t used = 0;
+            clientMs = std::stoll(requested, &used);
+            if (used != requested.size()) {
+                clientMs = 0;
+            }
+        } catch (const std::exception&) {
+        }
+        if (clientMs <= 0) {
+            throw std::invalid_argument("Invalid deadline '" + requested + "'. Must be a positive number of milliseconds.");
+        }
+        budgetMs = budgetMs > 0 ? std::min(budgetMs, clientMs) : clientMs;
+    }
+    if (budgetMs > 0) {
+        token.setDeadline(std::chrono::steady_clock::now() + std::chrono::milliseconds(budgetMs));
+    }
+}
+
+void TradingServer::endRequest(const std::string& requestId) {
+    if (!requestId.empty()) {
+        std::lock_guard<std::mutex> lock(activeRequestsMutex);
+        activeRequests.erase(requestId);
+    }
+}
+
+/**
+ * @brief Sends a spilled response body.
+ *
+ * Clients that accept gzip get the file's compressed bytes as stored, with
+ * Content-Encoding set, streamed from the mapping without copying them
+ * into a buffer. Other clients get the body decompressed.
+ *
+ * @param req Request, consulted for Accept-Encoding
+ * @param res Response to fill
+ * @param body The mapped spill file
+ */
+void TradingServer::sendSpilled(const httplib::Request& req, httplib::Response& res,
+                                std::shared_ptr<const SpilledBody> body) const {
+    res.set_header("Vary", "Accept-Encoding");
+    if (!acceptsGzip(req.get_header_value("Accept-Encoding"))) {
+        res.set_content(body->decompress(), "application/json");
+        return;
+    }
+    res.set_header("Content-Encoding", "gzip");
+    size_t length = body->gzipSize();
+    res.set_content_provider(length, "application/json",
+        [body](size_t offset, size_t remaining, httplib::DataSink& sink) {
+            size_t n = std::min(remaining, kBodyChunkBytes);
+            return sink.write(body->gzipData() + offset, n);
+        });
+}
+
+/**
+ * @brief Cancels an in-flight request by the id its client supplied.
+ *
+ * The cancelled request stops at its next checkpoint, killing its fetcher
+ * process if one is running.
+ */
+std::string TradingServer::handleCancel(const httplib::Request& req, httplib::Response& res) {
+    if (!req.has_param("request_id")) {
+        res.status = 400;
+        res.set_content("Please provide a 'request_id' parameter.", "text/plain");
+        return "";
+    }
+    std::string requestId = req.get_param_value("request_id");
+    bool found = false;
+    {
+        std::lock_guard<std::mutex> lock(activeRequestsMutex);
+        auto it = activeRequests.find(requestId);
+        if (it != activeRequests.end()) {
+            it->second.cancel("Cancelled by client");
+            found = true;
+        }
+    }
+    json response = {{"request_id", requestId}, {"cancelled", found}};
+    res.status = found ? 200 : 404;
+    res.set_content(response.dump(), "application/json");
+    return "";
+}
+
+/**
+ * @brief Reports scheduler, cache, upstream health and stage timing metrics.
+ *
+ * Includes the compute CPU set and per-priority-class queue depth, running
+ * count, concurrency limit, completed tasks, executed units, and queue and
+ * run time statistics (the max against the average shows jitter), plus the stage
+ * duration estimates used for deadline checks.
+ */
+std::string TradingServer::handleMetrics(const httplib::Request& /* req */, httplib::Response& res) {
+    SchedulerStats stats = scheduler->stats();
+    json response;
+    response["scheduler"] = {
+        {"workers", stats.workers},
+        {"cpus", formatCpuList(stats.cpus)},
+        {"interactive", classStatsJson(stats.interactive)},
+        {"background", classStatsJson(stats.background)}
+    };
+    response["caches"] = {
+        {"data", {{"entries", dataCache.size()}, {"bytes", dataCache.bytes()}}},
+        {"results", {{"entries", resultCache.size()}, {"bytes", resultCache.bytes()}}},
+        {"spilled_results", {{"entries", spillCache->size()}, {"bytes", spillCache->bytes()}}},
+        {"chart_pyramids", {{"entries", chartCache.size()}, {"bytes", chartCache.bytes()}}}
+    };
+    FetchHealth fetchHealth = DataFetcher::health();
+    response["upstream"] = {
+        {"breaker", fetchHealth.breakerState},
+        {"consecutive_failures", fetchHealth.consecutiveFailures},
+        {"negative_cache_entries", fetchHealth.negativeEntries}
+    };
+    response["stage_estimates_ms"] = {
+        {"fetch", DataFetcher::scriptDuration().averageMs()},
+        {"simulate", simulateStage.averageMs()},
+        {"serialize", serializeStage.averageMs()}
+    };
+    res.set_content(response.dump(), "application/json");
+    return "";
+}
+
+/**
+ * @brief Runs a parameter sweep of one strategy over a single series.
+ *
+ * Every strategy parameter may be given as a comma separated list; the
+ * cartesian product of all lists is simulated in lockstep by the batch
+ * engine and one summary is returned per configuration, best first.
+ * The sweep runs as background work in chunks, so it never holds a worker
+ * that an interactive request is waiting for.
+ * Supported strategies: "macd" and "mean_reversion".
+ */
+std::string TradingServer::handleSweep(const httplib::Request& req, httplib::Response& res) {
+    std::string requestId;
+    CancellationToken token;
+    if (!beginRequest(req, res, requestId, token)) {
+        return "";
+    }
+    auto requestScope = makeScopeExit([this, &requestId]() { endRequest(requestId); });
+    try {
+        std::string symbol = req.has_param("symbol") ? req.get_param_value("symbol") : "AAPL";
+        std::string interval = req.has_param("interval") ? req.get_param_value("interval") : "5min";
+        std::string strategyName = req.has_param("strategy") ? req.get_param_value("strategy") : "macd";
+        std::string dateStr = req.has_param("date") ? req.get_param_value("date") : "";
+        double initialCash = 100000.0;
+
+        if (req.has_param("initial_capital")) {
+            try {
+                initialCash = std::stod(req.get_param_value("initial_capital"));
+            } catch (const std::invalid_argument& e) {
+                res.status = 400;
+                res.set_content("Invalid 'initial_capital' parameter. Must be a number.", "text/plain");
+                return "";
+            }
+        }
+
+        if (dateStr.empty()) {
+            res.status = 400;
+            res.set_content("Please provide a 'date' parameter in YYYY-MM-DD format.", "text/plain");
+            return "";
+        }
+
+        try {
+            applyDeadline(req, token);
+        } catch (const std::invalid_argument& e) {
+            res.status = 400;
+            res.set_content(e.what(), "text/plain");
+            return "";
+        }
+
+        std::vector<std::string> names;
+        std::vector<std::vector<double>> combos;
+        try {
+            std::vector<std::vector<double>> axes;
+            if (strategyName == "macd") {
+                names = {"macdFastPeriod", "macdSlowPeriod", "signalPeriod", "stopLossPercentage", "transactionCost"};
+                const double defaults[] = {12, 26, 9, 0.02, 0.001};
+                for (size_t a = 0; a < names.size(); ++a) {
+                    axes.push_back(sweepValues(req, names[a], defaults[a]));
+                }
+            } else if (strategyName == "mean_reversion") {
+                names = {"lookbackPeriod", "entryThreshold", "exitThreshold", "stopLossPercentage",
+                         "profitTargetPercentage", "transactionCost"};
+                const double defaults[] = {20, 1.5, 0.5, 0.02, 0.03, 0.001};
+                for (size_t a = 0; a < names.size(); ++a) {
+                    axes.push_back(sweepValues(req, names[a], defaults[a]));
+                }
+            } else {
+                res.status = 400;
+                res.set_content("Sweeps are not supported for strategy: " + strategyName, "text/plain");
+                return "";
+            }
+            combos = cartesianProduct(axes);
+        } catch (const std::exception& e) {
+            res.status = 400;
+            res.set_content(std::string("Invalid sweep parameters: ") + e.what(), "text/plain");
+            return "";
+        }
+
+        DataFetcher fetcher(dataSource);
+        fetcher.setCancellationToken(token);
+        json intradayData = fetcher.fetchIntradayData(symbol, interval, dateStr);
+        auto marketData = fetcher.parseIntradayData(intradayData, interval, dateStr);
+
+        if (marketData.prices.empty()) {
+            res.status = 404;
+            res.set_content("No data found for the specified date.", "text/plain");
+            return "";
+        }
+
+        std::vector<BatchResult> results;
+        try {
+            if (strategyName == "macd") {
+                std::vector<MACDConfig> configs;
+                configs.reserve(combos.size());
+                for (const auto& c : combos) {
+                    configs.push_back({static_cast<int>(c[0]), static_cast<int>(c[1]), static_cast<int>(c[2]), c[3], c[4]});
+                }
+                results = runSweep(*scheduler, MACDBatch(configs), marketData, initialCash, token);
+            } else {
+                std::vector<MeanReversionConfig> configs;
+                configs.reserve(combos.size());
+                for (const auto& c : combos) {
+                    configs.push_back({static_cast<int>(c[0]), c[1], c[2], c[3], c[4], c[5]});
+                }
+                results = runSweep(*scheduler, MeanReversionBatch(configs), marketData, initialCash, token);
+            }
+        } catch (const std::invalid_argument& e) {
+            res.status = 400;
+            res.set_content(e.what(), "text/plain");
+            return "";
+        }
+
+        std::vector<size_t> order(results.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&results](size_t a, size_t b) {
+            return results[a].profitLoss > results[b].profitLoss;
+        });
 
         json response;
         response["symbol"] = symbol;
@@ -162,58 +1106,674 @@ std::string TradingServer::handleSimulate(const httplib::Request& req, httplib::
         response["interval"] = interval;
         response["date"] = dateStr;
         response["initial_capital"] = initialCash;
-        response["final_portfolio_value"] = result.finalPortfolioValue;
-        response["profit_loss"] = result.profitLoss;
-        response["num_trades"] = result.trades.size();
-
-
-        response["historical_data"] = json::array();
-
-        for (size_t i = 0; i < marketData.timestamps.size(); i++) {
-            json timestepData;
-            timestepData["timestamp"] = marketData.timestamps[i];
-            timestepData["price"] = marketData.prices[i];
-
-            timestepData["indicators"] = {
-                {"macd", result.historical[i].macd},
-                {"signal", result.historical[i].signal},
-                {"portfolio_value", result.historical[i].portfolioValue},
-                {"position", result.historical[i].position},
-                {"cash", result.historical[i].cash},
-                {"trend", result.historical[i].trend},
-                {"volatility", result.historical[i].volatility}
-            };
+        response["num_configs"] = results.size();
+        response["results"] = json::array();
+        for (size_t i : order) {
+            json params;
+            for (size_t a = 0; a < names.size(); ++a) {
+                params[names[a]] = combos[i][a];
+            }
+            response["results"].push_back({
+                {"params", params},
+                {"final_portfolio_value", results[i].finalPortfolioValue},
+                {"profit_loss", results[i].profitLoss},
+                {"num_trades", results[i].numTrades}
+            });
+        }
 
-            auto trade_it = std::find_if(result.trades.begin(), result.trades.end(),
-                [i](const Trade& trade) { return trade.timeStep == static_cast<int>(i); });
+        res.set_content(response.dump(), "application/json");
+        return "";
 
-            if (trade_it != result.trades.end()) {
-                timestepData["trade"] = {
-                    {"type", trade_it->type},
-                    {"side", trade_it->side},
-                    {"quantity", trade_it->quantity},
-                    {"price", trade_it->price}
-                };
+    } catch (const UpstreamUnavailable& ex) {
+        res.status = 503;
+        res.set_header("Retry-After", std::to_string(ex.retryAfter().count()));
+        res.set_content(ex.what(), "text/plain");
+        return "";
+    } catch (const DeadlineExceeded& ex) {
+        res.status = kGatewayTimeout;
+        res.set_content(ex.what(), "text/plain");
+        return "";
+    } catch (const OperationCancelled& ex) {
+        res.status = kClientClosedRequest;
+        res.set_content(ex.what(), "text/plain");
+        return "";
+    } catch (const std::exception& ex) {
+        res.status = 500;
+        res.set_content(ex.what(), "text/plain");
+        return "";
+    }
+}
+
+std::string TradingServer::handleBaseline(const httplib::Request& req, httplib::Response& res) {
+    std::string requestId;
+    CancellationToken token;
+    if (!beginRequest(req, res, requestId, token)) {
+        return "";
+    }
+    auto requestScope = makeScopeExit([this, &requestId]() { endRequest(requestId); });
+    try {
+        std::string symbol = req.has_param("symbol") ? req.get_param_value("symbol") : "AAPL";
+        std::string interval = req.has_param("interval") ? req.get_param_value("interval") : "5min";
+        std::string strategyName = req.has_param("strategy") ? req.get_param_value("strategy") : "macd";
+        std::string dateStr = req.has_param("date") ? req.get_param_value("date") : "";
+        double initialCash = 100000.0;
+        size_t runs = kDefaultBaselineRuns;
+        uint64_t seed = kDefaultBaselineSeed;
+
+        try {
+            if (req.has_param("initial_capital")) {
+                initialCash = std::stod(req.get_param_value("initial_capital"));
+            }
+            if (req.has_param("runs")) {
+                runs = std::stoull(req.get_param_value("runs"));
             }
+            if (req.has_param("seed")) {
+                seed = std::stoull(req.get_param_value("seed"));
+            }
+        } catch (const std::exception& e) {
+            res.status = 400;
+            res.set_content("Invalid 'initial_capital', 'runs' or 'seed' parameter. Must be a number.", "text/plain");
+            return "";
+        }
+        if (runs == 0 || runs > kMaxBaselineRuns) {
+            res.status = 400;
+            res.set_content("'runs' must be between 1 and " + std::to_string(kMaxBaselineRuns), "text/plain");
+            return "";
+        }
 
-            response["historical_data"].push_back(timestepData);
+        if (dateStr.empty()) {
+            res.status = 400;
+            res.set_content("Please provide a 'date' parameter in YYYY-MM-DD format.", "text/plain");
+            return "";
         }
 
+        try {
+            applyDeadline(req, token);
+        } catch (const std::invalid_argument& e) {
+            res.status = 400;
+            res.set_content(e.what(), "text/plain");
+            return "";
+        }
+
+        const auto& strategies = Strategy::getRegisteredStrategies();
+        auto it = strategies.find(strategyName);
+        if (it == strategies.end()) {
+            res.status = 400;
+            res.set_content("Unknown strategy: " + strategyName, "text/plain");
+            return "";
+        }
+
+        DataFetcher fetcher(dataSource);
+        fetcher.setCancellationToken(token);
+        json intradayData = fetcher.fetchIntradayData(symbol, interval, dateStr);
+        auto marketData = fetcher.parseIntradayData(intradayData, interval, dateStr);
+
+        if (marketData.prices.empty()) {
+            res.status = 404;
+            res.set_content("No data found for the specified date.", "text/plain");
+            return "";
+        }
+
+        // The strategy under test, then baselines trading as often as it did
+        // and paying the same fee. Both run as interactive work.
+        SimulationResult target;
+        scheduler->submit(Priority::Interactive, [&]() {
+            auto strategy = it->second.factory();
+            strategy->setCancellationToken(token);
+            target = strategy->execute(marketData, initialCash);
+        }).get();
+
+        const double tradeRate = std::min(1.0, static_cast<double>(target.trades.size()) / marketData.prices.size());
+        const double transactionCost = registeredDefault(it->second, "transactionCost", 0.001);
+        auto results = runSweep(*scheduler, RandomBatch(runs, tradeRate, transactionCost, seed),
+                                marketData, initialCash, token, Priority::Interactive);
+
+        std::vector<double> pnl(results.size());
+        double sum = 0.0;
+        double trades = 0.0;
+        for (size_t i = 0; i < results.size(); ++i) {
+            pnl[i] = results[i].profitLoss;
+            sum += pnl[i];
+            trades += results[i].numTrades;
+        }
+        std::sort(pnl.begin(), pnl.end());
+        const double mean = sum / runs;
+        double sumSq = 0.0;
+        for (double x : pnl) {
+            sumSq += (x - mean) * (x - mean);
+        }
+
+        // Ties count half toward the percentile; the one-sided p-value counts
+        // the strategy itself as one more draw from the null
+        const auto below = std::lower_bound(pnl.begin(), pnl.end(), target.profitLoss) - pnl.begin();
+        const auto notAbove = std::upper_bound(pnl.begin(), pnl.end(), target.profitLoss) - pnl.begin();
+        const double percentile = 100.0 * (below + 0.5 * (notAbove - below)) / runs;
+        const double pValue = (1.0 + (runs - below)) / (runs + 1.0);
+
+        json quantiles;
+        for (double q : kBaselineQuantiles) {
+            std::ostringstream name;
+            name << "p" << q * 100;
+            quantiles[name.str()] = pnl[static_cast<size_t>(q * (runs - 1) + 0.5)];
+        }
+
+        json response;
+        response["symbol"] = symbol;
+        response["strategy"] = strategyName;
+        response["interval"] = interval;
+        response["date"] = dateStr;
+        response["initial_capital"] = initialCash;
+        response["final_portfolio_value"] = target.finalPortfolioValue;
+        response["profit_loss"] = target.profitLoss;
+        response["num_trades"] = target.trades.size();
+        response["percentile"] = percentile;
+        response["p_value"] = pValue;
+        response["baseline"] = {
+            {"runs", runs},
+            {"seed", seed},
+            {"trade_rate", tradeRate},
+            {"transaction_cost", transactionCost},
+            {"mean_profit_loss", mean},
+            {"std_profit_loss", runs > 1 ? std::sqrt(sumSq / (runs - 1)) : 0.0},
+            {"mean_num_trades", trades / runs},
+            {"quantiles", quantiles},
+            {"profit_loss", pnl}
+        };
+
+        res.set_content(response.dump(), "application/json");
+        return "";
+
+    } catch (const UpstreamUnavailable& ex) {
+        res.status = 503;
+        res.set_header("Retry-After", std::to_string(ex.retryAfter().count()));
+        res.set_content(ex.what(), "text/plain");
+        return "";
+    } catch (const DeadlineExceeded& ex) {
+        res.status = kGatewayTimeout;
+        res.set_content(ex.what(), "text/plain");
+        return "";
+    } catch (const OperationCancelled& ex) {
+        res.status = kClientClosedRequest;
+        res.set_content(ex.what(), "text/plain");
+        return "";
+    } catch (const std::exception& ex) {
+        res.status = 500;
+        res.set_content(ex.what(), "text/plain");
+        return "";
+    }
+}
+
+/**
+ * @brief Serves stored bars for a symbol and time range straight from the bar store.
+ *
+ * The range is given as `from` and `to` (each "YYYY-MM-DD" or
+ * "YYYY-MM-DD HH:MM:SS"; a bare `to` date includes the whole day), or as a
+ * single `date`. By default the overlapping segment files are sent as
+ * stored, back to back, with their sizes in the X-Segment-Lengths header.
+ * The body is streamed from the segments' mappings, so no bytes are copied
+ * or decoded in user space; clients trim to the exact range using each
+ * segment's footer. With format=json only the overlapping blocks are
+ * decoded and the bars are returned in the fetcher's JSON layout.
+ */
+std::string TradingServer::handleBars(const httplib::Request& req, httplib::Response& res) {
+    if (!barStore.enabled()) {
+        res.status = 404;
+        res.set_content("The bar store is disabled; set TRADING_BAR_STORE_DIR to enable it.", "text/plain");
+        return "";
+    }
+    std::string symbol = req.has_param("symbol") ? req.get_param_value("symbol") : "AAPL";
+    std::string interval = req.has_param("interval") ? req.get_param_value("interval") : "5min";
+    std::string format = req.has_param("format") ? req.get_param_value("format") : "segment";
+    std::string fromStr = req.has_param("from") ? req.get_param_value("from") : req.get_param_value("date");
+    std::string toStr = req.has_param("to") ? req.get_param_value("to") : fromStr;
+    if (fromStr.empty()) {
+        res.status = 400;
+        res.set_content("Please provide a 'date' or 'from' parameter.", "text/plain");
+        return "";
+    }
+    if (format != "segment" && format != "json") {
+        res.status = 400;
+        res.set_content("Invalid 'format' parameter. Must be 'segment' or 'json'.", "text/plain");
+        return "";
+    }
+
+    int64_t from = 0;
+    int64_t to = 0;
+    try {
+        from = parseBarTime(fromStr);
+        to = parseBarTime(toStr);
+    } catch (const std::invalid_argument& e) {
+        res.status = 400;
+        res.set_content(e.what(), "text/plain");
+        return "";
+    }
+    if (toStr.size() == 10) {
+        to += kSecondsPerDay - 1;
+    }
+
+    try {
+        if (format == "json") {
+            BarColumns bars = barStore.readRange(symbol, interval, from, to);
+            json rows = json::array();
+            for (size_t i = 0; i < bars.size(); ++i) {
+                rows.push_back({
+                    {"timestamp", formatBarTime(bars.timestamps[i])},
+                    {"open", bars.open[i]},
+                    {"high", bars.high[i]},
+                    {"low", bars.low[i]},
+                    {"close", bars.close[i]},
+                    {"volume", bars.volume[i]}
+                });
+            }
+            json response = {{"symbol", symbol}, {"interval", interval}, {"data", std::move(rows)}};
+            res.set_content(response.dump(), "application/json");
+            return "";
+        }
 
-        response["trades"] = json::array();
-        for (const auto& trade : result.trades) {
-            response["trades"].push_back({
-                {"time_step", trade.timeStep},
-                {"type", trade.type},
-                {"side", trade.side},
-                {"price", trade.price},
-                {"quantity", trade.quantity}
+        auto segments = std::make_shared<std::vector<std::shared_ptr<const BarSegment>>>(
+            barStore.openRange(symbol, interval, from, to));
+        auto starts = std::make_shared<std::vector<size_t>>();
+        std::string lengths;
+        size_t total = 0;
+        for (const auto& segment : *segments) {
+            segment->willNeed();
+            starts->push_back(total);
+            total += segment->byteSize();
+            lengths += (lengths.empty() ? "" : ",") + std::to_string(segment->byteSize());
+        }
+        res.set_header("X-Segment-Lengths", lengths);
+        if (total == 0) {
+            res.set_content("", "application/octet-stream");
+            return "";
+        }
+        res.set_content_provider(total, "application/octet-stream",
+            [segments, starts](size_t offset, size_t length, httplib::DataSink& sink) {
+                size_t i = std::upper_bound(starts->begin(), starts->end(), offset) - starts->begin() - 1;
+                const BarSegment& segment = *(*segments)[i];
+                size_t within = offset - (*starts)[i];
+                size_t n = std::min({length, segment.byteSize() - within, kBodyChunkBytes});
+                return sink.write(reinterpret_cast<const char*>(segment.bytes() + within), n);
             });
+        return "";
+    } catch (const std::exception& ex) {
+        res.status = 500;
+        res.set_content(ex.what(), "text/plain");
+        return "";
+    }
+}
+
+/**
+ * @brief Serves a zoomed view of a cached /simulate result from its chart pyramid.
+ *
+ * Takes the /simulate parameters of the result to view, plus `from` and
+ * `to` (each "YYYY-MM-DD" or "YYYY-MM-DD HH:MM:SS", defaulting to the
+ * whole session), `width` (output buckets, usually the chart's width in
+ * pixels) and an optional comma separated `series` list. Each bucket
+ * carries the first, last, min and max of its points, which is enough to
+ * draw a line without losing spikes. The pyramid is built when the result
+ * is cached; if it has been evicted it is rebuilt from the cached result.
+ * The strategy is never re-run: a result that is not cached is a 404.
+ */
+std::string TradingServer::handleChart(const httplib::Request& req, httplib::Response& res) {
+    size_t width = kDefaultChartWidth;
+    int64_t from = std::numeric_limits<int64_t>::min();
+    int64_t to = std::numeric_limits<int64_t>::max();
+    try {
+        if (req.has_param("width")) {
+            int64_t requested = std::stoll(req.get_param_value("width"));
+            if (requested < 1 || requested > static_cast<int64_t>(kMaxChartWidth)) {
+                throw std::invalid_argument("out of range");
+            }
+            width = static_cast<size_t>(requested);
+        }
+    } catch (const std::exception&) {
+        res.status = 400;
+        res.set_content("Invalid 'width' parameter. Must be between 1 and " + std::to_string(kMaxChartWidth) + ".",
+                        "text/plain");
+        return "";
+    }
+    try {
+        if (req.has_param("from")) {
+            from = parseBarTime(req.get_param_value("from"));
+        }
+        if (req.has_param("to")) {
+            std::string toStr = req.get_param_value("to");
+            to = parseBarTime(toStr);
+            if (toStr.size() == 10) {
+                to += kSecondsPerDay - 1;
+            }
+        }
+    } catch (const std::invalid_argument& e) {
+        res.status = 400;
+        res.set_content(e.what(), "text/plain");
+        return "";
+    }
+
+    try {
+        const std::string resultKey = chartResultKey(req);
+        std::shared_ptr<const SeriesPyramid> pyramid = chartCache.get(resultKey);
+        if (!pyramid) {
+            std::string body;
+            if (auto cached = resultCache.get(resultKey)) {
+                body = *cached;
+            } else if (auto spilled = spillCache->get(resultKey)) {
+                body = spilled->decompress();
+            } else {
+                res.status = 404;
+                res.set_content("No cached result for these parameters; run /simulate for a completed session first.",
+                                "text/plain");
+                return "";
+            }
+            pyramid = buildChartPyramid(json::parse(body).at("historical_data"));
+            chartCache.put(resultKey, pyramid);
+        }
+
+        std::vector<size_t> series;
+        if (req.has_param("series")) {
+            std::stringstream ss(req.get_param_value("series"));
+            std::string name;
+            while (std::getline(ss, name, ',')) {
+                size_t index = pyramid->find(name);
+                if (index == static_cast<size_t>(-1)) {
+                    res.status = 400;
+                    res.set_content("Unknown series: " + name, "text/plain");
+                    return "";
+                }
+                series.push_back(index);
+            }
+        } else {
+            for (size_t i = 0; i < pyramid->names().size(); ++i) {
+                series.push_back(i);
+            }
         }
 
+        auto [begin, end] = pyramid->indexRange(from, to);
+        PyramidView view = pyramid->query(begin, end, width, series);
+
+        json response;
+        response["points"] = end - begin;
+        response["level"] = view.level;
+        response["timestamps"] = json::array();
+        for (int64_t t : view.timestamps) {
+            response["timestamps"].push_back(formatBarTime(t));
+        }
+        response["series"] = json::object();
+        for (size_t s = 0; s < series.size(); ++s) {
+            json first = json::array();
+            json last = json::array();
+            json min = json::array();
+            json max = json::array();
+            for (const auto& bucket : view.series[s]) {
+                first.push_back(bucket.first);
+                last.push_back(bucket.last);
+                min.push_back(bucket.min);
+                max.push_back(bucket.max);
+            }
+            response["series"][pyramid->names()[series[s]]] = {
+                {"first", std::move(first)},
+                {"last", std::move(last)},
+                {"min", std::move(min)},
+                {"max", std::move(max)}
+            };
+        }
         res.set_content(response.dump(), "application/json");
         return "";
+    } catch (const std::exception& ex) {
+        res.status = 500;
+        res.set_content(ex.what(), "text/plain");
+        return "";
+    }
+}
+
+/**
+ * @brief Serves the return correlation matrix of a set of symbols.
+ *
+ * Takes a comma separated `symbols` list, a `date` or a `from`/`to` range
+ * of session dates, and an optional `interval` (default 5min). Bars come
+ * from the bar store where it has the session, and are fetched through the
+ * data pipeline otherwise, several sessions at a time. Log returns are
+ * aligned on the union of the symbols' bar times; each pair is correlated
+ * over the returns both symbols have, and is null with fewer than
+ * `min_overlap` of them. By default the response holds the full matrix;
+ * with `top` it holds only the K strongest pairs, ranked by |r| or, with
+ * `order=desc` or `order=asc`, by r itself. The matrix is computed as
+ * background work, one tile of pairs per unit.
+ */
+std::string TradingServer::handleCorrelation(const httplib::Request& req, httplib::Response& res) {
+    std::string requestId;
+    CancellationToken token;
+    if (!beginRequest(req, res, requestId, token)) {
+        return "";
+    }
+    auto requestScope = makeScopeExit([this, &requestId]() { endRequest(requestId); });
+    try {
+        std::string interval = req.has_param("interval") ? req.get_param_value("interval") : "5min";
+        std::string order = req.has_param("order") ? req.get_param_value("order") : "abs";
+        std::string fromStr = req.has_param("from") ? req.get_param_value("from") : req.get_param_value("date");
+        std::string toStr = req.has_param("to") ? req.get_param_value("to") : fromStr;
 
+        std::vector<std::string> symbols;
+        std::stringstream ss(req.get_param_value("symbols"));
+        std::string symbol;
+        while (std::getline(ss, symbol, ',')) {
+            if (!symbol.empty()) {
+                symbols.push_back(symbol);
+            }
+        }
+        if (symbols.size() < 2 || symbols.size() > kMaxCorrelationSymbols) {
+            res.status = 400;
+            res.set_content("Please provide between 2 and " + std::to_string(kMaxCorrelationSymbols) +
+                            " comma separated 'symbols'.", "text/plain");
+            return "";
+        }
+        std::vector<std::string> sorted = symbols;
+        std::sort(sorted.begin(), sorted.end());
+        auto duplicate = std::adjacent_find(sorted.begin(), sorted.end());
+        if (duplicate != sorted.end()) {
+            res.status = 400;
+            res.set_content("Duplicate symbol: " + *duplicate, "text/plain");
+            return "";
+        }
+        if (order != "abs" && order != "desc" && order != "asc") {
+            res.status = 400;
+            res.set_content("Invalid 'order' parameter. Must be 'abs', 'desc' or 'asc'.", "text/plain");
+            return "";
+        }
+
+        size_t minOverlap = kDefaultMinOverlap;
+        size_t top = 0;
+        try {
+            if (req.has_param("min_overlap")) {
+                minOverlap = std::stoull(req.get_param_value("min_overlap"));
+            }
+            if (req.has_param("top")) {
+                top = std::stoull(req.get_param_value("top"));
+            }
+        } catch (const std::exception&) {
+            res.status = 400;
+            res.set_content("Invalid 'min_overlap' or 'top' parameter. Must be a non-negative integer.", "text/plain");
+            return "";
+        }
+
+        if (fromStr.empty()) {
+            res.status = 400;
+            res.set_content("Please provide a 'date' or 'from' parameter in YYYY-MM-DD format.", "text/plain");
+            return "";
+        }
+        std::vector<std::string> dates;
+        try {
+            dates = weekdaySessions(fromStr, toStr, kMaxCorrelationSessions);
+        } catch (const std::invalid_argument& e) {
+            res.status = 400;
+            res.set_content(e.what(), "text/plain");
+            return "";
+        }
+
+        try {
+            applyDeadline(req, token);
+        } catch (const std::invalid_argument& e) {
+            res.status = 400;
+            res.set_content(e.what(), "text/plain");
+            return "";
+        }
+
+        // Stored sessions of every symbol are read in one batch
+        const int64_t rangeStart = parseBarTime(dates.front());
+        const int64_t rangeEnd = parseBarTime(dates.back()) + kSecondsPerDay - 1;
+        std::vector<std::vector<bool>> stored(symbols.size(), std::vector<bool>(dates.size(), false));
+        std::vector<BarColumns> storedBars(symbols.size());
+        if (barStore.enabled()) {
+            std::vector<RangeQuery> queries;
+            std::vector<size_t> queried;
+            for (size_t s = 0; s < symbols.size(); ++s) {
+                for (const auto& info : barStore.manifest(symbols[s], interval)) {
+                    auto date = std::lower_bound(dates.begin(), dates.end(), info.date);
+                    if (date != dates.end() && *date == info.date && info.rowCount > 0) {
+                        stored[s][date - dates.begin()] = true;
+                    }
+                }
+                if (std::find(stored[s].begin(), stored[s].end(), true) != stored[s].end()) {
+                    queries.push_back({symbols[s], interval, rangeStart, rangeEnd});
+                    queried.push_back(s);
+                }
+            }
+            try {
+                std::vector<BarColumns> read = barStore.readRanges(queries);
+                for (size_t q = 0; q < queried.size(); ++q) {
+                    storedBars[queried[q]] = std::move(read[q]);
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: ignoring stored bars for /correlation: " << e.what() << std::endl;
+                for (auto& flags : stored) {
+                    std::fill(flags.begin(), flags.end(), false);
+                }
+            }
+        }
+        token.throwIfCancelled();
+
+        // The rest are fetched a few at a time; a session the source has no
+        // bars for is left out, but an unavailable upstream fails the request
+        std::vector<std::pair<size_t, size_t>> fetches; // symbol, date
+        for (size_t s = 0; s < symbols.size(); ++s) {
+            for (size_t d = 0; d < dates.size(); ++d) {
+                if (!stored[s][d]) {
+                    fetches.emplace_back(s, d);
+                }
+            }
+        }
+        std::vector<BarColumns> fetched(fetches.size());
+        std::atomic<size_t> nextFetch{0};
+        std::atomic<size_t> failedFetches{0};
+        std::mutex errorMutex;
+        std::exception_ptr fetchError;
+        auto fetchWork = [&]() {
+            DataFetcher fetcher(dataSource);
+            fetcher.setCancellationToken(token);
+            for (size_t i = nextFetch++; i < fetches.size() && !token.isCancelled(); i = nextFetch++) {
+                const std::string& date = dates[fetches[i].second];
+                try {
+                    fetched[i] = sessionBars(fetcher.fetchIntradayData(symbols[fetches[i].first], interval, date), date);
+                } catch (const OperationCancelled&) {
+                    return;
+                } catch (const UpstreamUnavailable&) {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!fetchError) {
+                        fetchError = std::current_exception();
+                    }
+                    token.cancel("Upstream unavailable");
+                    return;
+                } catch (const std::exception&) {
+                    ++failedFetches;
+                }
+            }
+        };
+        size_t fetchThreads = std::min(kCorrelationFetchThreads, fetches.size());
+        std::vector<std::thread> fetchWorkers;
+        for (size_t t = 1; t < fetchThreads; ++t) {
+            fetchWorkers.emplace_back(fetchWork);
+        }
+        if (fetchThreads > 0) {
+            fetchWork();
+        }
+        for (auto& worker : fetchWorkers) {
+            worker.join();
+        }
+        if (fetchError) {
+            std::rethrow_exception(fetchError);
+        }
+        token.throwIfCancelled();
+
+        // Each symbol's sessions back to back in time order
+        std::vector<BarColumns> bars(symbols.size());
+        size_t fetchIndex = 0;
+        for (size_t s = 0; s < symbols.size(); ++s) {
+            const BarColumns& storedSeries = storedBars[s];
+            for (size_t d = 0; d < dates.size(); ++d) {
+                if (!stored[s][d]) {
+                    const BarColumns& session = fetched[fetchIndex++];
+                    bars[s].append(session, 0, session.size());
+                    continue;
+                }
+                appendSession(bars[s], storedSeries, dates[d]);
+            }
+        }
+
+        ReturnPanel panel = alignReturns(bars);
+        CorrelationKernel kernel(panel, minOverlap);
+        runCorrelation(*scheduler, kernel, token);
+        CorrelationMatrix matrix = kernel.result();
+
+        json response;
+        response["symbols"] = symbols;
+        response["interval"] = interval;
+        response["from"] = dates.front();
+        response["to"] = dates.back();
+        response["min_overlap"] = minOverlap;
+        response["grid_returns"] = panel.times.size();
+        response["returns"] = panel.counts;
+        response["stored_sessions"] = symbols.size() * dates.size() - fetches.size();
+        response["fetched_sessions"] = fetches.size() - failedFetches;
+        response["failed_sessions"] = failedFetches.load();
+        if (req.has_param("top")) {
+            response["order"] = order;
+            json pairs = json::array();
+            for (const auto& pair : topPairs(matrix, top, order)) {
+                pairs.push_back({
+                    {"a", symbols[pair.first]},
+                    {"b", symbols[pair.second]},
+                    {"correlation", pair.correlation},
+                    {"overlap", pair.overlap}
+                });
+            }
+            response["pairs"] = std::move(pairs);
+        } else {
+            json rows = json::array();
+            for (size_t i = 0; i < matrix.size; ++i) {
+                json row = json::array();
+                for (size_t j = 0; j < matrix.size; ++j) {
+                    const double r = matrix.at(i, j);
+                    row.push_back(std::isnan(r) ? json(nullptr) : json(r));
+                }
+                rows.push_back(std::move(row));
+            }
+            response["matrix"] = std::move(rows);
+        }
+        res.set_content(response.dump(), "application/json");
+        return "";
+
+    } catch (const UpstreamUnavailable& ex) {
+        res.status = 503;
+        res.set_header("Retry-After", std::to_string(ex.retryAfter().count()));
+        res.set_content(ex.what(), "text/plain");
+        return "";
+    } catch (const DeadlineExceeded& ex) {
+        res.status = kGatewayTimeout;
+        res.set_content(ex.what(), "text/plain");
+        return "";
+    } catch (const OperationCancelled& ex) {
+        res.status = kClientClosedRequest;
+        res.set_content(ex.what(), "text/plain");
+        return "";
     } catch (const std::exception& ex) {
         res.status = 500;
         res.set_content(ex.what(), "text/plain");
@@ -1,7 +1,17 @@
 #include "http/server.h"
+#include "http/prefork.h"
+#include "features/feature_export.h"
 
-int main() {
+int main(int argc, char** argv) {
     try {
+        if (argc > 1 && std::string(argv[1]) == "export") {
+            return trading::runFeatureExport(std::vector<std::string>(argv + 2, argv + argc));
+        }
+        int workers = trading::workerCountFromEnvironment();
+        if (workers > 0) {
+            return trading::runPreforked(workers);
+        }
+        trading::blockShutdownSignals();
         trading::TradingServer server;
         server.run();
     } catch (const std::exception& e) {
@@ -9,4 +19,4 @@ int main() {
         return 1;
     }
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,489 @@
+#include "store/async_reader.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace trading {
+
+namespace {
+    constexpr size_t kDefaultDepth = 32;
+
+    // Registered buffer slot size; larger reads use a heap buffer instead.
+    // depth * slot size must stay under RLIMIT_MEMLOCK for registration.
+    constexpr size_t kSlotBytes = 128 * 1024;
+
+    constexpr size_t kPreadThreads = 8;
+
+    // Largest single read; longer requests continue as short reads
+    constexpr size_t kMaxReadBytes = size_t(1) << 30;
+
+    int ioUringSetup(unsigned entries, io_uring_params* params) {
+        return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+    }
+
+    int ioUringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+        return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+    }
+
+    int ioUringRegister(int fd, unsigned opcode, const void* arg, unsigned count) {
+        return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+    }
+
+    // Keeps the first exception thrown by a completion callback
+    struct CallbackErrors {
+        std::exception_ptr first;
+
+        void run(const ReadCompletion& onComplete, size_t index, const uint8_t* data, size_t length, int error) {
+            if (first) {
+                return;
+            }
+            try {
+                onComplete(index, data, length, error);
+            } catch (...) {
+                first = std::current_exception();
+            }
+        }
+
+        void rethrow() {
+            if (first) {
+                std::rethrow_exception(first);
+            }
+        }
+    };
+
+    // io_uring backend driven directly through the raw system calls. One
+    // thread submits reads in batches, keeps up to `depth` in flight and
+    // reaps completions as they arrive.
+    class IoUringReader : public AsyncReader {
+    public:
+        explicit IoUringReader(size_t depth) : depth(depth) {
+            io_uring_params params = {};
+            ringFd = ioUringSetup(static_cast<unsigned>(depth), &params);
+            if (ringFd < 0) {
+                throw std::runtime_error(std::string("io_uring_setup failed: ") + std::strerror(errno));
+            }
+            try {
+                mapRings(params);
+                allocateSlots();
+            } catch (...) {
+                release();
+                throw;
+            }
+        }
+
+        ~IoUringReader() override {
+            release();
+        }
+
+        const char* backend() const override {
+            return registered ? "io_uring (registered buffers)" : "io_uring";
+        }
+
+        void readBatch(const std::vector<ReadRequest>& requests, const ReadCompletion& onComplete) override {
+            std::lock_guard<std::mutex> lock(mutex);
+            CallbackErrors errors;
+            std::vector<size_t> freeSlots;
+            for (size_t s = depth; s-- > 0;) {
+                freeSlots.push_back(s);
+            }
+            std::deque<size_t> retries; // slots whose read came back short
+            size_t next = 0;
+            size_t inFlight = 0;
+            unsigned unsubmitted = 0;
+
+            while (next < requests.size() || inFlight > 0 || !retries.empty()) {
+                while (!retries.empty()) {
+                    queue(retries.front());
+                    retries.pop_front();
+                    unsubmitted++;
+                    inFlight++;
+                }
+                while (next < requests.size() && !freeSlots.empty()) {
+                    size_t slot = freeSlots.back();
+                    freeSlots.pop_back();
+                    Op& op = ops[slot];
+                    op.request = next;
+                    op.fd = requests[next].fd;
+                    op.offset = requests[next].offset;
+                    op.length = requests[next].length;
+                    op.done = 0;
+                    if (op.length > kSlotBytes) {
+                        op.heap.resize(op.length);
+                    }
+                    next++;
+                    if (op.length == 0) {
+                        errors.run(onComplete, op.request, buffer(slot), 0, 0);
+                        freeSlots.push_back(slot);
+                        continue;
+                    }
+                    queue(slot);
+                    unsubmitted++;
+                    inFlight++;
+                }
+                if (inFlight == 0) {
+                    continue;
+                }
+
+                int submitted = ioUringEnter(ringFd, unsubmitted, 1, IORING_ENTER_GETEVENTS);
+                if (submitted < 0) {
+                    if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+                        reap(onComplete, errors, freeSlots, retries, inFlight);
+                        continue;
+                    }
+                    throw std::runtime_error(std::string("io_uring_enter failed: ") + std::strerror(errno));
+                }
+                unsubmitted -= std::min<unsigned>(unsubmitted, static_cast<unsigned>(submitted));
+                reap(onComplete, errors, freeSlots, retries, inFlight);
+            }
+            errors.rethrow();
+        }
+
+    private:
+        struct Op {
+            size_t request;
+            int fd;
+            uint64_t offset;
+            size_t length;
+            size_t done;
+            std::vector<uint8_t> heap; // destination for reads larger than a slot
+        };
+
+        uint8_t* buffer(size_t slot) {
+            return ops[slot].heap.empty() ? slots + slot * kSlotBytes : ops[slot].heap.data();
+        }
+
+        void mapRings(const io_uring_params& params) {
+            sqRingBytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cqRingBytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+            if (single) {
+                sqRingBytes = cqRingBytes = std::max(sqRingBytes, cqRingBytes);
+            }
+            sqRing = mmap(nullptr, sqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+            if (sqRing == MAP_FAILED) {
+                sqRing = nullptr;
+                throw std::runtime_error("io_uring: cannot map submission ring");
+            }
+            if (single) {
+                cqRing = sqRing;
+            } else {
+                cqRing = mmap(nullptr, cqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+                if (cqRing == MAP_FAILED) {
+                    cqRing = nullptr;
+                    throw std::runtime_error("io_uring: cannot map completion ring");
+                }
+            }
+            sqeBytes = params.sq_entries * sizeof(io_uring_sqe);
+            void* mappedSqes = mmap(nullptr, sqeBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+            if (mappedSqes == MAP_FAILED) {
+                throw std::runtime_error("io_uring: cannot map submission entries");
+            }
+            sqes = static_cast<io_uring_sqe*>(mappedSqes);
+
+            char* sq = static_cast<char*>(sqRing);
+            sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+            sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+            sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+            char* cq = static_cast<char*>(cqRing);
+            cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+            cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+            cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+            cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        }
+
+        // One slot per in-flight read. The slot pool is registered with the
+        // ring when the memlock limit allows, which saves the kernel from
+        // pinning and unpinning the pages on every read.
+        void allocateSlots() {
+            ops.resize(depth);
+            slotBytes = depth * kSlotBytes;
+            void* pool = mmap(nullptr, slotBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (pool == MAP_FAILED) {
+                throw std::runtime_error("io_uring: cannot allocate read buffers");
+            }
+            slots = static_cast<uint8_t*>(pool);
+            std::vector<iovec> iovecs(depth);
+            for (size_t s = 0; s < depth; ++s) {
+                iovecs[s] = {slots + s * kSlotBytes, kSlotBytes};
+            }
+            registered = ioUringRegister(ringFd, IORING_REGISTER_BUFFERS, iovecs.data(), static_cast<unsigned>(depth)) == 0;
+        }
+
+        void release() {
+            if (slots) {
+                munmap(slots, slotBytes);
+            }
+            if (sqes) {
+                munmap(sqes, sqeBytes);
+            }
+            if (cqRing && cqRing != sqRing) {
+                munmap(cqRing, cqRingBytes);
+            }
+            if (sqRing) {
+                munmap(sqRing, sqRingBytes);
+            }
+            if (ringFd >= 0) {
+                close(ringFd);
+            }
+        }
+
+        // Writes the SQE for a slot's next (or remaining) read and publishes it
+        void queue(size_t slot) {
+            Op& op = ops[slot];
+            unsigned tail = *sqTail;
+            unsigned index = tail & sqMask;
+            io_uring_sqe* sqe = &sqes[index];
+            std::memset(sqe, 0, sizeof(*sqe));
+            bool fixed = registered && op.heap.empty();
+            sqe->opcode = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+            sqe->fd = op.fd;
+            sqe->off = op.offset + op.done;
+            sqe->addr = reinterpret_cast<uint64_t>(buffer(slot) + op.done);
+            sqe->len = static_cast<uint32_t>(std::min<size_t>(op.length - op.done, kMaxReadBytes));
+            if (fixed) {
+                sqe->buf_index = static_cast<uint16_t>(slot);
+            }
+            sqe->user_data = slot;
+            sqArray[index] = index;
+            __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+        }
+
+        void reap(const ReadCompletion& onComplete, CallbackErrors& errors,
+                  std::vector<size_t>& freeSlots, std::deque<size_t>& retries, size_t& inFlight) {
+            unsigned head = *cqHead;
+            unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+            while (head != tail) {
+                const io_uring_cqe& cqe = cqes[head & cqMask];
+                size_t slot = static_cast<size_t>(cqe.user_data);
+                int result = cqe.res;
+                head++;
+                __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+                inFlight--;
+
+                Op& op = ops[slot];
+                if (result == -EINTR || result == -EAGAIN) {
+                    retries.push_back(slot);
+                    continue;
+                }
+                if (result > 0) {
+                    op.done += static_cast<size_t>(result);
+                    if (op.done < op.length) {
+                        retries.push_back(slot);
+                        continue;
+                    }
+                    errors.run(onComplete, op.request, buffer(slot), op.length, 0);
+                } else {
+                    // result == 0 means the file ended before the requested range
+                    errors.run(onComplete, op.request, nullptr, 0, result < 0 ? -result : EIO);
+                }
+                op.heap.clear();
+                op.heap.shrink_to_fit();
+                freeSlots.push_back(slot);
+            }
+        }
+
+        size_t depth;
+        int ringFd = -1;
+        void* sqRing = nullptr;
+        void* cqRing = nullptr;
+        size_t sqRingBytes = 0;
+        size_t cqRingBytes = 0;
+        io_uring_sqe* sqes = nullptr;
+        size_t sqeBytes = 0;
+        unsigned* sqTail = nullptr;
+        unsigned sqMask = 0;
+        unsigned* sqArray = nullptr;
+        unsigned* cqHead = nullptr;
+        unsigned* cqTail = nullptr;
+        unsigned cqMask = 0;
+        io_uring_cqe* cqes = nullptr;
+
+        uint8_t* slots = nullptr;
+        size_t slotBytes = 0;
+        bool registered = false;
+        std::vector<Op> ops;
+        std::mutex mutex;
+    };
+
+    // Fallback backend: a fixed pool of threads runs blocking preads and
+    // hands the filled buffers back to the issuing thread. At most `depth`
+    // reads are outstanding or waiting to be consumed at a time.
+    class PreadReader : public AsyncReader {
+    public:
+        PreadReader(size_t depth, size_t threads) : depth(depth) {
+            for (size_t i = 0; i < threads; ++i) {
+                workers.emplace_back([this]() { workerLoop(); });
+            }
+        }
+
+        ~PreadReader() override {
+            {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                stopping = true;
+            }
+            workAvailable.notify_all();
+            for (auto& worker : workers) {
+                worker.join();
+            }
+        }
+
+        const char* backend() const override {
+            return "pread";
+        }
+
+        void readBatch(const std::vector<ReadRequest>& requests, const ReadCompletion& onComplete) override {
+            std::lock_guard<std::mutex> batchLock(batchMutex);
+            CallbackErrors errors;
+            {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                batch = &requests;
+                next = 0;
+                outstanding = 0;
+            }
+            workAvailable.notify_all();
+
+            for (size_t consumed = 0; consumed < requests.size(); ++consumed) {
+                Completion completion;
+                {
+                    std::unique_lock<std::mutex> lock(stateMutex);
+                    resultReady.wait(lock, [this]() { return !completed.empty(); });
+                    completion = std::move(completed.front());
+                    completed.pop_front();
+                    outstanding--;
+                }
+                workAvailable.notify_one();
+                errors.run(onComplete, completion.index,
+                           completion.error ? nullptr : completion.data.data(),
+                           completion.error ? 0 : completion.data.size(), completion.error);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                batch = nullptr;
+            }
+            errors.rethrow();
+        }
+
+    private:
+        struct Completion {
+            size_t index = 0;
+            std::vector<uint8_t> data;
+            int error = 0;
+        };
+
+        void workerLoop() {
+            std::unique_lock<std::mutex> lock(stateMutex);
+            while (true) {
+                workAvailable.wait(lock, [this]() {
+                    return stopping || (batch && next < batch->size() && outstanding < depth);
+                });
+                if (stopping) {
+                    return;
+                }
+                size_t index = next++;
+                outstanding++;
+                ReadRequest request = (*batch)[index];
+                lock.unlock();
+
+                Completion completion;
+                completion.index = index;
+                completion.data.resize(request.length);
+                size_t done = 0;
+                while (done < request.length) {
+                    ssize_t n = pread(request.fd, completion.data.data() + done, request.length - done,
+                                      static_cast<off_t>(request.offset + done));
+                    if (n < 0 && errno == EINTR) {
+                        continue;
+                    }
+                    if (n <= 0) {
+                        completion.error = n < 0 ? errno : EIO;
+                        break;
+                    }
+                    done += static_cast<size_t>(n);
+                }
+
+                lock.lock();
+                completed.push_back(std::move(completion));
+                resultReady.notify_one();
+            }
+        }
+
+        size_t depth;
+        std::vector<std::thread> workers;
+        std::mutex batchMutex;
+        std::mutex stateMutex;
+        std::condition_variable workAvailable;
+        std::condition_variable resultReady;
+        const std::vector<ReadRequest>* batch = nullptr;
+        size_t next = 0;
+        size_t outstanding = 0; // being read or waiting to be consumed
+        std::deque<Completion> completed;
+        bool stopping = false;
+    };
+}
+
+/**
+ * @brief Creates a reader for the requested backend.
+ *
+ * @param backend "io_uring", "pread" or "auto" (io_uring if the kernel allows it)
+ * @param depth Maximum reads in flight
+ * @return The reader
+ * @throws std::runtime_error if io_uring was requested explicitly and is unavailable
+ * @throws std::invalid_argument for an unknown backend name
+ */
+std::unique_ptr<AsyncReader> AsyncReader::create(const std::string& backend, size_t depth) {
+    depth = std::max<size_t>(1, std::min<size_t>(depth, 4096));
+    if (backend == "pread") {
+        return std::make_unique<PreadReader>(depth, kPreadThreads);
+    }
+    if (backend == "io_uring") {
+        return std::make_unique<IoUringReader>(depth);
+    }
+    if (backend != "auto") {
+        throw std::invalid_argument("AsyncReader: unknown backend '" + backend + "'");
+    }
+    try {
+        return std::make_unique<IoUringReader>(depth);
+    } catch (const std::exception& e) {
+        std::cerr << "Warning: " << e.what() << "; falling back to pread" << std::endl;
+        return std::make_unique<PreadReader>(depth, kPreadThreads);
+    }
+}
+
+/**
+ * @brief Returns the process-wide reader, creating it on first use.
+ */
+AsyncReader& AsyncReader::shared() {
+    static std::unique_ptr<AsyncReader> reader = []() {
+        const char* backend = std::getenv("TRADING_IO_BACKEND");
+        const char* depth = std::getenv("TRADING_IO_DEPTH");
+        size_t parsedDepth = kDefaultDepth;
+        if (depth) {
+            char* end = nullptr;
+            unsigned long value = std::strtoul(depth, &end, 10);
+            if (end != depth && *end == '\0' && value > 0) {
+                parsedDepth = value;
+            } else {
+                std::cerr << "Warning: ignoring invalid TRADING_IO_DEPTH value '" << depth << "'" << std::endl;
+            }
+        }
+        return create(backend ? backend : "auto", parsedDepth);
+    }();
+    return *reader;
+}
+
+} // namespace trading
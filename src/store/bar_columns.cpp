@@ -0,0 +1,211 @@
+#include "store/bar_columns.h"
+#include "utils/placement.h"
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+namespace trading {
+
+namespace {
+    constexpr int64_t kSecondsPerDay = 86400;
+
+    // Days since 1970-01-01 of a proleptic Gregorian date (Howard Hinnant's algorithm)
+    int64_t daysFromCivil(int64_t y, unsigned m, unsigned d) {
+        y -= m <= 2;
+        const int64_t era = (y >= 0 ? y : y - 399) / 400;
+        const unsigned yoe = static_cast<unsigned>(y - era * 400);
+        const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+        const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return era * 146097 + static_cast<int64_t>(doe) - 719468;
+    }
+
+    void civilFromDays(int64_t z, int64_t& y, unsigned& m, unsigned& d) {
+        z += 719468;
+        const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+        const unsigned doe = static_cast<unsigned>(z - era * 146097);
+        const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        const unsigned mp = (5 * doy + 2) / 153;
+        d = doy - (153 * mp + 2) / 5 + 1;
+        m = mp < 10 ? mp + 3 : mp - 9;
+        y = static_cast<int64_t>(yoe) + era * 400 + (m <= 2);
+    }
+
+    int digits(const std::string& text, size_t pos, size_t count) {
+        int value = 0;
+        for (size_t i = pos; i < pos + count; ++i) {
+            if (text[i] < '0' || text[i] > '9') {
+                throw std::invalid_argument("Invalid bar timestamp: " + text);
+            }
+            value = value * 10 + (text[i] - '0');
+        }
+        return value;
+    }
+
+    bool isWeekday(int64_t day) {
+        const int64_t weekday = ((day % 7) + 11) % 7; // 0 = Sunday; 1970-01-01 was a Thursday
+        return weekday != 0 && weekday != 6;
+    }
+}
+
+/**
+ * @brief Reserves room for a number of rows without writing it.
+ *
+ * Large column sets are shared by every strategy run that reads them, so
+ * with TRADING_HUGE_PAGES=1 each column is advised onto transparent huge
+ * pages before its first write.
+ *
+ * @param rows Rows to reserve
+ */
+void BarColumns::reserve(size_t rows) {
+    timestamps.reserve(rows);
+    open.reserve(rows);
+    high.reserve(rows);
+    low.reserve(rows);
+    close.reserve(rows);
+    volume.reserve(rows);
+    adviseHugePages(timestamps.data(), timestamps.capacity() * sizeof(int64_t));
+    adviseHugePages(open.data(), open.capacity() * sizeof(double));
+    adviseHugePages(high.data(), high.capacity() * sizeof(double));
+    adviseHugePages(low.data(), low.capacity() * sizeof(double));
+    adviseHugePages(close.data(), close.capacity() * sizeof(double));
+    adviseHugePages(volume.data(), volume.capacity() * sizeof(int64_t));
+}
+
+void BarColumns::resize(size_t rows) {
+    timestamps.resize(rows);
+    open.resize(rows);
+    high.resize(rows);
+    low.resize(rows);
+    close.resize(rows);
+    volume.resize(rows);
+}
+
+/**
+ * @brief Appends rows [begin, end) of another column set.
+ */
+void BarColumns::append(const BarColumns& other, size_t begin, size_t end) {
+    timestamps.insert(timestamps.end(), other.timestamps.begin() + begin, other.timestamps.begin() + end);
+    open.insert(open.end(), other.open.begin() + begin, other.open.begin() + end);
+    high.insert(high.end(), other.high.begin() + begin, other.high.begin() + end);
+    low.insert(low.end(), other.low.begin() + begin, other.low.begin() + end);
+    close.insert(close.end(), other.close.begin() + begin, other.close.begin() + end);
+    volume.insert(volume.end(), other.volume.begin() + begin, other.volume.begin() + end);
+}
+
+/**
+ * @brief Parses a fetcher timestamp into bar time.
+ *
+ * Only the fixed "YYYY-MM-DD HH:MM:SS" layout is accepted; a bare date
+ * means midnight.
+ *
+ * @param text Timestamp text
+ * @return Seconds since the epoch of the wall-clock time
+ */
+int64_t parseBarTime(const std::string& text) {
+    if ((text.size() != 10 && text.size() != 19) || text[4] != '-' || text[7] != '-') {
+        throw std::invalid_argument("Invalid bar timestamp: " + text);
+    }
+    int month = digits(text, 5, 2);
+    int day = digits(text, 8, 2);
+    if (month < 1 || month > 12 || day < 1 || day > 31) {
+        throw std::invalid_argument("Invalid bar timestamp: " + text);
+    }
+    int64_t seconds = daysFromCivil(digits(text, 0, 4), month, day) * 86400;
+    if (text.size() == 19) {
+        if (text[10] != ' ' || text[13] != ':' || text[16] != ':') {
+            throw std::invalid_argument("Invalid bar timestamp: " + text);
+        }
+        int hour = digits(text, 11, 2);
+        int minute = digits(text, 14, 2);
+        int second = digits(text, 17, 2);
+        if (hour > 23 || minute > 59 || second > 59) {
+            throw std::invalid_argument("Invalid bar timestamp: " + text);
+        }
+        seconds += hour * 3600 + minute * 60 + second;
+    }
+    return seconds;
+}
+
+/**
+ * @brief Formats bar time as "YYYY-MM-DD HH:MM:SS".
+ */
+std::string formatBarTime(int64_t seconds) {
+    int64_t days = seconds >= 0 ? seconds / 86400 : (seconds - 86399) / 86400;
+    int64_t secondOfDay = seconds - days * 86400;
+    int64_t year;
+    unsigned month, day;
+    civilFromDays(days, year, month, day);
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%04lld-%02u-%02u %02lld:%02lld:%02lld",
+                  static_cast<long long>(year), month, day,
+                  static_cast<long long>(secondOfDay / 3600),
+                  static_cast<long long>(secondOfDay / 60 % 60),
+                  static_cast<long long>(secondOfDay % 60));
+    return buffer;
+}
+
+/**
+ * @brief Lists the weekday sessions in a date range.
+ *
+ * Whole weeks are counted arithmetically, so a range of centuries is
+ * refused without building a string for each of its days.
+ *
+ * @param from First date, "YYYY-MM-DD"
+ * @param to Last date, "YYYY-MM-DD"
+ * @param maxSessions Most sessions the caller accepts
+ * @return Session dates in order
+ */
+std::vector<std::string> weekdaySessions(const std::string& from, const std::string& to, size_t maxSessions) {
+    if (from.size() != 10 || to.size() != 10) {
+        throw std::invalid_argument("Session dates must be in YYYY-MM-DD format: " + from + " to " + to);
+    }
+    const int64_t first = parseBarTime(from) / kSecondsPerDay;
+    const int64_t last = parseBarTime(to) / kSecondsPerDay;
+    if (last < first) {
+        throw std::invalid_argument("Session range ends before it starts: " + from + " to " + to);
+    }
+    const int64_t days = last - first + 1;
+    uint64_t count = static_cast<uint64_t>(days / 7) * 5;
+    for (int64_t day = last - days % 7 + 1; day <= last; ++day) {
+        count += isWeekday(day);
+    }
+    if (count == 0) {
+        throw std::invalid_argument("No weekday sessions from " + from + " to " + to);
+    }
+    if (count > maxSessions) {
+        throw std::invalid_argument("The range from " + from + " to " + to + " covers " + std::to_string(count) +
+                                    " weekday sessions; at most " + std::to_string(maxSessions) + " are allowed");
+    }
+
+    std::vector<std::string> dates;
+    dates.reserve(count);
+    for (int64_t day = first; day <= last; ++day) {
+        if (isWeekday(day)) {
+            dates.push_back(formatBarTime(day * kSecondsPerDay).substr(0, 10));
+        }
+    }
+    return dates;
+}
+
+/**
+ * @brief Appends one session's rows of a time-ordered column set.
+ *
+ * Fetcher responses can hold more than the session asked for, and stored
+ * ranges hold several sessions; both are cut to the day this way.
+ *
+ * @param out Columns to append to
+ * @param bars Time-ordered bars
+ * @param date Session date, "YYYY-MM-DD"
+ * @return Rows appended
+ */
+size_t appendSession(BarColumns& out, const BarColumns& bars, const std::string& date) {
+    const int64_t dayStart = parseBarTime(date);
+    const auto& times = bars.timestamps;
+    const auto first = std::lower_bound(times.begin(), times.end(), dayStart);
+    const auto last = std::lower_bound(first, times.end(), dayStart + kSecondsPerDay);
+    out.append(bars, first - times.begin(), last - times.begin());
+    return static_cast<size_t>(last - first);
+}
+
+} // namespace trading
@@ -0,0 +1,459 @@
+#include "store/bar_segment.h"
+#include "store/column_codec.h"
+#include "utils/file_lock.h"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace trading {
+
+namespace {
+    // File layout (native byte order):
+    //   SegmentHeader
+    //   per block: BlockHeader, then timestamp, open, high, low, close, volume columns
+    //   BlockIndexEntry[blockCount]
+    //   SegmentFooter
+    constexpr char kMagic[8] = {'D', 'G', 'B', 'A', 'R', 'S', '0', '2'};
+    constexpr char kFooterMagic[8] = {'D', 'G', 'B', 'A', 'R', 'E', 'N', 'D'};
+    constexpr size_t kColumns = 6;
+
+    struct SegmentHeader {
+        char magic[8];
+        uint32_t blockRows;
+        uint32_t blockCount;
+        uint64_t rowCount;
+    };
+
+    struct BlockHeader {
+        uint32_t rowCount;
+        uint32_t columnBytes[kColumns];
+        uint32_t reserved;
+    };
+
+    struct BlockIndexEntry {
+        uint64_t offset; // of the BlockHeader
+        uint32_t bytes;  // BlockHeader plus columns
+        uint32_t rowCount;
+        int64_t firstTime;
+        int64_t lastTime;
+        uint32_t checksum; // CRC-32 of the block's bytes
+        uint32_t reserved;
+    };
+
+    struct SegmentFooter {
+        int64_t minTime;
+        int64_t maxTime;
+        uint64_t rowCount;
+        uint64_t indexOffset;
+        uint32_t blockCount;
+        uint32_t indexChecksum;
+        char magic[8];
+    };
+
+    // Slicing-by-8 tables for the reflected CRC-32 polynomial
+    using CrcTables = std::array<std::array<uint32_t, 256>, 8>;
+
+    const CrcTables& crcTables() {
+        static const CrcTables tables = []() {
+            CrcTables t{};
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; ++k) {
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                }
+                t[0][i] = c;
+            }
+            for (uint32_t i = 0; i < 256; ++i) {
+                for (size_t k = 1; k < 8; ++k) {
+                    t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFF];
+                }
+            }
+            return t;
+        }();
+        return tables;
+    }
+
+    uint32_t crc32(const uint8_t* data, size_t length) {
+        const CrcTables& t = crcTables();
+        uint32_t c = 0xFFFFFFFFu;
+        while (length >= 8) {
+            uint32_t lo;
+            uint32_t hi;
+            std::memcpy(&lo, data, 4);
+            std::memcpy(&hi, data + 4, 4);
+            lo ^= c;
+            c = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+                t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+            data += 8;
+            length -= 8;
+        }
+        while (length-- > 0) {
+            c = t[0][(c ^ *data++) & 0xFF] ^ (c >> 8);
+        }
+        return c ^ 0xFFFFFFFFu;
+    }
+
+    template <typename T>
+    void append(std::string& out, const T& value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    [[noreturn]] void corrupt(const std::string& detail) {
+        throw std::runtime_error("BarSegment: corrupt segment (" + detail + ")");
+    }
+
+    // Footer and index of a segment after bounds checking
+    struct SegmentIndex {
+        SegmentFooter footer;
+        const BlockIndexEntry* blocks;
+    };
+
+    SegmentIndex readIndex(const uint8_t* data, size_t length) {
+        if (length < sizeof(SegmentHeader) + sizeof(SegmentFooter) ||
+            std::memcmp(data, kMagic, sizeof(kMagic)) != 0) {
+            corrupt("bad header");
+        }
+        SegmentIndex index;
+        std::memcpy(&index.footer, data + length - sizeof(SegmentFooter), sizeof(SegmentFooter));
+        const SegmentFooter& footer = index.footer;
+        size_t indexBytes = static_cast<size_t>(footer.blockCount) * sizeof(BlockIndexEntry);
+        if (std::memcmp(footer.magic, kFooterMagic, sizeof(kFooterMagic)) != 0 ||
+            footer.indexOffset < sizeof(SegmentHeader) || footer.indexOffset % 8 != 0 ||
+            footer.indexOffset > length - sizeof(SegmentFooter) ||
+            indexBytes != length - sizeof(SegmentFooter) - footer.indexOffset) {
+            corrupt("bad footer");
+        }
+        index.blocks = reinterpret_cast<const BlockIndexEntry*>(data + footer.indexOffset);
+        if (crc32(data + footer.indexOffset, indexBytes) != footer.indexChecksum) {
+            corrupt("index checksum mismatch");
+        }
+        uint64_t rows = 0;
+        for (uint32_t b = 0; b < footer.blockCount; ++b) {
+            const BlockIndexEntry& entry = index.blocks[b];
+            if (entry.offset < sizeof(SegmentHeader) || entry.offset > footer.indexOffset ||
+                entry.bytes < sizeof(BlockHeader) || entry.bytes > footer.indexOffset - entry.offset ||
+                entry.rowCount > BarSegment::kBlockRows) {
+                corrupt("block index");
+            }
+            rows += entry.rowCount;
+        }
+        // The footer's summary is not checksummed; it must agree with the index
+        if (rows != footer.rowCount ||
+            (footer.blockCount > 0 && (footer.minTime != index.blocks[0].firstTime ||
+                                       footer.maxTime != index.blocks[footer.blockCount - 1].lastTime))) {
+            corrupt("bad footer");
+        }
+        return index;
+    }
+
+    // Verifies and decodes one block, appending its rows [skip, skip + take) to `out`
+    void decodeBlock(const uint8_t* data, const BlockIndexEntry& entry, size_t skip, size_t take, BarColumns& out) {
+        const uint8_t* blockData = data + entry.offset;
+        if (crc32(blockData, entry.bytes) != entry.checksum) {
+            corrupt("block checksum mismatch");
+        }
+        BlockHeader block;
+        std::memcpy(&block, blockData, sizeof(block));
+        size_t columnTotal = 0;
+        for (size_t c = 0; c < kColumns; ++c) {
+            columnTotal += block.columnBytes[c];
+        }
+        if (block.rowCount != entry.rowCount || sizeof(BlockHeader) + columnTotal != entry.bytes ||
+            skip + take > block.rowCount) {
+            corrupt("block header");
+        }
+
+        size_t n = block.rowCount;
+        BarColumns decoded;
+        BarColumns& target = (skip == 0 && take == n) ? out : decoded;
+        size_t base = target.size();
+        target.resize(base + n);
+
+        const uint8_t* column = blockData + sizeof(BlockHeader);
+        decodeTimestamps(column, block.columnBytes[0], target.timestamps.data() + base, n);
+        column += block.columnBytes[0];
+        decodeFloats(column, block.columnBytes[1], target.open.data() + base, n);
+        column += block.columnBytes[1];
+        decodeFloats(column, block.columnBytes[2], target.high.data() + base, n);
+        column += block.columnBytes[2];
+        decodeFloats(column, block.columnBytes[3], target.low.data() + base, n);
+        column += block.columnBytes[3];
+        decodeFloats(column, block.columnBytes[4], target.close.data() + base, n);
+        column += block.columnBytes[4];
+        decodeIntegers(column, block.columnBytes[5], target.volume.data() + base, n);
+
+        if (&target == &decoded) {
+            out.append(decoded, skip, skip + take);
+        }
+    }
+
+    void decodeBlocks(const uint8_t* data, const BlockIndexEntry* blocks, uint32_t blockCount,
+                      int64_t from, int64_t to, BarColumns& out) {
+        // First block whose last bar is at or after `from`
+        const BlockIndexEntry* first = std::lower_bound(blocks, blocks + blockCount, from,
+            [](const BlockIndexEntry& entry, int64_t t) { return entry.lastTime < t; });
+        for (const BlockIndexEntry* it = first; it != blocks + blockCount; ++it) {
+            const BlockIndexEntry& entry = *it;
+            if (entry.firstTime > to) {
+                break;
+            }
+            if (entry.firstTime >= from && entry.lastTime <= to) {
+                decodeBlock(data, entry, 0, entry.rowCount, out);
+                continue;
+            }
+            // Partially covered block: decode it, then keep the rows inside the range
+            BarColumns block;
+            decodeBlock(data, entry, 0, entry.rowCount, block);
+            auto first = std::lower_bound(block.timestamps.begin(), block.timestamps.end(), from);
+            auto last = std::upper_bound(block.timestamps.begin(), block.timestamps.end(), to);
+            if (first < last) {
+                out.append(block, first - block.timestamps.begin(), last - block.timestamps.begin());
+            }
+        }
+    }
+}
+
+/**
+ * @brief Encodes bars into the segment format.
+ *
+ * @param bars Bars in time order
+ * @return The encoded segment
+ * @throws std::invalid_argument if the timestamps are not in ascending order
+ */
+std::string BarSegment::encode(const BarColumns& bars) {
+    const size_t rows = bars.size();
+    if (!std::is_sorted(bars.timestamps.begin(), bars.timestamps.end())) {
+        throw std::invalid_argument("BarSegment: bars must be in time order");
+    }
+    SegmentHeader header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.blockRows = kBlockRows;
+    header.blockCount = static_cast<uint32_t>((rows + kBlockRows - 1) / kBlockRows);
+    header.rowCount = rows;
+
+    std::string out;
+    out.reserve(sizeof(header) + rows * 12);
+    append(out, header);
+
+    std::vector<BlockIndexEntry> index;
+    std::string columns[kColumns];
+    for (size_t begin = 0; begin < rows; begin += kBlockRows) {
+        size_t count = std::min<size_t>(kBlockRows, rows - begin);
+        for (auto& column : columns) {
+            column.clear();
+        }
+        encodeTimestamps(bars.timestamps.data() + begin, count, columns[0]);
+        encodeFloats(bars.open.data() + begin, count, columns[1]);
+        encodeFloats(bars.high.data() + begin, count, columns[2]);
+        encodeFloats(bars.low.data() + begin, count, columns[3]);
+        encodeFloats(bars.close.data() + begin, count, columns[4]);
+        encodeIntegers(bars.volume.data() + begin, count, columns[5]);
+
+        size_t blockOffset = out.size();
+        BlockHeader block = {};
+        block.rowCount = static_cast<uint32_t>(count);
+        for (size_t c = 0; c < kColumns; ++c) {
+            block.columnBytes[c] = static_cast<uint32_t>(columns[c].size());
+        }
+        append(out, block);
+        for (const auto& column : columns) {
+            out += column;
+        }
+
+        BlockIndexEntry entry = {};
+        entry.offset = blockOffset;
+        entry.bytes = static_cast<uint32_t>(out.size() - blockOffset);
+        entry.rowCount = static_cast<uint32_t>(count);
+        entry.firstTime = bars.timestamps[begin];
+        entry.lastTime = bars.timestamps[begin + count - 1];
+        entry.checksum = crc32(reinterpret_cast<const uint8_t*>(out.data()) + blockOffset, entry.bytes);
+        index.push_back(entry);
+    }
+
+    out.resize((out.size() + 7) & ~size_t(7), '\0');
+    SegmentFooter footer = {};
+    footer.minTime = rows ? bars.timestamps.front() : 0;
+    footer.maxTime = rows ? bars.timestamps.back() : -1;
+    footer.rowCount = rows;
+    footer.indexOffset = out.size();
+    footer.blockCount = static_cast<uint32_t>(index.size());
+    footer.indexChecksum = crc32(reinterpret_cast<const uint8_t*>(index.data()), index.size() * sizeof(BlockIndexEntry));
+    std::memcpy(footer.magic, kFooterMagic, sizeof(kFooterMagic));
+    out.append(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(BlockIndexEntry));
+    append(out, footer);
+    return out;
+}
+
+/**
+ * @brief Decodes a whole segment, verifying every checksum.
+ *
+ * @param data Segment bytes
+ * @param length Segment size in bytes
+ * @return The decoded bars
+ * @throws std::runtime_error if the segment is malformed
+ */
+BarColumns BarSegment::decode(const uint8_t* data, size_t length) {
+    SegmentIndex index = readIndex(data, length);
+    BarColumns bars;
+    if (index.footer.rowCount <= static_cast<uint64_t>(index.footer.blockCount) * kBlockRows) {
+        bars.reserve(index.footer.rowCount);
+    }
+    decodeBlocks(data, index.blocks, index.footer.blockCount, INT64_MIN, INT64_MAX, bars);
+    if (bars.size() != index.footer.rowCount) {
+        corrupt("row count");
+    }
+    return bars;
+}
+
+/**
+ * @brief Decodes the bars of a time range from segment bytes already in memory.
+ *
+ * Used when the file was read by other means than open(), such as a batched
+ * asynchronous read. Only blocks overlapping the range are checksummed and decoded.
+ *
+ * @param data Segment bytes
+ * @param length Segment size in bytes
+ * @param from First timestamp to include
+ * @param to Last timestamp to include
+ * @param out Receives the bars
+ * @throws std::runtime_error if the segment is malformed
+ */
+void BarSegment::decodeRange(const uint8_t* data, size_t length, int64_t from, int64_t to, BarColumns& out) {
+    SegmentIndex index = readIndex(data, length);
+    if (from <= to) {
+        decodeBlocks(data, index.blocks, index.footer.blockCount, from, to, out);
+    }
+}
+
+/**
+ * @brief Encodes bars and publishes them as a segment file.
+ *
+ * @param path Destination path
+ * @param bars Bars in time order
+ */
+void BarSegment::write(const std::string& path, const BarColumns& bars) {
+    const std::string encoded = encode(bars);
+    publishFile(path, "BarSegment", [&](FILE* file) {
+        return std::fwrite(encoded.data(), 1, encoded.size(), file) == encoded.size();
+    });
+}
+
+/**
+ * @brief Reads and decodes a whole segment file.
+ *
+ * @param path Segment file path
+ * @return The decoded bars
+ * @throws std::runtime_error if the file cannot be read or is malformed
+ */
+BarColumns BarSegment::read(const std::string& path) {
+    return open(path)->readRange(INT64_MIN, INT64_MAX);
+}
+
+BarSegment::BarSegment(const uint8_t* data, size_t size)
+    : data(data)
+    , size(size)
+    , firstTime(0)
+    , lastTime(-1)
+    , rows(0)
+    , blocks(0)
+    , indexOffset(0)
+{
+}
+
+BarSegment::~BarSegment() {
+    munmap(const_cast<uint8_t*>(data), size);
+}
+
+/**
+ * @brief Memory-maps a segment file.
+ *
+ * Only the footer and block index are validated here. Blocks are checked
+ * against their checksums when a range read decodes them, so opening a
+ * segment costs the same regardless of its size.
+ *
+ * @param path Segment file path
+ * @return The mapped segment
+ * @throws std::runtime_error if the file cannot be mapped or its footer is invalid
+ */
+std::shared_ptr<const BarSegment> BarSegment::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("BarSegment: cannot open " + path + ": " + std::strerror(errno));
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        int err = errno;
+        close(fd);
+        throw std::runtime_error("BarSegment: cannot stat " + path + ": " + std::strerror(err));
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    if (size == 0) {
+        close(fd);
+        corrupt("empty file " + path);
+    }
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        throw std::runtime_error("BarSegment: cannot map " + path + ": " + std::strerror(errno));
+    }
+    // Owns the mapping from here on, so a corrupt footer unmaps it on throw
+    std::shared_ptr<BarSegment> segment(new BarSegment(static_cast<const uint8_t*>(mapped), size));
+    SegmentIndex index;
+    try {
+        index = readIndex(segment->data, size);
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error(std::string(e.what()) + " in " + path);
+    }
+    segment->firstTime = index.footer.minTime;
+    segment->lastTime = index.footer.maxTime;
+    segment->rows = index.footer.rowCount;
+    segment->blocks = index.footer.blockCount;
+    segment->indexOffset = index.footer.indexOffset;
+    madvise(mapped, size, MADV_RANDOM);
+    return segment;
+}
+
+/**
+ * @brief Asks the kernel to read the whole mapping in the background.
+ *
+ * Segments are mapped for random access, which turns readahead off. A
+ * caller about to stream the whole file calls this first, so the pages
+ * are already cached by the time they are sent.
+ */
+void BarSegment::willNeed() const {
+    madvise(const_cast<uint8_t*>(data), size, MADV_WILLNEED);
+}
+
+BarColumns BarSegment::readRange(int64_t from, int64_t to) const {
+    BarColumns bars;
+    readRange(from, to, bars);
+    return bars;
+}
+
+/**
+ * @brief Appends the bars with from <= timestamp <= to.
+ *
+ * The first block is found by binary search over the block index. Only
+ * blocks overlapping the range are touched, and each is checksummed before
+ * it is decoded.
+ *
+ * @param from First timestamp to include
+ * @param to Last timestamp to include
+ * @param out Receives the bars
+ * @throws std::runtime_error if a touched block is corrupt
+ */
+void BarSegment::readRange(int64_t from, int64_t to, BarColumns& out) const {
+    if (from > to) {
+        return;
+    }
+    decodeBlocks(data, reinterpret_cast<const BlockIndexEntry*>(data + indexOffset), blocks, from, to, out);
+}
+
+} // namespace trading
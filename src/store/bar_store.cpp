@@ -0,0 +1,351 @@
+#include "store/bar_store.h"
+#include "store/async_reader.h"
+#include "store/bar_segment.h"
+#include "utils/file_lock.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace trading {
+
+namespace {
+    // MANIFEST layout (native byte order): ManifestHeader, then
+    // ManifestEntry[count] sorted by minTime. Sessions never overlap, so the
+    // entries are sorted by maxTime as well.
+    constexpr char kManifestMagic[8] = {'D', 'G', 'M', 'A', 'N', 'I', '0', '1'};
+
+    struct ManifestHeader {
+        char magic[8];
+        uint64_t count;
+    };
+
+    struct ManifestEntry {
+        int64_t minTime;
+        int64_t maxTime;
+        uint64_t rowCount;
+        char date[16];
+    };
+
+    // fcntl locks are per process, so threads take this before the manifest lock
+    std::mutex manifestMutex;
+
+    std::vector<SegmentInfo> loadManifest(const std::string& path) {
+        std::vector<SegmentInfo> entries;
+        FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file) {
+            return entries;
+        }
+        ManifestHeader header;
+        bool ok = std::fread(&header, sizeof(header), 1, file) == 1 &&
+                  std::memcmp(header.magic, kManifestMagic, sizeof(kManifestMagic)) == 0;
+        std::vector<ManifestEntry> raw;
+        if (ok && header.count < (1u << 24)) {
+            raw.resize(header.count);
+            ok = std::fread(raw.data(), sizeof(ManifestEntry), raw.size(), file) == raw.size();
+        } else {
+            ok = false;
+        }
+        std::fclose(file);
+        if (!ok) {
+            throw std::runtime_error("BarStore: corrupt manifest " + path);
+        }
+        entries.reserve(raw.size());
+        for (const auto& entry : raw) {
+            entries.push_back({std::string(entry.date, strnlen(entry.date, sizeof(entry.date))),
+                               entry.minTime, entry.maxTime, entry.rowCount});
+        }
+        return entries;
+    }
+
+    void saveManifest(const std::string& path, const std::vector<SegmentInfo>& entries) {
+        ManifestHeader header = {};
+        std::memcpy(header.magic, kManifestMagic, sizeof(kManifestMagic));
+        header.count = entries.size();
+        std::vector<ManifestEntry> raw(entries.size());
+        for (size_t i = 0; i < entries.size(); ++i) {
+            raw[i] = {entries[i].minTime, entries[i].maxTime, entries[i].rowCount, {}};
+            std::strncpy(raw[i].date, entries[i].date.c_str(), sizeof(raw[i].date) - 1);
+        }
+
+        publishFile(path, "BarStore", [&](FILE* file) {
+            return std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   std::fwrite(raw.data(), sizeof(ManifestEntry), raw.size(), file) == raw.size();
+        });
+    }
+}
+
+std::string pathComponent(const std::string& name) {
+    std::string safe;
+    for (char c : name) {
+        bool allowed = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                       (c >= '0' && c <= '9') || c == '-' || c == '.' || c == '^' || c == '=';
+        safe += allowed ? c : '_';
+    }
+    if (safe.empty() || safe == "." || safe == "..") {
+        throw std::invalid_argument("invalid name '" + name + "'");
+    }
+    return safe;
+}
+
+/**
+ * @brief Constructor for the bar store.
+ *
+ * @param root Root directory; empty disables the store
+ */
+BarStore::BarStore(std::string root) : root(std::move(root)) {
+    while (this->root.size() > 1 && this->root.back() == '/') {
+        this->root.pop_back();
+    }
+}
+
+BarStore BarStore::fromEnvironment() {
+    const char* dir = std::getenv("TRADING_BAR_STORE_DIR");
+    return BarStore(dir ? dir : "");
+}
+
+std::string BarStore::directoryFor(const std::string& symbol, const std::string& interval) const {
+    return root + "/" + pathComponent(symbol) + "/" + pathComponent(interval);
+}
+
+std::string BarStore::pathFor(const std::string& symbol, const std::string& interval, const std::string& date) const {
+    return directoryFor(symbol, interval) + "/" + pathComponent(date) + ".seg";
+}
+
+/**
+ * @brief Writes one session's bars as a segment, replacing any previous one.
+ *
+ * @param symbol Ticker symbol
+ * @param interval Bar interval
+ * @param date Session date in YYYY-MM-DD format
+ * @param bars Bars in time order
+ */
+void BarStore::put(const std::string& symbol, const std::string& interval, const std::string& date,
+                   const BarColumns& bars) const {
+    if (!enabled()) {
+        return;
+    }
+    const std::string directory = directoryFor(symbol, interval);
+    makeDirectory(directory, "BarStore");
+    BarSegment::write(pathFor(symbol, interval, date), bars);
+    if (bars.size() > 0) {
+        updateManifest(directory, {pathComponent(date), bars.timestamps.front(), bars.timestamps.back(), bars.size()});
+    }
+}
+
+/**
+ * @brief Adds or replaces a segment's manifest entry.
+ *
+ * The read-modify-write runs under the directory's manifest lock, and the
+ * new manifest is published with rename(), so concurrent writers in other
+ * processes never lose entries and readers never see a torn file.
+ *
+ * @param directory Symbol and interval directory
+ * @param info Entry for the segment just written
+ */
+void BarStore::updateManifest(const std::string& directory, const SegmentInfo& info) const {
+    std::lock_guard<std::mutex> guard(manifestMutex);
+    FileLock lock(directory + "/MANIFEST.lock");
+
+    const std::string path = directory + "/MANIFEST";
+    std::vector<SegmentInfo> entries = loadManifest(path);
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                 [&info](const SegmentInfo& entry) { return entry.date == info.date; }),
+                  entries.end());
+    entries.push_back(info);
+    std::sort(entries.begin(), entries.end(),
+              [](const SegmentInfo& a, const SegmentInfo& b) { return a.minTime < b.minTime; });
+    saveManifest(path, entries);
+}
+
+std::vector<SegmentInfo> BarStore::manifest(const std::string& symbol, const std::string& interval) const {
+    if (!enabled()) {
+        return {};
+    }
+    return loadManifest(directoryFor(symbol, interval) + "/MANIFEST");
+}
+
+/**
+ * @brief Opens the segments overlapping a time range.
+ *
+ * The first overlapping segment is found by binary search over the
+ * manifest, and segments are opened in order until one starts after the
+ * range. Each returned segment maps the file it was opened from, so a
+ * segment replaced afterwards does not change what the caller sees.
+ *
+ * @param symbol Ticker symbol
+ * @param interval Bar interval
+ * @param from First bar time of the range
+ * @param to Last bar time of the range
+ * @return The segments in time order; empty if nothing is stored for the range
+ * @throws std::runtime_error if a listed segment is missing or corrupt
+ */
+std::vector<std::shared_ptr<const BarSegment>> BarStore::openRange(const std::string& symbol,
+                                                                   const std::string& interval,
+                                                                   int64_t from, int64_t to) const {
+    std::vector<std::shared_ptr<const BarSegment>> segments;
+    if (!enabled() || from > to) {
+        return segments;
+    }
+    std::vector<SegmentInfo> entries = manifest(symbol, interval);
+    auto first = std::lower_bound(entries.begin(), entries.end(), from,
+                                  [](const SegmentInfo& entry, int64_t t) { return entry.maxTime < t; });
+    for (auto it = first; it != entries.end() && it->minTime <= to; ++it) {
+        segments.push_back(BarSegment::open(pathFor(symbol, interval, it->date)));
+    }
+    return segments;
+}
+
+/**
+ * @brief Reads the bars of a time range across sessions.
+ *
+ * Each overlapping segment seeks to its overlapping blocks via its footer.
+ *
+ * @param symbol Ticker symbol
+ * @param interval Bar interval
+ * @param from First bar time to include
+ * @param to Last bar time to include
+ * @return The bars in time order; empty if nothing is stored for the range
+ */
+BarColumns BarStore::readRange(const std::string& symbol, const std::string& interval,
+                               int64_t from, int64_t to) const {
+    std::vector<std::shared_ptr<const BarSegment>> segments = openRange(symbol, interval, from, to);
+    uint64_t rows = 0;
+    for (const auto& segment : segments) {
+        rows += segment->rowCount();
+    }
+    BarColumns bars;
+    bars.reserve(rows);
+    for (const auto& segment : segments) {
+        segment->readRange(from, to, bars);
+    }
+    return bars;
+}
+
+/**
+ * @brief Reads one session's bars.
+ *
+ * @return The bars, or std::nullopt if the store has no segment for the session
+ * @throws std::runtime_error if the segment exists but is corrupt
+ */
+std::optional<BarColumns> BarStore::get(const std::string& symbol, const std::string& interval,
+                                        const std::string& date) const {
+    if (!enabled()) {
+        return std::nullopt;
+    }
+    std::string path = pathFor(symbol, interval, date);
+    if (access(path.c_str(), F_OK) != 0) {
+        return std::nullopt;
+    }
+    return BarSegment::read(path);
+}
+
+/**
+ * @brief Reads many time ranges with batched asynchronous I/O.
+ *
+ * Manifests are consulted first to list every overlapping segment. All
+ * segment files are then read in a single AsyncReader batch, so a scan
+ * over hundreds of symbols keeps the device busy without a thread per read.
+ * Segments are decoded on completion, directly into their result when
+ * they complete in time order.
+ *
+ * @param queries Ranges to read
+ * @return One column set per query, in query order
+ * @throws std::runtime_error if a segment cannot be read or is corrupt
+ */
+std::vector<BarColumns> BarStore::readRanges(const std::vector<RangeQuery>& queries) const {
+    std::vector<BarColumns> results(queries.size());
+    if (!enabled()) {
+        return results;
+    }
+
+    struct Part {
+        size_t query;
+        std::string path;
+        int fd;
+        BarColumns bars;
+    };
+    std::vector<Part> parts;
+    std::vector<ReadRequest> requests;
+    auto closeAll = [&parts]() {
+        for (auto& part : parts) {
+            if (part.fd >= 0) {
+                close(part.fd);
+            }
+        }
+    };
+
+    try {
+        for (size_t q = 0; q < queries.size(); ++q) {
+            const RangeQuery& query = queries[q];
+            if (query.from > query.to) {
+                continue;
+            }
+            std::vector<SegmentInfo> entries = manifest(query.symbol, query.interval);
+            auto first = std::lower_bound(entries.begin(), entries.end(), query.from,
+                                          [](const SegmentInfo& entry, int64_t t) { return entry.maxTime < t; });
+            uint64_t rows = 0;
+            for (auto it = first; it != entries.end() && it->minTime <= query.to; ++it) {
+                rows += it->rowCount;
+            }
+            results[q].reserve(rows);
+            for (auto it = first; it != entries.end() && it->minTime <= query.to; ++it) {
+                std::string path = pathFor(query.symbol, query.interval, it->date);
+                int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+                if (fd < 0) {
+                    throw std::runtime_error("BarStore: cannot open " + path + ": " + std::strerror(errno));
+                }
+                parts.push_back({q, path, fd, {}});
+                struct stat st;
+                if (fstat(fd, &st) != 0) {
+                    throw std::runtime_error("BarStore: cannot stat " + path + ": " + std::strerror(errno));
+                }
+                requests.push_back({fd, 0, static_cast<size_t>(st.st_size)});
+            }
+        }
+
+        // Parts of a query are listed in time order. A part that completes in
+        // order is decoded straight into the result; one that completes early
+        // is decoded aside and appended once the parts before it are in.
+        std::vector<size_t> nextPart(queries.size(), parts.size());
+        for (size_t i = parts.size(); i-- > 0;) {
+            nextPart[parts[i].query] = i;
+        }
+        std::vector<bool> done(parts.size(), false);
+
+        AsyncReader::shared().readBatch(requests, [&](size_t index, const uint8_t* data, size_t length, int error) {
+            Part& part = parts[index];
+            if (error != 0) {
+                throw std::runtime_error("BarStore: reading " + part.path + " failed: " + std::strerror(error));
+            }
+            const RangeQuery& query = queries[part.query];
+            BarColumns& result = results[part.query];
+            if (index != nextPart[part.query]) {
+                BarSegment::decodeRange(data, length, query.from, query.to, part.bars);
+                done[index] = true;
+                return;
+            }
+            BarSegment::decodeRange(data, length, query.from, query.to, result);
+            size_t next = index + 1;
+            while (next < parts.size() && parts[next].query == part.query && done[next]) {
+                result.append(parts[next].bars, 0, parts[next].bars.size());
+                parts[next].bars = BarColumns();
+                next++;
+            }
+            nextPart[part.query] = next;
+        });
+    } catch (...) {
+        closeAll();
+        throw;
+    }
+    closeAll();
+    return results;
+}
+
+} // namespace trading
@@ -0,0 +1,291 @@
+#include "store/column_codec.h"
+#include <cstring>
+#include <stdexcept>
+
+namespace trading {
+
+namespace {
+    uint64_t zigzag(int64_t v) {
+        return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+    }
+
+    int64_t unzigzag(uint64_t v) {
+        return static_cast<int64_t>((v >> 1) ^ (~(v & 1) + 1));
+    }
+
+    void putVarint(uint64_t v, std::string& out) {
+        while (v >= 0x80) {
+            out.push_back(static_cast<char>(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back(static_cast<char>(v));
+    }
+
+    [[noreturn]] void truncated(const char* column) {
+        throw std::runtime_error(std::string("Corrupt ") + column + " column");
+    }
+
+    // Decodes `count` zigzag varints into signed values. The fast path runs
+    // while a full 10-byte varint is guaranteed to be in bounds; the common
+    // one-byte case is a single compare and branch.
+    void decodeVarints(const uint8_t* p, size_t length, int64_t* values, size_t count, const char* column) {
+        const uint8_t* end = p + length;
+        size_t i = 0;
+        while (i < count && end - p >= 10) {
+            uint64_t b = *p++;
+            if (b < 0x80) {
+                values[i++] = unzigzag(b);
+                continue;
+            }
+            uint64_t v = b & 0x7f;
+            for (unsigned shift = 7;; shift += 7) {
+                b = *p++;
+                v |= (b & 0x7f) << shift;
+                if (b < 0x80) {
+                    break;
+                }
+                if (shift >= 63) {
+                    truncated(column);
+                }
+            }
+            values[i++] = unzigzag(v);
+        }
+        while (i < count) {
+            uint64_t v = 0;
+            for (unsigned shift = 0;; shift += 7) {
+                if (p == end || shift > 63) {
+                    truncated(column);
+                }
+                uint64_t b = *p++;
+                v |= (b & 0x7f) << shift;
+                if (b < 0x80) {
+                    break;
+                }
+            }
+            values[i++] = unzigzag(v);
+        }
+        if (p != end) {
+            truncated(column);
+        }
+    }
+
+    // MSB-first bit packing into a byte string
+    class BitWriter {
+    public:
+        explicit BitWriter(std::string& out) : out(out), acc(0), fill(0) {}
+
+        void write(uint64_t value, unsigned bits) {
+            if (bits > 32) {
+                write(value >> 32, bits - 32);
+                value &= 0xffffffffULL;
+                bits = 32;
+            }
+            acc = (acc << bits) | (value & ((1ULL << bits) - 1));
+            fill += bits;
+            while (fill >= 8) {
+                fill -= 8;
+                out.push_back(static_cast<char>(acc >> fill));
+            }
+        }
+
+        void flush() {
+            if (fill > 0) {
+                out.push_back(static_cast<char>(acc << (8 - fill)));
+                fill = 0;
+            }
+        }
+
+    private:
+        std::string& out;
+        uint64_t acc;
+        unsigned fill;
+    };
+
+    // Reads MSB-first bits, refilling a 64-bit window a byte at a time
+    class BitReader {
+    public:
+        BitReader(const uint8_t* data, size_t length) : p(data), end(data + length), acc(0), fill(0) {}
+
+        uint64_t read(unsigned bits) {
+            if (bits > 32) {
+                uint64_t high = read(bits - 32);
+                return (high << 32) | read(32);
+            }
+            if (fill < bits) {
+                refill();
+                if (fill < bits) {
+                    truncated("price");
+                }
+            }
+            fill -= bits;
+            return (acc >> fill) & ((1ULL << bits) - 1);
+        }
+
+    private:
+        void refill() {
+            while (fill <= 56 && p < end) {
+                acc = (acc << 8) | *p++;
+                fill += 8;
+            }
+        }
+
+        const uint8_t* p;
+        const uint8_t* end;
+        uint64_t acc;
+        unsigned fill;
+    };
+
+    uint64_t bitsOf(double v) {
+        uint64_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        return bits;
+    }
+
+    double doubleOf(uint64_t bits) {
+        double v;
+        std::memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+}
+
+/**
+ * @brief Encodes timestamps as zigzag varints of their second differences.
+ *
+ * The first value is stored as is; after that each entry is the change in
+ * the gap between bars, which is zero for evenly spaced bars.
+ */
+void encodeTimestamps(const int64_t* values, size_t count, std::string& out) {
+    int64_t previous = 0;
+    int64_t previousDelta = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (i == 0) {
+            putVarint(zigzag(values[0]), out);
+        } else {
+            int64_t delta = values[i] - previous;
+            putVarint(zigzag(delta - previousDelta), out);
+            previousDelta = delta;
+        }
+        previous = values[i];
+    }
+}
+
+/**
+ * @brief Decodes timestamps written by encodeTimestamps.
+ *
+ * Varints are decoded into the output first, then two prefix sums restore
+ * the deltas and the timestamps. Each pass is a tight loop over the block.
+ */
+void decodeTimestamps(const uint8_t* data, size_t length, int64_t* values, size_t count) {
+    decodeVarints(data, length, values, count, "timestamp");
+    int64_t delta = 0;
+    for (size_t i = 1; i < count; ++i) {
+        delta += values[i];
+        values[i] = delta;
+    }
+    for (size_t i = 1; i < count; ++i) {
+        values[i] += values[i - 1];
+    }
+}
+
+/**
+ * @brief Encodes doubles with Gorilla XOR compression.
+ *
+ * The first value is stored raw. After that each value is XORed with its
+ * predecessor: '0' for no change, '10' plus the meaningful bits if they fit
+ * the previous leading/trailing-zero window, or '11', a 5-bit leading-zero
+ * count, a 6-bit length and the meaningful bits otherwise.
+ */
+void encodeFloats(const double* values, size_t count, std::string& out) {
+    if (count == 0) {
+        return;
+    }
+    BitWriter writer(out);
+    uint64_t previous = bitsOf(values[0]);
+    writer.write(previous, 64);
+    unsigned windowLeading = 65; // no window yet
+    unsigned windowTrailing = 0;
+    for (size_t i = 1; i < count; ++i) {
+        uint64_t current = bitsOf(values[i]);
+        uint64_t x = current ^ previous;
+        previous = current;
+        if (x == 0) {
+            writer.write(0, 1);
+            continue;
+        }
+        unsigned leading = static_cast<unsigned>(__builtin_clzll(x));
+        unsigned trailing = static_cast<unsigned>(__builtin_ctzll(x));
+        if (leading > 31) {
+            leading = 31;
+        }
+        if (windowLeading <= 64 && leading >= windowLeading && trailing >= windowTrailing) {
+            writer.write(0b10, 2);
+            writer.write(x >> windowTrailing, 64 - windowLeading - windowTrailing);
+        } else {
+            unsigned significant = 64 - leading - trailing;
+            writer.write(0b11, 2);
+            writer.write(leading, 5);
+            writer.write(significant & 63, 6); // 64 is stored as 0
+            writer.write(x >> trailing, significant);
+            windowLeading = leading;
+            windowTrailing = trailing;
+        }
+    }
+    writer.flush();
+}
+
+/**
+ * @brief Decodes doubles written by encodeFloats.
+ */
+void decodeFloats(const uint8_t* data, size_t length, double* values, size_t count) {
+    if (count == 0) {
+        if (length != 0) {
+            truncated("price");
+        }
+        return;
+    }
+    BitReader reader(data, length);
+    uint64_t previous = reader.read(64);
+    values[0] = doubleOf(previous);
+    unsigned windowLeading = 0;
+    unsigned windowSignificant = 64;
+    for (size_t i = 1; i < count; ++i) {
+        if (reader.read(1) != 0) {
+            if (reader.read(1) != 0) {
+                windowLeading = static_cast<unsigned>(reader.read(5));
+                windowSignificant = static_cast<unsigned>(reader.read(6));
+                if (windowSignificant == 0) {
+                    windowSignificant = 64;
+                }
+                if (windowLeading + windowSignificant > 64) {
+                    truncated("price");
+                }
+            }
+            unsigned trailing = 64 - windowLeading - windowSignificant;
+            previous ^= reader.read(windowSignificant) << trailing;
+        }
+        values[i] = doubleOf(previous);
+    }
+}
+
+/**
+ * @brief Encodes integers as zigzag varints of their first differences.
+ */
+void encodeIntegers(const int64_t* values, size_t count, std::string& out) {
+    uint64_t previous = 0;
+    for (size_t i = 0; i < count; ++i) {
+        putVarint(zigzag(static_cast<int64_t>(static_cast<uint64_t>(values[i]) - previous)), out);
+        previous = static_cast<uint64_t>(values[i]);
+    }
+}
+
+/**
+ * @brief Decodes integers written by encodeIntegers with one prefix sum.
+ */
+void decodeIntegers(const uint8_t* data, size_t length, int64_t* values, size_t count) {
+    decodeVarints(data, length, values, count, "volume");
+    for (size_t i = 1; i < count; ++i) {
+        values[i] = static_cast<int64_t>(static_cast<uint64_t>(values[i]) + static_cast<uint64_t>(values[i - 1]));
+    }
+}
+
+} // namespace trading
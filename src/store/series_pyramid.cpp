@@ -0,0 +1,181 @@
+#include "store/series_pyramid.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace trading {
+
+namespace {
+    PyramidBucket combine(const PyramidBucket& a, const PyramidBucket& b) {
+        return {a.first, b.last, std::min(a.min, b.min), std::max(a.max, b.max)};
+    }
+
+    size_t floorLog2(size_t n) {
+        size_t level = 0;
+        while (n >>= 1) {
+            level++;
+        }
+        return level;
+    }
+}
+
+/**
+ * @brief Builds every level of the pyramid.
+ *
+ * Level 1 pairs raw points and each higher level pairs buckets of the one
+ * below, so building is O(n) per series. A trailing run shorter than a
+ * level's bucket is left out of that level; queries cover it from lower
+ * levels.
+ *
+ * @throws std::invalid_argument if a series' length differs from the timestamps'
+ */
+SeriesPyramid::SeriesPyramid(std::vector<int64_t> timestamps,
+                             std::vector<std::pair<std::string, std::vector<double>>> series)
+    : timestamps_(std::move(timestamps))
+{
+    const size_t n = timestamps_.size();
+    for (auto& [name, values] : series) {
+        if (values.size() != n) {
+            throw std::invalid_argument("SeriesPyramid: series '" + name + "' has " + std::to_string(values.size()) +
+                                        " values for " + std::to_string(n) + " timestamps");
+        }
+        names_.push_back(std::move(name));
+        raw_.push_back(std::move(values));
+    }
+
+    upper_.resize(raw_.size());
+    for (size_t s = 0; s < raw_.size(); ++s) {
+        const auto& values = raw_[s];
+        for (size_t count = n / 2; count > 0; count /= 2) {
+            std::vector<PyramidBucket> level(count);
+            if (upper_[s].empty()) {
+                for (size_t i = 0; i < count; ++i) {
+                    double a = values[2 * i];
+                    double b = values[2 * i + 1];
+                    level[i] = {a, b, std::min(a, b), std::max(a, b)};
+                }
+            } else {
+                const auto& below = upper_[s].back();
+                for (size_t i = 0; i < count; ++i) {
+                    level[i] = combine(below[2 * i], below[2 * i + 1]);
+                }
+            }
+            upper_[s].push_back(std::move(level));
+        }
+    }
+}
+
+size_t SeriesPyramid::levels() const {
+    return timestamps_.empty() ? 0 : floorLog2(timestamps_.size()) + 1;
+}
+
+size_t SeriesPyramid::byteSize() const {
+    size_t bytes = timestamps_.size() * sizeof(int64_t);
+    for (size_t s = 0; s < raw_.size(); ++s) {
+        bytes += names_[s].size() + raw_[s].size() * sizeof(double);
+        for (const auto& level : upper_[s]) {
+            bytes += level.size() * sizeof(PyramidBucket);
+        }
+    }
+    return bytes;
+}
+
+size_t SeriesPyramid::find(const std::string& name) const {
+    auto it = std::find(names_.begin(), names_.end(), name);
+    return it == names_.end() ? static_cast<size_t>(-1) : static_cast<size_t>(it - names_.begin());
+}
+
+std::pair<size_t, size_t> SeriesPyramid::indexRange(int64_t from, int64_t to) const {
+    auto begin = std::lower_bound(timestamps_.begin(), timestamps_.end(), from);
+    auto end = std::upper_bound(begin, timestamps_.end(), to);
+    return {static_cast<size_t>(begin - timestamps_.begin()), static_cast<size_t>(end - timestamps_.begin())};
+}
+
+/**
+ * @brief Summarizes points [begin, end) of one series.
+ *
+ * Greedily takes the largest aligned run that starts at the cursor and
+ * fits in the range. Ranges whose ends are aligned to level k take O(1)
+ * runs of level k or above; unaligned ends add O(log n) smaller runs.
+ */
+PyramidBucket SeriesPyramid::aggregate(size_t s, size_t begin, size_t end) const {
+    const auto& values = raw_[s];
+    const auto& levels = upper_[s];
+    PyramidBucket bucket = {values[begin], values[begin], values[begin], values[begin]};
+    bool empty = true;
+    while (begin < end) {
+        size_t level = std::min(floorLog2(end - begin), levels.size());
+        while (level > 0 && (begin & ((size_t(1) << level) - 1)) != 0) {
+            level--;
+        }
+        PyramidBucket run;
+        if (level == 0) {
+            run = {values[begin], values[begin], values[begin], values[begin]};
+        } else {
+            run = levels[level - 1][begin >> level];
+        }
+        bucket = empty ? run : combine(bucket, run);
+        empty = false;
+        begin += size_t(1) << level;
+    }
+    return bucket;
+}
+
+/**
+ * @brief Reduces an index range to at most `width` buckets per series.
+ *
+ * The level chosen is the coarsest whose runs are no longer than one
+ * output column. Interior column edges are rounded down to that level's
+ * alignment, so each column is assembled from a handful of precomputed
+ * runs and the whole view costs O(width) per series, plus O(log n) for
+ * the range's unaligned ends. Ranges no wider than `width` come back as
+ * raw points.
+ *
+ * @param begin First point index
+ * @param end One past the last point index; clamped to the series length
+ * @param width Maximum number of buckets
+ * @param series Indices of the series to return, in output order
+ * @throws std::out_of_range for an unknown series index
+ */
+PyramidView SeriesPyramid::query(size_t begin, size_t end, size_t width, const std::vector<size_t>& series) const {
+    PyramidView view;
+    end = std::min(end, timestamps_.size());
+    for (size_t s : series) {
+        if (s >= raw_.size()) {
+            throw std::out_of_range("SeriesPyramid: no series " + std::to_string(s));
+        }
+    }
+    if (begin >= end || width == 0) {
+        view.series.resize(series.size());
+        return view;
+    }
+
+    const size_t length = end - begin;
+    const size_t columns = std::min(width, length);
+    const size_t level = std::min(floorLog2(length / columns), levels() - 1);
+
+    std::vector<size_t> edges(columns + 1);
+    edges[0] = begin;
+    edges[columns] = end;
+    for (size_t j = 1; j < columns; ++j) {
+        size_t edge = begin + j * length / columns;
+        edges[j] = (edge >> level) << level;
+    }
+
+    view.level = level;
+    view.timestamps.reserve(columns);
+    for (size_t j = 0; j < columns; ++j) {
+        view.timestamps.push_back(timestamps_[edges[j]]);
+    }
+    view.series.reserve(series.size());
+    for (size_t s : series) {
+        std::vector<PyramidBucket> buckets;
+        buckets.reserve(columns);
+        for (size_t j = 0; j < columns; ++j) {
+            buckets.push_back(aggregate(s, edges[j], edges[j + 1]));
+        }
+        view.series.push_back(std::move(buckets));
+    }
+    return view;
+}
+
+} // namespace trading
@@ -0,0 +1,489 @@
+#include "strategies/batch_strategy.h"
+#include "strategies/portfolio.h"
+#include "utils/philox.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace trading {
+
+namespace {
+    // Configurations are processed in blocks so the per-run state of a block
+    // stays resident in L1 while the whole series streams past it. The
+    // per-bar loops always cover a whole block, so their trip count is a
+    // constant multiple of the vector width, which -O2 requires before it
+    // vectorizes; lanes past the last configuration repeat the first one
+    // of the block and their results are dropped.
+    constexpr size_t kBlockSize = 256;
+
+    // Copies `n` parameters of a block into `dest`, padding it to a whole block
+    template <typename T>
+    void loadBlock(const std::vector<T>& params, size_t blockStart, size_t n, T* dest) {
+        for (size_t j = 0; j < kBlockSize; ++j) {
+            dest[j] = params[blockStart + (j < n ? j : 0)];
+        }
+    }
+}
+
+/**
+ * @brief Constructor for the lockstep MACD batch.
+ *
+ * Validates each configuration with the same rules as MACDStrategy and stores
+ * the parameters in struct-of-arrays form.
+ *
+ * @param configs One entry per configuration to simulate
+ */
+MACDBatch::MACDBatch(const std::vector<MACDConfig>& configs) {
+    fastAlpha.reserve(configs.size());
+    slowAlpha.reserve(configs.size());
+    signalAlpha.reserve(configs.size());
+    stopLossPct.reserve(configs.size());
+    transactionCostRate.reserve(configs.size());
+
+    for (const auto& cfg : configs) {
+        if (cfg.macdFastPeriod <= 0 || cfg.macdSlowPeriod <= 0 || cfg.signalPeriod <= 0) {
+            throw std::invalid_argument("MACDBatch: MACD periods must be positive");
+        }
+        if (cfg.macdFastPeriod >= cfg.macdSlowPeriod) {
+            throw std::invalid_argument("MACDBatch: fastPeriod must be smaller than slowPeriod");
+        }
+        if (cfg.stopLossPercentage < 0 || cfg.stopLossPercentage >= 1) {
+            throw std::invalid_argument("MACDBatch: stopLossPercentage must be between 0 and 1 (exclusive of 1)");
+        }
+        if (cfg.transactionCost < 0) {
+            throw std::invalid_argument("MACDBatch: transactionCost cannot be negative");
+        }
+        fastAlpha.push_back(2.0 / (cfg.macdFastPeriod + 1.0));
+        slowAlpha.push_back(2.0 / (cfg.macdSlowPeriod + 1.0));
+        signalAlpha.push_back(2.0 / (cfg.signalPeriod + 1.0));
+        stopLossPct.push_back(cfg.stopLossPercentage);
+        transactionCostRate.push_back(cfg.transactionCost);
+    }
+}
+
+/**
+ * @brief Runs every configuration over the series.
+ *
+ * @param data Market data containing prices and timestamps
+ * @param initialCash Starting capital for each configuration
+ * @return One BatchResult per configuration, in construction order
+ */
+std::vector<BatchResult> MACDBatch::run(const MarketData& data, double initialCash) const {
+    std::vector<BatchResult> results(size());
+    run(data, initialCash, 0, size(), results.data());
+    return results;
+}
+
+/**
+ * @brief Runs configurations [begin, end) over the series.
+ *
+ * Mirrors the trading rules of MACDStrategy::onTick (long entry, long exit,
+ * short entry, short exit, stop loss, end-of-session liquidation) with
+ * every decision expressed as a select instead of a branch, so the inner
+ * loop over configurations compiles to straight-line vector code. Fills go
+ * through the same tradeTo kernel Portfolio uses, so results match. The
+ * trend and GARCH estimators are skipped since they do not affect trades.
+ *
+ * @param data Market data containing prices and timestamps
+ * @param initialCash Starting capital for each configuration
+ * @param begin First configuration index
+ * @param end One past the last configuration index
+ * @param out Destination for end - begin results
+ */
+void MACDBatch::run(const MarketData& data, double initialCash,
+                    size_t begin, size_t end, BatchResult* out) const {
+    end = std::min(end, size());
+    if (begin >= end) {
+        return;
+    }
+
+    const std::vector<double>& prices = data.prices;
+    if (prices.empty()) {
+        for (size_t j = begin; j < end; ++j) {
+            out[j - begin] = {initialCash, 0.0, 0};
+        }
+        return;
+    }
+
+    double fa[kBlockSize], sa[kBlockSize], ga[kBlockSize], sl[kBlockSize], tc[kBlockSize];
+    double fast[kBlockSize], slow[kBlockSize], signal[kBlockSize];
+    double cash[kBlockSize], pos[kBlockSize], entry[kBlockSize], tradeCount[kBlockSize];
+
+    for (size_t blockStart = begin; blockStart < end; blockStart += kBlockSize) {
+        const size_t n = std::min(kBlockSize, end - blockStart);
+        loadBlock(fastAlpha, blockStart, n, fa);
+        loadBlock(slowAlpha, blockStart, n, sa);
+        loadBlock(signalAlpha, blockStart, n, ga);
+        loadBlock(stopLossPct, blockStart, n, sl);
+        loadBlock(transactionCostRate, blockStart, n, tc);
+
+        for (size_t j = 0; j < kBlockSize; ++j) {
+            fast[j] = prices.front();
+            slow[j] = prices.front();
+            signal[j] = 0.0;
+            cash[j] = initialCash;
+            pos[j] = 0.0;
+            entry[j] = 0.0;
+            tradeCount[j] = 0.0;
+        }
+
+        for (double p : prices) {
+            for (size_t j = 0; j < kBlockSize; ++j) {
+                fast[j] = fa[j] * p + (1 - fa[j]) * fast[j];
+                slow[j] = sa[j] * p + (1 - sa[j]) * slow[j];
+                const double macd = fast[j] - slow[j];
+                signal[j] = ga[j] * macd + (1 - ga[j]) * signal[j];
+                const bool buy = macd > signal[j];
+                const bool sell = macd < signal[j];
+
+                Account a{cash[j], pos[j], entry[j], tradeCount[j]};
+                const double q = a.position;
+                const double e = a.entryPrice;
+
+                // Every decision follows from the position at the start of
+                // the bar: a sell may exit a long and open a short in the
+                // same bar, and a position opened on this bar cannot hit
+                // its stop at its own entry price
+                const double qLong = affordableShares(a.cash, p, tc[j]);
+                tradeTo(a, qLong, p, tc[j], buy & (q == 0) & (qLong > 0));
+                tradeTo(a, 0.0, p, tc[j], (sell & (q > 0)) | (buy & (q < 0)));
+                const double qShort = floorBranchless(a.cash / p);
+                tradeTo(a, -qShort, p, tc[j], sell & (q >= 0) & (qShort > 0));
+
+                const bool stopLong = !sell & (q > 0) & (e > 0) & (p < e * (1 - sl[j]));
+                const bool stopShort = !buy & (q < 0) & (e > 0) & (p > e * (1 + sl[j]));
+                tradeTo(a, 0.0, p, tc[j], stopLong | stopShort);
+
+                cash[j] = a.cash;
+                pos[j] = a.position;
+                entry[j] = a.entryPrice;
+                tradeCount[j] = a.fills;
+            }
+        }
+
+        // End-of-session liquidation
+        const double finalPrice = prices.back();
+        for (size_t j = 0; j < n; ++j) {
+            Account a{cash[j], pos[j], entry[j], tradeCount[j]};
+            tradeTo(a, 0.0, finalPrice, tc[j], true);
+            out[blockStart - begin + j] = {a.cash, a.cash - initialCash, static_cast<int>(a.fills)};
+        }
+    }
+}
+
+/**
+ * @brief Constructor for the lockstep Mean Reversion batch.
+ *
+ * Validates each configuration with the same rules as MeanReversionStrategy.
+ * Distinct lookback periods are collected so window statistics can be shared
+ * between configurations that use the same lookback.
+ *
+ * @param configs One entry per configuration to simulate
+ */
+MeanReversionBatch::MeanReversionBatch(const std::vector<MeanReversionConfig>& configs) {
+    lookbackIndex.reserve(configs.size());
+    entryThreshold.reserve(configs.size());
+    exitThreshold.reserve(configs.size());
+    stopLossPct.reserve(configs.size());
+    profitTargetPct.reserve(configs.size());
+    transactionCostRate.reserve(configs.size());
+
+    for (const auto& cfg : configs) {
+        if (cfg.lookbackPeriod < 3) {
+            throw std::invalid_argument("MeanReversionBatch: lookbackPeriod must be at least 3");
+        }
+        if (cfg.entryThreshold <= 0) {
+            throw std::invalid_argument("MeanReversionBatch: entryThreshold must be positive");
+        }
+        if (cfg.exitThreshold < 0) {
+            throw std::invalid_argument("MeanReversionBatch: exitThreshold cannot be negative");
+        }
+        if (cfg.stopLossPercentage < 0 || cfg.stopLossPercentage >= 1) {
+            throw std::invalid_argument("MeanReversionBatch: stopLossPercentage must be between 0 and 1");
+        }
+        if (cfg.profitTargetPercentage <= 0 || cfg.profitTargetPercentage >= 1) {
+            throw std::invalid_argument("MeanReversionBatch: profitTargetPercentage must be between 0 and 1");
+        }
+        if (cfg.transactionCost < 0) {
+            throw std::invalid_argument("MeanReversionBatch: transactionCost cannot be negative");
+        }
+
+        auto it = std::find(lookbacks.begin(), lookbacks.end(), cfg.lookbackPeriod);
+        if (it == lookbacks.end()) {
+            lookbacks.push_back(cfg.lookbackPeriod);
+            it = lookbacks.end() - 1;
+        }
+        lookbackIndex.push_back(static_cast<int>(it - lookbacks.begin()));
+        entryThreshold.push_back(cfg.entryThreshold);
+        exitThreshold.push_back(cfg.exitThreshold);
+        stopLossPct.push_back(cfg.stopLossPercentage);
+        profitTargetPct.push_back(cfg.profitTargetPercentage);
+        transactionCostRate.push_back(cfg.transactionCost);
+    }
+}
+
+/**
+ * @brief Runs every configuration over the series.
+ *
+ * @param data Market data containing prices and timestamps
+ * @param initialCash Starting capital for each configuration
+ * @return One BatchResult per configuration, in construction order
+ */
+std::vector<BatchResult> MeanReversionBatch::run(const MarketData& data, double initialCash) const {
+    std::vector<BatchResult> results(size());
+    run(data, initialCash, 0, size(), results.data());
+    return results;
+}
+
+/**
+ * @brief Runs configurations [begin, end) over the series.
+ *
+ * Z-scores for every distinct lookback are computed once per bar from
+ * sliding window sums (prices are shifted by the first price to keep the
+ * variance well conditioned), then each configuration applies the
+ * MeanReversionStrategy::onTick rules branch-free: at most one of
+ * exit long, exit short, enter long or enter short fires per bar.
+ *
+ * @param data Market data containing prices and timestamps
+ * @param initialCash Starting capital for each configuration
+ * @param begin First configuration index
+ * @param end One past the last configuration index
+ * @param out Destination for end - begin results
+ */
+void MeanReversionBatch::run(const MarketData& data, double initialCash,
+                             size_t begin, size_t end, BatchResult* out) const {
+    end = std::min(end, size());
+    if (begin >= end) {
+        return;
+    }
+
+    const std::vector<double>& prices = data.prices;
+    if (prices.empty()) {
+        for (size_t j = begin; j < end; ++j) {
+            out[j - begin] = {initialCash, 0.0, 0};
+        }
+        return;
+    }
+
+    // z-score and readiness per (bar, lookback), shared by every configuration.
+    // The tables are per-thread scratch reused across chunks: every cell is
+    // rewritten below, and a pinned worker's pages stay local to its CPU.
+    const size_t numBars = prices.size();
+    const size_t numLookbacks = lookbacks.size();
+    thread_local std::vector<double> zScores;
+    thread_local std::vector<unsigned char> ready;
+    zScores.resize(numBars * numLookbacks);
+    ready.resize(numBars * numLookbacks);
+    const double shift = prices.front();
+    for (size_t k = 0; k < numLookbacks; ++k) {
+        const size_t lookback = static_cast<size_t>(lookbacks[k]);
+        double sum = 0.0;
+        double sumSq = 0.0;
+        for (size_t t = 0; t < numBars; ++t) {
+            const double x = prices[t] - shift;
+            sum += x;
+            sumSq += x * x;
+            if (t >= lookback) {
+                const double old = prices[t - lookback] - shift;
+                sum -= old;
+                sumSq -= old * old;
+            }
+            const size_t count = std::min(t + 1, lookback);
+            double z = 0.0;
+            if (count > 1) {
+                const double mean = sum / count;
+                const double variance = std::max(0.0, sumSq / count - mean * mean);
+                const double stdDev = std::sqrt(variance);
+                z = stdDev > 0.0 ? (x - mean) / stdDev : 0.0;
+            }
+            zScores[t * numLookbacks + k] = z;
+            ready[t * numLookbacks + k] = count >= lookback;
+        }
+    }
+
+    int li[kBlockSize];
+    double et[kBlockSize], xt[kBlockSize], sl[kBlockSize], pt[kBlockSize], tc[kBlockSize];
+    double zs[kBlockSize], live[kBlockSize];
+    double cash[kBlockSize], pos[kBlockSize], entry[kBlockSize], tradeCount[kBlockSize];
+
+    for (size_t blockStart = begin; blockStart < end; blockStart += kBlockSize) {
+        const size_t n = std::min(kBlockSize, end - blockStart);
+        loadBlock(lookbackIndex, blockStart, n, li);
+        loadBlock(entryThreshold, blockStart, n, et);
+        loadBlock(exitThreshold, blockStart, n, xt);
+        loadBlock(stopLossPct, blockStart, n, sl);
+        loadBlock(profitTargetPct, blockStart, n, pt);
+        loadBlock(transactionCostRate, blockStart, n, tc);
+
+        for (size_t j = 0; j < kBlockSize; ++j) {
+            cash[j] = initialCash;
+            pos[j] = 0.0;
+            entry[j] = 0.0;
+            tradeCount[j] = 0.0;
+        }
+
+        for (size_t bar = 0; bar < numBars; ++bar) {
+            const double p = prices[bar];
+            const double* zRow = zScores.data() + bar * numLookbacks;
+            const unsigned char* readyRow = ready.data() + bar * numLookbacks;
+
+            // Gather each configuration's z-score first, so the decision
+            // loop below reads only contiguous arrays
+            for (size_t j = 0; j < kBlockSize; ++j) {
+                zs[j] = zRow[li[j]];
+                live[j] = readyRow[li[j]];
+            }
+
+            for (size_t j = 0; j < kBlockSize; ++j) {
+                const double z = zs[j];
+                const bool ready = live[j] != 0.0;
+                Account a{cash[j], pos[j], entry[j], tradeCount[j]};
+                const double q = a.position;
+                const double e = a.entryPrice;
+
+                const bool calm = std::abs(z) < xt[j];
+                const bool exitLong = ready & (q > 0) &
+                    ((p < e * (1 - sl[j])) | (p > e * (1 + pt[j])) | calm);
+                const bool exitShort = ready & (q < 0) &
+                    ((p > e * (1 + sl[j])) | (p < e * (1 - pt[j])) | calm);
+
+                // floor matches the strategy's trunc wherever qty > 0
+                const double qty = floorBranchless(a.cash / (p * (1 + tc[j])) * 0.95);
+                const bool flat = ready & (q == 0) & (qty > 0);
+                const bool enterLong = flat & (z < -et[j]);
+                const bool enterShort = flat & !(z < -et[j]) & (z > et[j]);
+
+                // At most one of these fires per bar
+                const double target = enterLong ? qty : (enterShort ? -qty : 0.0);
+                tradeTo(a, target, p, tc[j], exitLong | exitShort | enterLong | enterShort);
+
+                cash[j] = a.cash;
+                pos[j] = a.position;
+                entry[j] = a.entryPrice;
+                tradeCount[j] = a.fills;
+            }
+        }
+
+        // End-of-session liquidation
+        const double finalPrice = prices.back();
+        for (size_t j = 0; j < n; ++j) {
+            Account a{cash[j], pos[j], entry[j], tradeCount[j]};
+            tradeTo(a, 0.0, finalPrice, tc[j], true);
+            out[blockStart - begin + j] = {a.cash, a.cash - initialCash, static_cast<int>(a.fills)};
+        }
+    }
+}
+
+/**
+ * @brief Constructor for the random baseline batch.
+ *
+ * @param runs Number of independent baseline runs
+ * @param tradeRate Probability of trading on each bar, in [0, 1]
+ * @param transactionCost Fee as a fraction of traded value
+ * @param seed Seed shared by every run; run i uses stream i under it
+ */
+RandomBatch::RandomBatch(size_t runs, double tradeRate, double transactionCost, uint64_t seed)
+    : runs(runs)
+    , tradeRate(tradeRate)
+    , transactionCostRate(transactionCost)
+    , seed(seed)
+{
+    if (!(tradeRate >= 0 && tradeRate <= 1)) {
+        throw std::invalid_argument("RandomBatch: tradeRate must be between 0 and 1");
+    }
+    if (transactionCost < 0) {
+        throw std::invalid_argument("RandomBatch: transactionCost cannot be negative");
+    }
+}
+
+std::vector<BatchResult> RandomBatch::run(const MarketData& data, double initialCash) const {
+    std::vector<BatchResult> results(size());
+    run(data, initialCash, 0, size(), results.data());
+    return results;
+}
+
+/**
+ * @brief Runs baselines [begin, end) over the series.
+ *
+ * Each bar first draws one Philox block per run, keyed by (seed, run, bar),
+ * giving the trade and side uniforms; then applies them to the block of
+ * accounts with tradeTo. Both loops are straight-line code over the block
+ * and nothing is allocated, so thousands of runs take about as long as
+ * one MACD sweep of the same size.
+ *
+ * @param data Market data containing prices and timestamps
+ * @param initialCash Starting capital for each run
+ * @param begin First run index
+ * @param end One past the last run index
+ * @param out Destination for end - begin results
+ */
+void RandomBatch::run(const MarketData& data, double initialCash,
+                      size_t begin, size_t end, BatchResult* out) const {
+    end = std::min(end, size());
+    if (begin >= end) {
+        return;
+    }
+
+    const std::vector<double>& prices = data.prices;
+    if (prices.empty()) {
+        for (size_t j = begin; j < end; ++j) {
+            out[j - begin] = {initialCash, 0.0, 0};
+        }
+        return;
+    }
+
+    const std::array<uint32_t, 2> key = {static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)};
+    uint32_t c0[kBlockSize], c1[kBlockSize], c2[kBlockSize], c3[kBlockSize];
+    double trade[kBlockSize], side[kBlockSize];
+    double cash[kBlockSize], pos[kBlockSize], entry[kBlockSize], tradeCount[kBlockSize];
+
+    for (size_t blockStart = begin; blockStart < end; blockStart += kBlockSize) {
+        const size_t n = std::min(kBlockSize, end - blockStart);
+        for (size_t j = 0; j < kBlockSize; ++j) {
+            cash[j] = initialCash;
+            pos[j] = 0.0;
+            entry[j] = 0.0;
+            tradeCount[j] = 0.0;
+            trade[j] = 1.0; // lanes past `n` never trade
+            side[j] = 0.0;
+        }
+
+        for (size_t t = 0; t < prices.size(); ++t) {
+            const double p = prices[t];
+            for (size_t j = 0; j < n; ++j) {
+                const uint64_t stream = blockStart + j;
+                c0[j] = static_cast<uint32_t>(t);
+                c1[j] = 0;
+                c2[j] = static_cast<uint32_t>(stream);
+                c3[j] = static_cast<uint32_t>(stream >> 32);
+            }
+            Philox::generate(n, c0, c1, c2, c3, key);
+            for (size_t j = 0; j < n; ++j) {
+                trade[j] = Philox::unit(c0[j], c1[j]);
+                side[j] = Philox::unit(c2[j], c3[j]);
+            }
+            for (size_t j = 0; j < kBlockSize; ++j) {
+                Account a{cash[j], pos[j], entry[j], tradeCount[j]};
+                const bool act = trade[j] < tradeRate;
+                const double qty = affordableShares(a.cash, p, transactionCostRate);
+                const double target = a.position != 0 ? 0.0 : (side[j] < 0.5 ? qty : -qty);
+                tradeTo(a, target, p, transactionCostRate, act);
+
+                cash[j] = a.cash;
+                pos[j] = a.position;
+                entry[j] = a.entryPrice;
+                tradeCount[j] = a.fills;
+            }
+        }
+
+        // End-of-session liquidation
+        const double finalPrice = prices.back();
+        for (size_t j = 0; j < n; ++j) {
+            Account a{cash[j], pos[j], entry[j], tradeCount[j]};
+            tradeTo(a, 0.0, finalPrice, transactionCostRate, true);
+            out[blockStart - begin + j] = {a.cash, a.cash - initialCash, static_cast<int>(a.fills)};
+        }
+    }
+}
+
+} // namespace trading
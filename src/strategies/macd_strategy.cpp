@@ -35,13 +35,8 @@ MACDStrategy::MACDStrategy(double volEstimate,
     , fastEMAEstimator(0, 2.0 / (macdFastPeriod + 1.0))
     , slowEMAEstimator(0, 2.0 / (macdSlowPeriod + 1.0))
     , signalEMAEstimator(0, 2.0 / (signalPeriod + 1.0))
-    , trades()
-    , historicalData()
-    , cash(0)
-    , position(0.0) // Changed to double
+    , portfolio(transactionCost)
     , stopLossPct(stopLossPercentage)
-    , transactionCostRate(transactionCost)
-    , entryPrice(0.0)
     , lastPrice(0.0)
     , currentMACD(0.0)
     , currentSignal(0.0)
@@ -85,20 +80,15 @@ MACDStrategy::MACDStrategy(double volEstimate,
  * @return SimulationResult object with performance metrics and trade history
  */
 SimulationResult MACDStrategy::execute(const MarketData& data, double initialCash) {
-    cash = initialCash;
-    position = 0;
-    trades.clear();
-    historicalData.clear();
-    historicalData.reserve(data.prices.size());
+    portfolio.reset(initialCash, data.prices.size());
     lastPrice = 0.0;
-    entryPrice = 0.0;
     currentMACD = 0.0;
     currentSignal = 0.0;
     debugDetailTicks = false;
 
     if (data.prices.empty()) {
         std::cout << "No price data to process: Prices vector is empty." << std::endl;
-        return {cash, 0, trades, historicalData};
+        return portfolio.finish(0.0, 0);
     }
     if (initialCash <= 0) {
         std::cout << "Warning: Initial cash is not positive, simulation might not be meaningful." << std::endl;
@@ -122,38 +112,20 @@ SimulationResult MACDStrategy::execute(const MarketData& data, double initialCas
     garchEstimator = GARCHEstimator<double>(garchEstimator.getSigma(), garchEstimator.getOmega(), garchEstimator.getAlpha(), garchEstimator.getBeta());
 
     for (size_t i = 0; i < data.prices.size(); ++i) {
+        checkCancellation(i);
         onTick(data.prices[i], i, data.timestamps[i]); // Pass timestamp
     }
 
-    if (position != 0) { // Check if any position (long or short)
+    if (portfolio.position() != 0) {
         double finalPrice = data.prices.back();
-        double quantity = std::abs(position);
-        std::string tradeType = (position > 0) ? "EXIT_LONG" : "EXIT_SHORT";
-        std::string tradeSide = (position > 0) ? "SELL" : "BUY";
-        double proceeds = 0.0;
-
-        if (position > 0) { // Exiting long
-            proceeds = quantity * finalPrice * (1 - transactionCostRate);
-            cash += proceeds;
-        } else { // Exiting short
-            // Need the entry price for calculating profit/loss on short
-            // This assumes entryPrice is still set from the last entry trade.
-            // A more robust solution might store entry price per position.
-            // For now, using the last entryPrice.
-            proceeds = quantity * (entryPrice - finalPrice) * (1 - transactionCostRate);
-            cash += proceeds;
-        }
-
-        trades.push_back({static_cast<int>(data.prices.size()-1),
-                         tradeType,
-                         tradeSide,
-                         finalPrice,
-                         quantity});
+        double quantity = std::abs(portfolio.position());
+        std::string tradeType = (portfolio.position() > 0) ? "EXIT_LONG" : "EXIT_SHORT";
+        double proceeds = portfolio.close(finalPrice, static_cast<int>(data.prices.size() - 1));
         std::cout << "DEBUG: " << timestamp << " - INFO: End of session, liquidated position (" << tradeType << ") at price " << finalPrice << ", quantity: " << quantity << ", proceeds: " << proceeds << std::endl;
     }
 
     std::cout << "DEBUG: " << timestamp << " - INFO: Strategy execution completed." << std::endl;
-    return {cash, cash - initialCash, trades, historicalData};  // Include historical data in return
+    return portfolio.finish(data.prices.back(), static_cast<int>(data.prices.size() - 1));
 }
 
 /**
@@ -205,21 +177,8 @@ void MACDStrategy::onTick(double price, int timeStep, const std::string& tickTim
     double buyThreshold = currentTrend * (1 - tradeThresholdFactor * currentSigma);
     double sellThreshold = currentTrend * (1 + tradeThresholdFactor * currentSigma);
 
-    HistoricalDataPoint dataPoint{
-        currentMACD,
-        currentSignal,
-        cash + (position * price),  // current portfolio value
-        static_cast<double>(position),
-        cash,
-        currentTrend,
-        currentSigma
-    };
-
-    if (static_cast<size_t>(timeStep) >= historicalData.size()) {
-        historicalData.push_back(dataPoint);
-    } else {
-        historicalData[timeStep] = dataPoint;
-    }
+    portfolio.mark(price, currentMACD, currentSignal, currentTrend, currentSigma);
+    const double position = portfolio.position();
 
 
     if (timeStep % 10 == 0 || debugDetailTicks) {
@@ -236,27 +195,12 @@ void MACDStrategy::onTick(double price, int timeStep, const std::string& tickTim
     if (timeStep % 10 == 0 || debugDetailTicks) {
         std::cout << "  DEBUG: " << timestamp << " - BUY Signal Check - MACD > Signal: (" << std::fixed << std::setprecision(6) << currentMACD << " > " << std::fixed << std::setprecision(6) << currentSignal << ") - " << (buySignal ? "TRUE" : "FALSE") << std::endl;
     }
-    if (buySignal && position == 0) { // Only enter long if not currently in a position
-        // Calculate quantity affordable after transaction costs
-        double qty_double = cash / (price * (1 + transactionCostRate));
-        if (qty_double <= 0) { // Avoid issues if cash is too low
-            qty_double = 0;
-        }
-        double qty = std::floor(qty_double); // Use floor to get whole shares
-
+    if (buySignal && portfolio.position() == 0) { // Only enter long if not currently in a position
+        double qty = affordableShares(portfolio.cash(), price, portfolio.feeRate());
         if (qty > 0) {
-            double cost = qty * price * (1 + transactionCostRate);
-            // This check should now be more robust, but an additional small epsilon might be needed for floating point issues
-            if (cash >= cost - 1e-9) { // Allow for tiny floating point discrepancies
-                cash -= cost;
-                trades.push_back({timeStep, "LONG", "BUY", price, static_cast<double>(qty)});
-                position += qty;
-                entryPrice = price;
-                std::cout << "DEBUG: " << timestamp << " - INFO: BUY (LONG) at " << std::fixed << std::setprecision(2) << price << ", qty: " << qty << ", cost: " << std::fixed << std::setprecision(2) << cost << ", new cash: " << std::fixed << std::setprecision(2) << cash << std::endl; // Log BUY info
-                debugDetailTicks = true;
-            } else {
-                std::cout << "WARNING: Not enough cash to BUY (LONG) at " << std::fixed << std::setprecision(2) << price << ", qty: " << qty << ", cost: " << std::fixed << std::setprecision(2) << cost << ". Current cash: " << std::fixed << std::setprecision(2) << cash << std::endl;
-            }
+            double cost = -portfolio.buy(qty, price, timeStep);
+            std::cout << "DEBUG: " << timestamp << " - INFO: BUY (LONG) at " << std::fixed << std::setprecision(2) << price << ", qty: " << qty << ", cost: " << std::fixed << std::setprecision(2) << cost << ", new cash: " << std::fixed << std::setprecision(2) << portfolio.cash() << std::endl; // Log BUY info
+            debugDetailTicks = true;
         }
     }
 
@@ -265,13 +209,10 @@ void MACDStrategy::onTick(double price, int timeStep, const std::string& tickTim
      if (timeStep % 10 == 0 || debugDetailTicks) {
         std::cout << "  DEBUG: " << timestamp << " - SELL Signal Check - MACD < Signal: (" << std::fixed << std::setprecision(6) << currentMACD << " < " << std::fixed << std::setprecision(6) << currentSignal << ") - " << (sellSignal ? "TRUE" : "FALSE") << std::endl;
     }
-    if (sellSignal && position > 0) { // Only exit long if currently in a long position
-        double proceeds = position * price * (1 - transactionCostRate);
-        cash += proceeds;
-        trades.push_back({timeStep, "EXIT_LONG", "SELL", price, static_cast<double>(position)});
-        std::cout << "DEBUG: " << timestamp << " - INFO: SELL (EXIT LONG) at " << std::fixed << std::setprecision(2) << price << ", qty: " << position << ", proceeds: " << std::fixed << std::setprecision(2) << proceeds << ", new cash: " << std::fixed << std::setprecision(2) << cash << std::endl; // Log SELL info
-        position = 0;
-        entryPrice = 0.0;
+    if (sellSignal && portfolio.position() > 0) { // Only exit long if currently in a long position
+        double qty = portfolio.position();
+        double proceeds = portfolio.close(price, timeStep);
+        std::cout << "DEBUG: " << timestamp << " - INFO: SELL (EXIT LONG) at " << std::fixed << std::setprecision(2) << price << ", qty: " << qty << ", proceeds: " << std::fixed << std::setprecision(2) << proceeds << ", new cash: " << std::fixed << std::setprecision(2) << portfolio.cash() << std::endl; // Log SELL info
         debugDetailTicks = true;
     }
 
@@ -280,33 +221,13 @@ void MACDStrategy::onTick(double price, int timeStep, const std::string& tickTim
     if (timeStep % 10 == 0 || debugDetailTicks) {
         std::cout << "  DEBUG: " << timestamp << " - SHORT Signal Check - MACD < Signal: (" << std::fixed << std::setprecision(6) << currentMACD << " < " << std::fixed << std::setprecision(6) << currentSignal << ") - " << (shortSignal ? "TRUE" : "FALSE") << std::endl;
     }
-    if (shortSignal && position == 0) { // Only enter short if not currently in a position
-        // For shorting, qty isn't directly limited by cash in the same way as buying.
-        // Let's assume we want to size the short position similarly to how a long position might be sized.
-        // This part is a bit ambiguous in the original logic.
-        // A common approach is to size based on a fraction of portfolio or a fixed amount.
-        // Here, we'll keep it similar to the long entry for now, assuming 'cash / price' is a proxy for desired position size.
-        double qty_double = cash / price; // Still using this as a proxy for desired short size.
-                                         // This implies shorting an amount that, if it were a long position, would use up current cash.
-        if (qty_double <= 0) {
-            qty_double = 0;
-        }
-        double qty = std::floor(qty_double);
-
+    if (shortSignal && portfolio.position() == 0) { // Only enter short if not currently in a position
+        // Sized like a long entry: the shares current cash would buy
+        double qty = std::floor(portfolio.cash() / price);
         if (qty > 0) {
-            double transaction_fee = qty * price * transactionCostRate;
-            if (cash >= transaction_fee) { // Ensure cash can cover the transaction fee for shorting
-                cash -= transaction_fee; // Deduct transaction fee
-                // Note: For actual short selling, cash doesn't decrease by the value of shares,
-                // but margin might be required. This model simplifies that.
-                trades.push_back({timeStep, "SHORT", "SELL", price, static_cast<double>(qty)});
-                position -= qty; // Negative position for short
-                entryPrice = price;
-                std::cout << "DEBUG: " << timestamp << " - INFO: SELL (SHORT) at " << std::fixed << std::setprecision(2) << price << ", qty: " << qty << ", transaction_fee: " << std::fixed << std::setprecision(2) << transaction_fee << ", new cash: " << std::fixed << std::setprecision(2) << cash << std::endl; // Log SHORT info
-                debugDetailTicks = true;
-            } else {
-                std::cout << "WARNING: Not enough cash for transaction fee to SELL (SHORT) at " << std::fixed << std::setprecision(2) << price << ", qty: " << qty << ", transaction_fee: " << std::fixed << std::setprecision(2) << transaction_fee << ". Current cash: " << std::fixed << std::setprecision(2) << cash << std::endl;
-            }
+            double proceeds = portfolio.sell(qty, price, timeStep);
+            std::cout << "DEBUG: " << timestamp << " - INFO: SELL (SHORT) at " << std::fixed << std::setprecision(2) << price << ", qty: " << qty << ", proceeds: " << std::fixed << std::setprecision(2) << proceeds << ", new cash: " << std::fixed << std::setprecision(2) << portfolio.cash() << std::endl; // Log SHORT info
+            debugDetailTicks = true;
         }
     }
 
@@ -315,26 +236,23 @@ void MACDStrategy::onTick(double price, int timeStep, const std::string& tickTim
     if (timeStep % 10 == 0 || debugDetailTicks) {
         std::cout << "  DEBUG: " << timestamp << " - EXIT SHORT Signal Check - MACD > Signal: (" << std::fixed << std::setprecision(6) << currentMACD << " > " << std::fixed << std::setprecision(6) << currentSignal << ") - " << (exitShortSignal ? "TRUE" : "FALSE") << std::endl;
     }
-    if (exitShortSignal && position < 0) { // Only exit short if currently in a short position
-        double proceeds = std::abs(position) * (entryPrice - price) * (1 - transactionCostRate); // Profit/Loss on short position
-        cash += proceeds; // Add profit/loss to cash
-        trades.push_back({timeStep, "EXIT_SHORT", "BUY", price, static_cast<double>(std::abs(position))});
-        std::cout << "DEBUG: " << timestamp << " - INFO: BUY (EXIT SHORT) at " << std::fixed << std::setprecision(2) << price << ", qty: " << std::abs(position) << ", proceeds: " << std::fixed << std::setprecision(2) << proceeds << ", new cash: " << std::fixed << std::setprecision(2) << cash << std::endl; // Log EXIT SHORT info
-        position = 0;
-        entryPrice = 0.0;
+    if (exitShortSignal && portfolio.position() < 0) { // Only exit short if currently in a short position
+        double qty = -portfolio.position();
+        double cost = -portfolio.close(price, timeStep);
+        std::cout << "DEBUG: " << timestamp << " - INFO: BUY (EXIT SHORT) at " << std::fixed << std::setprecision(2) << price << ", qty: " << qty << ", cost: " << std::fixed << std::setprecision(2) << cost << ", new cash: " << std::fixed << std::setprecision(2) << portfolio.cash() << std::endl; // Log EXIT SHORT info
         debugDetailTicks = true;
     }
 
 
     // stop loss check
-    if (position != 0 && entryPrice > 0) {
+    if (portfolio.position() != 0 && portfolio.entryPrice() > 0) {
         bool stopLossCondition = false;
         std::string tradeType = "";
-        if (position > 0) { // Long position stop loss
-            stopLossCondition = (price < entryPrice * (1 - stopLossPct));
+        if (portfolio.position() > 0) { // Long position stop loss
+            stopLossCondition = (price < portfolio.entryPrice() * (1 - stopLossPct));
             tradeType = "SELL (Stop Loss Long)";
         } else { // Short position stop loss
-            stopLossCondition = (price > entryPrice * (1 + stopLossPct));
+            stopLossCondition = (price > portfolio.entryPrice() * (1 + stopLossPct));
             tradeType = "BUY (Stop Loss Short)";
         }
 
@@ -342,30 +260,20 @@ void MACDStrategy::onTick(double price, int timeStep, const std::string& tickTim
             std::cout << "  DEBUG: " << timestamp << " - STOP LOSS Conditions Check - " << tradeType << ": " << (stopLossCondition ? "TRUE" : "FALSE") << std::endl;
         }
         if (stopLossCondition) {
-            double quantity = std::abs(position);
-            double proceeds = 0.0;
-            if (position > 0) { // Exiting long stop loss
-                 proceeds = quantity * price * (1 - transactionCostRate);
-                 cash += proceeds;
-            } else { // Exiting short stop loss
-                 proceeds = quantity * (entryPrice - price) * (1 - transactionCostRate);
-                 cash += proceeds;
-            }
-
-            trades.push_back({timeStep, (position > 0 ? "EXIT_LONG" : "EXIT_SHORT"), (position > 0 ? "SELL" : "BUY"), price, static_cast<double>(quantity)});
-            std::cout << "DEBUG: " << timestamp << " - INFO: STOP LOSS triggered (" << tradeType << ") at " << std::fixed << std::setprecision(2) << price << ", qty: " << quantity << ", proceeds: " << std::fixed << std::setprecision(2) << proceeds << ", new cash: " << std::fixed << std::setprecision(2) << cash << std::endl; // Log STOP LOSS info
-            position = 0;
-            entryPrice = 0.0;
+            double quantity = std::abs(portfolio.position());
+            double proceeds = portfolio.close(price, timeStep);
+            std::cout << "DEBUG: " << timestamp << " - INFO: STOP LOSS triggered (" << tradeType << ") at " << std::fixed << std::setprecision(2) << price << ", qty: " << quantity << ", proceeds: " << std::fixed << std::setprecision(2) << proceeds << ", new cash: " << std::fixed << std::setprecision(2) << portfolio.cash() << std::endl; // Log STOP LOSS info
             debugDetailTicks = true;
         }
     }
 
 
+    const auto& trades = portfolio.trades();
     if (debugDetailTicks && (trades.size() > 0) && (trades.back().timeStep <= timeStep) && (trades.back().timeStep + 5 < timeStep)) {
         debugDetailTicks = false;
     }
      if (timeStep % 10 == 0 || debugDetailTicks) {
-        std::cout << "DEBUG: " << timestamp << " - TICK END - Tick " << timeStep <<  " - Position: " << position <<  " - Cash: " << std::fixed << std::setprecision(2) << cash << " - Portfolio Value: " << std::fixed << std::setprecision(2) << cash + (position * price) << std::endl; // Debug log at tick end
+        std::cout << "DEBUG: " << timestamp << " - TICK END - Tick " << timeStep <<  " - Position: " << portfolio.position() <<  " - Cash: " << std::fixed << std::setprecision(2) << portfolio.cash() << " - Portfolio Value: " << std::fixed << std::setprecision(2) << portfolio.equity(price) << std::endl; // Debug log at tick end
     }
 }
 
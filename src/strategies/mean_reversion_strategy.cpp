@@ -1,7 +1,7 @@
 #include "strategies/mean_reversion_strategy.h"
 #include <cmath>
 #include <iostream>
-#include <numeric>
+#include <algorithm>
 #include <limits>
 #include <iomanip>
 #include <chrono>
@@ -17,22 +17,21 @@ namespace trading {
  * @param stopLossPercentage Maximum loss percentage before exiting position
  * @param profitTargetPercentage Target profit percentage to take profits
  * @param transactionCost Transaction cost as a percentage of trade value
+ * @param robustZScore Measure deviation with the rolling median and MAD instead of mean and standard deviation
  */
 MeanReversionStrategy::MeanReversionStrategy(int lookbackPeriod, 
                                            double entryThreshold,
                                            double exitThreshold,
                                            double stopLossPercentage,
                                            double profitTargetPercentage,
-                                           double transactionCost)
-    : trades()
-    , historicalData()
-    , priceHistory()
-    , cash(0)
-    , position(0)
+                                           double transactionCost,
+                                           bool robustZScore)
+    : portfolio(transactionCost)
+    , priceStats(std::max(lookbackPeriod, 1))  // validated below
+    , priceQuantiles(std::max(lookbackPeriod, 1))
+    , robustZScore(robustZScore)
     , stopLossPct(stopLossPercentage)
     , profitTargetPct(profitTargetPercentage)
-    , transactionCostRate(transactionCost)
-    , entryPrice(0.0)
     , lastPrice(0.0)
     , lookbackPeriod(lookbackPeriod)
     , entryThreshold(entryThreshold)
@@ -77,14 +76,10 @@ MeanReversionStrategy::MeanReversionStrategy(int lookbackPeriod,
  * @return SimulationResult object with performance metrics and trade history
  */
 SimulationResult MeanReversionStrategy::execute(const MarketData& data, double initialCash) {
-    cash = initialCash;
-    position = 0;
-    trades.clear();
-    historicalData.clear();
-    historicalData.reserve(data.prices.size());
-    priceHistory.clear();
+    portfolio.reset(initialCash, data.prices.size());
+    priceStats.reset();
+    priceQuantiles.reset();
     lastPrice = 0.0;
-    entryPrice = 0.0;
     currentMean = 0.0;
     currentStdDev = 0.0;
     currentZScore = 0.0;
@@ -92,7 +87,7 @@ SimulationResult MeanReversionStrategy::execute(const MarketData& data, double i
 
     if (data.prices.empty()) {
         std::cout << "No price data to process: Prices vector is empty." << std::endl;
-        return {cash, 0, trades, historicalData};
+        return portfolio.finish(0.0, 0);
     }
     if (initialCash <= 0) {
         std::cout << "Warning: Initial cash is not positive, simulation might not be meaningful." << std::endl;
@@ -110,34 +105,24 @@ SimulationResult MeanReversionStrategy::execute(const MarketData& data, double i
     std::cout << "DEBUG: " << timestamp << " - INFO: Initial cash: " << initialCash << std::endl;
 
     for (size_t i = 0; i < data.prices.size(); ++i) {
+        checkCancellation(i);
         onTick(data.prices[i], i, data.timestamps[i]);
     }
 
     // Final liquidation at the end of the session if still holding
-    if (position > 0) {
+    if (portfolio.position() != 0) {
         double finalPrice = data.prices.back();
-        double proceeds = position * finalPrice * (1 - transactionCostRate);
-        cash += proceeds;
-        trades.push_back({static_cast<int>(data.prices.size()-1),
-                         "EXIT_LONG",
-                         "SELL",
-                         finalPrice,
-                         static_cast<double>(position)});
-        std::cout << "DEBUG: " << timestamp << " - INFO: End of session, liquidated position at price " << finalPrice << ", proceeds: " << proceeds << std::endl;
-    } else if (position < 0) {
-        double finalPrice = data.prices.back();
-        double cost = -position * finalPrice * (1 + transactionCostRate);
-        cash -= cost;
-        trades.push_back({static_cast<int>(data.prices.size()-1),
-                         "EXIT_SHORT",
-                         "BUY",
-                         finalPrice,
-                         static_cast<double>(-position)});
-        std::cout << "DEBUG: " << timestamp << " - INFO: End of session, covered short position at price " << finalPrice << ", cost: " << cost << std::endl;
+        bool wasLong = portfolio.position() > 0;
+        double proceeds = portfolio.close(finalPrice, static_cast<int>(data.prices.size() - 1));
+        if (wasLong) {
+            std::cout << "DEBUG: " << timestamp << " - INFO: End of session, liquidated position at price " << finalPrice << ", proceeds: " << proceeds << std::endl;
+        } else {
+            std::cout << "DEBUG: " << timestamp << " - INFO: End of session, covered short position at price " << finalPrice << ", cost: " << -proceeds << std::endl;
+        }
     }
 
     std::cout << "DEBUG: " << timestamp << " - INFO: Strategy execution completed." << std::endl;
-    return {cash, cash - initialCash, trades, historicalData};
+    return portfolio.finish(data.prices.back(), static_cast<int>(data.prices.size() - 1));
 }
 
 /**
@@ -145,33 +130,19 @@ SimulationResult MeanReversionStrategy::execute(const MarketData& data, double i
  *
  * Calculates the mean, standard deviation, and z-score based on the price history.
  * These statistics are used to determine entry and exit points for the strategy.
+ * In robust mode the median stands in for the mean and 1.4826 * MAD for the
+ * standard deviation, so a single jump in the window moves neither.
  */
 void MeanReversionStrategy::calculateStats() {
-    if (priceHistory.size() <= 1) {
-        currentMean = priceHistory.front();
-        currentStdDev = 0.0;
-        currentZScore = 0.0;
+    if (robustZScore) {
+        currentMean = priceQuantiles.median();
+        currentStdDev = 1.4826 * priceQuantiles.mad();
+        currentZScore = currentStdDev > 0.0 ? (lastPrice - currentMean) / currentStdDev : 0.0;
         return;
     }
-
-    // Calculate mean
-    double sum = std::accumulate(priceHistory.begin(), priceHistory.end(), 0.0);
-    currentMean = sum / priceHistory.size();
-
-    // Calculate standard deviation
-    double variance = 0.0;
-    for (double price : priceHistory) {
-        variance += (price - currentMean) * (price - currentMean);
-    }
-    variance /= priceHistory.size();
-    currentStdDev = std::sqrt(variance);
-
-    // Calculate z-score
-    if (currentStdDev > 0.0) {
-        currentZScore = (lastPrice - currentMean) / currentStdDev;
-    } else {
-        currentZScore = 0.0;
-    }
+    currentMean = priceStats.mean();
+    currentStdDev = priceStats.stdDev();
+    currentZScore = priceStats.zScore(lastPrice);
 }
 
 /**
@@ -198,36 +169,23 @@ void MeanReversionStrategy::onTick(double price, int timeStep, const std::string
     std::string timestamp = ss.str();
 
     // Update price history
-    priceHistory.push_back(price);
-    if (priceHistory.size() > static_cast<size_t>(lookbackPeriod)) {
-        priceHistory.pop_front();
+    priceStats.update(price);
+    if (robustZScore) {
+        priceQuantiles.update(price);
     }
     lastPrice = price;
 
     // Calculate statistics
     calculateStats();
 
-    // Record historical data point
-    HistoricalDataPoint dataPoint{
-        currentZScore, // Using MACD field for z-score
-        0.0,           // Not using signal field
-        cash + (position * price),  // current portfolio value
-        static_cast<double>(position),
-        cash,
-        currentMean,   // Using trend field for mean
-        currentStdDev  // Using volatility field for std dev
-    };
-
-    if (static_cast<size_t>(timeStep) >= historicalData.size()) {
-        historicalData.push_back(dataPoint);
-    } else {
-        historicalData[timeStep] = dataPoint;
-    }
+    // Record historical data point: z-score in the MACD field, mean as the
+    // trend and standard deviation as the volatility
+    portfolio.mark(price, currentZScore, 0.0, currentMean, currentStdDev);
 
     // Only start trading after we have enough data
-    if (priceHistory.size() < static_cast<size_t>(lookbackPeriod)) {
+    if (!priceStats.ready()) {
         if (timeStep % 10 == 0 || debugDetailTicks) {
-            std::cout << "DEBUG: " << timestamp << " - TICK " << timeStep << " - Building price history: " << priceHistory.size() << " / " << lookbackPeriod << std::endl;
+            std::cout << "DEBUG: " << timestamp << " - TICK " << timeStep << " - Building price history: " << priceStats.count() << " / " << lookbackPeriod << std::endl;
         }
         return;
     }
@@ -239,72 +197,47 @@ void MeanReversionStrategy::onTick(double price, int timeStep, const std::string
                   << " Z-Score: " << std::fixed << std::setprecision(2) << currentZScore << std::endl;
     }
 
+    const double position = portfolio.position();
+    const double entryPrice = portfolio.entryPrice();
+
     // Check stop loss and profit target for existing positions
     if (position > 0) { // Long position
-        // Check stop loss
+        const char* reason = nullptr;
         if (price < entryPrice * (1 - stopLossPct)) {
-            double proceeds = position * price * (1 - transactionCostRate);
-            cash += proceeds;
-            trades.push_back({timeStep, "EXIT_LONG", "SELL", price, static_cast<double>(position)});
-            std::cout << "DEBUG: " << timestamp << " - INFO: STOP LOSS triggered at " << std::fixed << std::setprecision(2) << price
-                      << ", qty: " << position << ", proceeds: " << std::fixed << std::setprecision(2) << proceeds << std::endl;
-            position = 0;
-            entryPrice = 0.0;
-            debugDetailTicks = true;
-            return;
+            reason = "STOP LOSS triggered";
+        } else if (price > entryPrice * (1 + profitTargetPct)) {
+            reason = "PROFIT TARGET reached";
         }
-        
-        // Check profit target
-        if (price > entryPrice * (1 + profitTargetPct)) {
-            double proceeds = position * price * (1 - transactionCostRate);
-            cash += proceeds;
-            trades.push_back({timeStep, "EXIT_LONG", "SELL", price, static_cast<double>(position)});
-            std::cout << "DEBUG: " << timestamp << " - INFO: PROFIT TARGET reached at " << std::fixed << std::setprecision(2) << price
+        if (reason) {
+            double proceeds = portfolio.close(price, timeStep);
+            std::cout << "DEBUG: " << timestamp << " - INFO: " << reason << " at " << std::fixed << std::setprecision(2) << price
                       << ", qty: " << position << ", proceeds: " << std::fixed << std::setprecision(2) << proceeds << std::endl;
-            position = 0;
-            entryPrice = 0.0;
             debugDetailTicks = true;
             return;
         }
     }
     else if (position < 0) { // Short position
-        // Check stop loss
+        const char* reason = nullptr;
         if (price > entryPrice * (1 + stopLossPct)) {
-            double cost = -position * price * (1 + transactionCostRate);
-            cash -= cost;
-            trades.push_back({timeStep, "EXIT_SHORT", "BUY", price, static_cast<double>(-position)});
-            std::cout << "DEBUG: " << timestamp << " - INFO: STOP LOSS triggered at " << std::fixed << std::setprecision(2) << price
-                      << ", qty: " << -position << ", cost: " << std::fixed << std::setprecision(2) << cost << std::endl;
-            position = 0;
-            entryPrice = 0.0;
-            debugDetailTicks = true;
-            return;
+            reason = "STOP LOSS triggered";
+        } else if (price < entryPrice * (1 - profitTargetPct)) {
+            reason = "PROFIT TARGET reached";
         }
-        
-        // Check profit target
-        if (price < entryPrice * (1 - profitTargetPct)) {
-            double cost = -position * price * (1 + transactionCostRate);
-            cash -= cost;
-            trades.push_back({timeStep, "EXIT_SHORT", "BUY", price, static_cast<double>(-position)});
-            std::cout << "DEBUG: " << timestamp << " - INFO: PROFIT TARGET reached at " << std::fixed << std::setprecision(2) << price
+        if (reason) {
+            double cost = -portfolio.close(price, timeStep);
+            std::cout << "DEBUG: " << timestamp << " - INFO: " << reason << " at " << std::fixed << std::setprecision(2) << price
                       << ", qty: " << -position << ", cost: " << std::fixed << std::setprecision(2) << cost << std::endl;
-            position = 0;
-            entryPrice = 0.0;
             debugDetailTicks = true;
             return;
         }
     }
 
-    // Trading logic based on mean reversion
+    // Trading logic based on mean reversion. Entries use 95% of available cash.
+    const double qty = std::trunc(portfolio.cash() / (price * (1 + portfolio.feeRate())) * 0.95);
     // Buy (go long) when price is too low (negative z-score with large magnitude)
     if (position == 0 && currentZScore < -entryThreshold) {
-        int qty = static_cast<int>(cash / (price * (1 + transactionCostRate)) * 0.95); // Use 95% of available cash
         if (qty > 0) {
-            double cost = qty * price * (1 + transactionCostRate);
-            cash -= cost;
-            position = qty;
-            entryPrice = price;
-            trades.push_back({timeStep, "LONG", "BUY", price, static_cast<double>(qty)});
+            double cost = -portfolio.buy(qty, price, timeStep);
             std::cout << "DEBUG: " << timestamp << " - INFO: BUY (Oversold) at " << std::fixed << std::setprecision(2) << price
                       << ", qty: " << qty << ", z-score: " << std::fixed << std::setprecision(2) << currentZScore
                       << ", cost: " << std::fixed << std::setprecision(2) << cost << std::endl;
@@ -313,13 +246,8 @@ void MeanReversionStrategy::onTick(double price, int timeStep, const std::string
     }
     // Sell (go short) when price is too high (positive z-score with large magnitude)
     else if (position == 0 && currentZScore > entryThreshold) {
-        int qty = static_cast<int>(cash / (price * (1 + transactionCostRate)) * 0.95); // Use 95% of available cash
         if (qty > 0) {
-            double proceeds = qty * price * (1 - transactionCostRate);
-            cash += proceeds;
-            position = -qty; // Negative for short position
-            entryPrice = price;
-            trades.push_back({timeStep, "SHORT", "SELL", price, static_cast<double>(qty)});
+            double proceeds = portfolio.sell(qty, price, timeStep);
             std::cout << "DEBUG: " << timestamp << " - INFO: SELL (Overbought) at " << std::fixed << std::setprecision(2) << price
                       << ", qty: " << qty << ", z-score: " << std::fixed << std::setprecision(2) << currentZScore
                       << ", proceeds: " << std::fixed << std::setprecision(2) << proceeds << std::endl;
@@ -328,29 +256,22 @@ void MeanReversionStrategy::onTick(double price, int timeStep, const std::string
     }
     // Exit long position when price returns to normal range
     else if (position > 0 && std::abs(currentZScore) < exitThreshold) {
-        double proceeds = position * price * (1 - transactionCostRate);
-        cash += proceeds;
-        trades.push_back({timeStep, "EXIT_LONG", "SELL", price, static_cast<double>(position)});
+        double proceeds = portfolio.close(price, timeStep);
         std::cout << "DEBUG: " << timestamp << " - INFO: EXIT LONG at " << std::fixed << std::setprecision(2) << price
                   << ", qty: " << position << ", z-score: " << std::fixed << std::setprecision(2) << currentZScore
                   << ", proceeds: " << std::fixed << std::setprecision(2) << proceeds << std::endl;
-        position = 0;
-        entryPrice = 0.0;
         debugDetailTicks = true;
     }
     // Exit short position when price returns to normal range
     else if (position < 0 && std::abs(currentZScore) < exitThreshold) {
-        double cost = -position * price * (1 + transactionCostRate);
-        cash -= cost;
-        trades.push_back({timeStep, "EXIT_SHORT", "BUY", price, static_cast<double>(-position)});
+        double cost = -portfolio.close(price, timeStep);
         std::cout << "DEBUG: " << timestamp << " - INFO: EXIT SHORT at " << std::fixed << std::setprecision(2) << price
                   << ", qty: " << -position << ", z-score: " << std::fixed << std::setprecision(2) << currentZScore
                   << ", cost: " << std::fixed << std::setprecision(2) << cost << std::endl;
-        position = 0;
-        entryPrice = 0.0;
         debugDetailTicks = true;
     }
 
+    const auto& trades = portfolio.trades();
     if (debugDetailTicks && (trades.size() > 0) && (trades.back().timeStep <= timeStep) && (trades.back().timeStep + 5 < timeStep)) {
         debugDetailTicks = false;
     }
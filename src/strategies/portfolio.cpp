@@ -0,0 +1,87 @@
+#include "strategies/portfolio.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace trading {
+
+/**
+ * @brief Constructor for the portfolio.
+ *
+ * @param feeRate Transaction cost as a fraction of traded value, charged on every fill
+ */
+Portfolio::Portfolio(double feeRate)
+    : account_()
+    , feeRate_(feeRate)
+    , initialCash_(0.0)
+{
+    if (feeRate < 0) {
+        throw std::invalid_argument("Portfolio: feeRate cannot be negative");
+    }
+}
+
+void Portfolio::reset(double initialCash, size_t bars) {
+    account_ = Account{initialCash, 0.0, 0.0, 0.0};
+    initialCash_ = initialCash;
+    trades_.clear();
+    historical_.clear();
+    historical_.reserve(bars);
+}
+
+/**
+ * @brief Trades to a target position.
+ *
+ * A move across zero is recorded as two trades at the same price: the exit
+ * of the old side, then the entry of the new one.
+ *
+ * @param target Shares to hold afterwards, negative for a short position
+ * @param price Fill price
+ * @param timeStep Bar index recorded with the trades
+ * @return Cash received, negative when cash was paid
+ */
+double Portfolio::targetPosition(double target, double price, int timeStep) {
+    const double current = account_.position;
+    if (target == current) {
+        return 0.0;
+    }
+    if (target < current) {
+        const double exitLong = current - std::max(target, 0.0);
+        const double enterShort = std::max(-target, 0.0) - std::max(-current, 0.0);
+        if (current > 0 && exitLong > 0) {
+            trades_.push_back({timeStep, "EXIT_LONG", "SELL", price, exitLong});
+        }
+        if (enterShort > 0) {
+            trades_.push_back({timeStep, "SHORT", "SELL", price, enterShort});
+        }
+    } else {
+        const double exitShort = -current - std::max(-target, 0.0);
+        const double enterLong = std::max(target, 0.0) - std::max(current, 0.0);
+        if (current < 0 && exitShort > 0) {
+            trades_.push_back({timeStep, "EXIT_SHORT", "BUY", price, exitShort});
+        }
+        if (enterLong > 0) {
+            trades_.push_back({timeStep, "LONG", "BUY", price, enterLong});
+        }
+    }
+    const double before = account_.cash;
+    tradeTo(account_, target, price, feeRate_, true);
+    return account_.cash - before;
+}
+
+void Portfolio::mark(double price, double macd, double signal, double trend, double volatility) {
+    historical_.push_back({
+        macd,
+        signal,
+        account_.equity(price),
+        account_.position,
+        account_.cash,
+        trend,
+        volatility
+    });
+}
+
+SimulationResult Portfolio::finish(double finalPrice, int finalStep) {
+    close(finalPrice, finalStep);
+    return {account_.cash, account_.cash - initialCash_, std::move(trades_), std::move(historical_)};
+}
+
+} // namespace trading
@@ -6,30 +6,37 @@
 #include <stdexcept>
 #include <iomanip>
 #include <chrono>
-#include <random>
 #include <ctime>
 
 namespace trading {
 
+namespace {
+    // Draw slots within a bar, so each decision has its own independent draw
+    constexpr uint32_t kDrawTradePct = 0;
+    constexpr uint32_t kDrawCoinFlip = 1;
+    constexpr uint32_t kDrawSellPct = 2;
+}
+
 /**
  * @brief Constructor for the Random strategy.
  *
  * This strategy makes random trading decisions at specified intervals,
  * simulating non-predictive or discretionary trading behavior.
- * Uses a fixed seed (42) for the random number generator to ensure
- * consistent simulation results across runs.
+ * Decisions come from a counter-based generator keyed by the seed, the
+ * run id and the bar index, so a given (seed, runId) always trades the
+ * same way on the same bars, and runs with different ids are independent
+ * however they are scheduled.
  *
  * @param transactionCost Transaction cost as a percentage of trade value
  * @param timeStepInterval Number of ticks to wait between trading decisions
  * @param clearAtEndOfDay Whether to liquidate all positions at the end of each trading day
+ * @param seed Random seed
+ * @param runId Stream within the seed; distinct ids give independent runs
  */
-RandomStrategy::RandomStrategy(double transactionCost, int timeStepInterval, bool clearAtEndOfDay)
-    : trades()
-    , historicalData()
-    , rng(42) // Use fixed seed for reproducible simulations
-    , cash(0)
-    , position(0)
-    , transactionCostRate(transactionCost)
+RandomStrategy::RandomStrategy(double transactionCost, int timeStepInterval, bool clearAtEndOfDay,
+                               uint64_t seed, uint64_t runId)
+    : portfolio(transactionCost)
+    , rng(seed, runId)
     , timeStepInterval(timeStepInterval)
     , clearAtEndOfDay(clearAtEndOfDay)
     , lastPrice(0.0)
@@ -49,7 +56,7 @@ RandomStrategy::RandomStrategy(double transactionCost, int timeStepInterval, boo
  * @brief Main execution method for the Random strategy.
  *
  * Processes market data tick by tick, executing the strategy logic:
- * 1. Initialize portfolio with random seed
+ * 1. Initialize the portfolio
  * 2. Process each price point sequentially
  * 3. Make random trading decisions at specified intervals
  * 4. Clear positions at the end of each day if configured
@@ -64,11 +71,7 @@ RandomStrategy::RandomStrategy(double transactionCost, int timeStepInterval, boo
  * @return SimulationResult object with performance metrics and trade history
  */
 SimulationResult RandomStrategy::execute(const MarketData& data, double initialCash) {
-    cash = initialCash;
-    position = 0;
-    trades.clear();
-    historicalData.clear();
-    historicalData.reserve(data.prices.size());
+    portfolio.reset(initialCash, data.prices.size());
     lastPrice = 0.0;
     currentDay = "";
     tickCounter = 0;
@@ -76,7 +79,7 @@ SimulationResult RandomStrategy::execute(const MarketData& data, double initialC
 
     if (data.prices.empty()) {
         std::cout << "No price data to process: Prices vector is empty." << std::endl;
-        return {cash, 0, trades, historicalData};
+        return portfolio.finish(0.0, 0);
     }
     if (initialCash <= 0) {
         std::cout << "Warning: Initial cash is not positive, simulation might not be meaningful." << std::endl;
@@ -94,24 +97,19 @@ SimulationResult RandomStrategy::execute(const MarketData& data, double initialC
     std::cout << "DEBUG: " << timestamp << " - INFO: Initial cash: " << initialCash << std::endl;
 
     for (size_t i = 0; i < data.prices.size(); ++i) {
+        checkCancellation(i);
         onTick(data.prices[i], i, data.timestamps[i]); // Pass timestamp
     }
 
     // Final liquidation at the end of the session if still holding
-    if (position > 0) {
+    if (portfolio.position() > 0) {
         double finalPrice = data.prices.back();
-        double proceeds = position * finalPrice * (1 - transactionCostRate);
-        cash += proceeds;
-        trades.push_back({static_cast<int>(data.prices.size()-1),
-                         "EXIT_LONG",
-                         "SELL",
-                         finalPrice,
-                         static_cast<double>(position)});
+        double proceeds = portfolio.close(finalPrice, static_cast<int>(data.prices.size() - 1));
         std::cout << "DEBUG: " << timestamp << " - INFO: End of session, liquidated position at price " << finalPrice << ", proceeds: " << proceeds << std::endl;
     }
 
     std::cout << "DEBUG: " << timestamp << " - INFO: Strategy execution completed." << std::endl;
-    return {cash, cash - initialCash, trades, historicalData};
+    return portfolio.finish(data.prices.back(), static_cast<int>(data.prices.size() - 1));
 }
 
 /**
@@ -147,30 +145,13 @@ void RandomStrategy::onTick(double price, int timeStep, const std::string& tickT
     currentDay = day;
     
     // Sell all holdings at the end of the day if setting is enabled and we just changed days
-    if (clearAtEndOfDay && isNewDay && position > 0) {
-        double proceeds = position * price * (1 - transactionCostRate);
-        cash += proceeds;
-        trades.push_back({timeStep, "EXIT_LONG", "SELL", price, static_cast<double>(position)});
+    if (clearAtEndOfDay && isNewDay && portfolio.position() > 0) {
+        double proceeds = portfolio.close(price, timeStep);
         std::cout << "DEBUG: " << timestamp << " - INFO: End of day " << currentDay << ", liquidated position at price " << std::fixed << std::setprecision(2) << price << ", proceeds: " << std::fixed << std::setprecision(2) << proceeds << std::endl;
-        position = 0;
     }
 
     // Record historical data point
-    HistoricalDataPoint dataPoint{
-        0.0, // No MACD in this strategy
-        0.0, // No signal in this strategy
-        cash + (position * price),  // current portfolio value
-        static_cast<double>(position),
-        cash,
-        0.0, // No trend in this strategy  
-        0.0  // No volatility in this strategy
-    };
-
-    if (static_cast<size_t>(timeStep) >= historicalData.size()) {
-        historicalData.push_back(dataPoint);
-    } else {
-        historicalData[timeStep] = dataPoint;
-    }
+    portfolio.mark(price);
 
     // Increment tick counter
     tickCounter++;
@@ -180,36 +161,29 @@ void RandomStrategy::onTick(double price, int timeStep, const std::string& tickT
         tickCounter = 0;
         
         // Generate a random percentage (1-5%) for trading
-        std::uniform_real_distribution<double> pctDist(0.01, 0.05);
-        double tradePct = pctDist(rng);
+        double tradePct = rng.uniform(timeStep, kDrawTradePct, 0.01, 0.05);
         
         if (timeStep % 10 == 0 || debugDetailTicks) {
             std::cout << "DEBUG: " << timestamp << " - TICK " << timeStep << " - Considering random trade of " << std::fixed << std::setprecision(2) << (tradePct * 100) << "% at price " << std::fixed << std::setprecision(2) << price << std::endl;
         }
         
         // If we don't have a position, make a buy
-        if (position == 0) {
-            int maxQty = static_cast<int>(cash / (price * (1 + transactionCostRate)));
-            int qty = static_cast<int>(maxQty * tradePct);
+        if (portfolio.position() == 0) {
+            double maxQty = affordableShares(portfolio.cash(), price, portfolio.feeRate());
+            double qty = std::trunc(maxQty * tradePct);
             
             // Ensure at least 1 share is bought if we have cash
             if (qty < 1 && maxQty >= 1) qty = 1;
             
             if (qty > 0) {
-                double cost = qty * price * (1 + transactionCostRate);
-                if (cash >= cost) {
-                    cash -= cost;
-                    position += qty;
-                    trades.push_back({timeStep, "LONG", "BUY", price, static_cast<double>(qty)});
-                    std::cout << "DEBUG: " << timestamp << " - INFO: RANDOM BUY at " << std::fixed << std::setprecision(2) << price << ", qty: " << qty << ", cost: " << std::fixed << std::setprecision(2) << cost << ", new cash: " << std::fixed << std::setprecision(2) << cash << std::endl;
-                    debugDetailTicks = true;
-                }
+                double cost = -portfolio.buy(qty, price, timeStep);
+                std::cout << "DEBUG: " << timestamp << " - INFO: RANDOM BUY at " << std::fixed << std::setprecision(2) << price << ", qty: " << qty << ", cost: " << std::fixed << std::setprecision(2) << cost << ", new cash: " << std::fixed << std::setprecision(2) << portfolio.cash() << std::endl;
+                debugDetailTicks = true;
             }
         } 
         // If we have a position, flip a coin to decide whether to sell
-        else if (position > 0) {
-            std::uniform_int_distribution<int> coinFlip(0, 1);
-            bool sellDecision = coinFlip(rng) == 1;
+        else if (portfolio.position() > 0) {
+            bool sellDecision = rng.uniform(timeStep, kDrawCoinFlip) < 0.5;
             
             if (timeStep % 10 == 0 || debugDetailTicks) {
                 std::cout << "DEBUG: " << timestamp << " - TICK " << timeStep << " - Coin flip for sell: " << (sellDecision ? "HEADS (Sell)" : "TAILS (Hold)") << std::endl;
@@ -217,21 +191,17 @@ void RandomStrategy::onTick(double price, int timeStep, const std::string& tickT
             
             if (sellDecision) {
                 // Sell a random portion (between 50-100%) of the position
-                std::uniform_real_distribution<double> sellPctDist(0.5, 1.0);
-                double sellPct = sellPctDist(rng);
-                int sellQty = static_cast<int>(position * sellPct);
+                double sellPct = rng.uniform(timeStep, kDrawSellPct, 0.5, 1.0);
+                double sellQty = std::trunc(portfolio.position() * sellPct);
                 
                 // Ensure at least 1 share is sold
                 if (sellQty < 1) sellQty = 1;
                 // Don't sell more than we have
-                if (sellQty > position) sellQty = position;
+                if (sellQty > portfolio.position()) sellQty = portfolio.position();
                 
                 if (sellQty > 0) {
-                    double proceeds = sellQty * price * (1 - transactionCostRate);
-                    cash += proceeds;
-                    position -= sellQty;
-                    trades.push_back({timeStep, "EXIT_LONG", "SELL", price, static_cast<double>(sellQty)});
-                    std::cout << "DEBUG: " << timestamp << " - INFO: COIN FLIP SELL at " << std::fixed << std::setprecision(2) << price << ", qty: " << sellQty << ", proceeds: " << std::fixed << std::setprecision(2) << proceeds << ", new cash: " << std::fixed << std::setprecision(2) << cash << std::endl;
+                    double proceeds = portfolio.sell(sellQty, price, timeStep);
+                    std::cout << "DEBUG: " << timestamp << " - INFO: COIN FLIP SELL at " << std::fixed << std::setprecision(2) << price << ", qty: " << sellQty << ", proceeds: " << std::fixed << std::setprecision(2) << proceeds << ", new cash: " << std::fixed << std::setprecision(2) << portfolio.cash() << std::endl;
                     debugDetailTicks = true;
                 }
             }
@@ -240,6 +210,7 @@ void RandomStrategy::onTick(double price, int timeStep, const std::string& tickT
     
     lastPrice = price;
     
+    const auto& trades = portfolio.trades();
     if (debugDetailTicks && (trades.back().timeStep <= timeStep) && (trades.back().timeStep + 5 < timeStep)) {
         debugDetailTicks = false;
     }
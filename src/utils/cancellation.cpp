@@ -0,0 +1,161 @@
+#include "utils/cancellation.h"
+#include <algorithm>
+
+namespace trading {
+
+CancellationToken::CancellationToken() : state(std::make_shared<State>()) {}
+
+/**
+ * @brief Cancels the token; the first reason given is kept.
+ *
+ * @param reason Message carried by the resulting OperationCancelled
+ */
+void CancellationToken::cancel(const std::string& reason) const {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (!state->cancelled.load(std::memory_order_relaxed)) {
+        state->reason = reason;
+        state->cancelled.store(true, std::memory_order_release);
+    }
+}
+
+/**
+ * @brief Checks the flag, then the deadline, then the probe.
+ *
+ * @return true once the token has been cancelled
+ */
+bool CancellationToken::isCancelled() const {
+    if (state->cancelled.load(std::memory_order_acquire)) {
+        return true;
+    }
+    int64_t deadlineNs = state->deadlineNs.load(std::memory_order_relaxed);
+    if (deadlineNs != 0 && Clock::now().time_since_epoch().count() >= deadlineNs) {
+        expire("Deadline exceeded");
+        return true;
+    }
+    std::function<bool()> probe;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        probe = state->probe;
+    }
+    if (probe && probe()) {
+        cancel("Client disconnected");
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Cancellation checkpoint.
+ *
+ * @throws DeadlineExceeded if the token's deadline has passed
+ * @throws OperationCancelled if the token has been cancelled for another reason
+ */
+void CancellationToken::throwIfCancelled() const {
+    if (isCancelled()) {
+        if (state->deadlineExceeded.load(std::memory_order_acquire)) {
+            throw DeadlineExceeded(reason());
+        }
+        throw OperationCancelled(reason());
+    }
+}
+
+std::string CancellationToken::reason() const {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return state->reason;
+}
+
+/**
+ * @brief Installs a probe that is polled on every check.
+ *
+ * @param probe Returns true when the work should be abandoned
+ */
+void CancellationToken::setProbe(std::function<bool()> probe) {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->probe = std::move(probe);
+}
+
+void CancellationToken::expire(const std::string& reason) const {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (!state->cancelled.load(std::memory_order_relaxed)) {
+        state->reason = reason;
+        state->deadlineExceeded.store(true, std::memory_order_release);
+        state->cancelled.store(true, std::memory_order_release);
+    }
+}
+
+/**
+ * @brief Sets the point in time after which the token counts as cancelled.
+ *
+ * @param deadline Steady-clock deadline
+ */
+void CancellationToken::setDeadline(Clock::time_point deadline) {
+    int64_t ns = deadline.time_since_epoch().count();
+    state->deadlineNs.store(ns == 0 ? 1 : ns, std::memory_order_relaxed);
+}
+
+bool CancellationToken::hasDeadline() const {
+    return state->deadlineNs.load(std::memory_order_relaxed) != 0;
+}
+
+/**
+ * @brief Time left until the deadline.
+ *
+ * @return Remaining budget (zero once expired), or milliseconds::max() without a deadline
+ */
+std::chrono::milliseconds CancellationToken::remaining() const {
+    int64_t deadlineNs = state->deadlineNs.load(std::memory_order_relaxed);
+    if (deadlineNs == 0) {
+        return std::chrono::milliseconds::max();
+    }
+    auto left = Clock::duration(deadlineNs) - Clock::now().time_since_epoch();
+    return std::max(std::chrono::milliseconds(0), std::chrono::duration_cast<std::chrono::milliseconds>(left));
+}
+
+/**
+ * @brief Budget checkpoint before starting a stage.
+ *
+ * Expires the token right away if the stage is not expected to finish in
+ * the remaining budget, instead of starting work that would be thrown away.
+ *
+ * @param needed Expected duration of the stage
+ * @param stage Stage name used in the error message
+ * @throws DeadlineExceeded if the budget is insufficient
+ * @throws OperationCancelled if the token was already cancelled
+ */
+void CancellationToken::requireBudget(std::chrono::milliseconds needed, const std::string& stage) const {
+    throwIfCancelled();
+    auto left = remaining();
+    if (left < needed) {
+        expire("Deadline exceeded: " + std::to_string(left.count()) + "ms left, " + stage + " needs about " +
+               std::to_string(needed.count()) + "ms");
+        throwIfCancelled();
+    }
+}
+
+namespace {
+    // Weight of the newest sample in a duration estimate
+    constexpr double kEstimateWeight = 0.2;
+}
+
+/**
+ * @brief Folds a stage's duration into the moving average.
+ *
+ * @param start When the stage started
+ */
+void DurationEstimate::record(CancellationToken::Clock::time_point start) {
+    double sample = std::chrono::duration<double, std::milli>(CancellationToken::Clock::now() - start).count();
+    double current = average.load(std::memory_order_relaxed);
+    double next;
+    do {
+        next = current == 0.0 ? sample : current + kEstimateWeight * (sample - current);
+    } while (!average.compare_exchange_weak(current, next, std::memory_order_relaxed));
+}
+
+/**
+ * @brief Budget a request should have left before starting the stage.
+ */
+std::chrono::milliseconds DurationEstimate::budget() const {
+    return std::chrono::milliseconds(static_cast<int64_t>(averageMs()));
+}
+
+} // namespace trading
@@ -0,0 +1,104 @@
+#include "utils/circuit_breaker.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace trading {
+
+/**
+ * @brief Constructor for the circuit breaker.
+ *
+ * @param failureThreshold Consecutive failures that open the breaker
+ * @param cooldown How long the breaker stays open before a trial call
+ */
+CircuitBreaker::CircuitBreaker(size_t failureThreshold, std::chrono::milliseconds cooldown)
+    : failureThreshold(failureThreshold)
+    , cooldown(cooldown)
+    , current(State::Closed)
+    , failures(0)
+    , trialInFlight(false)
+{
+    if (failureThreshold == 0) {
+        throw std::invalid_argument("CircuitBreaker: failure threshold must be positive");
+    }
+}
+
+/**
+ * @brief Decides whether a call may go ahead.
+ *
+ * While open, calls are rejected until the cooldown has passed. The first
+ * call after that becomes the half-open trial; others are rejected until
+ * its outcome is recorded.
+ *
+ * @return true if the call may proceed
+ */
+bool CircuitBreaker::allow() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (current == State::Closed) {
+        return true;
+    }
+    if (current == State::Open) {
+        if (Clock::now() - openedAt < cooldown) {
+            return false;
+        }
+        current = State::HalfOpen;
+    }
+    if (trialInFlight) {
+        return false;
+    }
+    trialInFlight = true;
+    return true;
+}
+
+void CircuitBreaker::recordSuccess() {
+    std::lock_guard<std::mutex> lock(mutex);
+    current = State::Closed;
+    failures = 0;
+    trialInFlight = false;
+}
+
+/**
+ * @brief Counts a failed call, opening the breaker at the threshold or on a failed trial.
+ */
+void CircuitBreaker::recordFailure() {
+    std::lock_guard<std::mutex> lock(mutex);
+    failures++;
+    if (current == State::HalfOpen || failures >= failureThreshold) {
+        current = State::Open;
+        openedAt = Clock::now();
+    }
+    trialInFlight = false;
+}
+
+/**
+ * @brief Ends a call that finished without telling us anything (e.g. it was cancelled).
+ */
+void CircuitBreaker::recordAbandoned() {
+    std::lock_guard<std::mutex> lock(mutex);
+    trialInFlight = false;
+}
+
+CircuitBreaker::State CircuitBreaker::state() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return current;
+}
+
+size_t CircuitBreaker::consecutiveFailures() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return failures;
+}
+
+/**
+ * @brief Time until the breaker lets a trial call through.
+ *
+ * @return Remaining cooldown, or zero if calls are currently allowed
+ */
+std::chrono::milliseconds CircuitBreaker::retryAfter() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (current != State::Open) {
+        return std::chrono::milliseconds(0);
+    }
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(cooldown - (Clock::now() - openedAt));
+    return std::max(std::chrono::milliseconds(0), left);
+}
+
+} // namespace trading
@@ -0,0 +1,125 @@
+#include "utils/file_lock.h"
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace trading {
+
+namespace {
+    std::atomic<uint64_t> tempCounter{0};
+}
+
+/**
+ * @brief Opens (creating if needed) and exclusively locks a lock file, blocking until it is free.
+ *
+ * @param path Lock file path
+ * @throws std::runtime_error if the file cannot be opened or locked
+ */
+FileLock::FileLock(const std::string& path) : fd(open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644)) {
+    if (fd < 0) {
+        throw std::runtime_error("FileLock: cannot open " + path + ": " + std::strerror(errno));
+    }
+    struct flock fl = {};
+    fl.l_type = F_WRLCK;
+    fl.l_whence = SEEK_SET;
+    while (fcntl(fd, F_SETLKW, &fl) != 0) {
+        if (errno != EINTR) {
+            int err = errno;
+            close(fd);
+            throw std::runtime_error("FileLock: cannot lock " + path + ": " + std::strerror(err));
+        }
+    }
+}
+
+FileLock::~FileLock() {
+    close(fd);
+}
+
+/**
+ * @brief Creates a directory and its missing parents, like mkdir -p.
+ *
+ * @param path Directory path
+ * @param owner Prefix for error messages
+ * @throws std::runtime_error if a component cannot be created
+ */
+void makeDirectory(const std::string& path, const std::string& owner) {
+    std::string partial;
+    for (size_t i = 0; i <= path.size(); ++i) {
+        if (i == path.size() || (path[i] == '/' && i > 0)) {
+            partial = path.substr(0, i);
+            if (mkdir(partial.c_str(), 0755) != 0 && errno != EEXIST) {
+                throw std::runtime_error(owner + ": cannot create directory " + partial + ": " + std::strerror(errno));
+            }
+        }
+    }
+}
+
+/**
+ * @brief Writes the contents of a file about to be published.
+ *
+ * The temp name carries the host, the process and a per-process counter,
+ * so concurrent writers of one path, in threads, processes or on hosts
+ * sharing the directory, never write into each other's file.
+ *
+ * @param path Final path; the temp file is created next to it
+ * @param owner Prefix for error messages
+ * @param write Writes the contents, returning false on failure; may throw
+ * @param sync Whether to fsync the file before returning
+ * @return The temp path, ready for publishTempFile
+ * @throws std::runtime_error if the file cannot be created, written or flushed
+ */
+std::string writeTempFile(const std::string& path, const std::string& owner,
+                          const std::function<bool(FILE*)>& write, bool sync) {
+    char host[64] = "localhost";
+    gethostname(host, sizeof(host) - 1);
+    const std::string tempPath = path + ".tmp." + host + "." + std::to_string(getpid()) + "." +
+                                 std::to_string(tempCounter.fetch_add(1));
+    FILE* file = std::fopen(tempPath.c_str(), "wbx");
+    if (!file) {
+        throw std::runtime_error(owner + ": cannot create " + tempPath + ": " + std::strerror(errno));
+    }
+    bool ok;
+    try {
+        ok = write(file);
+    } catch (...) {
+        std::fclose(file);
+        unlink(tempPath.c_str());
+        throw;
+    }
+    ok = std::fflush(file) == 0 && ok;
+    ok = (!sync || fsync(fileno(file)) == 0) && ok;
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok) {
+        unlink(tempPath.c_str());
+        throw std::runtime_error(owner + ": writing " + tempPath + " failed");
+    }
+    return tempPath;
+}
+
+/**
+ * @brief Renames a temp file from writeTempFile over its final path.
+ *
+ * @throws std::runtime_error if the rename fails; the temp file is removed
+ */
+void publishTempFile(const std::string& tempPath, const std::string& path, const std::string& owner) {
+    if (rename(tempPath.c_str(), path.c_str()) != 0) {
+        int err = errno;
+        unlink(tempPath.c_str());
+        throw std::runtime_error(owner + ": publishing " + path + " failed: " + std::strerror(err));
+    }
+}
+
+/**
+ * @brief Replaces a file atomically: write a temp file, fsync, rename.
+ *
+ * A crash leaves either the old file or the new one, never a torn one.
+ */
+void publishFile(const std::string& path, const std::string& owner, const std::function<bool(FILE*)>& write) {
+    publishTempFile(writeTempFile(path, owner, write), path, owner);
+}
+
+} // namespace trading
@@ -0,0 +1,143 @@
+#include "utils/gzip.h"
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+#include <stdexcept>
+#include <zlib.h>
+
+namespace trading {
+
+namespace {
+    // zlib window bits plus 16 selects the gzip wrapper instead of zlib's own
+    constexpr int kGzipWindowBits = 15 + 16;
+
+    // zlib counts in uInt, so large inputs are fed in slices
+    constexpr size_t kMaxSlice = 1u << 30;
+
+    std::string trim(const std::string& s) {
+        size_t begin = s.find_first_not_of(" \t");
+        size_t end = s.find_last_not_of(" \t");
+        return begin == std::string::npos ? "" : s.substr(begin, end - begin + 1);
+    }
+}
+
+/**
+ * @brief Compresses a buffer into a single gzip member.
+ *
+ * @param data Bytes to compress
+ * @param level zlib level, 1 (fastest) to 9 (smallest)
+ * @return The gzip stream
+ * @throws std::runtime_error if zlib fails
+ */
+std::string gzipCompress(std::string_view data, int level) {
+    z_stream stream = {};
+    if (deflateInit2(&stream, level, Z_DEFLATED, kGzipWindowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw std::runtime_error("gzip: deflateInit2 failed");
+    }
+    std::string out;
+    out.resize(deflateBound(&stream, static_cast<uLong>(std::min(data.size(), kMaxSlice))) + 64);
+    size_t consumed = 0;
+    int status = Z_OK;
+    do {
+        size_t slice = std::min(data.size() - consumed, kMaxSlice);
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data() + consumed));
+        stream.avail_in = static_cast<uInt>(slice);
+        consumed += slice;
+        int flush = consumed == data.size() ? Z_FINISH : Z_NO_FLUSH;
+        do {
+            if (stream.total_out == out.size()) {
+                out.resize(out.size() * 2);
+            }
+            stream.next_out = reinterpret_cast<Bytef*>(&out[stream.total_out]);
+            stream.avail_out = static_cast<uInt>(std::min<size_t>(out.size() - stream.total_out, kMaxSlice));
+            status = deflate(&stream, flush);
+            if (status == Z_STREAM_ERROR) {
+                deflateEnd(&stream);
+                throw std::runtime_error("gzip: deflate failed");
+            }
+        } while (stream.avail_out == 0 || (flush == Z_FINISH && status != Z_STREAM_END));
+    } while (consumed < data.size());
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    return out;
+}
+
+/**
+ * @brief Decompresses a gzip stream.
+ *
+ * @param data gzip bytes
+ * @param length Size of the stream
+ * @return The original bytes
+ * @throws std::runtime_error if the stream is corrupt or truncated
+ */
+std::string gzipDecompress(const char* data, size_t length) {
+    z_stream stream = {};
+    if (inflateInit2(&stream, kGzipWindowBits) != Z_OK) {
+        throw std::runtime_error("gzip: inflateInit2 failed");
+    }
+    std::string out;
+    out.resize(std::max<size_t>(length * 4, 4096));
+    size_t consumed = 0;
+    int status = Z_OK;
+    while (status != Z_STREAM_END) {
+        if (stream.avail_in == 0) {
+            size_t slice = std::min(length - consumed, kMaxSlice);
+            if (slice == 0) {
+                inflateEnd(&stream);
+                throw std::runtime_error("gzip: truncated stream");
+            }
+            stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data + consumed));
+            stream.avail_in = static_cast<uInt>(slice);
+            consumed += slice;
+        }
+        if (stream.total_out == out.size()) {
+            out.resize(out.size() * 2);
+        }
+        stream.next_out = reinterpret_cast<Bytef*>(&out[stream.total_out]);
+        stream.avail_out = static_cast<uInt>(std::min<size_t>(out.size() - stream.total_out, kMaxSlice));
+        status = inflate(&stream, Z_NO_FLUSH);
+        if (status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR) {
+            inflateEnd(&stream);
+            throw std::runtime_error("gzip: corrupt stream");
+        }
+    }
+    out.resize(stream.total_out);
+    inflateEnd(&stream);
+    return out;
+}
+
+/**
+ * @brief Checks an Accept-Encoding header for gzip, honouring "q=0".
+ *
+ * @param acceptEncoding Header value, e.g. "gzip, deflate, br"
+ * @return true if gzip (or "*") is listed with a non-zero quality
+ */
+bool acceptsGzip(const std::string& acceptEncoding) {
+    std::stringstream ss(acceptEncoding);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        std::string coding = item;
+        double quality = 1.0;
+        size_t semicolon = item.find(';');
+        if (semicolon != std::string::npos) {
+            coding = item.substr(0, semicolon);
+            std::string param = trim(item.substr(semicolon + 1));
+            if (param.rfind("q=", 0) == 0) {
+                try {
+                    quality = std::stod(param.substr(2));
+                } catch (const std::exception&) {
+                    quality = 0.0;
+                }
+            }
+        }
+        coding = trim(coding);
+        std::transform(coding.begin(), coding.end(), coding.begin(),
+                       [](unsigned char c) { return std::tolower(c); });
+        if ((coding == "gzip" || coding == "*") && quality > 0.0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace trading
@@ -0,0 +1,190 @@
+#include "utils/placement.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+namespace trading {
+
+namespace {
+    constexpr uintptr_t kHugePageBytes = 2 * 1024 * 1024;
+
+    int parseCpu(const std::string& text, const std::string& list) {
+        size_t used = 0;
+        int cpu = -1;
+        try {
+            cpu = std::stoi(text, &used);
+        } catch (const std::exception&) {
+        }
+        if (used != text.size() || cpu < 0 || cpu >= CPU_SETSIZE) {
+            throw std::invalid_argument("Invalid CPU list '" + list + "'");
+        }
+        return cpu;
+    }
+}
+
+/**
+ * @brief Parses a CPU list in the format used by taskset and /sys.
+ *
+ * @param text Comma separated CPU numbers and inclusive ranges, e.g. "0-3,8"
+ * @return Sorted, de-duplicated CPU numbers
+ * @throws std::invalid_argument if the list is empty or malformed
+ */
+CpuList parseCpuList(const std::string& text) {
+    CpuList cpus;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty()) {
+            continue;
+        }
+        size_t dash = item.find('-');
+        int first = parseCpu(item.substr(0, dash), text);
+        int last = dash == std::string::npos ? first : parseCpu(item.substr(dash + 1), text);
+        if (last < first) {
+            throw std::invalid_argument("Invalid CPU list '" + text + "'");
+        }
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    if (cpus.empty()) {
+        throw std::invalid_argument("Invalid CPU list '" + text + "'");
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+/**
+ * @brief Formats a CPU list compactly, e.g. {0, 1, 2, 3, 8} becomes "0-3,8".
+ */
+std::string formatCpuList(const CpuList& cpus) {
+    std::string text;
+    for (size_t i = 0; i < cpus.size();) {
+        size_t j = i;
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) {
+            j++;
+        }
+        if (!text.empty()) {
+            text += ',';
+        }
+        text += std::to_string(cpus[i]);
+        if (j > i) {
+            text += '-' + std::to_string(cpus[j]);
+        }
+        i = j + 1;
+    }
+    return text;
+}
+
+/**
+ * @brief Lists the CPUs in the process's affinity mask.
+ */
+CpuList availableCpus() {
+    CpuList cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+        return cpus;
+    }
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &set)) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+/**
+ * @brief Reads a CPU list from the environment.
+ *
+ * CPUs the process is not allowed to use (for example outside its cgroup
+ * or taskset mask) are dropped with a warning.
+ *
+ * @param name Environment variable name
+ * @return The usable CPUs, or an empty list if unset, invalid or none usable
+ */
+CpuList cpuListFromEnvironment(const char* name) {
+    const char* value = std::getenv(name);
+    if (!value || !*value) {
+        return {};
+    }
+    CpuList requested;
+    try {
+        requested = parseCpuList(value);
+    } catch (const std::invalid_argument&) {
+        std::cerr << "Warning: ignoring invalid " << name << " value '" << value << "'" << std::endl;
+        return {};
+    }
+
+    CpuList allowed = availableCpus();
+    CpuList cpus;
+    std::set_intersection(requested.begin(), requested.end(), allowed.begin(), allowed.end(),
+                          std::back_inserter(cpus));
+    if (cpus.empty()) {
+        std::cerr << "Warning: ignoring " << name << ", none of its CPUs are in this process's mask ("
+                  << formatCpuList(allowed) << ")" << std::endl;
+    } else if (cpus.size() != requested.size()) {
+        std::cerr << "Warning: " << name << " lists CPUs outside this process's mask ("
+                  << formatCpuList(allowed) << "); using '" << formatCpuList(cpus) << "'" << std::endl;
+    }
+    return cpus;
+}
+
+/**
+ * @brief Sets the calling thread's affinity mask.
+ *
+ * Threads started afterwards by this thread inherit the mask.
+ *
+ * @param cpus CPUs to allow; an empty list leaves the mask unchanged
+ * @return true if the mask was applied
+ */
+bool pinCurrentThread(const CpuList& cpus) {
+    if (cpus.empty()) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        CPU_SET(cpu, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+bool hugePagesEnabled() {
+    static const bool enabled = []() {
+        const char* value = std::getenv("TRADING_HUGE_PAGES");
+        return value && std::string(value) == "1";
+    }();
+    return enabled;
+}
+
+/**
+ * @brief Advises the kernel to back a buffer with transparent huge pages.
+ *
+ * Only whole 2 MB pages inside the buffer are advised, so neighbouring heap
+ * memory is untouched. The advice only shapes pages that are faulted in
+ * afterwards, which is why callers reserve first and write second.
+ *
+ * @param data Start of the buffer
+ * @param bytes Buffer size in bytes
+ */
+void adviseHugePages(const void* data, size_t bytes) {
+    if (!hugePagesEnabled() || !data) {
+        return;
+    }
+    uintptr_t begin = (reinterpret_cast<uintptr_t>(data) + kHugePageBytes - 1) & ~(kHugePageBytes - 1);
+    uintptr_t end = (reinterpret_cast<uintptr_t>(data) + bytes) & ~(kHugePageBytes - 1);
+    if (end > begin) {
+        madvise(reinterpret_cast<void*>(begin), end - begin, MADV_HUGEPAGE);
+    }
+}
+
+} // namespace trading
@@ -0,0 +1,221 @@
+#include "utils/scheduler.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace trading {
+
+namespace {
+    size_t envCount(const char* name, size_t defaultValue) {
+        const char* value = std::getenv(name);
+        if (!value) {
+            return defaultValue;
+        }
+        try {
+            long long parsed = std::stoll(value);
+            if (parsed > 0) {
+                return static_cast<size_t>(parsed);
+            }
+        } catch (const std::exception&) {
+        }
+        std::cerr << "Warning: ignoring invalid " << name << " value '" << value << "'" << std::endl;
+        return defaultValue;
+    }
+}
+
+/**
+ * @brief Constructor for the two-tier scheduler.
+ *
+ * @param workers Number of compute worker threads
+ * @param maxInteractive Maximum interactive tasks running at once
+ * @param maxBackground Maximum background units running at once
+ * @param cpus CPUs the workers are pinned to; empty leaves placement to the kernel
+ */
+Scheduler::Scheduler(size_t workers, size_t maxInteractive, size_t maxBackground, CpuList cpus)
+    : stopping(false)
+    , cpuSet(std::move(cpus))
+{
+    if (workers == 0 || maxInteractive == 0 || maxBackground == 0) {
+        throw std::invalid_argument("Scheduler: worker count and class limits must be positive");
+    }
+    classes[static_cast<int>(Priority::Interactive)].limit = std::min(maxInteractive, workers);
+    classes[static_cast<int>(Priority::Background)].limit = std::min(maxBackground, workers);
+
+    // One CPU per worker when there are enough, otherwise all share the set
+    bool dedicated = workers <= cpuSet.size();
+    threads.reserve(workers);
+    for (size_t i = 0; i < workers; ++i) {
+        CpuList mask = dedicated ? CpuList{cpuSet[i]} : cpuSet;
+        threads.emplace_back([this, mask]() { workerLoop(mask); });
+    }
+}
+
+/**
+ * @brief Drains all queued work and joins the workers.
+ */
+Scheduler::~Scheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeup.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+/**
+ * @brief Builds a scheduler sized from the environment.
+ *
+ * By default there is one worker per hardware thread (at least two). All of
+ * them may run interactive work, but at most half may run background work,
+ * so interactive requests never wait behind a large background job.
+ * With TRADING_COMPUTE_CPUS set, the default is one worker per listed CPU.
+ *
+ * @return The configured scheduler
+ */
+std::unique_ptr<Scheduler> Scheduler::fromEnvironment() {
+    CpuList cpus = cpuListFromEnvironment("TRADING_COMPUTE_CPUS");
+    size_t hardware = cpus.empty() ? std::max<size_t>(2, std::thread::hardware_concurrency()) : cpus.size();
+    size_t workers = envCount("TRADING_COMPUTE_THREADS", hardware);
+    size_t maxInteractive = envCount("TRADING_MAX_INTERACTIVE", workers);
+    size_t maxBackground = envCount("TRADING_MAX_BACKGROUND", std::max<size_t>(1, workers / 2));
+    return std::make_unique<Scheduler>(workers, maxInteractive, maxBackground, std::move(cpus));
+}
+
+/**
+ * @brief Queues a task that runs to completion in a single unit.
+ *
+ * @param priority Priority class of the task
+ * @param task Work to run on a compute worker
+ * @return Future that becomes ready (or holds the task's exception) when it finishes
+ */
+std::future<void> Scheduler::submit(Priority priority, std::function<void()> task) {
+    return submitResumable(priority, [task = std::move(task)]() {
+        task();
+        return false;
+    });
+}
+
+/**
+ * @brief Queues a resumable task.
+ *
+ * The task is called repeatedly, one unit per call, until it returns false.
+ * Between units it goes to the back of its class queue. Queued interactive
+ * work and other background jobs therefore get a worker before the task's
+ * next unit runs.
+ *
+ * @param priority Priority class of the task
+ * @param task Unit of work returning true while more units remain
+ * @return Future that becomes ready when the last unit has run
+ */
+std::future<void> Scheduler::submitResumable(Priority priority, ResumableTask task) {
+    auto done = std::make_shared<std::promise<void>>();
+    std::future<void> future = done->get_future();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) {
+            throw std::runtime_error("Scheduler: cannot submit work while shutting down");
+        }
+        classes[static_cast<int>(priority)].queue.push_back({std::move(task), std::move(done), Clock::now()});
+    }
+    wakeup.notify_one();
+    return future;
+}
+
+size_t Scheduler::limit(Priority priority) const {
+    return classes[static_cast<int>(priority)].limit;
+}
+
+bool Scheduler::runnable(const ClassState& state) const {
+    return !state.queue.empty() && state.running < state.limit;
+}
+
+/**
+ * @brief Worker thread body.
+ *
+ * Pins itself first when a CPU set is configured, so everything the worker
+ * allocates afterwards is first touched on its own CPU. Then picks the next
+ * unit, preferring interactive work, and runs it outside the lock. Records
+ * queue and run time per unit, and re-queues resumable tasks that still
+ * have work left.
+ *
+ * @param cpus CPUs this worker may run on; empty leaves it unpinned
+ */
+void Scheduler::workerLoop(const CpuList& cpus) {
+    if (!cpus.empty() && !pinCurrentThread(cpus)) {
+        std::cerr << "Warning: cannot pin compute worker to CPUs " << formatCpuList(cpus) << std::endl;
+    }
+
+    ClassState& interactive = classes[static_cast<int>(Priority::Interactive)];
+    ClassState& background = classes[static_cast<int>(Priority::Background)];
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wakeup.wait(lock, [&]() {
+            return runnable(interactive) || runnable(background) ||
+                   (stopping && interactive.queue.empty() && background.queue.empty());
+        });
+        if (!runnable(interactive) && !runnable(background)) {
+            return; // stopping and fully drained
+        }
+
+        ClassState& state = runnable(interactive) ? interactive : background;
+        Job job = std::move(state.queue.front());
+        state.queue.pop_front();
+        state.running++;
+        double waitedMs = std::chrono::duration<double, std::milli>(Clock::now() - job.enqueuedAt).count();
+        state.totalQueueMs += waitedMs;
+        state.maxQueueMs = std::max(state.maxQueueMs, waitedMs);
+        lock.unlock();
+
+        bool more = false;
+        Clock::time_point started = Clock::now();
+        try {
+            more = job.task();
+        } catch (...) {
+            job.done->set_exception(std::current_exception());
+            job.done.reset();
+        }
+        double ranMs = std::chrono::duration<double, std::milli>(Clock::now() - started).count();
+
+        lock.lock();
+        state.running--;
+        state.totalRunMs += ranMs;
+        state.maxRunMs = std::max(state.maxRunMs, ranMs);
+        state.units++;
+        if (more && job.done) {
+            job.enqueuedAt = Clock::now();
+            state.queue.push_back(std::move(job));
+        } else {
+            state.completed++;
+            if (job.done) {
+                job.done->set_value();
+            }
+        }
+        lock.unlock();
+        wakeup.notify_all();
+        lock.lock();
+    }
+}
+
+SchedulerClassStats Scheduler::snapshot(const ClassState& state) const {
+    return {state.queue.size(), state.running, state.limit, state.completed,
+            state.units, state.totalQueueMs, state.maxQueueMs,
+            state.totalRunMs, state.maxRunMs};
+}
+
+/**
+ * @brief Returns queue depths, running counts, limits, and queue and run time metrics per class.
+ */
+SchedulerStats Scheduler::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return {threads.size(),
+            cpuSet,
+            snapshot(classes[static_cast<int>(Priority::Interactive)]),
+            snapshot(classes[static_cast<int>(Priority::Background)])};
+}
+
+} // namespace trading
@@ -0,0 +1,208 @@
+#include "utils/timer_wheel.h"
+#include <algorithm>
+
+namespace trading {
+
+TimerWheel::TimerWheel(int64_t start)
+    : current(start)
+    , active(0)
+    , occupied{}
+{
+}
+
+void TimerWheel::reset(int64_t start) {
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        if (nodes[i].list != kNone) {
+            unlink(static_cast<int32_t>(i));
+            release(static_cast<int32_t>(i));
+        }
+    }
+    current = start;
+}
+
+TimerWheel::TimerId TimerWheel::idOf(int32_t index) const {
+    return (static_cast<uint64_t>(nodes[index].generation) << 32) | static_cast<uint32_t>(index + 1);
+}
+
+int32_t TimerWheel::indexOf(TimerId id) const {
+    const uint32_t slot = static_cast<uint32_t>(id);
+    if (slot == 0 || slot > nodes.size()) {
+        return kNone;
+    }
+    const int32_t index = static_cast<int32_t>(slot - 1);
+    const Node& node = nodes[index];
+    if (node.list == kNone || node.generation != static_cast<uint32_t>(id >> 32)) {
+        return kNone;
+    }
+    return index;
+}
+
+TimerWheel::TimerId TimerWheel::schedule(int64_t due, uint64_t payload) {
+    int32_t index;
+    if (!freeNodes.empty()) {
+        index = freeNodes.back();
+        freeNodes.pop_back();
+    } else {
+        index = static_cast<int32_t>(nodes.size());
+        nodes.push_back({0, 0, 0, kNone, kNone, kNone});
+    }
+    nodes[index].due = due;
+    nodes[index].payload = payload;
+    place(index);
+    active++;
+    return idOf(index);
+}
+
+bool TimerWheel::pending(TimerId id) const {
+    return indexOf(id) != kNone;
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    const int32_t index = indexOf(id);
+    if (index == kNone) {
+        return false;
+    }
+    unlink(index);
+    release(index);
+    return true;
+}
+
+/**
+ * @brief Files a timer under the lowest level whose block contains both
+ * its due time and the current time.
+ */
+void TimerWheel::place(int32_t index) {
+    const int64_t due = nodes[index].due;
+    if (due <= current) {
+        link(index, kReady);
+        return;
+    }
+    for (int level = 0; level < kLevels; ++level) {
+        const int shift = kLevelBits * (level + 1);
+        if ((due >> shift) == (current >> shift)) {
+            const int slot = static_cast<int>((due >> (kLevelBits * level)) & (kSlots - 1));
+            link(index, level * kSlots + slot);
+            return;
+        }
+    }
+    link(index, kOverflow);
+}
+
+void TimerWheel::link(int32_t index, int32_t list) {
+    Node& node = nodes[index];
+    List& l = lists[list];
+    node.list = list;
+    node.prev = l.tail;
+    node.next = kNone;
+    if (l.tail != kNone) {
+        nodes[l.tail].next = index;
+    } else {
+        l.head = index;
+    }
+    l.tail = index;
+    if (list < kReady) {
+        occupied[list / kSlots] |= uint64_t(1) << (list % kSlots);
+    }
+}
+
+void TimerWheel::unlink(int32_t index) {
+    Node& node = nodes[index];
+    List& l = lists[node.list];
+    if (node.prev != kNone) {
+        nodes[node.prev].next = node.next;
+    } else {
+        l.head = node.next;
+    }
+    if (node.next != kNone) {
+        nodes[node.next].prev = node.prev;
+    } else {
+        l.tail = node.prev;
+    }
+    if (l.head == kNone && node.list < kReady) {
+        occupied[node.list / kSlots] &= ~(uint64_t(1) << (node.list % kSlots));
+    }
+    node.list = kNone;
+}
+
+void TimerWheel::release(int32_t index) {
+    nodes[index].list = kNone;
+    nodes[index].generation++;
+    freeNodes.push_back(index);
+    active--;
+}
+
+void TimerWheel::fire(int32_t index, std::vector<Expired>& expired) {
+    expired.push_back({idOf(index), nodes[index].due, nodes[index].payload});
+    release(index);
+}
+
+/**
+ * @brief Advances the clock, firing and cascading timers on the way.
+ *
+ * Every filed timer lies in a slot after the current one at its level, so
+ * the next time anything can happen is the start of the first occupied
+ * slot after the current one at the lowest non-empty level, or, failing
+ * that, the top-level block holding the earliest overflow timer. The clock
+ * jumps from one such time to the next: a level-0 slot fires, a higher
+ * slot is refiled relative to the new time, which moves its timers down.
+ * Once the next such time lies beyond `time`, nothing is due before it and
+ * the clock moves straight there.
+ */
+void TimerWheel::advance(int64_t time, std::vector<Expired>& expired) {
+    // Timers scheduled overdue, in the order they were scheduled; all are
+    // due no later than anything still filed
+    const size_t firstReady = expired.size();
+    while (lists[kReady].head != kNone) {
+        const int32_t index = lists[kReady].head;
+        unlink(index);
+        fire(index, expired);
+    }
+    std::stable_sort(expired.begin() + firstReady, expired.end(),
+                     [](const Expired& a, const Expired& b) { return a.due < b.due; });
+
+    while (time > current) {
+        int64_t next = 0;
+        int32_t list = kNone;
+        for (int level = 0; level < kLevels && list == kNone; ++level) {
+            const int cur = static_cast<int>((current >> (kLevelBits * level)) & (kSlots - 1));
+            const uint64_t later = cur == kSlots - 1 ? 0 : occupied[level] & (~uint64_t(0) << (cur + 1));
+            if (later != 0) {
+                const int slot = __builtin_ctzll(later);
+                const int shift = kLevelBits * (level + 1);
+                next = ((current >> shift) << shift) + (static_cast<int64_t>(slot) << (kLevelBits * level));
+                list = level * kSlots + slot;
+            }
+        }
+        if (list == kNone && lists[kOverflow].head != kNone) {
+            int64_t earliest = nodes[lists[kOverflow].head].due;
+            for (int32_t i = lists[kOverflow].head; i != kNone; i = nodes[i].next) {
+                earliest = std::min(earliest, nodes[i].due);
+            }
+            const int shift = kLevelBits * kLevels;
+            next = (earliest >> shift) << shift;
+            list = kOverflow;
+        }
+        if (list == kNone || next > time) {
+            current = time;
+            break;
+        }
+
+        current = next;
+        int32_t index = lists[list].head;
+        lists[list] = List();
+        if (list < kReady) {
+            occupied[list / kSlots] &= ~(uint64_t(1) << (list % kSlots));
+        }
+        while (index != kNone) {
+            const int32_t following = nodes[index].next;
+            if (nodes[index].due <= current) {
+                fire(index, expired);
+            } else {
+                place(index);
+            }
+            index = following;
+        }
+    }
+}
+
+} // namespace trading
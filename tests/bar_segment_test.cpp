@@ -0,0 +1,208 @@
+// Column codecs and bar segments: bit-exact round trips, block boundaries,
+// range decoding, and rejection of corrupted blocks and footers.
+#include "store/bar_segment.h"
+#include "store/column_codec.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace trading;
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::printf("  FAILED: %s\n", what.c_str());
+            ++failures;
+        }
+    }
+
+    // Equal bit patterns, so NaN payloads and -0.0 count as differences
+    bool sameBits(const std::vector<double>& a, const std::vector<double>& b) {
+        return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(double)) == 0);
+    }
+
+    bool sameBars(const BarColumns& a, const BarColumns& b) {
+        return a.timestamps == b.timestamps && sameBits(a.open, b.open) && sameBits(a.high, b.high) &&
+               sameBits(a.low, b.low) && sameBits(a.close, b.close) && a.volume == b.volume;
+    }
+
+    // Five-minute bars with a random-walk close and gaps now and then
+    BarColumns makeBars(size_t rows, unsigned seed) {
+        std::mt19937 rng(seed);
+        std::normal_distribution<double> step(0.0, 0.05);
+        BarColumns bars;
+        int64_t t = 1710149400; // 2024-03-11 09:30:00 as bar time
+        double price = 172.5;
+        for (size_t i = 0; i < rows; ++i) {
+            t += (rng() % 50 == 0) ? 900 : 300;
+            price = std::round((price + step(rng)) * 100) / 100;
+            bars.timestamps.push_back(t);
+            bars.open.push_back(price);
+            bars.high.push_back(price + 0.12);
+            bars.low.push_back(price - 0.07);
+            bars.close.push_back(price + 0.01);
+            bars.volume.push_back(static_cast<int64_t>(rng() % 100000));
+        }
+        return bars;
+    }
+
+    std::vector<double> decodeFloatsOf(const std::vector<double>& values) {
+        std::string encoded;
+        encodeFloats(values.data(), values.size(), encoded);
+        std::vector<double> decoded(values.size());
+        decodeFloats(reinterpret_cast<const uint8_t*>(encoded.data()), encoded.size(), decoded.data(), decoded.size());
+        return decoded;
+    }
+
+    template <typename Encode, typename Decode>
+    std::vector<int64_t> roundTrip(const std::vector<int64_t>& values, Encode encode, Decode decode) {
+        std::string encoded;
+        encode(values.data(), values.size(), encoded);
+        std::vector<int64_t> decoded(values.size());
+        decode(reinterpret_cast<const uint8_t*>(encoded.data()), encoded.size(), decoded.data(), decoded.size());
+        return decoded;
+    }
+
+    bool throwsRuntimeError(const std::string& segment) {
+        try {
+            BarSegment::decode(reinterpret_cast<const uint8_t*>(segment.data()), segment.size());
+        } catch (const std::runtime_error&) {
+            return true;
+        }
+        return false;
+    }
+
+    BarColumns decodeRange(const std::string& segment, int64_t from, int64_t to) {
+        BarColumns out;
+        BarSegment::decodeRange(reinterpret_cast<const uint8_t*>(segment.data()), segment.size(), from, to, out);
+        return out;
+    }
+
+    BarColumns slice(const BarColumns& bars, size_t begin, size_t end) {
+        BarColumns out;
+        out.append(bars, begin, end);
+        return out;
+    }
+}
+
+int main() {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double inf = std::numeric_limits<double>::infinity();
+    double payloadNan;
+    const uint64_t payloadBits = 0x7ff8dead0000beefULL;
+    std::memcpy(&payloadNan, &payloadBits, sizeof(payloadNan));
+
+    // Floats keep their exact bits, including signed zeros and NaN payloads
+    const std::vector<double> specials = {0.0, -0.0, -0.0, 0.0, nan, nan, payloadNan, -nan, inf, -inf, 1e-310,
+                                          std::numeric_limits<double>::max(), 172.5, 172.5, 172.51, -0.0};
+    check(sameBits(decodeFloatsOf(specials), specials), "floats round trip NaN, -0.0, infinities and subnormals");
+    check(sameBits(decodeFloatsOf({}), {}), "an empty float column round trips");
+    check(sameBits(decodeFloatsOf({-0.0}), {-0.0}), "a single -0.0 round trips");
+
+    // Integers cover the whole range, timestamps irregular gaps and going back
+    const std::vector<int64_t> integers = {0, 1, -1, std::numeric_limits<int64_t>::max(),
+                                           std::numeric_limits<int64_t>::min(), 42, 42, 0};
+    check(roundTrip(integers, encodeIntegers, decodeIntegers) == integers, "integers round trip at the extremes");
+    const std::vector<int64_t> times = {1710149400, 1710149700, 1710150000, 1710150900, 1710150600, 0, -86400};
+    check(roundTrip(times, encodeTimestamps, decodeTimestamps) == times, "timestamps round trip irregular gaps");
+
+    // Truncated and overlong columns are rejected
+    std::string encoded;
+    encodeIntegers(integers.data(), integers.size(), encoded);
+    std::vector<int64_t> out(integers.size());
+    bool threw = false;
+    try {
+        decodeIntegers(reinterpret_cast<const uint8_t*>(encoded.data()), encoded.size() - 1, out.data(), out.size());
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    check(threw, "a truncated varint column throws");
+    threw = false;
+    try {
+        decodeIntegers(reinterpret_cast<const uint8_t*>(encoded.data()), encoded.size(), out.data(), out.size() - 1);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    check(threw, "trailing bytes in a varint column throw");
+
+    // Segments around the block size, with special values in the price columns
+    for (size_t rows : {0, 1, 1023, 1024, 1025, 3 * 1024 + 7}) {
+        BarColumns bars = makeBars(rows, static_cast<unsigned>(rows));
+        if (rows > 2) {
+            bars.open[1] = -0.0;
+            bars.close[rows - 1] = nan;
+            bars.high[rows / 2] = payloadNan;
+        }
+        const std::string segment = BarSegment::encode(bars);
+        const BarColumns decoded = BarSegment::decode(reinterpret_cast<const uint8_t*>(segment.data()), segment.size());
+        check(sameBars(decoded, bars), std::to_string(rows) + " rows round trip");
+    }
+
+    // decodeRange boundaries: inclusive ends, ranges that start or end on a
+    // block edge, empty and inverted ranges, ranges outside the segment
+    const BarColumns bars = makeBars(3000, 3);
+    const std::string segment = BarSegment::encode(bars);
+    const std::vector<int64_t>& t = bars.timestamps;
+    check(sameBars(decodeRange(segment, t.front(), t.back()), bars), "the full range decodes every bar");
+    check(sameBars(decodeRange(segment, t[1023], t[1024]), slice(bars, 1023, 1025)),
+          "a range across the first block edge");
+    check(sameBars(decodeRange(segment, t[1024], t[2047]), slice(bars, 1024, 2048)), "exactly the second block");
+    check(decodeRange(segment, t[1024] - 1, t[1024] - 1).size() == 0, "a gap between bars holds no rows");
+    check(sameBars(decodeRange(segment, t[500] + 1, t[2500] - 1), slice(bars, 501, 2500)),
+          "bounds between bars are exclusive of the bars outside them");
+    check(sameBars(decodeRange(segment, t[2999], t[2999]), slice(bars, 2999, 3000)), "the last bar alone");
+    check(decodeRange(segment, t[10], t[5]).size() == 0, "an inverted range is empty");
+    check(decodeRange(segment, 0, t.front() - 1).size() == 0, "a range before the segment is empty");
+    check(decodeRange(segment, t.back() + 1, t.back() + 1000).size() == 0, "a range after the segment is empty");
+    BarColumns appended = slice(bars, 0, 10);
+    BarSegment::decodeRange(reinterpret_cast<const uint8_t*>(segment.data()), segment.size(), t[10], t[19], appended);
+    check(sameBars(appended, slice(bars, 0, 20)), "decodeRange appends to what is already there");
+
+    // Corruption: a flipped bit in any block, the index or the footer is rejected
+    std::string flipped = segment;
+    flipped[200] ^= 0x01;
+    check(throwsRuntimeError(flipped), "a flipped bit in the first block is rejected");
+    BarColumns stillFine = decodeRange(flipped, t[2000], t[2100]);
+    check(sameBars(stillFine, slice(bars, 2000, 2101)), "a range that skips the damaged block still reads");
+    // Footer fields: minTime, maxTime, rowCount, indexOffset, blockCount,
+    // indexChecksum, magic, 48 bytes in all
+    const char* footerFields[] = {"minTime", "maxTime", "rowCount", "indexOffset", "blockCount", "indexChecksum"};
+    const size_t footerOffsets[] = {0, 8, 16, 24, 32, 36};
+    for (size_t f = 0; f < 6; ++f) {
+        flipped = segment;
+        flipped[segment.size() - 48 + footerOffsets[f]] ^= 0x10;
+        check(throwsRuntimeError(flipped), std::string("a damaged footer ") + footerFields[f] + " is rejected");
+    }
+    flipped = segment;
+    flipped[segment.size() - 1] = 'X'; // footer magic
+    check(throwsRuntimeError(flipped), "a damaged footer magic is rejected");
+    flipped = segment;
+    flipped[segment.size() - 64 - 10] ^= 0x04; // last index entry
+    check(throwsRuntimeError(flipped), "a damaged block index is rejected");
+    check(throwsRuntimeError(segment.substr(0, segment.size() - 1)), "a truncated segment is rejected");
+    check(throwsRuntimeError(segment.substr(0, 16)), "a segment cut inside its header is rejected");
+
+    threw = false;
+    try {
+        BarColumns unordered = makeBars(10, 4);
+        std::swap(unordered.timestamps[3], unordered.timestamps[4]);
+        BarSegment::encode(unordered);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    check(threw, "bars out of time order are refused");
+
+    if (failures > 0) {
+        std::printf("bar_segment_test: %d checks failed\n", failures);
+        return 1;
+    }
+    std::printf("bar_segment_test: passed\n");
+    return 0;
+}
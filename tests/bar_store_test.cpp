@@ -0,0 +1,264 @@
+// BarStore manifests and batched range reads, session dates, and
+// AsyncReader on both of its backends: io_uring (skipped where the kernel
+// refuses it) and pread.
+#include "store/async_reader.h"
+#include "store/bar_store.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+using namespace trading;
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::printf("  FAILED: %s\n", what.c_str());
+            ++failures;
+        }
+    }
+
+    // One session of `rows` 5-minute bars from 09:30, prices offset by `base`
+    BarColumns session(const std::string& date, size_t rows, double base) {
+        BarColumns bars;
+        const int64_t open = parseBarTime(date + " 09:30:00");
+        for (size_t i = 0; i < rows; ++i) {
+            bars.timestamps.push_back(open + static_cast<int64_t>(i) * 300);
+            bars.open.push_back(base + i * 0.01);
+            bars.high.push_back(base + i * 0.01 + 0.05);
+            bars.low.push_back(base + i * 0.01 - 0.05);
+            bars.close.push_back(base + i * 0.01 + 0.02);
+            bars.volume.push_back(static_cast<int64_t>(1000 + i));
+        }
+        return bars;
+    }
+
+    bool sameBars(const BarColumns& a, const BarColumns& b) {
+        return a.timestamps == b.timestamps && a.open == b.open && a.high == b.high && a.low == b.low &&
+               a.close == b.close && a.volume == b.volume;
+    }
+
+    void removeTree(const std::string& path) {
+        if (DIR* dir = opendir(path.c_str())) {
+            while (struct dirent* entry = readdir(dir)) {
+                std::string name = entry->d_name;
+                if (name != "." && name != "..") {
+                    removeTree(path + "/" + name);
+                }
+            }
+            closedir(dir);
+            rmdir(path.c_str());
+        } else {
+            unlink(path.c_str());
+        }
+    }
+
+    // Direct batches: offsets and lengths, a failing read, and a throwing callback
+    void checkReader(AsyncReader& reader, const std::string& file) {
+        const std::string name = reader.backend();
+        int fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+        std::vector<ReadRequest> requests;
+        for (size_t i = 0; i < 40; ++i) {
+            requests.push_back({fd, i * 1000, 1000});
+        }
+        requests.push_back({-1, 0, 16});
+        std::vector<int> seen(requests.size(), 0);
+        bool contentsMatch = true;
+        int badFdError = 0;
+        reader.readBatch(requests, [&](size_t index, const uint8_t* data, size_t length, int error) {
+            seen[index]++;
+            if (index == 40) {
+                badFdError = error;
+                return;
+            }
+            for (size_t b = 0; b < length && contentsMatch; ++b) {
+                contentsMatch = error == 0 && length == 1000 && data[b] == static_cast<uint8_t>((index * 1000 + b) % 251);
+            }
+        });
+        bool onceEach = true;
+        for (int count : seen) {
+            onceEach = onceEach && count == 1;
+        }
+        check(onceEach, name + ": every request completes once");
+        check(contentsMatch, name + ": each read returns the bytes at its offset");
+        check(badFdError == EBADF, name + ": a read on a bad descriptor reports EBADF");
+
+        size_t completions = 0;
+        bool rethrown = false;
+        try {
+            reader.readBatch(std::vector<ReadRequest>(requests.begin(), requests.begin() + 40),
+                             [&](size_t, const uint8_t*, size_t, int) {
+                                 if (completions++ == 3) {
+                                     throw std::runtime_error("stop");
+                                 }
+                             });
+        } catch (const std::runtime_error& e) {
+            rethrown = std::string(e.what()) == "stop";
+        }
+        check(rethrown, name + ": a callback's exception is rethrown");
+        size_t after = 0;
+        reader.readBatch({requests[0]}, [&](size_t, const uint8_t*, size_t, int error) { after += error == 0; });
+        check(after == 1, name + ": the reader is usable after a failed batch");
+        close(fd);
+    }
+
+    // readRanges through the shared reader, compared with readRange. Runs in
+    // a child process, since TRADING_IO_BACKEND is read once per process.
+    int checkReadRanges(const std::string& backend, const std::string& root) {
+        setenv("TRADING_IO_BACKEND", backend.c_str(), 1);
+        setenv("TRADING_IO_DEPTH", "4", 1); // fewer slots than segments, so reads queue and complete out of order
+        const BarStore store(root);
+        std::vector<RangeQuery> queries;
+        for (const char* symbol : {"AAPL", "MSFT", "NONE"}) {
+            queries.push_back({symbol, "5m", parseBarTime("2024-03-11"), parseBarTime("2024-03-15 23:59:59")});
+            queries.push_back({symbol, "5m", parseBarTime("2024-03-12 12:00:00"), parseBarTime("2024-03-14 10:00:00")});
+            queries.push_back({symbol, "5m", parseBarTime("2024-03-13 09:30:00"), parseBarTime("2024-03-13 09:30:00")});
+        }
+        queries.push_back({"AAPL", "5m", parseBarTime("2024-03-14"), parseBarTime("2024-03-12")});
+        const std::vector<BarColumns> results = store.readRanges(queries);
+        check(results.size() == queries.size(), backend + ": one result per query");
+        for (size_t q = 0; q < queries.size() && q < results.size(); ++q) {
+            const RangeQuery& query = queries[q];
+            check(sameBars(results[q], store.readRange(query.symbol, query.interval, query.from, query.to)),
+                  backend + ": query " + std::to_string(q) + " matches readRange");
+        }
+        check(results[0].size() == 5 * 78 && results[1].size() > 78 && results[2].size() == 1 && results[6].size() == 0,
+              backend + ": result sizes");
+
+        AsyncReader& reader = AsyncReader::shared();
+        check(backend == "pread" ? std::string(reader.backend()) == "pread"
+                                 : std::string(reader.backend()).rfind("io_uring", 0) == 0,
+              backend + ": the shared reader uses the configured backend");
+        checkReader(reader, root + "/pattern");
+        return failures;
+    }
+}
+
+int main() {
+    char dirTemplate[] = "/tmp/bar_store_test.XXXXXX";
+    const std::string root = mkdtemp(dirTemplate);
+    const BarStore store(root);
+
+    // Replacing a session rewrites its manifest entry in place; sessions
+    // written out of order are listed in time order
+    const std::vector<std::string> dates = {"2024-03-13", "2024-03-11", "2024-03-15", "2024-03-12", "2024-03-14"};
+    for (const auto& date : dates) {
+        store.put("AAPL", "5m", date, session(date, 10, 100.0));
+        store.put("MSFT", "5m", date, session(date, 78, 400.0));
+    }
+    for (const auto& date : dates) {
+        store.put("AAPL", "5m", date, session(date, 78, 170.0));
+    }
+    const std::vector<SegmentInfo> entries = store.manifest("AAPL", "5m");
+    bool ordered = entries.size() == 5;
+    for (size_t i = 0; ordered && i < entries.size(); ++i) {
+        ordered = entries[i].rowCount == 78 && (i == 0 || entries[i - 1].maxTime < entries[i].minTime);
+    }
+    check(ordered, "the manifest lists each session once, replaced and in time order");
+    check(entries.size() == 5 && entries.front().date == "2024-03-11" && entries.back().date == "2024-03-15",
+          "manifest dates");
+    check(entries.size() == 5 && entries[2].minTime == parseBarTime("2024-03-13 09:30:00") &&
+              entries[2].maxTime == parseBarTime("2024-03-13 15:55:00"),
+          "manifest time bounds");
+    const auto replaced = store.get("AAPL", "5m", "2024-03-13");
+    check(replaced && sameBars(*replaced, session("2024-03-13", 78, 170.0)), "get returns the replacement");
+    check(store.manifest("NONE", "5m").empty(), "a symbol never stored has an empty manifest");
+
+    // Range reads find their sessions through the manifest
+    BarColumns expected;
+    for (const char* date : {"2024-03-12", "2024-03-13", "2024-03-14"}) {
+        BarColumns bars = session(date, 78, 170.0);
+        expected.append(bars, 0, bars.size());
+    }
+    BarColumns middle;
+    middle.append(expected, 30, 78 + 78 + 7);
+    check(sameBars(store.readRange("AAPL", "5m", parseBarTime("2024-03-12 12:00:00"), parseBarTime("2024-03-14 10:00:00")),
+                   middle),
+          "a range across three sessions");
+    check(store.readRange("AAPL", "5m", parseBarTime("2024-03-16"), parseBarTime("2024-03-17")).size() == 0,
+          "a range past the last session is empty");
+    check(store.openRange("AAPL", "5m", parseBarTime("2024-03-13 16:00:00"), parseBarTime("2024-03-14 09:00:00")).empty(),
+          "a range between sessions opens no segment");
+
+    // Session dates and cutting a multi-session range to one session
+    const std::vector<std::string> week = weekdaySessions("2024-03-08", "2024-03-18", 31);
+    check(week == std::vector<std::string>({"2024-03-08", "2024-03-11", "2024-03-12", "2024-03-13", "2024-03-14",
+                                            "2024-03-15", "2024-03-18"}),
+          "weekday sessions skip the weekend");
+    check(weekdaySessions("1969-12-29", "1970-01-04").size() == 5, "weekday sessions across the epoch");
+    bool refused = false;
+    try {
+        weekdaySessions("1970-01-01", "9999-12-31", 31);
+    } catch (const std::invalid_argument& e) {
+        refused = std::string(e.what()).find("2094927") != std::string::npos;
+    }
+    check(refused, "a range of millions of sessions is refused with its count");
+    for (const auto& range : std::vector<std::pair<std::string, std::string>>{
+             {"2024-03-09", "2024-03-10"}, {"2024-03-12", "2024-03-11"}, {"2024-03-12", "2024-03-12 09:30:00"}}) {
+        refused = false;
+        try {
+            weekdaySessions(range.first, range.second);
+        } catch (const std::invalid_argument&) {
+            refused = true;
+        }
+        check(refused, "weekday sessions refuse " + range.first + " to " + range.second);
+    }
+    BarColumns cut;
+    check(appendSession(cut, expected, "2024-03-13") == 78 && sameBars(cut, session("2024-03-13", 78, 170.0)),
+          "appendSession cuts one session out of a range");
+    check(appendSession(cut, expected, "2024-03-16") == 0 && cut.size() == 78, "a session with no bars appends none");
+
+    // A file of known bytes for direct reads
+    {
+        std::string pattern(40000, '\0');
+        for (size_t i = 0; i < pattern.size(); ++i) {
+            pattern[i] = static_cast<char>(i % 251);
+        }
+        FILE* file = std::fopen((root + "/pattern").c_str(), "wb");
+        std::fwrite(pattern.data(), 1, pattern.size(), file);
+        std::fclose(file);
+    }
+
+    bool uringAvailable = true;
+    try {
+        AsyncReader::create("io_uring", 4);
+    } catch (const std::exception& e) {
+        uringAvailable = false;
+        std::printf("  io_uring unavailable (%s); testing pread only\n", e.what());
+    }
+    std::vector<std::string> backends = {"pread"};
+    if (uringAvailable) {
+        backends.push_back("io_uring");
+    }
+    for (const auto& backend : backends) {
+        std::fflush(stdout);
+        pid_t pid = fork();
+        if (pid == 0) {
+            const int childFailures = checkReadRanges(backend, root);
+            std::fflush(stdout);
+            _exit(childFailures == 0 ? 0 : 1);
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+        check(WIFEXITED(status) && WEXITSTATUS(status) == 0, "readRanges and AsyncReader checks on " + backend);
+    }
+
+    removeTree(root);
+
+    if (failures > 0) {
+        std::printf("bar_store_test: %d checks failed\n", failures);
+        return 1;
+    }
+    std::printf("bar_store_test: passed\n");
+    return 0;
+}
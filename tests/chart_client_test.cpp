@@ -0,0 +1,165 @@
+// ChartClient against MockChartServer serving tests/fixtures/chart: parsing,
+// exchange-time conversion, skipped bars, and how failures are classified.
+#include "data/chart_client.h"
+#include "data/data_source.h"
+#include "mock_chart_server.h"
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace trading;
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::printf("  FAILED: %s\n", what.c_str());
+            ++failures;
+        }
+    }
+
+    std::vector<std::string> times(const BarColumns& bars) {
+        std::vector<std::string> out;
+        for (int64_t t : bars.timestamps) {
+            out.push_back(formatBarTime(t));
+        }
+        return out;
+    }
+
+    // Runs `call` expecting a ChartError; returns it, or a default one if none was thrown
+    ChartError chartError(const std::function<void()>& call, const std::string& what) {
+        try {
+            call();
+        } catch (const ChartError& e) {
+            return e;
+        }
+        check(false, what + " throws ChartError");
+        return ChartError("", false);
+    }
+
+    bool startsWith(const std::string& text, const std::string& prefix) {
+        return text.rfind(prefix, 0) == 0;
+    }
+}
+
+int main() {
+    MockChartServer server("tests/fixtures/chart");
+    server.start();
+    ChartClient client(server.baseUrl(), 3, std::chrono::milliseconds(2000));
+    CancellationToken token;
+
+    // Daylight time: 13:30 UTC is 09:30 in New York. The bar from the
+    // evening before, the one from the next day and the one without a
+    // close are dropped; a missing volume reads as 0.
+    BarColumns aapl = client.fetchBars({"aapl", "5min", "2024-03-11"}, token);
+    check(times(aapl) == std::vector<std::string>{"2024-03-11 09:30:00", "2024-03-11 09:35:00", "2024-03-11 09:45:00"},
+          "AAPL bars are the session's, in Eastern daylight time");
+    check(aapl.size() == 3 && aapl.open[0] == 172.94 && aapl.high[0] == 173.69 && aapl.low[0] == 172.6 &&
+              aapl.close[0] == 173.5 && aapl.volume[0] == 2841023,
+          "AAPL first bar prices and volume");
+    check(aapl.size() == 3 && aapl.volume[1] == 0, "missing volume reads as 0");
+    check(aapl.size() == 3 && aapl.close[2] == 172.71, "bar after the skipped one");
+
+    const std::vector<std::string> sent = server.requests();
+    const std::string dayStart = std::to_string(parseBarTime("2024-03-11"));
+    const std::string dayEnd = std::to_string(parseBarTime("2024-03-13"));
+    check(!sent.empty() && startsWith(sent.back(), "/v8/finance/chart/AAPL?"), "symbol is upper-cased");
+    check(!sent.empty() && sent.back().find("interval=5m") != std::string::npos, "5min is sent as 5m");
+    check(!sent.empty() && sent.back().find("period1=" + dayStart) != std::string::npos &&
+              sent.back().find("period2=" + dayEnd) != std::string::npos,
+          "the request window spans two UTC days from the session date");
+
+    // Standard time: 14:30 UTC is 09:30 in New York
+    BarColumns msft = client.fetchBars({"MSFT", "5m", "2024-01-16"}, token);
+    check(times(msft) == std::vector<std::string>{"2024-01-16 09:30:00", "2024-01-16 09:35:00", "2024-01-16 09:40:00"},
+          "MSFT bars in Eastern standard time");
+
+    // Other exchanges use the response's fixed offset, here UTC+1, which
+    // also moves 23:30 UTC the day before into the session
+    BarColumns sap = client.fetchBars({"SAP.DE", "5m", "2024-03-11"}, token);
+    check(times(sap) == std::vector<std::string>{"2024-03-11 00:30:00", "2024-03-11 09:00:00", "2024-03-11 09:05:00"},
+          "SAP.DE bars at the fixed gmtoffset");
+
+    BarColumns daily = client.fetchBars({"AAPL", "1d", "2024-03-11"}, token);
+    check(daily.size() == 3 && daily.timestamps.front() == parseBarTime("2024-03-11") &&
+              daily.timestamps.back() == parseBarTime("2024-03-11"),
+          "daily bars are stamped at midnight");
+
+    // Request errors: properties of the request, cached as rejections
+    ChartError delisted = chartError([&]() { client.fetchBars({"DELISTED", "5m", "2024-03-11"}, token); }, "DELISTED");
+    check(delisted.requestError() && startsWith(delisted.what(), "No data found"), "a 404 Not Found is a request error");
+    ChartError unknown = chartError([&]() { client.fetchBars({"ZZZZ", "5m", "2024-03-11"}, token); }, "ZZZZ");
+    check(unknown.requestError(), "an unknown symbol is a request error");
+    ChartError noSession = chartError([&]() { client.fetchBars({"AAPL", "5m", "2024-03-13"}, token); }, "no session");
+    check(noSession.requestError() && startsWith(noSession.what(), "No data found for date: 2024-03-13"),
+          "a date without bars is a request error");
+
+    const size_t before = server.requests().size();
+    ChartError interval = chartError([&]() { client.fetchBars({"AAPL", "7m", "2024-03-11"}, token); }, "7m");
+    check(interval.requestError(), "an unsupported interval is a request error");
+    ChartError date = chartError([&]() { client.fetchBars({"AAPL", "5m", "11/03/2024"}, token); }, "bad date");
+    check(date.requestError(), "a malformed date is a request error");
+    check(server.requests().size() == before, "invalid requests are rejected without a round trip");
+
+    // Upstream errors: failures of the source, counted by the circuit breaker
+    ChartError broken = chartError([&]() { client.fetchBars({"BROKEN", "5m", "2024-03-11"}, token); }, "BROKEN");
+    check(!broken.requestError() && std::string(broken.what()) == "An unexpected error occurred: HTTP 500",
+          "an HTTP 500 is an upstream error");
+    ChartError garbled = chartError([&]() { client.fetchBars({"GARBLED", "5m", "2024-03-11"}, token); }, "GARBLED");
+    check(!garbled.requestError(), "a body that is not chart JSON is an upstream error");
+
+    MockChartServer closed("tests/fixtures/chart");
+    closed.start();
+    closed.stop();
+    ChartClient unreachable(closed.baseUrl(), 1, std::chrono::milliseconds(500));
+    ChartError refused = chartError([&]() { unreachable.fetchBars({"AAPL", "5m", "2024-03-11"}, token); }, "refused");
+    check(!refused.requestError(), "a refused connection is an upstream error");
+
+    // A base URL with a path is kept in front of the chart path
+    ChartClient prefixed(server.baseUrl() + "/recorded/", 1, std::chrono::milliseconds(2000));
+    check(prefixed.fetchBars({"MSFT", "5m", "2024-01-16"}, token).size() == 3 &&
+              startsWith(server.requests().back(), "/recorded/v8/finance/chart/MSFT?"),
+          "base URL path prefix");
+
+    // fetchMany answers in request order in the fetcher's format
+    std::vector<ChartRequest> batch = {
+        {"AAPL", "5m", "2024-03-11"},
+        {"DELISTED", "5m", "2024-03-11"},
+        {"BROKEN", "5m", "2024-03-11"},
+        {"SAP.DE", "5m", "2024-03-11"},
+        {"MSFT", "5m", "2024-01-16"},
+        {"AAPL", "7m", "2024-03-11"},
+    };
+    std::vector<std::string> responses = client.fetchMany(batch, token);
+    const std::vector<FetchOutcome> expected = {
+        FetchOutcome::Data, FetchOutcome::Rejected, FetchOutcome::Failed,
+        FetchOutcome::Data, FetchOutcome::Data, FetchOutcome::Rejected,
+    };
+    check(responses.size() == batch.size(), "fetchMany returns one response per request");
+    for (size_t i = 0; i < responses.size() && i < expected.size(); ++i) {
+        check(classifyResponse(responses[i]) == expected[i], "fetchMany response " + std::to_string(i) + " classified");
+    }
+    check(responses.size() == batch.size() && responses[0] == formatBars(aapl) && responses[3] == formatBars(sap) &&
+              responses[4] == formatBars(msft),
+          "fetchMany data matches fetchBars");
+
+    CancellationToken cancelled;
+    cancelled.cancel();
+    bool threw = false;
+    try {
+        client.fetchMany(batch, cancelled);
+    } catch (const OperationCancelled&) {
+        threw = true;
+    }
+    check(threw, "fetchMany throws once the token is cancelled");
+
+    if (failures > 0) {
+        std::printf("chart_client_test: %d checks failed\n", failures);
+        return 1;
+    }
+    std::printf("chart_client_test: passed\n");
+    return 0;
+}
@@ -0,0 +1,105 @@
+// Request validation in front of the data pipeline, and FileSource paths
+// that cannot leave their directory.
+#include "data/data_source.h"
+#include "data/source_layers.h"
+#include "data/sources.h"
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace trading;
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::printf("  FAILED: %s\n", what.c_str());
+            ++failures;
+        }
+    }
+
+    void writeFile(const std::string& path, const std::string& contents) {
+        std::ofstream(path, std::ios::binary) << contents;
+    }
+}
+
+int main() {
+    // Well-formed requests, including Yahoo's index, currency and share class spellings
+    for (const char* symbol : {"AAPL", "brk-b", "^GSPC", "EURUSD=X", "SAP.DE"}) {
+        check(requestProblem({symbol, "5min", "2024-03-11"}).empty(), std::string("symbol ") + symbol + " accepted");
+    }
+    check(requestProblem({"AAPL", "1d", "2024-02-29"}).empty(), "a leap day is accepted");
+
+    const std::vector<DataRequest> malformed = {
+        {"", "5m", "2024-03-11"},
+        {"..", "5m", "2024-03-11"},
+        {"../../etc", "5m", "2024-03-11"},
+        {".hidden", "5m", "2024-03-11"},
+        {"AA PL", "5m", "2024-03-11"},
+        {"AAPL/x", "5m", "2024-03-11"},
+        {std::string(33, 'A'), "5m", "2024-03-11"},
+        {"AAPL", "", "2024-03-11"},
+        {"AAPL", "..", "2024-03-11"},
+        {"AAPL", "5m/..", "2024-03-11"},
+        {"AAPL", "5m", ""},
+        {"AAPL", "5m", "../../passwd"},
+        {"AAPL", "5m", "2024-3-11"},
+        {"AAPL", "5m", "2024-03-11x"},
+        {"AAPL", "5m", "2023-02-29"},
+        {"AAPL", "5m", "2024-13-01"},
+    };
+    for (const auto& request : malformed) {
+        check(!requestProblem(request).empty(),
+              "rejects '" + request.symbol + "', '" + request.interval + "', '" + request.date + "'");
+    }
+
+    // Rejected before the wrapped source runs, as a request error
+    auto inner = std::make_shared<MockSource>([](const DataRequest&) { return std::string(R"({"data": []})"); });
+    RequestValidationLayer validation(inner);
+    CancellationToken token;
+    std::string rejected = validation.fetch({"../../etc", "5m", "2024-03-11"}, token);
+    check(classifyResponse(rejected) == FetchOutcome::Rejected && inner->calls() == 0,
+          "the layer answers a malformed request without calling the source");
+    check(classifyResponse(validation.fetch({"AAPL", "5m", "2024-03-11"}, token)) == FetchOutcome::Data &&
+              inner->calls() == 1,
+          "the layer passes a well-formed request on");
+
+    // FileSource maps each field to a file name, so even without the
+    // validation layer a request cannot read outside its directory
+    char dirTemplate[] = "/tmp/data_source_test.XXXXXX";
+    const std::string root = mkdtemp(dirTemplate);
+    const std::string recorded = root + "/recorded";
+    mkdir(recorded.c_str(), 0755);
+    mkdir((recorded + "/AAPL").c_str(), 0755);
+    mkdir((recorded + "/AAPL/5m").c_str(), 0755);
+    writeFile(recorded + "/AAPL/5m/2024-03-11.json", R"({"data": []})");
+    writeFile(root + "/secret.json", R"({"data": ["secret"]})");
+
+    FileSource files(recorded);
+    check(files.fetch({"AAPL", "5m", "2024-03-11"}, token) == R"({"data": []})", "FileSource reads a recorded response");
+    std::string escaped = files.fetch({"AAPL", "5m", "../../../secret"}, token);
+    check(escaped.find("secret\"]") == std::string::npos && classifyResponse(escaped) == FetchOutcome::Rejected,
+          "FileSource does not follow '..' in the date");
+    std::string dotdot = files.fetch({"..", "..", "secret"}, token);
+    check(dotdot.find("secret\"]") == std::string::npos && classifyResponse(dotdot) == FetchOutcome::Rejected,
+          "FileSource rejects '..' components");
+
+    unlink((recorded + "/AAPL/5m/2024-03-11.json").c_str());
+    rmdir((recorded + "/AAPL/5m").c_str());
+    rmdir((recorded + "/AAPL").c_str());
+    rmdir(recorded.c_str());
+    unlink((root + "/secret.json").c_str());
+    rmdir(root.c_str());
+
+    if (failures > 0) {
+        std::printf("data_source_test: %d checks failed\n", failures);
+        return 1;
+    }
+    std::printf("data_source_test: passed\n");
+    return 0;
+}
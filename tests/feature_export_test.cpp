@@ -0,0 +1,129 @@
+// Feature export: repeated symbols are exported once, and concurrent writes
+// of one feature file never share a temp file.
+#include "data/data_fetcher.h"
+#include "data/sources.h"
+#include "features/feature_export.h"
+#include "features/feature_file.h"
+#include <cstdio>
+#include <dirent.h>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace trading;
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::printf("  FAILED: %s\n", what.c_str());
+            ++failures;
+        }
+    }
+
+    std::vector<std::string> listDirectory(const std::string& path) {
+        std::vector<std::string> names;
+        if (DIR* dir = opendir(path.c_str())) {
+            while (struct dirent* entry = readdir(dir)) {
+                std::string name = entry->d_name;
+                if (name != "." && name != "..") {
+                    names.push_back(name);
+                }
+            }
+            closedir(dir);
+        }
+        return names;
+    }
+
+    // One session of 5-minute bars
+    BarColumns sessionBars(const std::string& date, size_t count) {
+        BarColumns bars;
+        const int64_t open = parseBarTime(date + " 09:30:00");
+        for (size_t i = 0; i < count; ++i) {
+            bars.timestamps.push_back(open + static_cast<int64_t>(i) * 300);
+            bars.open.push_back(100.0 + i);
+            bars.high.push_back(101.0 + i);
+            bars.low.push_back(99.0 + i);
+            bars.close.push_back(100.5 + i);
+            bars.volume.push_back(1000 + static_cast<int64_t>(i));
+        }
+        return bars;
+    }
+}
+
+int main() {
+    char dirTemplate[] = "/tmp/feature_export_test.XXXXXX";
+    const std::string dir = mkdtemp(dirTemplate);
+
+    // Repeats within --symbols and across --symbols-file keep the first position
+    std::ofstream(dir + "/symbols.txt") << "MSFT\n# comment\nAAPL\nSPY\n";
+    FeatureExportConfig config = FeatureExportConfig::fromArguments(
+        {"--symbols", "AAPL,MSFT,AAPL", "--symbols-file", dir + "/symbols.txt", "--from", "2024-03-11"});
+    check(config.symbols == std::vector<std::string>{"AAPL", "MSFT", "SPY"}, "repeated symbols are kept once");
+
+    // An export of a repeated symbol writes one file and one manifest entry
+    const std::string out = dir + "/out";
+    config = FeatureExportConfig::fromArguments({"--symbols", "AAPL,AAPL,AAPL", "--from", "2024-03-11",
+                                                 "--features", "ema:3", "--out", out, "--threads", "4"});
+    auto source = std::make_shared<MockSource>(
+        [](const DataRequest& request) { return formatBars(sessionBars(request.date, 20)); });
+    FeatureExportSummary summary = exportFeatures(config, source, BarStore(""));
+    check(summary.files == 1 && summary.failedSymbols == 0 && source->calls() == 1, "AAPL is exported once");
+    std::ifstream manifestFile(out + "/MANIFEST.json");
+    json manifest = json::parse(manifestFile, nullptr, false);
+    check(manifest.is_object() && manifest["symbols"].size() == 1, "the manifest lists AAPL once");
+    const std::vector<std::string> written = listDirectory(out);
+    check(written.size() == 2, "only AAPL.feat and MANIFEST.json are left in the output directory");
+
+    // Concurrent writes of the same path each use their own temp file; the
+    // survivor is one complete file
+    FeatureTable table;
+    table.bars = sessionBars("2024-03-11", 5000);
+    table.sessions.push_back({"2024-03-11", 0, table.bars.size()});
+    table.names = {"x"};
+    table.values = {std::vector<double>(table.bars.size(), 1.5)};
+    const std::string path = dir + "/SAME.feat";
+    std::vector<std::thread> writers;
+    int writeErrors = 0;
+    std::mutex errorMutex;
+    for (int t = 0; t < 8; ++t) {
+        writers.emplace_back([&]() {
+            for (int i = 0; i < 10; ++i) {
+                try {
+                    FeatureFile::write(path, table);
+                } catch (const std::exception&) {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    writeErrors++;
+                }
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    check(writeErrors == 0, "concurrent writes of one path all succeed");
+    FeatureTable read = FeatureFile::read(path);
+    check(read.rows() == table.rows() && read.values.size() == 1 && read.values[0].back() == 1.5,
+          "the published file is complete");
+
+    for (const auto& name : listDirectory(out)) {
+        unlink((out + "/" + name).c_str());
+    }
+    rmdir(out.c_str());
+    for (const auto& name : listDirectory(dir)) {
+        check(name == "SAME.feat" || name == "symbols.txt", "no temp file is left behind: " + name);
+        unlink((dir + "/" + name).c_str());
+    }
+    rmdir(dir.c_str());
+
+    if (failures > 0) {
+        std::printf("feature_export_test: %d checks failed\n", failures);
+        return 1;
+    }
+    std::printf("feature_export_test: passed\n");
+    return 0;
+}
@@ -0,0 +1,103 @@
+// RollingStats against a direct computation over the window, and flat
+// windows that must neither drift from 0 nor fall back to recomputing the
+// window on every update.
+#include "utils/indicators.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <random>
+#include <string>
+
+using namespace trading;
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::printf("  FAILED: %s\n", what.c_str());
+            ++failures;
+        }
+    }
+
+    double populationVariance(const std::deque<double>& window) {
+        double sum = 0;
+        for (double x : window) {
+            sum += x;
+        }
+        const double mean = sum / window.size();
+        double m2 = 0;
+        for (double x : window) {
+            m2 += (x - mean) * (x - mean);
+        }
+        return m2 / window.size();
+    }
+
+    // Seconds taken by `updates` updates of a window of `period` values
+    template <typename Next>
+    double timeUpdates(int period, int updates, Next next) {
+        RollingStats<double> stats(period);
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < updates; ++i) {
+            stats.update(next(i));
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main() {
+    // Sliding updates track the window through price-like noise
+    std::mt19937_64 rng(7);
+    std::normal_distribution<double> step(0.0, 0.5);
+    RollingStats<double> stats(50);
+    std::deque<double> window;
+    double price = 100.0;
+    double worst = 0;
+    for (int i = 0; i < 20000; ++i) {
+        price += step(rng);
+        stats.update(price);
+        window.push_back(price);
+        if (window.size() > 50) {
+            window.pop_front();
+        }
+        if (stats.ready()) {
+            const double expected = populationVariance(window);
+            worst = std::max(worst, std::abs(stats.variance() - expected) / std::max(expected, 1e-12));
+        }
+    }
+    check(worst < 1e-9, "sliding variance matches the window");
+
+    // A move followed by a flat run: the variance reaches exactly 0 and
+    // z-scores read 0, however large the earlier move was
+    RollingStats<double> halted(20);
+    for (int i = 0; i < 20; ++i) {
+        halted.update(1e6 + i * 1e3);
+    }
+    for (int i = 0; i < 40; ++i) {
+        halted.update(42.5);
+    }
+    check(halted.variance() == 0 && halted.mean() == 42.5, "a flat window has variance 0");
+    check(halted.zScore(42.5) == 0 && halted.zScore(50.0) == 0, "z-scores in a flat window are 0");
+    halted.update(43.5);
+    check(std::abs(halted.mean() - (42.5 * 19 + 43.5) / 20) < 1e-12 && halted.variance() > 0,
+          "a flat window picks up the next move");
+
+    // Flat input costs the same as varying input. Recomputing the window on
+    // every update made this run thousands of times slower.
+    const int period = 20000;
+    const int updates = 200000;
+    const double flat = timeUpdates(period, updates, [](int) { return 100.0; });
+    const double zeros = timeUpdates(period, updates, [](int) { return 0.0; });
+    const double varying = timeUpdates(period, updates, [](int i) { return 100.0 + (i % 7) * 0.25; });
+    check(flat < 20 * varying + 0.05, "a flat window updates in O(1) amortized time");
+    check(zeros < 20 * varying + 0.05, "a window of zeros updates in O(1) amortized time");
+
+    if (failures > 0) {
+        std::printf("indicators_test: %d checks failed\n", failures);
+        return 1;
+    }
+    std::printf("indicators_test: passed\n");
+    return 0;
+}
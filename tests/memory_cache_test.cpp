@@ -0,0 +1,96 @@
+// MemoryCache snapshots: lookups across several processes' snapshots, and
+// saves that stay within the cache's capacity.
+#include "cache/memory_cache.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace trading;
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::printf("  FAILED: %s\n", what.c_str());
+            ++failures;
+        }
+    }
+
+    int64_t nowSeconds() {
+        return std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    // Entries of 10 key bytes and 90 value bytes
+    CacheSnapshot::Entry entry(const std::string& name, int64_t createdAt) {
+        std::string key = name + std::string(10 - name.size(), '_');
+        return {key, std::make_shared<const std::string>(std::string(90, name[0])), createdAt};
+    }
+
+    std::string key(const std::string& name) {
+        return name + std::string(10 - name.size(), '_');
+    }
+
+    bool has(const std::shared_ptr<const CacheSnapshot>& snapshot, const std::string& name) {
+        return snapshot && snapshot->find(key(name)).has_value();
+    }
+}
+
+int main() {
+    char dirTemplate[] = "/tmp/memory_cache_test.XXXXXX";
+    const std::string dir = mkdtemp(dirTemplate);
+    const std::string generation = "test-v1";
+    const int64_t now = nowSeconds();
+    auto fresh = [now](const std::string&, int64_t createdAt) { return now - createdAt <= 3600; };
+
+    // Two workers' snapshots from the last run; "old" has aged out
+    CacheSnapshot::write(dir + "/own", generation,
+                         {entry("a3", now - 20), entry("a1", now), entry("a4", now - 30), entry("a2", now - 10),
+                          entry("old", now - 7200)});
+    CacheSnapshot::write(dir + "/other", generation, {entry("b1", now), entry("a1", now)});
+
+    MemoryCache cache(300);
+    cache.attachSnapshots({CacheSnapshot::open(dir + "/own", generation), nullptr,
+                           CacheSnapshot::open(dir + "/other", generation)},
+                          fresh);
+
+    check(cache.get(key("b1")) != nullptr, "an entry only another worker cached is found");
+    check(cache.get(key("old")) == nullptr, "an aged-out entry is not served");
+    check(cache.get(key("none")) == nullptr, "a key in no snapshot misses");
+    cache.put(key("c1"), std::string(90, 'c'));
+    check(cache.size() == 2 && cache.bytes() == 200, "b1 was promoted next to c1");
+
+    // In-memory entries first, then this process's own unrequested entries,
+    // newest first, until the 300 bytes are used; nothing of the other
+    // worker's snapshot is copied, and nothing stale
+    cache.saveSnapshot(dir + "/saved", generation);
+    auto saved = CacheSnapshot::open(dir + "/saved", generation);
+    check(saved && saved->entryCount() == 3, "the saved snapshot holds capacity's worth of entries");
+    check(has(saved, "c1") && has(saved, "b1"), "in-memory entries are saved");
+    check(has(saved, "a1") && !has(saved, "a2"), "the newest own unrequested entries fill the rest");
+    check(!has(saved, "old"), "stale entries are not carried over");
+
+    // Without a snapshot of its own, a process saves only what it holds
+    MemoryCache other(1000);
+    other.attachSnapshots({nullptr, CacheSnapshot::open(dir + "/own", generation)}, fresh);
+    other.put(key("d1"), std::string(90, 'd'));
+    other.saveSnapshot(dir + "/saved2", generation);
+    auto saved2 = CacheSnapshot::open(dir + "/saved2", generation);
+    check(saved2 && saved2->entryCount() == 1 && has(saved2, "d1"), "other processes' entries are not copied");
+
+    for (const char* name : {"own", "other", "saved", "saved2"}) {
+        unlink((dir + "/" + name).c_str());
+    }
+    rmdir(dir.c_str());
+
+    if (failures > 0) {
+        std::printf("memory_cache_test: %d checks failed\n", failures);
+        return 1;
+    }
+    std::printf("memory_cache_test: passed\n");
+    return 0;
+}
@@ -0,0 +1,25 @@
+// Serves the recorded chart fixtures until interrupted, for running the
+// trader without network access:
+//   ./tests/mock_chart 9000 &
+//   TRADING_CHART_URL=http://127.0.0.1:9000 ./trader
+#include "mock_chart_server.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+int main(int argc, char** argv) {
+    int port = argc > 1 ? std::stoi(argv[1]) : 9000;
+    std::string fixtures = argc > 2 ? argv[2] : "tests/fixtures/chart";
+    try {
+        trading::MockChartServer server(fixtures);
+        server.start(port);
+        std::cout << "Serving " << fixtures << " at " << server.baseUrl() << std::endl;
+        while (true) {
+            std::this_thread::sleep_for(std::chrono::hours(1));
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,133 @@
+#include "mock_chart_server.h"
+#include "../httplib.h"
+#include <cctype>
+#include <dirent.h>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace trading {
+
+namespace {
+    const char* const kUnknownSymbolBody =
+        R"({"chart":{"result":null,"error":{"code":"Not Found","description":"No data found, symbol may be delisted"}}})";
+
+    std::string readFile(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("MockChartServer: cannot read " + path);
+        }
+        std::ostringstream contents;
+        contents << in.rdbuf();
+        return contents.str();
+    }
+
+    // "AAPL.json" -> 200, "BROKEN.500.json" -> 500; the symbol is what precedes
+    bool statusSuffix(const std::string& stem, int& status) {
+        if (stem.size() < 5 || stem[stem.size() - 4] != '.') {
+            return false;
+        }
+        for (size_t i = stem.size() - 3; i < stem.size(); ++i) {
+            if (!std::isdigit(static_cast<unsigned char>(stem[i]))) {
+                return false;
+            }
+        }
+        status = std::stoi(stem.substr(stem.size() - 3));
+        return true;
+    }
+}
+
+/**
+ * @brief Loads every *.json fixture in a directory.
+ *
+ * @param fixtureDir Directory of recorded responses
+ * @throws std::runtime_error if the directory or a fixture cannot be read
+ */
+MockChartServer::MockChartServer(const std::string& fixtureDir) {
+    DIR* dir = opendir(fixtureDir.c_str());
+    if (!dir) {
+        throw std::runtime_error("MockChartServer: cannot open " + fixtureDir);
+    }
+    while (struct dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name.size() <= 5 || name.compare(name.size() - 5, 5, ".json") != 0) {
+            continue;
+        }
+        std::string stem = name.substr(0, name.size() - 5);
+        int status = 200;
+        if (statusSuffix(stem, status)) {
+            stem.resize(stem.size() - 4);
+        }
+        fixtures[stem] = {status, readFile(fixtureDir + "/" + name)};
+    }
+    closedir(dir);
+}
+
+MockChartServer::~MockChartServer() {
+    stop();
+}
+
+/**
+ * @brief Starts serving the fixtures.
+ *
+ * The route accepts any path prefix, so a client configured with a base
+ * URL such as http://127.0.0.1:9000/recorded is served too.
+ *
+ * @param port Port to bind, or 0 for any free port
+ * @return The bound port
+ * @throws std::runtime_error if the port cannot be bound
+ */
+int MockChartServer::start(int port) {
+    server = std::make_unique<httplib::Server>();
+    server->Get(R"((.*)/v8/finance/chart/([^/]+))", [this](const httplib::Request& req, httplib::Response& res) {
+        {
+            std::lock_guard<std::mutex> lock(logMutex);
+            std::string query;
+            for (const auto& param : req.params) {
+                query += (query.empty() ? "?" : "&") + param.first + "=" + param.second;
+            }
+            log.push_back(req.path + query);
+        }
+        auto fixture = fixtures.find(req.matches[2].str());
+        if (fixture == fixtures.end()) {
+            res.status = 404;
+            res.set_content(kUnknownSymbolBody, "application/json");
+            return;
+        }
+        res.status = fixture->second.status;
+        res.set_content(fixture->second.body, "application/json");
+    });
+
+    if (port == 0) {
+        port = server->bind_to_any_port("127.0.0.1");
+    } else if (!server->bind_to_port("127.0.0.1", port)) {
+        port = -1;
+    }
+    if (port < 0) {
+        throw std::runtime_error("MockChartServer: cannot bind a port");
+    }
+    this->port = port;
+    listener = std::thread([this]() { server->listen_after_bind(); });
+    server->wait_until_ready();
+    return port;
+}
+
+void MockChartServer::stop() {
+    if (server) {
+        server->stop();
+    }
+    if (listener.joinable()) {
+        listener.join();
+    }
+}
+
+std::string MockChartServer::baseUrl() const {
+    return "http://127.0.0.1:" + std::to_string(port);
+}
+
+std::vector<std::string> MockChartServer::requests() const {
+    std::lock_guard<std::mutex> lock(logMutex);
+    return log;
+}
+
+} // namespace trading
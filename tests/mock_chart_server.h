@@ -0,0 +1,52 @@
+#pragma once
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace httplib {
+class Server;
+}
+
+namespace trading {
+
+// Serves recorded chart responses on GET [<prefix>]/v8/finance/chart/<SYMBOL>
+// from a directory of fixtures: <SYMBOL>.json is answered with status 200,
+// <SYMBOL>.<status>.json with that status, and any other symbol with the
+// 404 Yahoo gives for an unknown symbol.
+class MockChartServer {
+public:
+    explicit MockChartServer(const std::string& fixtureDir);
+    ~MockChartServer();
+
+    MockChartServer(const MockChartServer&) = delete;
+    MockChartServer& operator=(const MockChartServer&) = delete;
+
+    // Binds 127.0.0.1:`port` (0 picks a free port) and serves on a
+    // background thread; returns the bound port
+    int start(int port = 0);
+    void stop();
+
+    std::string baseUrl() const;
+
+    // Path and query string of every request served so far
+    std::vector<std::string> requests() const;
+
+private:
+    struct Fixture {
+        int status;
+        std::string body;
+    };
+
+    std::map<std::string, Fixture> fixtures; // by symbol
+    std::unique_ptr<httplib::Server> server;
+    std::thread listener;
+    int port = 0;
+
+    mutable std::mutex logMutex;
+    std::vector<std::string> log;
+};
+
+} // namespace trading
@@ -0,0 +1,129 @@
+// Philox4x32-10 against the Random123 known-answer vectors, the column
+// form against the scalar one, and RandomBatch results that do not depend
+// on how runs are split into chunks.
+#include "strategies/batch_strategy.h"
+#include "utils/philox.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace trading;
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::printf("  FAILED: %s\n", what.c_str());
+            ++failures;
+        }
+    }
+
+    struct KnownAnswer {
+        Philox::Block counter;
+        std::array<uint32_t, 2> key;
+        Philox::Block expected;
+    };
+
+    // kat_vectors from the Random123 distribution, philox4x32 with 10 rounds
+    const KnownAnswer kKnownAnswers[] = {
+        {{0x00000000, 0x00000000, 0x00000000, 0x00000000}, {0x00000000, 0x00000000},
+         {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}},
+        {{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff},
+         {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}},
+        {{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0},
+         {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}},
+    };
+
+    MarketData randomWalk(size_t bars, unsigned seed) {
+        MarketData data;
+        std::mt19937 rng(seed);
+        std::normal_distribution<double> step(0.0, 0.003);
+        double price = 100.0;
+        for (size_t i = 0; i < bars; ++i) {
+            price *= std::exp(step(rng));
+            data.prices.push_back(price);
+            data.timestamps.push_back("2024-03-05 10:00:00");
+        }
+        return data;
+    }
+}
+
+int main() {
+    for (const auto& answer : kKnownAnswers) {
+        check(Philox::generate(answer.counter, answer.key) == answer.expected, "known-answer vector");
+    }
+
+    // The column form matches the scalar block function, including the vectors
+    std::vector<uint32_t> c0, c1, c2, c3;
+    std::vector<Philox::Block> expected;
+    std::mt19937 rng(3);
+    const std::array<uint32_t, 2> key = {0xa4093822, 0x299f31d0};
+    for (size_t i = 0; i < 1000; ++i) {
+        Philox::Block counter = {static_cast<uint32_t>(rng()), static_cast<uint32_t>(rng()),
+                                 static_cast<uint32_t>(rng()), static_cast<uint32_t>(rng())};
+        c0.push_back(counter[0]);
+        c1.push_back(counter[1]);
+        c2.push_back(counter[2]);
+        c3.push_back(counter[3]);
+        expected.push_back(Philox::generate(counter, key));
+    }
+    Philox::generate(c0.size(), c0.data(), c1.data(), c2.data(), c3.data(), key);
+    bool columnsMatch = true;
+    for (size_t i = 0; i < expected.size(); ++i) {
+        columnsMatch = columnsMatch && Philox::Block{c0[i], c1[i], c2[i], c3[i]} == expected[i];
+    }
+    check(columnsMatch, "the column form matches the block function");
+
+    // Draws are pure functions of (seed, stream, index, draw) and lie in [0, 1)
+    const Philox a(42, 7);
+    const Philox b(42, 7);
+    const Philox other(42, 8);
+    bool inRange = true;
+    bool repeatable = true;
+    size_t sameAsOtherStream = 0;
+    double sum = 0;
+    for (uint32_t index = 0; index < 20000; ++index) {
+        for (uint32_t draw = 0; draw < 3; ++draw) {
+            const double u = a.uniform(index, draw);
+            inRange = inRange && u >= 0.0 && u < 1.0;
+            repeatable = repeatable && u == b.uniform(index, draw);
+            sameAsOtherStream += u == other.uniform(index, draw);
+            sum += u;
+        }
+    }
+    check(inRange, "uniform draws lie in [0, 1)");
+    check(repeatable, "the same seed, stream, index and draw give the same value");
+    check(sameAsOtherStream == 0, "different streams give different values");
+    check(std::abs(sum / 60000 - 0.5) < 0.01, "uniform draws average about 0.5");
+    check(Philox::unit(0xffffffff, 0xffffffff) < 1.0 && Philox::unit(0, 0) == 0.0, "unit() bounds");
+    check(a.seed() == 42 && a.stream() == 7, "seed and stream accessors");
+
+    // Run i of a RandomBatch is the same whether it is run alone or in any chunk
+    const MarketData data = randomWalk(3000, 9);
+    const RandomBatch batch(300, 0.05, 0.001, 1234);
+    const std::vector<BatchResult> whole = batch.run(data, 100000.0);
+    std::vector<BatchResult> chunked(batch.size());
+    const size_t edges[] = {0, 1, 7, 64, 200, 299, 300};
+    for (size_t c = 0; c + 1 < sizeof(edges) / sizeof(edges[0]); ++c) {
+        batch.run(data, 100000.0, edges[c], edges[c + 1], chunked.data() + edges[c]);
+    }
+    bool chunkIndependent = whole.size() == chunked.size();
+    for (size_t i = 0; chunkIndependent && i < whole.size(); ++i) {
+        chunkIndependent = whole[i].finalPortfolioValue == chunked[i].finalPortfolioValue &&
+                           whole[i].numTrades == chunked[i].numTrades;
+    }
+    check(chunkIndependent, "RandomBatch results do not depend on the chunking");
+    const RandomBatch reseeded(300, 0.05, 0.001, 1235);
+    check(reseeded.run(data, 100000.0)[0].finalPortfolioValue != whole[0].finalPortfolioValue,
+          "another seed gives other runs");
+
+    if (failures > 0) {
+        std::printf("philox_test: %d checks failed\n", failures);
+        return 1;
+    }
+    std::printf("philox_test: passed\n");
+    return 0;
+}
@@ -0,0 +1,186 @@
+// Portfolio accounting: fills and fees on both sides, short sales that
+// credit their proceeds, trade records for moves across zero, and the
+// MACD strategy and batch engine that share the same core.
+#include "strategies/batch_strategy.h"
+#include "strategies/macd_strategy.h"
+#include "strategies/portfolio.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fcntl.h>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace trading;
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::printf("  FAILED: %s\n", what.c_str());
+            ++failures;
+        }
+    }
+
+    bool near(double a, double b) {
+        return std::abs(a - b) <= 1e-9 * std::max(1.0, std::abs(b));
+    }
+
+    bool sameTrade(const Trade& trade, int timeStep, const char* type, const char* side, double price, double qty) {
+        return trade.timeStep == timeStep && trade.type == type && trade.side == side && trade.price == price &&
+               trade.quantity == qty;
+    }
+
+    MarketData randomWalk(size_t bars, unsigned seed) {
+        MarketData data;
+        std::mt19937 rng(seed);
+        std::normal_distribution<double> step(0.0, 0.004);
+        double price = 100.0;
+        for (size_t i = 0; i < bars; ++i) {
+            price *= std::exp(step(rng));
+            data.prices.push_back(price);
+            data.timestamps.push_back("2024-03-05 10:00:00");
+        }
+        return data;
+    }
+
+    // MACDStrategy logs every decision to stdout; the test only wants its result
+    SimulationResult quietly(Strategy& strategy, const MarketData& data, double initialCash) {
+        std::fflush(stdout);
+        const int saved = dup(STDOUT_FILENO);
+        const int devNull = open("/dev/null", O_WRONLY | O_CLOEXEC);
+        dup2(devNull, STDOUT_FILENO);
+        close(devNull);
+        SimulationResult result = strategy.execute(data, initialCash);
+        std::fflush(stdout);
+        dup2(saved, STDOUT_FILENO);
+        close(saved);
+        return result;
+    }
+}
+
+int main() {
+    // A long round trip pays price plus fee and receives price minus fee
+    Portfolio portfolio(0.001);
+    portfolio.reset(10000.0, 4);
+    check(near(portfolio.buy(10, 100.0, 0), -1001.0), "a buy pays price plus fee");
+    check(near(portfolio.cash(), 8999.0) && portfolio.position() == 10 && portfolio.entryPrice() == 100.0,
+          "a long entry");
+    check(near(portfolio.equity(110.0), 10099.0), "long equity is cash plus position value");
+    check(near(portfolio.close(110.0, 1), 1098.9), "a sale receives price minus fee");
+    check(near(portfolio.cash(), 10097.9) && portfolio.position() == 0 && portfolio.entryPrice() == 0.0,
+          "flat after the exit");
+
+    // A short sale credits its proceeds net of fee, and covering pays price
+    // plus fee, so equity is cash + position * price while the short is open
+    portfolio.reset(10000.0, 4);
+    check(near(portfolio.sell(10, 100.0, 0), 999.0), "a short sale credits its proceeds net of fee");
+    check(near(portfolio.cash(), 10999.0) && portfolio.position() == -10 && portfolio.entryPrice() == 100.0,
+          "a short entry");
+    check(near(portfolio.equity(90.0), 10099.0), "a short gains as the price falls");
+    check(near(portfolio.equity(110.0), 9899.0), "and loses as it rises");
+    check(near(portfolio.close(90.0, 1), -900.9), "covering pays price plus fee");
+    check(near(portfolio.cash(), 10098.1), "the short's profit net of both fees");
+    check(portfolio.trades().size() == 2 && sameTrade(portfolio.trades()[0], 0, "SHORT", "SELL", 100.0, 10) &&
+              sameTrade(portfolio.trades()[1], 1, "EXIT_SHORT", "BUY", 90.0, 10),
+          "short and cover trade records");
+
+    // Moving across zero is an exit and an entry at the same price
+    portfolio.reset(10000.0, 4);
+    portfolio.buy(10, 100.0, 0);
+    portfolio.buy(5, 102.0, 1);
+    check(portfolio.entryPrice() == 100.0, "adding to a position keeps its entry price");
+    portfolio.targetPosition(-5, 104.0, 2);
+    check(portfolio.trades().size() == 4 && sameTrade(portfolio.trades()[2], 2, "EXIT_LONG", "SELL", 104.0, 15) &&
+              sameTrade(portfolio.trades()[3], 2, "SHORT", "SELL", 104.0, 5),
+          "long to short records an exit and an entry");
+    check(portfolio.entryPrice() == 104.0 && portfolio.account().fills == 4, "the flip resets the entry price");
+    check(portfolio.targetPosition(-5, 120.0, 3) == 0.0 && portfolio.trades().size() == 4,
+          "moving to the current position is not a trade");
+    const double cashBefore = portfolio.cash();
+    const SimulationResult finished = portfolio.finish(103.0, 3);
+    check(near(finished.finalPortfolioValue, cashBefore - 5 * 103.0 * 1.001) &&
+              near(finished.profitLoss, finished.finalPortfolioValue - 10000.0) && finished.trades.size() == 5,
+          "finish covers the open short at the last price");
+
+    // tradeTo without execute leaves the account alone
+    Account account{1000.0, 3.0, 50.0, 1.0};
+    tradeTo(account, -2.0, 60.0, 0.01, false);
+    check(account.cash == 1000.0 && account.position == 3.0 && account.entryPrice == 50.0 && account.fills == 1.0,
+          "an unexecuted tradeTo changes nothing");
+
+    // Random orders keep equity = cash + position * price, with cash moving
+    // by exactly what each order reports
+    std::mt19937 rng(5);
+    portfolio.reset(50000.0, 0);
+    double price = 100.0;
+    bool cashMatches = true;
+    double expectedCash = 50000.0;
+    for (int step = 0; step < 5000; ++step) {
+        price *= std::exp(std::normal_distribution<double>(0.0, 0.01)(rng));
+        const double target = static_cast<double>(static_cast<int>(rng() % 41) - 20);
+        const double fill = fillCash(target - portfolio.position(), price, 0.001);
+        expectedCash += fill;
+        cashMatches = cashMatches && near(portfolio.targetPosition(target, price, step), fill);
+    }
+    check(cashMatches && near(portfolio.cash(), expectedCash), "random orders move cash by their fills");
+    check(near(portfolio.equity(price), portfolio.cash() + portfolio.position() * price), "equity identity");
+
+    // floorBranchless and affordableShares agree with std::floor
+    bool floors = true;
+    for (double x : {0.0, -0.0, 0.5, -0.5, 1.0, -1.0, 2.999999, -2.000001, 1e15 + 0.5, -1e15 - 0.5, 1e300, -1e300}) {
+        floors = floors && floorBranchless(x) == std::floor(x);
+    }
+    for (int i = 0; i < 10000; ++i) {
+        const double x = std::normal_distribution<double>(0.0, 1e6)(rng);
+        floors = floors && floorBranchless(x) == std::floor(x);
+    }
+    check(floors, "floorBranchless matches std::floor");
+    check(affordableShares(10010.0, 100.0, 0.001) == 100.0 && affordableShares(10009.99, 100.0, 0.001) == 99.0,
+          "affordableShares includes the fee");
+
+    bool threw = false;
+    try {
+        Portfolio negative(-0.001);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    check(threw, "a negative fee rate is refused");
+
+    // MACD: every bar's recorded equity is cash + position * price, shorts
+    // included, and the batch engine trades and values exactly the same
+    const MarketData data = randomWalk(3000, 17);
+    const std::vector<MACDConfig> configs = {
+        {12, 26, 9, 0.02, 0.001}, {5, 35, 5, 0.01, 0.0005}, {8, 17, 9, 0.05, 0.002}, {3, 10, 16, 0.03, 0.0}};
+    const std::vector<BatchResult> batch = MACDBatch(configs).run(data, 100000.0);
+    for (size_t c = 0; c < configs.size(); ++c) {
+        const MACDConfig& config = configs[c];
+        MACDStrategy strategy(0.02, 0.3, 1e-6, 0.1, 0.85, config.macdFastPeriod, config.macdSlowPeriod,
+                              config.signalPeriod, 0.05, config.stopLossPercentage, config.transactionCost);
+        const SimulationResult result = quietly(strategy, data, 100000.0);
+        const std::string name = "MACD config " + std::to_string(c) + ": ";
+        bool identity = result.historical.size() == data.prices.size();
+        bool shorted = false;
+        for (size_t i = 0; identity && i < result.historical.size(); ++i) {
+            const HistoricalDataPoint& point = result.historical[i];
+            identity = near(point.portfolioValue, point.cash + point.position * data.prices[i]);
+            shorted = shorted || point.position < 0;
+        }
+        check(identity, name + "recorded equity is cash + position * price");
+        check(shorted, name + "the run holds a short at some point");
+        check(near(batch[c].finalPortfolioValue, result.finalPortfolioValue) &&
+                  batch[c].numTrades == static_cast<int>(result.trades.size()),
+              name + "MACDBatch matches MACDStrategy");
+    }
+
+    if (failures > 0) {
+        std::printf("portfolio_test: %d checks failed\n", failures);
+        return 1;
+    }
+    std::printf("portfolio_test: passed\n");
+    return 0;
+}
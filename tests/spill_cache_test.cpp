@@ -0,0 +1,154 @@
+// SpillCache: several processes sharing one spill directory stay within
+// one disk budget between them, and eviction removes the least recently
+// used files whichever process wrote them.
+#include "cache/spill_cache.h"
+#include <cstdio>
+#include <dirent.h>
+#include <random>
+#include <string>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace trading;
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::printf("  FAILED: %s\n", what.c_str());
+            ++failures;
+        }
+    }
+
+    // Random bytes, so gzip cannot shrink them much
+    std::string body(size_t bytes, uint64_t seed) {
+        std::mt19937_64 rng(seed);
+        std::string out(bytes, '\0');
+        for (auto& c : out) {
+            c = static_cast<char>(rng());
+        }
+        return out;
+    }
+
+    // Bytes of *.spill files, as they are on disk
+    size_t spilledBytes(const std::string& dir, size_t& files) {
+        size_t total = 0;
+        files = 0;
+        if (DIR* d = opendir(dir.c_str())) {
+            while (struct dirent* entry = readdir(d)) {
+                std::string name = entry->d_name;
+                struct stat st;
+                if (name.size() > 6 && name.compare(name.size() - 6, 6, ".spill") == 0 &&
+                    stat((dir + "/" + name).c_str(), &st) == 0) {
+                    total += static_cast<size_t>(st.st_size);
+                    files++;
+                }
+            }
+            closedir(d);
+        }
+        return total;
+    }
+
+    void removeAll(const std::string& dir) {
+        if (DIR* d = opendir(dir.c_str())) {
+            while (struct dirent* entry = readdir(d)) {
+                std::string name = entry->d_name;
+                if (name != "." && name != "..") {
+                    unlink((dir + "/" + name).c_str());
+                }
+            }
+            closedir(d);
+        }
+        rmdir(dir.c_str());
+    }
+
+    // Backdates the spill files written in the last minute by `secondsAgo`
+    void age(const std::string& dir, int secondsAgo) {
+        struct timeval now;
+        gettimeofday(&now, nullptr);
+        struct timeval times[2] = {{now.tv_sec - secondsAgo, 0}, {now.tv_sec - secondsAgo, 0}};
+        if (DIR* d = opendir(dir.c_str())) {
+            while (struct dirent* entry = readdir(d)) {
+                std::string name = entry->d_name;
+                const std::string path = dir + "/" + name;
+                struct stat st;
+                if (name.size() > 6 && name.compare(name.size() - 6, 6, ".spill") == 0 &&
+                    stat(path.c_str(), &st) == 0 && st.st_mtime > now.tv_sec - 60) {
+                    utimes(path.c_str(), times);
+                }
+            }
+            closedir(d);
+        }
+    }
+}
+
+int main() {
+    constexpr size_t kBudget = 1 << 20;
+    constexpr size_t kBody = 100 << 10;
+
+    // Four worker processes spill 20 bodies each into one directory
+    char dirTemplate[] = "/tmp/spill_cache_test.XXXXXX";
+    const std::string dir = mkdtemp(dirTemplate);
+    std::vector<pid_t> children;
+    for (int worker = 0; worker < 4; ++worker) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            SpillCache cache(dir, "test", 1, kBudget);
+            for (int i = 0; i < 20; ++i) {
+                cache.put("/simulate?w=" + std::to_string(worker) + "&i=" + std::to_string(i),
+                          body(kBody, worker * 100 + i));
+            }
+            _exit(0);
+        }
+        children.push_back(pid);
+    }
+    bool exited = true;
+    for (pid_t pid : children) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        exited = exited && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    check(exited, "every worker process finished its puts");
+
+    size_t files = 0;
+    const size_t onDisk = spilledBytes(dir, files);
+    check(onDisk <= kBudget && files > 0, "the shared directory stays within one budget: " + std::to_string(onDisk));
+    SpillCache reader(dir, "test", 1, kBudget);
+    check(reader.bytes() == onDisk && reader.size() == files, "the ledger matches the files on disk");
+    removeAll(dir);
+
+    // Least recently used across processes: a hit in one process keeps a
+    // file that another process's puts would otherwise evict first
+    char lruTemplate[] = "/tmp/spill_cache_test.XXXXXX";
+    const std::string lruDir = mkdtemp(lruTemplate);
+    const size_t lruBudget = 3 * kBody + kBody / 2;
+    {
+        SpillCache first(lruDir, "test", 1, lruBudget);
+        first.put("a", body(kBody, 1));
+        age(lruDir, 3000);
+        first.put("b", body(kBody, 2));
+        age(lruDir, 2000);
+        first.put("c", body(kBody, 3));
+        age(lruDir, 1000);
+    }
+    SpillCache second(lruDir, "test", 1, lruBudget);
+    check(second.size() == 3, "the files of the first process are counted");
+    check(second.get("a") != nullptr, "a is served from the file the first process wrote");
+    second.put("d", body(kBody, 4));
+    check(second.get("b") == nullptr, "the least recently used file was evicted");
+    check(second.get("a") != nullptr && second.get("c") != nullptr && second.get("d") != nullptr,
+          "a, used since, and the newer files are kept");
+    check(second.size() == 3, "the ledger counts the remaining files");
+    removeAll(lruDir);
+
+    if (failures > 0) {
+        std::printf("spill_cache_test: %d checks failed\n", failures);
+        return 1;
+    }
+    std::printf("spill_cache_test: passed\n");
+    return 0;
+}
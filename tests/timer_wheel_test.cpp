@@ -0,0 +1,192 @@
+// TimerWheel against a brute-force map of pending timers: random schedules,
+// cancels and advances over short and long horizons, including timers
+// beyond the top level and advances that jump far ahead. Also the
+// FixedTimeStrategy periods scheduled on it.
+#include "strategies/fixed_time_strategy.h"
+#include "store/bar_columns.h"
+#include "utils/timer_wheel.h"
+#include <algorithm>
+#include <cstdio>
+#include <fcntl.h>
+#include <map>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+using namespace trading;
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::printf("  FAILED: %s\n", what.c_str());
+            ++failures;
+        }
+    }
+
+    struct Reference {
+        int64_t due;
+        uint64_t payload;
+    };
+
+    // Timers due at or before `time`, by due time and then id
+    std::vector<std::pair<int64_t, TimerWheel::TimerId>> takeDue(std::map<TimerWheel::TimerId, Reference>& pending,
+                                                                 int64_t time) {
+        std::vector<std::pair<int64_t, TimerWheel::TimerId>> due;
+        for (auto it = pending.begin(); it != pending.end();) {
+            if (it->second.due <= time) {
+                due.push_back({it->second.due, it->first});
+                it = pending.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        std::sort(due.begin(), due.end());
+        return due;
+    }
+
+    // One randomized run; `horizon` bounds how far ahead timers are due and
+    // `stride` how far each advance moves
+    void run(unsigned seed, int64_t start, int64_t horizon, int64_t stride, int steps) {
+        const std::string name = "seed " + std::to_string(seed) + ": ";
+        std::mt19937_64 rng(seed);
+        TimerWheel wheel(start);
+        std::map<TimerWheel::TimerId, Reference> pending;
+        std::vector<TimerWheel::TimerId> issued;
+        std::vector<TimerWheel::Expired> expired;
+        int64_t now = start;
+        uint64_t nextPayload = 1;
+        bool matches = true;
+        bool ordered = true;
+        bool idsFresh = true;
+        bool cancelsAgree = true;
+
+        for (int step = 0; step < steps && matches; ++step) {
+            const uint64_t action = rng() % 10;
+            if (action < 5) {
+                // Mostly future timers, some overdue and some due right now
+                const int64_t offset = static_cast<int64_t>(rng() % static_cast<uint64_t>(horizon)) - horizon / 20;
+                const int64_t due = now + offset;
+                const TimerWheel::TimerId id = wheel.schedule(due, nextPayload);
+                idsFresh = idsFresh && id != 0 && pending.count(id) == 0;
+                pending[id] = {due, nextPayload++};
+                issued.push_back(id);
+            } else if (action < 7 && !issued.empty()) {
+                // Cancel any id ever issued, pending or not
+                const TimerWheel::TimerId id = issued[rng() % issued.size()];
+                const bool wasPending = pending.erase(id) == 1;
+                cancelsAgree = cancelsAgree && wheel.pending(id) == wasPending && wheel.cancel(id) == wasPending &&
+                               !wheel.pending(id);
+            } else {
+                // Sometimes a backwards or zero move, which must not move the clock
+                const int64_t move = static_cast<int64_t>(rng() % static_cast<uint64_t>(stride)) - stride / 10;
+                const int64_t time = now + move;
+                expired.clear();
+                wheel.advance(time, expired);
+                now = std::max(now, time);
+                const auto due = takeDue(pending, now);
+                for (size_t i = 1; i < expired.size(); ++i) {
+                    ordered = ordered && expired[i - 1].due <= expired[i].due;
+                }
+                std::vector<std::pair<int64_t, TimerWheel::TimerId>> fired;
+                for (const auto& timer : expired) {
+                    fired.push_back({timer.due, timer.id});
+                }
+                std::sort(fired.begin(), fired.end());
+                bool payloads = true;
+                for (const auto& timer : expired) {
+                    payloads = payloads && timer.payload != 0;
+                }
+                matches = fired == due && payloads && wheel.now() == now;
+            }
+            matches = matches && wheel.size() == pending.size();
+        }
+        check(matches, name + "fires exactly the timers due, and size() follows");
+        check(ordered, name + "timers expire in due order");
+        check(idsFresh, name + "ids are non-zero and never reused while pending");
+        check(cancelsAgree, name + "pending() and cancel() agree with the reference");
+
+        // Draining far ahead fires everything left
+        expired.clear();
+        const int64_t end = now + horizon * 4;
+        wheel.advance(end, expired);
+        check(expired.size() == pending.size() && wheel.size() == 0, name + "draining fires every remaining timer");
+    }
+
+    // FixedTimeStrategy logs every tick to stdout; the test only wants its trades
+    SimulationResult quietly(Strategy& strategy, const MarketData& data) {
+        std::fflush(stdout);
+        const int saved = dup(STDOUT_FILENO);
+        const int devNull = open("/dev/null", O_WRONLY | O_CLOEXEC);
+        dup2(devNull, STDOUT_FILENO);
+        close(devNull);
+        SimulationResult result = strategy.execute(data, 100000.0);
+        std::fflush(stdout);
+        dup2(saved, STDOUT_FILENO);
+        close(saved);
+        return result;
+    }
+}
+
+int main() {
+    // Within one level-0 block, within the levels, and beyond 64^4 so timers
+    // wait in the overflow list; negative and block-edge starting clocks
+    run(1, 0, 60, 8, 20000);
+    run(2, 1000, 5000, 300, 20000);
+    run(3, -12345, 300000, 20000, 20000);
+    run(4, (int64_t(1) << 24) - 3, int64_t(1) << 26, int64_t(1) << 23, 20000);
+    run(5, 1710149400, int64_t(1) << 34, int64_t(1) << 30, 20000);
+
+    // Same-time timers and timers scheduled overdue fire on the next advance,
+    // in due order, even if the clock does not move
+    TimerWheel wheel(100);
+    std::vector<TimerWheel::Expired> expired;
+    wheel.schedule(90, 1);
+    wheel.schedule(100, 2);
+    wheel.schedule(50, 3);
+    wheel.advance(100, expired);
+    check(expired.size() == 3 && expired[0].payload == 3 && expired[1].payload == 1 && expired[2].payload == 2,
+          "overdue timers fire in due order without moving the clock");
+
+    // An advance that stops one short of a timer keeps it, the next fires it
+    expired.clear();
+    const TimerWheel::TimerId late = wheel.schedule(100 + 64 * 64 * 64 * 64 + 1, 4);
+    wheel.advance(100 + 64 * 64 * 64 * 64, expired);
+    check(expired.empty() && wheel.pending(late), "an overflow timer waits until it is due");
+    wheel.advance(100 + 64 * 64 * 64 * 64 + 1, expired);
+    check(expired.size() == 1 && expired[0].id == late && !wheel.pending(late), "then fires on time");
+
+    // reset() drops timers and invalidates their ids
+    const TimerWheel::TimerId dropped = wheel.schedule(wheel.now() + 10, 5);
+    wheel.reset(0);
+    expired.clear();
+    wheel.advance(1000, expired);
+    check(expired.empty() && wheel.size() == 0 && !wheel.pending(dropped) && !wheel.cancel(dropped),
+          "reset drops every timer");
+
+    // Periods whose length in seconds overflows an int: the position is held
+    // to the end of the session instead of being sold on the next bar
+    MarketData session;
+    for (int i = 0; i < 78; ++i) {
+        session.prices.push_back(100.0 + i * 0.1);
+        session.timestamps.push_back(formatBarTime(parseBarTime("2024-03-11 09:30:00") + i * 300));
+    }
+    FixedTimeStrategy longHold(40000000, 0.9, 0, 0.001);
+    const SimulationResult held = quietly(longHold, session);
+    check(held.trades.size() == 2 && held.trades.front().timeStep == 0 && held.trades.back().timeStep == 77,
+          "a holding period past INT_MAX seconds holds to the end");
+    FixedTimeStrategy longCooldown(10, 0.9, 40000000, 0.001);
+    const SimulationResult cooled = quietly(longCooldown, session);
+    check(cooled.trades.size() == 2 && cooled.trades.back().timeStep == 2,
+          "a cooldown past INT_MAX seconds allows a single trade");
+
+    if (failures > 0) {
+        std::printf("timer_wheel_test: %d checks failed\n", failures);
+        return 1;
+    }
+    std::printf("timer_wheel_test: passed\n");
+    return 0;
+}
@@ -43,6 +43,9 @@ export async function GET(request: NextRequest) {
           'Content-Type': 'application/json',
           ...(TRADING_API_TOKEN ? { Authorization: `Bearer ${TRADING_API_TOKEN}` } : {}),
         },
+        // Closing the backend connection when the browser goes away lets the
+        // server cancel the simulation instead of finishing it for nobody.
+        signal: request.signal,
       }
     );
 